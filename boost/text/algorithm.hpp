@@ -2,9 +2,14 @@
 #define BOOST_TEXT_ALGORITHM_HPP
 
 #include <boost/text/text_view.hpp>
+#include <boost/text/transcode.hpp>
 #include <boost/text/detail/algorithm.hpp>
 
-#include <boost/algorithm/searching/boyer_moore.hpp>
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
+#include <cstring>
 
 
 namespace boost { namespace text {
@@ -64,30 +69,239 @@ namespace boost { namespace text {
 
     namespace detail {
 
-#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
-
-        inline int find_impl (
+        // Searches the positions at which p could start, [r_first, r_last -
+        // p.size()], for p's first char, and compares p at each one found.
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_scalar (
             char const * r_first, char const * r_last,
             char const * p_first, char const * p_last
         ) noexcept {
-            if (p_first == p_last)
-                return 0;
-
-            if (r_first == r_last)
+            std::ptrdiff_t const p_len = p_last - p_first;
+            if (r_last - r_first < p_len)
                 return -1;
 
-            auto const pair =
-                algorithm::boyer_moore_search(r_first, r_last, p_first, p_last);
+            char const * const search_last = r_last - p_len + 1;
+            char const p_head = *p_first;
+            char const * it = r_first;
+            while (true) {
+                it = strchr(it, search_last, p_head);
+                if (it == search_last)
+                    return -1;
+                if (compare_impl(it, it + p_len, p_first, p_last) == 0)
+                    return it - r_first;
+                ++it;
+            }
+        }
 
-            if (pair.first == pair.second)
-                return -1;
+        // The runtime searches below take the range of positions at which p
+        // could start, [first, search_last), and return the position of the
+        // first (or for rfind, last) match, or nullptr.  Each one compares
+        // all of p only at positions that match two of p's chars, at offsets
+        // i and j within p.  find() uses p's first and last chars; a
+        // searcher uses the two it expects to be rarest.
+
+        inline bool matches_at (
+            char const * it,
+            char const * p_first,
+            std::ptrdiff_t p_len
+        ) noexcept
+        { return p_len <= 2 || !memcmp(it, p_first, p_len); }
+
+        inline char const * find_memchr (
+            char const * first, char const * search_last,
+            char const * p_first, std::ptrdiff_t p_len,
+            std::ptrdiff_t i, std::ptrdiff_t j
+        ) noexcept {
+            while (first != search_last) {
+                void const * const ptr =
+                    memchr(first + i, p_first[i], search_last - first);
+                if (!ptr)
+                    return nullptr;
+                first = static_cast<char const *>(ptr) - i;
+                if (first[j] == p_first[j] && matches_at(first, p_first, p_len))
+                    return first;
+                ++first;
+            }
+            return nullptr;
+        }
+
+        inline char const * rfind_bytewise (
+            char const * first, char const * search_last,
+            char const * p_first, std::ptrdiff_t p_len
+        ) noexcept {
+            char const p_tail = p_first[p_len - 1];
+            while (first != search_last) {
+                --search_last;
+                if (*search_last == *p_first &&
+                    search_last[p_len - 1] == p_tail &&
+                    matches_at(search_last, p_first, p_len)) {
+                    return search_last;
+                }
+            }
+            return nullptr;
+        }
+
+#if BOOST_TEXT_SSE2
+
+        // Returns a mask with bit k set iff it[k + i] is p[i] (broadcast in
+        // head) and it[k + j] is p[j] (broadcast in tail).
+        inline uint32_t sse2_candidates (
+            char const * it,
+            __m128i head,
+            __m128i tail,
+            std::ptrdiff_t i,
+            std::ptrdiff_t j
+        ) noexcept {
+            __m128i const firsts = _mm_loadu_si128((__m128i const *)(it + i));
+            __m128i const lasts = _mm_loadu_si128((__m128i const *)(it + j));
+            return (uint32_t)_mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(firsts, head),
+                _mm_cmpeq_epi8(lasts, tail)
+            ));
+        }
+
+        inline char const * find_sse2 (
+            char const * first, char const * search_last,
+            char const * p_first, std::ptrdiff_t p_len,
+            std::ptrdiff_t i, std::ptrdiff_t j
+        ) noexcept {
+            __m128i const head = _mm_set1_epi8(p_first[i]);
+            __m128i const tail = _mm_set1_epi8(p_first[j]);
+            for (; 16 <= search_last - first; first += 16) {
+                uint32_t mask = sse2_candidates(first, head, tail, i, j);
+                while (mask) {
+                    char const * const it = first + countr_zero(mask);
+                    if (matches_at(it, p_first, p_len))
+                        return it;
+                    mask &= mask - 1;
+                }
+            }
+            return find_memchr(first, search_last, p_first, p_len, i, j);
+        }
+
+        inline char const * rfind_sse2 (
+            char const * first, char const * search_last,
+            char const * p_first, std::ptrdiff_t p_len
+        ) noexcept {
+            __m128i const head = _mm_set1_epi8(*p_first);
+            __m128i const tail = _mm_set1_epi8(p_first[p_len - 1]);
+            while (16 <= search_last - first) {
+                search_last -= 16;
+                uint32_t mask =
+                    sse2_candidates(search_last, head, tail, 0, p_len - 1);
+                while (mask) {
+                    int const k = 31 - countl_zero(mask);
+                    char const * const it = search_last + k;
+                    if (matches_at(it, p_first, p_len))
+                        return it;
+                    mask &= ~(1u << k);
+                }
+            }
+            return rfind_bytewise(first, search_last, p_first, p_len);
+        }
+
+#endif
 
-            return pair.first - r_first;
+#if BOOST_TEXT_AVX2
+
+        BOOST_TEXT_TARGET_AVX2 inline uint32_t avx2_candidates (
+            char const * it,
+            __m256i head,
+            __m256i tail,
+            std::ptrdiff_t i,
+            std::ptrdiff_t j
+        ) noexcept {
+            __m256i const firsts =
+                _mm256_loadu_si256((__m256i const *)(it + i));
+            __m256i const lasts =
+                _mm256_loadu_si256((__m256i const *)(it + j));
+            return (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(
+                _mm256_cmpeq_epi8(firsts, head),
+                _mm256_cmpeq_epi8(lasts, tail)
+            ));
+        }
+
+        BOOST_TEXT_TARGET_AVX2 inline char const * find_avx2 (
+            char const * first, char const * search_last,
+            char const * p_first, std::ptrdiff_t p_len,
+            std::ptrdiff_t i, std::ptrdiff_t j
+        ) noexcept {
+            __m256i const head = _mm256_set1_epi8(p_first[i]);
+            __m256i const tail = _mm256_set1_epi8(p_first[j]);
+            for (; 32 <= search_last - first; first += 32) {
+                uint32_t mask = avx2_candidates(first, head, tail, i, j);
+                while (mask) {
+                    char const * const it = first + countr_zero(mask);
+                    if (matches_at(it, p_first, p_len))
+                        return it;
+                    mask &= mask - 1;
+                }
+            }
+            return find_sse2(first, search_last, p_first, p_len, i, j);
         }
 
+        BOOST_TEXT_TARGET_AVX2 inline char const * rfind_avx2 (
+            char const * first, char const * search_last,
+            char const * p_first, std::ptrdiff_t p_len
+        ) noexcept {
+            __m256i const head = _mm256_set1_epi8(*p_first);
+            __m256i const tail = _mm256_set1_epi8(p_first[p_len - 1]);
+            while (32 <= search_last - first) {
+                search_last -= 32;
+                uint32_t mask =
+                    avx2_candidates(search_last, head, tail, 0, p_len - 1);
+                while (mask) {
+                    int const k = 31 - countl_zero(mask);
+                    char const * const it = search_last + k;
+                    if (matches_at(it, p_first, p_len))
+                        return it;
+                    mask &= ~(1u << k);
+                }
+            }
+            return rfind_sse2(first, search_last, p_first, p_len);
+        }
+
+#endif
+
+        // Returns the first match of p in [r_first, r_last), or nullptr,
+        // comparing p[i] and p[j] before the rest of p.
+        // \pre p_len <= r_last - r_first
+        inline char const * find_filtered (
+            char const * r_first, char const * r_last,
+            char const * p_first, std::ptrdiff_t p_len,
+            std::ptrdiff_t i, std::ptrdiff_t j
+        ) noexcept {
+            if (p_len == 1) {
+                return static_cast<char const *>(
+                    memchr(r_first, *p_first, r_last - r_first)
+                );
+            }
+
+            char const * const search_last = r_last - p_len + 1;
+#if BOOST_TEXT_AVX2
+            if (cpu_has_avx2())
+                return find_avx2(r_first, search_last, p_first, p_len, i, j);
+            return find_sse2(r_first, search_last, p_first, p_len, i, j);
+#elif BOOST_TEXT_SSE2
+            return find_sse2(r_first, search_last, p_first, p_len, i, j);
 #else
+            return find_memchr(r_first, search_last, p_first, p_len, i, j);
+#endif
+        }
+
+        inline std::ptrdiff_t find_runtime (
+            char const * r_first, char const * r_last,
+            char const * p_first, char const * p_last
+        ) noexcept {
+            std::ptrdiff_t const p_len = p_last - p_first;
+            if (r_last - r_first < p_len)
+                return -1;
+            char const * const it = find_filtered(
+                r_first, r_last, p_first, p_len, 0, p_len - 1
+            );
+            return it ? it - r_first : -1;
+        }
 
-        inline constexpr int find_impl (
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_impl (
             char const * r_first, char const * r_last,
             char const * p_first, char const * p_last
         ) noexcept {
@@ -97,27 +311,14 @@ namespace boost { namespace text {
             if (r_first == r_last)
                 return -1;
 
-            char const p_head = *p_first;
-            int const p_len = p_last - p_first;
-            const char * it = r_first;
-            while (true) {
-                int const r_len = r_last - it;
-                if (r_len < p_len)
-                    return -1;
-
-                it = strchr(it, r_last, p_head);
-                if (it == r_last)
-                    return -1;
-
-                text_view candidate(it, p_len);
-                if (compare_impl(candidate.begin(), candidate.end(), p_first, p_last) == 0)
-                    return it - r_first;
-
-                ++it;
-            }
-        }
-
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+            return find_runtime(r_first, r_last, p_first, p_last);
+#else
+            if (!constant_evaluated())
+                return find_runtime(r_first, r_last, p_first, p_last);
+            return find_scalar(r_first, r_last, p_first, p_last);
 #endif
+        }
 
     }
 
@@ -126,7 +327,7 @@ namespace boost { namespace text {
         considered to match the beginning of r.
 
         This function is constexpr in C++14 and later. */
-    inline BOOST_TEXT_CXX14_CONSTEXPR int find (text_view r, text_view p) noexcept
+    inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find (text_view r, text_view p) noexcept
     { return detail::find_impl(begin(r), end(r), begin(p), end(p)); }
 
     /** Returns the offset of the first occurance of pattern p within range r,
@@ -139,7 +340,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find (text_view r, CharRange const & p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find(r, text_view(p)); }
 
     /** Returns the offset of the first occurance of pattern p within range r,
@@ -152,7 +353,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find (CharRange const & r, text_view p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find(text_view(r), p); }
 
     /** Returns the offset of the first occurance of pattern p within range r,
@@ -165,7 +366,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange, typename PatternCharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find (CharRange const & r, PatternCharRange const & p) noexcept
-        -> detail::rngs_alg_ret_t<int, CharRange, PatternCharRange>
+        -> detail::rngs_alg_ret_t<std::ptrdiff_t, CharRange, PatternCharRange>
     { return find(text_view(r), text_view(p)); }
 
 
@@ -184,7 +385,7 @@ namespace boost { namespace text {
             if (r_first == r_last)
                 return text_view(nullptr, 0);
 
-            int const n = find_impl(r_first, r_last, p_first, p_last);
+            std::ptrdiff_t const n = find_impl(r_first, r_last, p_first, p_last);
             if (n < 0)
                 return text_view(nullptr, 0);
             return text_view(r_first + n, p_last - p_first);
@@ -241,11 +442,546 @@ namespace boost { namespace text {
 
 
 
+    // char sets
+
+    namespace detail {
+
+        /** A set of chars, stored as a 256-bit bitmap. */
+        struct char_set
+        {
+            BOOST_TEXT_CXX14_CONSTEXPR char_set () noexcept : bits_ () {}
+
+            BOOST_TEXT_CXX14_CONSTEXPR
+            char_set (char const * first, char const * last) noexcept :
+                bits_ ()
+            {
+                while (first != last) {
+                    insert(*first++);
+                }
+            }
+
+            BOOST_TEXT_CXX14_CONSTEXPR void insert (char c) noexcept
+            {
+                unsigned char const uc = c;
+                bits_[uc >> 6] |= uint64_t(1) << (uc & 63);
+            }
+
+            constexpr bool contains (char c) const noexcept
+            {
+                return
+                    (bits_[(unsigned char)c >> 6] >> ((unsigned char)c & 63)) & 1;
+            }
+
+            uint64_t bits_[4];
+        };
+
+        // The scalar searches return a pointer to the first (or for the
+        // reverse searches, last) char c in [first, last) for which
+        // set.contains(c) == In, or nullptr if there is none.
+
+        template <bool In>
+        BOOST_TEXT_CXX14_CONSTEXPR char const * find_in_set_scalar (
+            char const * first, char const * last,
+            char_set const & set
+        ) noexcept {
+            for (; first != last; ++first) {
+                if (set.contains(*first) == In)
+                    return first;
+            }
+            return nullptr;
+        }
+
+        template <bool In>
+        BOOST_TEXT_CXX14_CONSTEXPR char const * rfind_in_set_scalar (
+            char const * first, char const * last,
+            char_set const & set
+        ) noexcept {
+            while (first != last) {
+                --last;
+                if (set.contains(*last) == In)
+                    return last;
+            }
+            return nullptr;
+        }
+
+        /** Sets no larger than this are searched by comparing each char in
+            a block with each member of the set, when the nibble tables
+            below cannot be used. */
+        constexpr int char_set_compare_max = 8;
+
+        /** Searches shorter than this are done with find_in_set_scalar();
+            they are not worth building char_set_tables for. */
+        constexpr int char_set_tables_min = 32;
+
+        /** A char_set, plus the data the vectorized searches use.
+
+            The nibble tables hold the set as a pair of 16-entry tables, lo_
+            indexed by a char's low 4 bits and hi_ by its high 4 bits, such
+            that c is in the set iff lo_[c & 0xf] & hi_[c >> 4] is nonzero.
+            Each high nibble is assigned a bit for its set of low nibbles,
+            so this works for any set in which no more than 8 distinct sets
+            of low nibbles occur; this is the case for all sets of up to 8
+            chars, and for most sets of ASCII punctuation or delimiters. */
+        struct char_set_tables
+        {
+            explicit char_set_tables (char_set const & set) noexcept :
+                set_ (set),
+                size_ (0),
+                has_nibbles_ (true),
+                lo_ (),
+                hi_ ()
+            {
+                uint16_t lows[16] = {};
+                for (int word = 0; word < 4; ++word) {
+                    uint64_t bits = set.bits_[word];
+                    while (bits) {
+                        int const c = word * 64 + countr_zero64(bits);
+                        if (size_ < char_set_compare_max)
+                            members_[size_] = (char)c;
+                        ++size_;
+                        lows[c >> 4] |= 1 << (c & 0xf);
+                        bits &= bits - 1;
+                    }
+                }
+
+                uint16_t classes[8] = {};
+                int num_classes = 0;
+                for (int hi = 0; hi < 16 && has_nibbles_; ++hi) {
+                    if (!lows[hi])
+                        continue;
+                    int k = 0;
+                    while (k < num_classes && classes[k] != lows[hi]) {
+                        ++k;
+                    }
+                    if (k == num_classes) {
+                        if (num_classes == 8) {
+                            has_nibbles_ = false;
+                            break;
+                        }
+                        classes[num_classes++] = lows[hi];
+                        for (int lo = 0; lo < 16; ++lo) {
+                            if (lows[hi] & (1 << lo))
+                                lo_[lo] |= 1 << k;
+                        }
+                    }
+                    hi_[hi] |= 1 << k;
+                }
+            }
+
+            char_set set_;
+            int size_;
+            bool has_nibbles_;
+            char members_[char_set_compare_max];
+            unsigned char lo_[16];
+            unsigned char hi_[16];
+        };
+
+#if BOOST_TEXT_SSE2
+
+        // Returns a mask with bit k set iff set.contains(it[k]) == In.
+        template <bool In>
+        inline uint32_t sse2_in_set_mask (
+            char const * it,
+            __m128i const * members,
+            int size
+        ) noexcept {
+            __m128i const v = _mm_loadu_si128((__m128i const *)it);
+            __m128i any = _mm_setzero_si128();
+            for (int i = 0; i < size; ++i) {
+                any = _mm_or_si128(any, _mm_cmpeq_epi8(v, members[i]));
+            }
+            uint32_t const mask = (uint32_t)_mm_movemask_epi8(any);
+            return In ? mask : ~mask & 0xffff;
+        }
+
+        template <bool In>
+        inline char const * find_in_set_sse2 (
+            char const * first, char const * last,
+            char_set_tables const & tables
+        ) noexcept {
+            __m128i members[char_set_compare_max];
+            for (int i = 0; i < tables.size_; ++i) {
+                members[i] = _mm_set1_epi8(tables.members_[i]);
+            }
+            for (; 16 <= last - first; first += 16) {
+                uint32_t const mask =
+                    sse2_in_set_mask<In>(first, members, tables.size_);
+                if (mask)
+                    return first + countr_zero(mask);
+            }
+            return find_in_set_scalar<In>(first, last, tables.set_);
+        }
+
+        template <bool In>
+        inline char const * rfind_in_set_sse2 (
+            char const * first, char const * last,
+            char_set_tables const & tables
+        ) noexcept {
+            __m128i members[char_set_compare_max];
+            for (int i = 0; i < tables.size_; ++i) {
+                members[i] = _mm_set1_epi8(tables.members_[i]);
+            }
+            while (16 <= last - first) {
+                last -= 16;
+                uint32_t const mask =
+                    sse2_in_set_mask<In>(last, members, tables.size_);
+                if (mask)
+                    return last + 31 - countl_zero(mask);
+            }
+            return rfind_in_set_scalar<In>(first, last, tables.set_);
+        }
+
+#endif
+
+#if BOOST_TEXT_AVX2
+
+        // Returns a mask with bit k set iff set.contains(it[k]) == In,
+        // using the nibble tables broadcast to both lanes of lo and hi.
+        template <bool In>
+        BOOST_TEXT_TARGET_AVX2 inline uint32_t avx2_in_set_mask (
+            char const * it,
+            __m256i lo,
+            __m256i hi
+        ) noexcept {
+            __m256i const v = _mm256_loadu_si256((__m256i const *)it);
+            __m256i const nibble = _mm256_set1_epi8(0xf);
+            __m256i const lo_bits =
+                _mm256_shuffle_epi8(lo, _mm256_and_si256(v, nibble));
+            __m256i const hi_bits = _mm256_shuffle_epi8(
+                hi,
+                _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)
+            );
+            uint32_t const not_in = (uint32_t)_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(
+                    _mm256_and_si256(lo_bits, hi_bits),
+                    _mm256_setzero_si256()
+                )
+            );
+            return In ? ~not_in : not_in;
+        }
+
+        template <bool In>
+        BOOST_TEXT_TARGET_AVX2 inline char const * find_in_set_avx2 (
+            char const * first, char const * last,
+            char_set_tables const & tables
+        ) noexcept {
+            __m256i const lo = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((__m128i const *)tables.lo_)
+            );
+            __m256i const hi = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((__m128i const *)tables.hi_)
+            );
+            for (; 32 <= last - first; first += 32) {
+                uint32_t const mask = avx2_in_set_mask<In>(first, lo, hi);
+                if (mask)
+                    return first + countr_zero(mask);
+            }
+            return find_in_set_scalar<In>(first, last, tables.set_);
+        }
+
+        template <bool In>
+        BOOST_TEXT_TARGET_AVX2 inline char const * rfind_in_set_avx2 (
+            char const * first, char const * last,
+            char_set_tables const & tables
+        ) noexcept {
+            __m256i const lo = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((__m128i const *)tables.lo_)
+            );
+            __m256i const hi = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((__m128i const *)tables.hi_)
+            );
+            while (32 <= last - first) {
+                last -= 32;
+                uint32_t const mask = avx2_in_set_mask<In>(last, lo, hi);
+                if (mask)
+                    return last + 31 - countl_zero(mask);
+            }
+            return rfind_in_set_scalar<In>(first, last, tables.set_);
+        }
+
+#endif
+
+        template <bool In>
+        inline char const * find_in_set_runtime (
+            char const * first, char const * last,
+            char_set_tables const & tables
+        ) noexcept {
+            if (In && tables.size_ == 1) {
+                return static_cast<char const *>(
+                    memchr(first, tables.members_[0], last - first)
+                );
+            }
+#if BOOST_TEXT_AVX2
+            if (tables.has_nibbles_ && cpu_has_avx2())
+                return find_in_set_avx2<In>(first, last, tables);
+#endif
+#if BOOST_TEXT_SSE2
+            if (tables.size_ <= char_set_compare_max)
+                return find_in_set_sse2<In>(first, last, tables);
+#endif
+            return find_in_set_scalar<In>(first, last, tables.set_);
+        }
+
+        template <bool In>
+        inline char const * rfind_in_set_runtime (
+            char const * first, char const * last,
+            char_set_tables const & tables
+        ) noexcept {
+#if BOOST_TEXT_AVX2
+            if (tables.has_nibbles_ && cpu_has_avx2())
+                return rfind_in_set_avx2<In>(first, last, tables);
+#endif
+#if BOOST_TEXT_SSE2
+            if (tables.size_ <= char_set_compare_max)
+                return rfind_in_set_sse2<In>(first, last, tables);
+#endif
+            return rfind_in_set_scalar<In>(first, last, tables.set_);
+        }
+
+        template <bool In>
+        inline char const * find_in_set_runtime (
+            char const * first, char const * last,
+            char_set const & set
+        ) noexcept {
+            if (last - first < char_set_tables_min)
+                return find_in_set_scalar<In>(first, last, set);
+            return find_in_set_runtime<In>(first, last, char_set_tables(set));
+        }
+
+        template <bool In>
+        inline char const * rfind_in_set_runtime (
+            char const * first, char const * last,
+            char_set const & set
+        ) noexcept {
+            if (last - first < char_set_tables_min)
+                return rfind_in_set_scalar<In>(first, last, set);
+            return rfind_in_set_runtime<In>(first, last, char_set_tables(set));
+        }
+
+        // Returns the offset within [r_first, r_last) of the first (or for
+        // Reverse, last) char c for which (c is in [p_first, p_last)) ==
+        // In, or -1 if there is none.
+        template <bool In, bool Reverse>
+        BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_in_set_impl (
+            char const * r_first, char const * r_last,
+            char const * p_first, char const * p_last
+        ) noexcept {
+            char_set const set(p_first, p_last);
+            char const * it = nullptr;
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+            it = Reverse ?
+                rfind_in_set_runtime<In>(r_first, r_last, set) :
+                find_in_set_runtime<In>(r_first, r_last, set);
+#else
+            if (!constant_evaluated()) {
+                it = Reverse ?
+                    rfind_in_set_runtime<In>(r_first, r_last, set) :
+                    find_in_set_runtime<In>(r_first, r_last, set);
+            } else {
+                it = Reverse ?
+                    rfind_in_set_scalar<In>(r_first, r_last, set) :
+                    find_in_set_scalar<In>(r_first, r_last, set);
+            }
+#endif
+            return it ? it - r_first : -1;
+        }
+
+    }
+
+
+
+    // code_point_set
+
+    struct code_point_set;
+
+    namespace detail {
+
+        template <bool In, bool Reverse>
+        std::ptrdiff_t find_in_code_point_set (
+            char const * r_first, char const * r_last,
+            code_point_set const & s
+        ) noexcept;
+
+    }
+
+    /** A set of code points, for use with find_first_of(), find_last_of(),
+        find_first_not_of(), and find_last_not_of().  A text_view pattern
+        passed to those functions is a set of chars, each of which may match
+        part of a multi-char code point.  A code_point_set matches only
+        whole code points.
+
+        The searches using a code_point_set scan for candidate chars a block
+        at a time, as the searches using a set of chars do, and decode only
+        at the candidates.  Invalid UTF-8 in the searched range is read as
+        one replacement character per maximal invalid subsequence, as
+        utf8::to_utf32_iterator reads it, by all four searches. */
+    struct code_point_set
+    {
+        /** Default ctor.
+
+            \post empty() */
+        code_point_set () : code_point_set (std::vector<uint32_t>()) {}
+
+        /** Constructs a set of the code points in UTF-8 sequence
+            code_points. */
+        explicit code_point_set (text_view code_points) :
+            code_point_set (decode(code_points))
+        {}
+
+        /** Constructs a set of the given code points.  Values that are not
+            valid code points are ignored. */
+        code_point_set (std::initializer_list<uint32_t> code_points) :
+            code_point_set (std::vector<uint32_t>(code_points))
+        {}
+
+        /** Returns true iff the set contains no code points. */
+        bool empty () const noexcept
+        { return !leads_.size_; }
+
+        /** Returns true iff the set contains cp. */
+        bool contains (uint32_t cp) const noexcept
+        {
+            if (cp < 0x80)
+                return ascii_.set_.contains((char)cp);
+            return std::binary_search(others_.begin(), others_.end(), cp);
+        }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        explicit code_point_set (std::vector<uint32_t> code_points) :
+            ascii_ (chars(code_points, false)),
+            leads_ (chars(code_points, true)),
+            others_ (non_ascii(std::move(code_points)))
+        {}
+
+        static std::vector<uint32_t> decode (text_view tv)
+        {
+            std::vector<uint32_t> retval;
+            char const * it = tv.begin();
+            while (it != tv.end()) {
+                retval.push_back(utf8::detail::decode_code_point(it, tv.end()));
+            }
+            return retval;
+        }
+
+        // The ASCII code points, plus (if leads) the first UTF-8 code unit
+        // of each other valid code point.  Any non-ASCII char can start an
+        // invalid sequence, which is read as a replacement character, so
+        // with leads a replacement character adds all of them.
+        static detail::char_set
+        chars (std::vector<uint32_t> const & code_points, bool leads) noexcept
+        {
+            detail::char_set retval;
+            for (uint32_t cp : code_points) {
+                if (cp < 0x80) {
+                    retval.insert((char)cp);
+                } else if (!leads || !utf8::valid_code_point(cp)) {
+                    continue;
+                } else if (cp == utf8::replacement_character()) {
+                    for (int c = 0x80; c < 0x100; ++c) {
+                        retval.insert((char)c);
+                    }
+                } else if (cp < 0x800) {
+                    retval.insert((char)(0xc0 | (cp >> 6)));
+                } else if (cp < 0x10000) {
+                    retval.insert((char)(0xe0 | (cp >> 12)));
+                } else {
+                    retval.insert((char)(0xf0 | (cp >> 18)));
+                }
+            }
+            return retval;
+        }
+
+        static std::vector<uint32_t> non_ascii (std::vector<uint32_t> code_points)
+        {
+            code_points.erase(
+                std::remove_if(
+                    code_points.begin(), code_points.end(),
+                    [](uint32_t cp) {
+                        return cp < 0x80 || !utf8::valid_code_point(cp);
+                    }
+                ),
+                code_points.end()
+            );
+            std::sort(code_points.begin(), code_points.end());
+            code_points.erase(
+                std::unique(code_points.begin(), code_points.end()),
+                code_points.end()
+            );
+            return code_points;
+        }
+
+        detail::char_set_tables ascii_;
+        detail::char_set_tables leads_;
+        std::vector<uint32_t> others_;
+
+        template <bool In, bool Reverse>
+        friend std::ptrdiff_t detail::find_in_code_point_set (
+            char const * r_first, char const * r_last,
+            code_point_set const & s
+        ) noexcept;
+#endif
+
+    };
+
+    namespace detail {
+
+        // Returns the offset within [r_first, r_last) of the start of the
+        // first (or for Reverse, last) code point cp for which
+        // s.contains(cp) == In, or -1 if there is none.  Only chars in
+        // s.leads_ can start a code point in s, and only chars not in
+        // s.ascii_ can start one that is not in s, so the searches skip
+        // over all other chars without decoding them.
+        template <bool In, bool Reverse>
+        std::ptrdiff_t find_in_code_point_set (
+            char const * r_first, char const * r_last,
+            code_point_set const & s
+        ) noexcept {
+            char_set_tables const & candidates = In ? s.leads_ : s.ascii_;
+            char const * first = r_first;
+            char const * last = r_last;
+            while (true) {
+                char const * const it = Reverse ?
+                    rfind_in_set_runtime<In>(first, last, candidates) :
+                    find_in_set_runtime<In>(first, last, candidates);
+                if (!it)
+                    return -1;
+                if ((unsigned char)*it < 0x80)
+                    return it - r_first;
+
+                // Searching backward can land on a continuation char.
+                char const * cp_first = it;
+                while (Reverse && cp_first != r_first && it - cp_first < 3 &&
+                       utf8::continuation(*cp_first)) {
+                    --cp_first;
+                }
+                char const * cp_last = cp_first;
+                uint32_t cp = utf8::detail::decode_code_point(cp_last, r_last);
+                if (cp_last <= it) {
+                    cp_first = it;
+                    cp_last = it + 1;
+                    cp = utf8::replacement_character();
+                }
+
+                if (s.contains(cp) == In)
+                    return cp_first - r_first;
+                if (Reverse)
+                    last = cp_first;
+                else
+                    first = cp_last;
+            }
+        }
+
+    }
+
+
+
     // find_first_of ()
 
     namespace detail {
 
-        inline BOOST_TEXT_CXX14_CONSTEXPR int find_first_of_impl (
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_first_of_impl (
             char const * r_first, char const * r_last,
             char const * p_first, char const * p_last
         ) noexcept {
@@ -255,18 +991,7 @@ namespace boost { namespace text {
             if (r_first == r_last)
                 return -1;
 
-            char const * r_it = r_first;
-            while (r_it != r_last) {
-                char const * p_it = p_first;
-                while (p_it != p_last) {
-                    if (*r_it == *p_it)
-                        return r_it - r_first;
-                    ++p_it;
-                }
-                ++r_it;
-            }
-
-            return -1;
+            return find_in_set_impl<true, false>(r_first, r_last, p_first, p_last);
         }
 
     }
@@ -275,7 +1000,7 @@ namespace boost { namespace text {
         chars in p, or a value < 0 if none of the chars in p is found in r.
 
         This function is constexpr in C++14 and later. */
-    inline BOOST_TEXT_CXX14_CONSTEXPR int find_first_of (text_view r, text_view p) noexcept
+    inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_first_of (text_view r, text_view p) noexcept
     { return detail::find_first_of_impl(begin(r), end(r), begin(p), end(p)); }
 
     /** Returns the offset of the first occurance within range r of any of the
@@ -287,7 +1012,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_first_of (text_view r, CharRange const & p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find_first_of(r, text_view(p)); }
 
     /** Returns the offset of the first occurance within range r of any of the
@@ -299,7 +1024,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_first_of (CharRange const & r, text_view p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find_first_of(text_view(r), p); }
 
     /** Returns the offset of the first occurance within range r of any of the
@@ -311,16 +1036,35 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange, typename PatternCharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_first_of (CharRange const & r, PatternCharRange const & p) noexcept
-        -> detail::rngs_alg_ret_t<int, CharRange, PatternCharRange>
+        -> detail::rngs_alg_ret_t<std::ptrdiff_t, CharRange, PatternCharRange>
     { return find_first_of(text_view(r), text_view(p)); }
 
+    /** Returns the offset of the first code point within range r that is
+        in s, or a value < 0 if there is none. */
+    inline std::ptrdiff_t find_first_of (text_view r, code_point_set const & s) noexcept
+    {
+        return detail::find_in_code_point_set<true, false>(
+            begin(r), end(r), s
+        );
+    }
+
+    /** Returns the offset of the first code point within range r that is
+        in s, or a value < 0 if there is none.
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept. */
+    template <typename CharRange>
+    auto find_first_of (CharRange const & r, code_point_set const & s) noexcept
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
+    { return find_first_of(text_view(r), s); }
+
 
 
     // find_last_of ()
 
     namespace detail {
 
-        inline BOOST_TEXT_CXX14_CONSTEXPR int find_last_of_impl (
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_last_of_impl (
             char const * r_first, char const * r_last,
             char const * p_first, char const * p_last
         ) noexcept {
@@ -330,17 +1074,7 @@ namespace boost { namespace text {
             if (r_first == r_last)
                 return -1;
 
-            char const * r_it = r_last;
-            while (r_first != r_it) {
-                --r_it;
-                char const * p_it = p_first;
-                while (p_it != p_last) {
-                    if (*r_it == *p_it)
-                        return r_it - r_first;
-                    ++p_it;
-                }
-            }
-            return -1;
+            return find_in_set_impl<true, true>(r_first, r_last, p_first, p_last);
         }
 
     }
@@ -349,7 +1083,7 @@ namespace boost { namespace text {
         chars in p, or a value < 0 if none of the chars in p is found in r.
 
         This function is constexpr in C++14 and later. */
-    inline BOOST_TEXT_CXX14_CONSTEXPR int find_last_of (text_view r, text_view p) noexcept
+    inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_last_of (text_view r, text_view p) noexcept
     { return detail::find_last_of_impl(begin(r), end(r), begin(p), end(p)); }
 
     /** Returns the offset of the last occurance within range r of any of the
@@ -361,7 +1095,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_last_of (text_view r, CharRange const & p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find_last_of(r, text_view(p)); }
 
     /** Returns the offset of the last occurance within range r of any of the
@@ -373,7 +1107,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_last_of (CharRange const & r, text_view p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find_last_of(text_view(r), p); }
 
     /** Returns the offset of the last occurance within range r of any of the
@@ -385,16 +1119,35 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange, typename PatternCharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_last_of (CharRange const & r, PatternCharRange const & p) noexcept
-        -> detail::rngs_alg_ret_t<int, CharRange, PatternCharRange>
+        -> detail::rngs_alg_ret_t<std::ptrdiff_t, CharRange, PatternCharRange>
     { return find_last_of(text_view(r), text_view(p)); }
 
+    /** Returns the offset of the last code point within range r that is in
+        s, or a value < 0 if there is none. */
+    inline std::ptrdiff_t find_last_of (text_view r, code_point_set const & s) noexcept
+    {
+        return detail::find_in_code_point_set<true, true>(
+            begin(r), end(r), s
+        );
+    }
+
+    /** Returns the offset of the last code point within range r that is in
+        s, or a value < 0 if there is none.
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept. */
+    template <typename CharRange>
+    auto find_last_of (CharRange const & r, code_point_set const & s) noexcept
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
+    { return find_last_of(text_view(r), s); }
+
 
 
     // find_first_not_of ()
 
     namespace detail {
 
-        inline BOOST_TEXT_CXX14_CONSTEXPR int find_first_not_of_impl (
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_first_not_of_impl (
             char const * r_first, char const * r_last,
             char const * p_first, char const * p_last
         ) noexcept {
@@ -404,21 +1157,7 @@ namespace boost { namespace text {
             if (r_first == r_last)
                 return -1;
 
-            char const * r_it = r_first;
-            while (r_it != r_last) {
-                char const * p_it = p_first;
-                bool found = true;
-                while (p_it != p_last && found) {
-                    if (*r_it == *p_it)
-                        found = false;
-                    ++p_it;
-                }
-                if (found)
-                    return r_it - r_first;
-                ++r_it;
-            }
-
-            return -1;
+            return find_in_set_impl<false, false>(r_first, r_last, p_first, p_last);
         }
 
     }
@@ -428,7 +1167,7 @@ namespace boost { namespace text {
         p.
 
         This function is constexpr in C++14 and later. */
-    inline BOOST_TEXT_CXX14_CONSTEXPR int find_first_not_of (text_view r, text_view p) noexcept
+    inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_first_not_of (text_view r, text_view p) noexcept
     { return detail::find_first_not_of_impl(begin(r), end(r), begin(p), end(p)); }
 
     /** Returns the offset of the first char within range r that does not
@@ -441,7 +1180,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_first_not_of (text_view r, CharRange const & p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find_first_not_of(r, text_view(p)); }
 
     /** Returns the offset of the first char within range r that does not
@@ -454,7 +1193,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_first_not_of (CharRange const & r, text_view p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find_first_not_of(text_view(r), p); }
 
     /** Returns the offset of the first char within range r that does not
@@ -467,16 +1206,35 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange, typename PatternCharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_first_not_of (CharRange const & r, PatternCharRange const & p) noexcept
-        -> detail::rngs_alg_ret_t<int, CharRange, PatternCharRange>
+        -> detail::rngs_alg_ret_t<std::ptrdiff_t, CharRange, PatternCharRange>
     { return find_first_not_of(text_view(r), text_view(p)); }
 
+    /** Returns the offset of the first code point within range r that is
+        not in s, or a value < 0 if every code point in r is in s. */
+    inline std::ptrdiff_t find_first_not_of (text_view r, code_point_set const & s) noexcept
+    {
+        return detail::find_in_code_point_set<false, false>(
+            begin(r), end(r), s
+        );
+    }
+
+    /** Returns the offset of the first code point within range r that is
+        not in s, or a value < 0 if every code point in r is in s.
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept. */
+    template <typename CharRange>
+    auto find_first_not_of (CharRange const & r, code_point_set const & s) noexcept
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
+    { return find_first_not_of(text_view(r), s); }
+
 
 
     // find_last_not_of ()
 
     namespace detail {
 
-        inline BOOST_TEXT_CXX14_CONSTEXPR int find_last_not_of_impl (
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_last_not_of_impl (
             char const * r_first, char const * r_last,
             char const * p_first, char const * p_last
         ) noexcept {
@@ -486,20 +1244,7 @@ namespace boost { namespace text {
             if (r_first == r_last)
                 return -1;
 
-            char const * r_it = r_last;
-            while (r_first != r_it) {
-                --r_it;
-                char const * p_it = p_first;
-                bool found = true;
-                while (p_it != p_last && found) {
-                    if (*r_it == *p_it)
-                        found = false;
-                    ++p_it;
-                }
-                if (found)
-                    return r_it - r_first;
-            }
-            return -1;
+            return find_in_set_impl<false, true>(r_first, r_last, p_first, p_last);
         }
 
     }
@@ -508,7 +1253,7 @@ namespace boost { namespace text {
         any char in pattern p, or a value < 0 if every char in r is in p.
 
         This function is constexpr in C++14 and later. */
-    inline BOOST_TEXT_CXX14_CONSTEXPR int find_last_not_of (text_view r, text_view p) noexcept
+    inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_last_not_of (text_view r, text_view p) noexcept
     { return detail::find_last_not_of_impl(begin(r), end(r), begin(p), end(p)); }
 
     /** Returns the offset of the last char within range r that does not match
@@ -520,7 +1265,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_last_not_of (text_view r, CharRange const & p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find_last_not_of(r, text_view(p)); }
 
     /** Returns the offset of the last char within range r that does not match
@@ -532,7 +1277,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_last_not_of (CharRange const & r, text_view p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return find_last_not_of(text_view(r), p); }
 
     /** Returns the offset of the last char within range r that does not match
@@ -544,43 +1289,80 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange, typename PatternCharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto find_last_not_of (CharRange const & r, PatternCharRange const & p) noexcept
-        -> detail::rngs_alg_ret_t<int, CharRange, PatternCharRange>
+        -> detail::rngs_alg_ret_t<std::ptrdiff_t, CharRange, PatternCharRange>
     { return find_last_not_of(text_view(r), text_view(p)); }
 
+    /** Returns the offset of the last code point within range r that is not
+        in s, or a value < 0 if every code point in r is in s. */
+    inline std::ptrdiff_t find_last_not_of (text_view r, code_point_set const & s) noexcept
+    {
+        return detail::find_in_code_point_set<false, true>(
+            begin(r), end(r), s
+        );
+    }
+
+    /** Returns the offset of the last code point within range r that is not
+        in s, or a value < 0 if every code point in r is in s.
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept. */
+    template <typename CharRange>
+    auto find_last_not_of (CharRange const & r, code_point_set const & s) noexcept
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
+    { return find_last_not_of(text_view(r), s); }
+
 
 
     // rfind ()
 
     namespace detail {
 
-#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
-
-        inline int rfind_impl (
-            char const * r_first_, char const * r_last_,
-            char const * p_first_, char const * p_last_
+        // Like find_scalar(), but searches for p's first char backward from
+        // the last position at which p could start.
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t rfind_scalar (
+            char const * r_first, char const * r_last,
+            char const * p_first, char const * p_last
         ) noexcept {
-            if (p_first_ == p_last_)
-                return r_last_ - r_first_;
-
-            if (r_first_ == r_last_)
+            std::ptrdiff_t const p_len = p_last - p_first;
+            if (r_last - r_first < p_len)
                 return -1;
 
-            const_reverse_char_iterator r_first(r_last_);
-            const_reverse_char_iterator r_last(r_first_);
-            const_reverse_char_iterator p_first(p_last_);
-            const_reverse_char_iterator p_last(p_first_);
-            auto const pair =
-                algorithm::boyer_moore_search(r_first, r_last, p_first, p_last);
+            char const p_head = *p_first;
+            char const * it = r_last - p_len + 1;
+            while (true) {
+                char const * const candidate = strrchr(r_first, it, p_head);
+                if (candidate == it)
+                    return -1;
+                if (compare_impl(candidate, candidate + p_len, p_first, p_last) == 0)
+                    return candidate - r_first;
+                it = candidate;
+            }
+        }
 
-            if (pair.first == pair.second)
+        inline std::ptrdiff_t rfind_runtime (
+            char const * r_first, char const * r_last,
+            char const * p_first, char const * p_last
+        ) noexcept {
+            std::ptrdiff_t const p_len = p_last - p_first;
+            if (r_last - r_first < p_len)
                 return -1;
 
-            return pair.second.base() - r_first_;
-        }
-
+            char const * const search_last = r_last - p_len + 1;
+#if BOOST_TEXT_AVX2
+            char const * const it = cpu_has_avx2() ?
+                rfind_avx2(r_first, search_last, p_first, p_len) :
+                rfind_sse2(r_first, search_last, p_first, p_len);
+#elif BOOST_TEXT_SSE2
+            char const * const it =
+                rfind_sse2(r_first, search_last, p_first, p_len);
 #else
+            char const * const it =
+                rfind_bytewise(r_first, search_last, p_first, p_len);
+#endif
+            return it ? it - r_first : -1;
+        }
 
-        inline constexpr int rfind_impl (
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t rfind_impl (
             char const * r_first, char const * r_last,
             char const * p_first, char const * p_last
         ) noexcept {
@@ -590,27 +1372,14 @@ namespace boost { namespace text {
             if (r_first == r_last)
                 return -1;
 
-            char const p_head = *p_first;
-            int const p_len = p_last - p_first;
-            const char * it = r_last;
-            while (true) {
-                int const r_len = it - r_first;
-                if (r_len < p_len)
-                    return -1;
-
-                auto candidate_first = strrchr(r_first, it, p_head);
-                if (candidate_first == r_last)
-                    return -1;
-
-                text_view candidate(candidate_first, p_len);
-                if (compare_impl(candidate.begin(), candidate.end(), p_first, p_last) == 0)
-                    return candidate_first - r_first;
-
-                it = candidate_first;
-            }
-        }
-
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+            return rfind_runtime(r_first, r_last, p_first, p_last);
+#else
+            if (!constant_evaluated())
+                return rfind_runtime(r_first, r_last, p_first, p_last);
+            return rfind_scalar(r_first, r_last, p_first, p_last);
 #endif
+        }
 
     }
 
@@ -619,7 +1388,7 @@ namespace boost { namespace text {
         considered to match the end of r.
 
         This function is constexpr in C++14 and later. */
-    inline BOOST_TEXT_CXX14_CONSTEXPR int rfind (text_view r, text_view p) noexcept
+    inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t rfind (text_view r, text_view p) noexcept
     { return detail::rfind_impl(begin(r), end(r), begin(p), end(p)); }
 
     /** Returns the offset of the last occurance of pattern p within range r,
@@ -632,7 +1401,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto rfind (text_view r, CharRange const & p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return rfind(r, text_view(p)); }
 
     /** Returns the offset of the last occurance of pattern p within range r,
@@ -645,7 +1414,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto rfind (CharRange const & r, text_view p) noexcept
-        -> detail::rng_alg_ret_t<int, CharRange>
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
     { return rfind(text_view(r), p); }
 
     /** Returns the offset of the last occurance of pattern p within range r,
@@ -658,7 +1427,7 @@ namespace boost { namespace text {
         This function is constexpr in C++14 and later. */
     template <typename CharRange, typename PatternCharRange>
     BOOST_TEXT_CXX14_CONSTEXPR auto rfind (CharRange const & r, PatternCharRange const & p) noexcept
-        -> detail::rngs_alg_ret_t<int, CharRange, PatternCharRange>
+        -> detail::rngs_alg_ret_t<std::ptrdiff_t, CharRange, PatternCharRange>
     { return rfind(text_view(r), text_view(p)); }
 
 
@@ -677,7 +1446,7 @@ namespace boost { namespace text {
             if (r_first == r_last)
                 return text_view(nullptr, 0);
 
-            int const n = rfind_impl(r_first, r_last, p_first, p_last);
+            std::ptrdiff_t const n = rfind_impl(r_first, r_last, p_first, p_last);
             if (n < 0)
                 return text_view(nullptr, 0);
             return text_view(r_first + n, p_last - p_first);
@@ -791,6 +1560,491 @@ namespace boost { namespace text {
         -> detail::rng_alg_ret_t<char, CharRange>
     { return back(text_view(r)); }
 
+
+
+    // compare_ascii_icase(), equal_ascii_icase()
+
+    namespace detail {
+
+        constexpr char ascii_lower (char c) noexcept
+        { return 'A' <= c && c <= 'Z' ? char(c - 'A' + 'a') : c; }
+
+        // Compares two chars after ASCII case folding, as unsigned chars.
+        constexpr int compare_ascii_icase_char (char l, char r) noexcept
+        {
+            return (unsigned char)ascii_lower(l) < (unsigned char)ascii_lower(r) ?
+                -1 : 1;
+        }
+
+        // The mismatch functions below return the offset of the first
+        // position at which [l, l + n) and [r, r + n) differ after ASCII case
+        // folding, or n if they do not.
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t mismatch_ascii_icase_scalar (
+            char const * l, char const * r, std::ptrdiff_t n
+        ) noexcept {
+            for (std::ptrdiff_t i = 0; i < n; ++i) {
+                if (ascii_lower(l[i]) != ascii_lower(r[i]))
+                    return i;
+            }
+            return n;
+        }
+
+#if BOOST_TEXT_SSE2
+
+        // Folds the ASCII upper case letters in x to lower case.  Bytes >=
+        // 0x80 are negative as signed chars, and so are left alone.
+        inline __m128i sse2_ascii_lower (__m128i x) noexcept
+        {
+            __m128i const upper = _mm_and_si128(
+                _mm_cmpgt_epi8(x, _mm_set1_epi8('A' - 1)),
+                _mm_cmplt_epi8(x, _mm_set1_epi8('Z' + 1))
+            );
+            return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+        }
+
+        inline __m128i sse2_load_ascii_lower (char const * it) noexcept
+        { return sse2_ascii_lower(_mm_loadu_si128((__m128i const *)it)); }
+
+        inline std::ptrdiff_t mismatch_ascii_icase_sse2 (
+            char const * l, char const * r, std::ptrdiff_t n
+        ) noexcept {
+            std::ptrdiff_t i = 0;
+            for (; 16 <= n - i; i += 16) {
+                uint32_t const mask = 0xffffu ^ (uint32_t)_mm_movemask_epi8(
+                    _mm_cmpeq_epi8(
+                        sse2_load_ascii_lower(l + i),
+                        sse2_load_ascii_lower(r + i)
+                    )
+                );
+                if (mask)
+                    return i + countr_zero(mask);
+            }
+            return i + mismatch_ascii_icase_scalar(l + i, r + i, n - i);
+        }
+
+#endif
+
+#if BOOST_TEXT_AVX2
+
+        BOOST_TEXT_TARGET_AVX2 inline __m256i avx2_load_ascii_lower (char const * it) noexcept
+        {
+            __m256i const x = _mm256_loadu_si256((__m256i const *)it);
+            __m256i const upper = _mm256_and_si256(
+                _mm256_cmpgt_epi8(x, _mm256_set1_epi8('A' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), x)
+            );
+            return _mm256_or_si256(
+                x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20))
+            );
+        }
+
+        BOOST_TEXT_TARGET_AVX2 inline std::ptrdiff_t mismatch_ascii_icase_avx2 (
+            char const * l, char const * r, std::ptrdiff_t n
+        ) noexcept {
+            std::ptrdiff_t i = 0;
+            for (; 32 <= n - i; i += 32) {
+                uint32_t const mask = ~(uint32_t)_mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(
+                        avx2_load_ascii_lower(l + i),
+                        avx2_load_ascii_lower(r + i)
+                    )
+                );
+                if (mask)
+                    return i + countr_zero(mask);
+            }
+            return i + mismatch_ascii_icase_sse2(l + i, r + i, n - i);
+        }
+
+#endif
+
+        inline std::ptrdiff_t mismatch_ascii_icase_runtime (
+            char const * l, char const * r, std::ptrdiff_t n
+        ) noexcept {
+#if BOOST_TEXT_AVX2
+            if (cpu_has_avx2())
+                return mismatch_ascii_icase_avx2(l, r, n);
+            return mismatch_ascii_icase_sse2(l, r, n);
+#elif BOOST_TEXT_SSE2
+            return mismatch_ascii_icase_sse2(l, r, n);
+#else
+            return mismatch_ascii_icase_scalar(l, r, n);
+#endif
+        }
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t mismatch_ascii_icase (
+            char const * l, char const * r, std::ptrdiff_t n
+        ) noexcept {
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+            return mismatch_ascii_icase_runtime(l, r, n);
+#else
+            if (!constant_evaluated())
+                return mismatch_ascii_icase_runtime(l, r, n);
+            return mismatch_ascii_icase_scalar(l, r, n);
+#endif
+        }
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR int compare_ascii_icase_impl (
+            char const * l_first, char const * l_last,
+            char const * r_first, char const * r_last
+        ) noexcept {
+            std::ptrdiff_t const l_size = l_last - l_first;
+            std::ptrdiff_t const r_size = r_last - r_first;
+            std::ptrdiff_t const n = min_(l_size, r_size);
+            std::ptrdiff_t const i = mismatch_ascii_icase(l_first, r_first, n);
+            if (i < n)
+                return compare_ascii_icase_char(l_first[i], r_first[i]);
+            if (l_size < r_size)
+                return -1;
+            return l_size == r_size ? 0 : 1;
+        }
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR bool equal_ascii_icase_impl (
+            char const * l_first, char const * l_last,
+            char const * r_first, char const * r_last
+        ) noexcept {
+            std::ptrdiff_t const n = l_last - l_first;
+            return n == r_last - r_first &&
+                mismatch_ascii_icase(l_first, r_first, n) == n;
+        }
+
+    }
+
+    /** Lexicographical compare, ignoring the case of ASCII letters.  Returns
+        a value < 0 when l is lexicographically less than r, 0 if l and r are
+        equal, and a value > 0 if l is lexicographically greater than r.
+
+        'A' through 'Z' compare as 'a' through 'z'; all other chars,
+        including the bytes of non-ASCII code points, are compared exactly,
+        as unsigned chars.  No copies are made, and the chars are folded and
+        compared 16 or 32 at a time where SIMD instructions are available.
+
+        This function is constexpr in C++14 and later. */
+    inline BOOST_TEXT_CXX14_CONSTEXPR int compare_ascii_icase (text_view l, text_view r) noexcept
+    { return detail::compare_ascii_icase_impl(begin(l), end(l), begin(r), end(r)); }
+
+    /** Lexicographical compare, ignoring the case of ASCII letters.  See
+        compare_ascii_icase(text_view, text_view).
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept.
+
+        This function is constexpr in C++14 and later. */
+    template <typename CharRange>
+    BOOST_TEXT_CXX14_CONSTEXPR auto compare_ascii_icase (text_view l, CharRange const & r) noexcept
+        -> detail::rng_alg_ret_t<int, CharRange>
+    { return compare_ascii_icase(l, text_view(r)); }
+
+    /** Lexicographical compare, ignoring the case of ASCII letters.  See
+        compare_ascii_icase(text_view, text_view).
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept.
+
+        This function is constexpr in C++14 and later. */
+    template <typename CharRange>
+    BOOST_TEXT_CXX14_CONSTEXPR auto compare_ascii_icase (CharRange const & l, text_view r) noexcept
+        -> detail::rng_alg_ret_t<int, CharRange>
+    { return compare_ascii_icase(text_view(l), r); }
+
+    /** Lexicographical compare, ignoring the case of ASCII letters.  See
+        compare_ascii_icase(text_view, text_view).
+
+        This function only participates in overload resolution if LCharRange
+        and RCharRange each model the Char_range concept.
+
+        This function is constexpr in C++14 and later. */
+    template <typename LCharRange, typename RCharRange>
+    BOOST_TEXT_CXX14_CONSTEXPR auto compare_ascii_icase (LCharRange const & l, RCharRange const & r) noexcept
+        -> detail::rngs_alg_ret_t<int, LCharRange, RCharRange>
+    { return compare_ascii_icase(text_view(l), text_view(r)); }
+
+    /** Returns true if l and r are equal, ignoring the case of ASCII
+        letters, as compare_ascii_icase() compares them.  Ranges of different
+        sizes are never equal, and are not compared further.
+
+        This function is constexpr in C++14 and later. */
+    inline BOOST_TEXT_CXX14_CONSTEXPR bool equal_ascii_icase (text_view l, text_view r) noexcept
+    { return detail::equal_ascii_icase_impl(begin(l), end(l), begin(r), end(r)); }
+
+    /** Returns true if l and r are equal, ignoring the case of ASCII
+        letters.  See equal_ascii_icase(text_view, text_view).
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept.
+
+        This function is constexpr in C++14 and later. */
+    template <typename CharRange>
+    BOOST_TEXT_CXX14_CONSTEXPR auto equal_ascii_icase (text_view l, CharRange const & r) noexcept
+        -> detail::rng_alg_ret_t<bool, CharRange>
+    { return equal_ascii_icase(l, text_view(r)); }
+
+    /** Returns true if l and r are equal, ignoring the case of ASCII
+        letters.  See equal_ascii_icase(text_view, text_view).
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept.
+
+        This function is constexpr in C++14 and later. */
+    template <typename CharRange>
+    BOOST_TEXT_CXX14_CONSTEXPR auto equal_ascii_icase (CharRange const & l, text_view r) noexcept
+        -> detail::rng_alg_ret_t<bool, CharRange>
+    { return equal_ascii_icase(text_view(l), r); }
+
+    /** Returns true if l and r are equal, ignoring the case of ASCII
+        letters.  See equal_ascii_icase(text_view, text_view).
+
+        This function only participates in overload resolution if LCharRange
+        and RCharRange each model the Char_range concept.
+
+        This function is constexpr in C++14 and later. */
+    template <typename LCharRange, typename RCharRange>
+    BOOST_TEXT_CXX14_CONSTEXPR auto equal_ascii_icase (LCharRange const & l, RCharRange const & r) noexcept
+        -> detail::rngs_alg_ret_t<bool, LCharRange, RCharRange>
+    { return equal_ascii_icase(text_view(l), text_view(r)); }
+
+
+
+    // find_ascii_icase()
+
+    namespace detail {
+
+        // \pre 0 < p_len && p_len <= r_last - r_first
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_ascii_icase_scalar (
+            char const * r_first, char const * r_last,
+            char const * p_first, std::ptrdiff_t p_len
+        ) noexcept {
+            char const p_head = ascii_lower(*p_first);
+            for (char const * it = r_first, * const search_last = r_last - p_len + 1;
+                 it != search_last; ++it) {
+                if (ascii_lower(*it) == p_head &&
+                    mismatch_ascii_icase(it, p_first, p_len) == p_len) {
+                    return it - r_first;
+                }
+            }
+            return -1;
+        }
+
+        // Like the find functions above, these compare all of p only where
+        // p's first and last chars match, after folding both.
+
+        inline bool matches_at_ascii_icase (
+            char const * it,
+            char const * p_first,
+            std::ptrdiff_t p_len
+        ) noexcept {
+            return p_len <= 2 ||
+                mismatch_ascii_icase_runtime(it, p_first, p_len) == p_len;
+        }
+
+#if BOOST_TEXT_SSE2
+
+        inline char const * find_ascii_icase_sse2 (
+            char const * first, char const * search_last,
+            char const * p_first, std::ptrdiff_t p_len
+        ) noexcept {
+            __m128i const head = _mm_set1_epi8(ascii_lower(*p_first));
+            __m128i const tail = _mm_set1_epi8(ascii_lower(p_first[p_len - 1]));
+            for (; 16 <= search_last - first; first += 16) {
+                uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(
+                    _mm_cmpeq_epi8(sse2_load_ascii_lower(first), head),
+                    _mm_cmpeq_epi8(sse2_load_ascii_lower(first + p_len - 1), tail)
+                ));
+                while (mask) {
+                    char const * const it = first + countr_zero(mask);
+                    if (matches_at_ascii_icase(it, p_first, p_len))
+                        return it;
+                    mask &= mask - 1;
+                }
+            }
+            std::ptrdiff_t const n = find_ascii_icase_scalar(
+                first, search_last + p_len - 1, p_first, p_len
+            );
+            return n < 0 ? nullptr : first + n;
+        }
+
+#endif
+
+#if BOOST_TEXT_AVX2
+
+        BOOST_TEXT_TARGET_AVX2 inline char const * find_ascii_icase_avx2 (
+            char const * first, char const * search_last,
+            char const * p_first, std::ptrdiff_t p_len
+        ) noexcept {
+            __m256i const head = _mm256_set1_epi8(ascii_lower(*p_first));
+            __m256i const tail =
+                _mm256_set1_epi8(ascii_lower(p_first[p_len - 1]));
+            for (; 32 <= search_last - first; first += 32) {
+                uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(
+                    _mm256_cmpeq_epi8(avx2_load_ascii_lower(first), head),
+                    _mm256_cmpeq_epi8(avx2_load_ascii_lower(first + p_len - 1), tail)
+                ));
+                while (mask) {
+                    char const * const it = first + countr_zero(mask);
+                    if (matches_at_ascii_icase(it, p_first, p_len))
+                        return it;
+                    mask &= mask - 1;
+                }
+            }
+            return find_ascii_icase_sse2(first, search_last, p_first, p_len);
+        }
+
+#endif
+
+        inline std::ptrdiff_t find_ascii_icase_runtime (
+            char const * r_first, char const * r_last,
+            char const * p_first, std::ptrdiff_t p_len
+        ) noexcept {
+#if BOOST_TEXT_SSE2
+            char const * const search_last = r_last - p_len + 1;
+# if BOOST_TEXT_AVX2
+            char const * const it = cpu_has_avx2() ?
+                find_ascii_icase_avx2(r_first, search_last, p_first, p_len) :
+                find_ascii_icase_sse2(r_first, search_last, p_first, p_len);
+# else
+            char const * const it =
+                find_ascii_icase_sse2(r_first, search_last, p_first, p_len);
+# endif
+            return it ? it - r_first : -1;
+#else
+            return find_ascii_icase_scalar(r_first, r_last, p_first, p_len);
+#endif
+        }
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_ascii_icase_impl (
+            char const * r_first, char const * r_last,
+            char const * p_first, char const * p_last
+        ) noexcept {
+            std::ptrdiff_t const p_len = p_last - p_first;
+            if (!p_len)
+                return 0;
+            if (r_last - r_first < p_len)
+                return -1;
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+            return find_ascii_icase_runtime(r_first, r_last, p_first, p_len);
+#else
+            if (!constant_evaluated())
+                return find_ascii_icase_runtime(r_first, r_last, p_first, p_len);
+            return find_ascii_icase_scalar(r_first, r_last, p_first, p_len);
+#endif
+        }
+
+    }
+
+    /** Returns the offset of the first occurance of pattern p within range r,
+        ignoring the case of ASCII letters, or a value < 0 if p is not found
+        in r.  An empty p is always considered to match the beginning of r.
+        Chars are compared as in compare_ascii_icase().
+
+        This function is constexpr in C++14 and later. */
+    inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t find_ascii_icase (text_view r, text_view p) noexcept
+    { return detail::find_ascii_icase_impl(begin(r), end(r), begin(p), end(p)); }
+
+    /** Returns the offset of the first occurance of pattern p within range r,
+        ignoring the case of ASCII letters, or a value < 0 if p is not found
+        in r.  See find_ascii_icase(text_view, text_view).
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept.
+
+        This function is constexpr in C++14 and later. */
+    template <typename CharRange>
+    BOOST_TEXT_CXX14_CONSTEXPR auto find_ascii_icase (CharRange const & r, text_view p) noexcept
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
+    { return find_ascii_icase(text_view(r), p); }
+
+    /** Returns the offset of the first occurance of pattern p within range r,
+        ignoring the case of ASCII letters, or a value < 0 if p is not found
+        in r.  See find_ascii_icase(text_view, text_view).
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept.
+
+        This function is constexpr in C++14 and later. */
+    template <typename CharRange>
+    BOOST_TEXT_CXX14_CONSTEXPR auto find_ascii_icase (text_view r, CharRange const & p) noexcept
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
+    { return find_ascii_icase(r, text_view(p)); }
+
+    /** Returns the offset of the first occurance of pattern p within range r,
+        ignoring the case of ASCII letters, or a value < 0 if p is not found
+        in r.  See find_ascii_icase(text_view, text_view).
+
+        This function only participates in overload resolution if CharRange
+        and PatternCharRange each model the Char_range concept.
+
+        This function is constexpr in C++14 and later. */
+    template <typename CharRange, typename PatternCharRange>
+    BOOST_TEXT_CXX14_CONSTEXPR auto find_ascii_icase (CharRange const & r, PatternCharRange const & p) noexcept
+        -> detail::rngs_alg_ret_t<std::ptrdiff_t, CharRange, PatternCharRange>
+    { return find_ascii_icase(text_view(r), text_view(p)); }
+
+
+
+    // compare_icase(), equal_icase()
+
+    namespace detail {
+
+        // Chars that are equal after ASCII case folding are equal after any
+        // case folding that folds 'A'-'Z' to 'a'-'z', so only the code
+        // points in which l and r differ after ASCII case folding are
+        // decoded and folded.
+        template <typename CaseFold>
+        int compare_icase_impl (
+            char const * l_first, char const * l_last,
+            char const * r_first, char const * r_last,
+            CaseFold & fold
+        ) {
+            while (true) {
+                std::ptrdiff_t const n = min_(l_last - l_first, r_last - r_first);
+                std::ptrdiff_t i = mismatch_ascii_icase_runtime(l_first, r_first, n);
+                if (i == n) {
+                    if (l_last - l_first < r_last - r_first)
+                        return -1;
+                    return l_last - l_first == r_last - r_first ? 0 : 1;
+                }
+                // The chars before i are the same code units, so l and r
+                // have a code point boundary at the same offset.
+                while (0 < i && (utf8::continuation(l_first[i]) ||
+                                 utf8::continuation(r_first[i]))) {
+                    --i;
+                }
+                l_first += i;
+                r_first += i;
+                uint32_t const l_cp =
+                    fold(utf8::detail::decode_code_point(l_first, l_last));
+                uint32_t const r_cp =
+                    fold(utf8::detail::decode_code_point(r_first, r_last));
+                if (l_cp != r_cp)
+                    return l_cp < r_cp ? -1 : 1;
+            }
+        }
+
+    }
+
+    /** Lexicographical compare of the code points of l and r, after each one
+        is case folded with fold.  Returns a value < 0 when l is
+        lexicographically less than r, 0 if l and r are equal, and a value >
+        0 if l is lexicographically greater than r.
+
+        fold must be callable as fold(uint32_t) and return the uint32_t code
+        point it folds its argument to, such as a Unicode simple case folding
+        (the C + S mappings of CaseFolding.txt).  It must fold 'A' through
+        'Z' to 'a' through 'z', as those foldings do, since spans that are
+        equal after ASCII case folding are skipped 16 or 32 chars at a time
+        without being decoded; fold is only called on the code points that
+        differ after ASCII case folding.  Invalid UTF-8 is decoded to
+        replacement characters. */
+    template <typename CaseFold>
+    int compare_icase (text_view l, text_view r, CaseFold fold)
+    { return detail::compare_icase_impl(begin(l), end(l), begin(r), end(r), fold); }
+
+    /** Returns true if l and r are equal after each of their code points is
+        case folded with fold.  See compare_icase(). */
+    template <typename CaseFold>
+    bool equal_icase (text_view l, text_view r, CaseFold fold)
+    { return compare_icase(l, r, fold) == 0; }
+
 } }
 
 #endif
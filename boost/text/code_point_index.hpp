@@ -0,0 +1,148 @@
+#ifndef BOOST_TEXT_CODE_POINT_INDEX_HPP
+#define BOOST_TEXT_CODE_POINT_INDEX_HPP
+
+#include <boost/text/text_view.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <cassert>
+
+
+namespace boost { namespace text {
+
+    /** The default number of code points between the entries of a
+        code_point_index. */
+    constexpr int code_point_index_default_stride = 256;
+
+    /** A sparse index of the code points in a UTF-8 sequence, such as the
+        contents of a text or a text_view.  The index records the offset of
+        every stride()-th code point, so converting between code point
+        offsets and code unit offsets takes a lookup and a scan of fewer than
+        stride() code points.
+
+        The index does not refer to the sequence it indexes; instead, the
+        sequence is passed to each query.  Entries are built lazily, only as
+        far into the sequence as a query requires.  After the sequence is
+        modified, call invalidate() with the code unit offset of the
+        modification; entries before that offset are kept, and the rest are
+        rebuilt on demand.
+
+        Code points are found as by utf8::advance_code_points(), so the
+        sequence is assumed to be valid UTF-8. */
+    struct code_point_index
+    {
+        /** Constructs an empty index that records the offset of every
+            stride-th code point.
+
+            \pre 0 < stride
+            \post stride() == stride && entries() == 0 */
+        explicit code_point_index (int stride = code_point_index_default_stride) :
+            stride_ (stride),
+            complete_ (false)
+        { assert(0 < stride); }
+
+        /** Returns the number of code points between consecutive entries. */
+        int stride () const noexcept
+        { return stride_; }
+
+        /** Returns the number of entries built so far. */
+        std::ptrdiff_t entries () const noexcept
+        { return (std::ptrdiff_t)offsets_.size(); }
+
+        /** Returns the code unit offset within tv of code point cp, or
+            tv.size() if tv contains cp or fewer code points.
+
+            \pre 0 <= cp */
+        std::ptrdiff_t code_unit_offset (text_view tv, std::ptrdiff_t cp)
+        {
+            assert(0 <= cp);
+            std::ptrdiff_t const entry = cp / stride_;
+            build(tv, [entry](std::vector<std::ptrdiff_t> const & offsets) {
+                return entry < (std::ptrdiff_t)offsets.size();
+            });
+            std::ptrdiff_t const nearest = (std::min)(entry, (std::ptrdiff_t)offsets_.size() - 1);
+            char const * const first = tv.begin() + offsets_[nearest];
+            std::ptrdiff_t const n = cp - nearest * stride_;
+            return utf8::advance_code_points(first, tv.end(), n) - tv.begin();
+        }
+
+        /** Returns the number of code points in tv before code unit offset
+            cu.
+
+            \pre 0 <= cu && cu <= tv.size() */
+        std::ptrdiff_t code_point_offset (text_view tv, std::ptrdiff_t cu)
+        {
+            assert(0 <= cu && cu <= tv.size());
+            build(tv, [cu](std::vector<std::ptrdiff_t> const & offsets) {
+                return cu <= offsets.back();
+            });
+            auto const it =
+                std::upper_bound(offsets_.begin(), offsets_.end(), cu) - 1;
+            std::ptrdiff_t const entry = it - offsets_.begin();
+            return
+                entry * stride_ +
+                (std::ptrdiff_t)utf8::count_code_points(tv.begin() + *it, tv.begin() + cu);
+        }
+
+        /** Returns the number of code points in tv. */
+        std::ptrdiff_t code_points (text_view tv)
+        { return code_point_offset(tv, tv.size()); }
+
+        /** Discards all entries for code points that begin after code unit
+            offset cu.  Call this after inserting into or erasing from the
+            indexed sequence at offset cu.  This takes logarithmic time; the
+            discarded entries are rebuilt by later queries as needed.
+
+            \pre 0 <= cu */
+        void invalidate (std::ptrdiff_t cu) noexcept
+        {
+            assert(0 <= cu);
+            offsets_.erase(
+                std::upper_bound(offsets_.begin(), offsets_.end(), cu),
+                offsets_.end()
+            );
+            complete_ = false;
+        }
+
+        /** Discards all entries. */
+        void clear () noexcept
+        {
+            offsets_.clear();
+            complete_ = false;
+        }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        template <typename Done>
+        void build (text_view tv, Done done)
+        {
+            if (offsets_.empty())
+                offsets_.push_back(0);
+            while (!complete_ && !done(offsets_)) {
+                char const * const first = tv.begin() + offsets_.back();
+                char const * const it =
+                    utf8::advance_code_points(first, tv.end(), stride_);
+                if (it == tv.end()) {
+                    // it is the offset of the next entry's code point only
+                    // if exactly stride_ code points remained.
+                    if (utf8::count_code_points(first, it) == stride_)
+                        offsets_.push_back(tv.size());
+                    complete_ = true;
+                } else {
+                    offsets_.push_back(it - tv.begin());
+                }
+            }
+        }
+
+        std::vector<std::ptrdiff_t> offsets_;
+        int stride_;
+        bool complete_;
+#endif
+
+    };
+
+} }
+
+#endif
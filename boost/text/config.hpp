@@ -11,6 +11,14 @@
 #define BOOST_TEXT_THREAD_UNSAFE 0
 #endif
 
+#ifndef BOOST_TEXT_USE_SIMD
+/** By default, runtime (non-constexpr) calls into the UTF-8 validation
+    functions use SSE2 or AVX2 code paths when the target supports them, with
+    AVX2 selected by a runtime CPU check.  #define this macro to 0 to use
+    only the portable scalar code. */
+#define BOOST_TEXT_USE_SIMD 1
+#endif
+
 // Nothing before GCC 6 has proper C++14 constexpr support.
 #if defined(__GNUC__) && __GNUC__ < 6 && !defined(__clang__)
 # define BOOST_TEXT_CXX14_CONSTEXPR
@@ -25,4 +33,16 @@
 # endif
 #endif
 
+// Lets a C++14 constexpr function pick a faster, non-constexpr
+// implementation when it is not being constant-evaluated.
+#if defined(__has_builtin)
+# if __has_builtin(__builtin_is_constant_evaluated)
+#   define BOOST_TEXT_HAS_CONSTANT_EVALUATED
+# endif
+#elif defined(__GNUC__) && 9 <= __GNUC__ && !defined(__clang__)
+# define BOOST_TEXT_HAS_CONSTANT_EVALUATED
+#elif defined(_MSC_VER) && 1925 <= _MSC_VER
+# define BOOST_TEXT_HAS_CONSTANT_EVALUATED
+#endif
+
 #endif
@@ -1,14 +1,13 @@
 #ifndef BOOST_TEXT_DETAIL_BTREE_HPP
 #define BOOST_TEXT_DETAIL_BTREE_HPP
 
+#include <boost/text/memory_resource.hpp>
 #include <boost/text/detail/utility.hpp>
 
 #ifndef BOOST_TEXT_THREAD_UNSAFE
 #include <boost/atomic.hpp>
 #endif
 #include <boost/align/align.hpp>
-#include <boost/align/aligned_alloc.hpp>
-#include <boost/align/aligned_delete.hpp>
 #include <boost/container/static_vector.hpp>
 #include <boost/smart_ptr/intrusive_ptr.hpp>
 
@@ -105,8 +104,16 @@ namespace boost { namespace text { namespace detail {
     template <typename T>
     struct node_t
     {
-        explicit node_t (bool leaf) noexcept : refs_ (0), leaf_ (leaf) {}
-        node_t (node_t const & rhs) noexcept : refs_ (0), leaf_ (rhs.leaf_) {}
+        explicit node_t (bool leaf) noexcept :
+            refs_ (0),
+            leaf_ (leaf),
+            resource_ (nullptr)
+        {}
+        node_t (node_t const & rhs) noexcept :
+            refs_ (0),
+            leaf_ (rhs.leaf_),
+            resource_ (nullptr)
+        {}
         node_t & operator= (node_t const & rhs) = delete;
 
 #ifdef BOOST_TEXT_THREAD_UNSAFE
@@ -115,8 +122,39 @@ namespace boost { namespace text { namespace detail {
         mutable atomic<int> refs_;
 #endif
         bool leaf_;
+        // The resource the node was allocated from, set by new_node().
+        memory_resource * resource_;
     };
 
+    // Allocates a Node from the calling thread's default resource, and
+    // constructs it from args.
+    template <typename Node, typename... Args>
+    Node * new_node (Args &&... args)
+    {
+        memory_resource * const resource = get_default_resource();
+        void * const ptr = resource->allocate(sizeof(Node), alignof(Node));
+        Node * retval = nullptr;
+        try {
+            retval = ::new (ptr) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            resource->deallocate(ptr, sizeof(Node), alignof(Node));
+            throw;
+        }
+        retval->resource_ = resource;
+        return retval;
+    }
+
+    // Destroys a Node allocated by new_node(), and returns its storage to
+    // the resource it came from.
+    template <typename Node>
+    void delete_node (Node const * node) noexcept
+    {
+        memory_resource * const resource = node->resource_;
+        Node * const ptr = const_cast<Node *>(node);
+        ptr->~Node();
+        resource->deallocate(ptr, sizeof(Node), alignof(Node));
+    }
+
     constexpr int min_children = 8;
     constexpr int max_children = 16;
 
@@ -143,19 +181,11 @@ namespace boost { namespace text { namespace detail {
 
     template <typename T>
     inline interior_node_t<T> * new_interior_node ()
-    {
-        void * ptr =
-            alignment::aligned_alloc(alignof(interior_node_t<T>), sizeof(interior_node_t<T>));
-        return ::new (ptr) interior_node_t<T>;
-    }
+    { return new_node<interior_node_t<T>>(); }
 
     template <typename T>
     inline interior_node_t<T> * new_interior_node (interior_node_t<T> const & other)
-    {
-        void * ptr =
-            alignment::aligned_alloc(alignof(interior_node_t<T>), sizeof(interior_node_t<T>));
-        return ::new (ptr) interior_node_t<T>(other);
-    }
+    { return new_node<interior_node_t<T>>(other); }
 
     template <typename T>
     constexpr int node_buf_size () noexcept
@@ -230,7 +260,7 @@ namespace boost { namespace text { namespace detail {
             }
         }
 
-        int size () const noexcept
+        std::ptrdiff_t size () const noexcept
         {
             switch (which_) {
             case which::vec: return as_vec().size(); break;
@@ -312,7 +342,7 @@ namespace boost { namespace text { namespace detail {
         if (ptr_->refs_ == 1)
             return mutable_node_ptr<T>(this_ref, const_cast<node_t<T> *>(ptr_.get()));
         if (ptr_->leaf_)
-            return mutable_node_ptr<T>(this_ref, new leaf_node_t<T>(*as_leaf()));
+            return mutable_node_ptr<T>(this_ref, new_node<leaf_node_t<T>>(*as_leaf()));
         else
             return mutable_node_ptr<T>(this_ref, new_interior_node(*as_interior()));
     }
@@ -328,9 +358,9 @@ namespace boost { namespace text { namespace detail {
     {
         if (!--node->refs_) {
             if (node->leaf_)
-                delete static_cast<leaf_node_t<T> const *>(node);
+                delete_node(static_cast<leaf_node_t<T> const *>(node));
             else
-                alignment::aligned_delete{}((interior_node_t<T> *)(node));
+                delete_node(static_cast<interior_node_t<T> const *>(node));
         }
     }
 
@@ -349,9 +379,9 @@ namespace boost { namespace text { namespace detail {
         if (node->refs_.fetch_sub(1, boost::memory_order_release) == 1) {
             boost::atomic_thread_fence(boost::memory_order_acquire);
             if (node->leaf_)
-                delete static_cast<leaf_node_t<T> const *>(node);
+                delete_node(static_cast<leaf_node_t<T> const *>(node));
             else
-                alignment::aligned_delete{}((interior_node_t<T> *)(node));
+                delete_node(static_cast<interior_node_t<T> const *>(node));
         }
     }
 
@@ -522,11 +552,11 @@ namespace boost { namespace text { namespace detail {
 
     template <typename T>
     inline node_ptr<T> make_node (std::vector<T> const & t)
-    { return node_ptr<T>(new leaf_node_t<T>(t)); }
+    { return node_ptr<T>(new_node<leaf_node_t<T>>(t)); }
 
     template <typename T>
     inline node_ptr<T> make_node (std::vector<T> && t)
-    { return node_ptr<T>(new leaf_node_t<T>(std::move(t))); }
+    { return node_ptr<T>(new_node<leaf_node_t<T>>(std::move(t))); }
 
     template <typename T>
     inline node_ptr<T> make_ref (
@@ -536,7 +566,7 @@ namespace boost { namespace text { namespace detail {
     ) {
         assert(v->which_ == leaf_node_t<T>::which::vec);
         leaf_node_t<T> * leaf = nullptr;
-        node_ptr<T> retval(leaf = new leaf_node_t<T>);
+        node_ptr<T> retval(leaf = new_node<leaf_node_t<T>>());
         leaf->which_ = leaf_node_t<T>::which::ref;
         auto at = placement_address<reference<T>>(leaf->buf_, sizeof(leaf->buf_));
         assert(at);
@@ -554,24 +584,99 @@ namespace boost { namespace text { namespace detail {
         return make_ref(r.vec_.as_leaf(), lo + offset, hi + offset);
     }
 
+    // Calls f on each leaf under node, in order, until f returns false.
+    // Returns false if f did.
+    template <typename T, typename Fn>
+    bool foreach_leaf_impl (node_ptr<T> const & node, Fn & f)
+    {
+        if (node->leaf_)
+            return f(node.as_leaf());
+        for (auto const & child : children(node)) {
+            if (!foreach_leaf_impl(child, f))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename T, typename Fn>
+    bool foreach_leaf_reverse_impl (node_ptr<T> const & node, Fn & f)
+    {
+        if (node->leaf_)
+            return f(node.as_leaf());
+        auto const & children_ = children(node);
+        for (auto it = children_.rbegin(), end = children_.rend(); it != end; ++it) {
+            if (!foreach_leaf_reverse_impl(*it, f))
+                return false;
+        }
+        return true;
+    }
+
+    // Calls f on the leaf under node that find_leaf() finds for offset n,
+    // and then on each leaf after it, in order, until f returns false.
+    // Subtrees before n are skipped without being visited.  Returns false
+    // if f did.
+    template <typename T, typename Fn>
+    bool foreach_leaf_from_impl (node_ptr<T> const & node, std::ptrdiff_t n, Fn & f)
+    {
+        if (node->leaf_)
+            return f(node.as_leaf());
+        auto const i = find_child(node.as_interior(), n);
+        auto const & children_ = children(node);
+        if (!foreach_leaf_from_impl(children_[i], n - offset(node, i), f))
+            return false;
+        for (auto it = children_.begin() + i + 1, end = children_.end(); it != end; ++it) {
+            if (!foreach_leaf_impl(*it, f))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename T, typename Fn>
+    bool foreach_leaf_reverse_from_impl (node_ptr<T> const & node, std::ptrdiff_t n, Fn & f)
+    {
+        if (node->leaf_)
+            return f(node.as_leaf());
+        auto const i = find_child(node.as_interior(), n);
+        auto const & children_ = children(node);
+        if (!foreach_leaf_reverse_from_impl(children_[i], n - offset(node, i), f))
+            return false;
+        for (auto it = children_.rbegin() + (children_.size() - i), end = children_.rend(); it != end; ++it) {
+            if (!foreach_leaf_reverse_impl(*it, f))
+                return false;
+        }
+        return true;
+    }
+
     template <typename T, typename Fn>
     void foreach_leaf (node_ptr<T> const & root, Fn && f)
     {
         if (!root)
             return;
+        foreach_leaf_impl(root, f);
+    }
 
-        std::ptrdiff_t offset = 0;
-        while (true) {
-            found_leaf<T> found;
-            find_leaf(root, offset, found);
-            leaf_node_t<T> const * leaf = found.leaf_->as_leaf();
+    template <typename T, typename Fn>
+    void foreach_leaf_reverse (node_ptr<T> const & root, Fn && f)
+    {
+        if (!root)
+            return;
+        foreach_leaf_reverse_impl(root, f);
+    }
 
-            if (!f(leaf))
-                break;
+    template <typename T, typename Fn>
+    void foreach_leaf_from (node_ptr<T> const & root, std::ptrdiff_t n, Fn && f)
+    {
+        if (!root)
+            return;
+        foreach_leaf_from_impl(root, n, f);
+    }
 
-            if ((offset += size(leaf)) == size(root.get()))
-                break;
-        }
+    template <typename T, typename Fn>
+    void foreach_leaf_reverse_from (node_ptr<T> const & root, std::ptrdiff_t n, Fn && f)
+    {
+        if (!root)
+            return;
+        foreach_leaf_reverse_from_impl(root, n, f);
     }
 
     template <typename Iter>
@@ -597,6 +702,19 @@ namespace boost { namespace text { namespace detail {
         }
     }
 
+    // Bumps the keys along found.path_, the path find_leaf() took to
+    // offset n, after bump elements are inserted in place into the leaf
+    // there.  n is relative to each node in turn.
+    template <typename T>
+    inline void bump_along_path_to_leaf (found_leaf<T> const & found, std::ptrdiff_t n, std::ptrdiff_t bump)
+    {
+        for (auto node : found.path_) {
+            auto const from = find_child(node, n);
+            n -= offset(node, from);
+            bump_keys(const_cast<interior_node_t<T> *>(node), from, bump);
+        }
+    }
+
     template <typename T>
     inline void insert_child (interior_node_t<T> * node, int i, node_ptr<T> && child) noexcept
     {
@@ -783,7 +901,7 @@ namespace boost { namespace text { namespace detail {
 
         auto const child_size = child.as_leaf()->size();
         auto const offset_at_i = offset(parent, i);
-        auto const cut = static_cast<int>(at - offset_at_i);
+        auto const cut = at - offset_at_i;
 
         if (cut == 0 || cut == child_size)
             return;
@@ -893,6 +1011,43 @@ namespace boost { namespace text { namespace detail {
         }
     }
 
+    // Builds a tree, bottom-up, whose leaves are nodes, in order.  Every
+    // leaf is at the same depth, and every interior node has between
+    // min_children and max_children children, except that the root may
+    // have fewer.
+    template <typename T>
+    inline node_ptr<T> btree_build (std::vector<node_ptr<T>> nodes)
+    {
+        if (nodes.empty())
+            return node_ptr<T>();
+
+        while (1 < nodes.size()) {
+            // Dividing n nodes evenly among ceil(n / max_children) parents
+            // gives each parent at least min_children of them.
+            std::ptrdiff_t const n = nodes.size();
+            std::ptrdiff_t const parents = (n + max_children - 1) / max_children;
+            std::vector<node_ptr<T>> parent_nodes;
+            parent_nodes.reserve(parents);
+            std::ptrdiff_t first = 0;
+            for (std::ptrdiff_t i = 0; i < parents; ++i) {
+                std::ptrdiff_t const last = n * (i + 1) / parents;
+                interior_node_t<T> * const parent = new_interior_node<T>();
+                node_ptr<T> parent_ptr(parent);
+                std::ptrdiff_t parent_size = 0;
+                for (std::ptrdiff_t j = first; j < last; ++j) {
+                    parent_size += size(nodes[j].get());
+                    parent->keys_.push_back(parent_size);
+                    parent->children_.push_back(std::move(nodes[j]));
+                }
+                parent_nodes.push_back(std::move(parent_ptr));
+                first = last;
+            }
+            nodes.swap(parent_nodes);
+        }
+
+        return std::move(nodes.front());
+    }
+
     // Recursing top-to-bottom, pull nodes down the tree as necessary to
     // ensure that each node has min_children + 1 nodes in it *before*
     // recursing into it.  This enables the erasure to happen in a single
@@ -11,7 +11,7 @@ namespace boost { namespace text { namespace detail {
     struct reverse_char_iterator
     {
         using value_type = char;
-        using difference_type = int;
+        using difference_type = std::ptrdiff_t;
         using pointer = char *;
         using reference = char &;
         using iterator_category = std::random_access_iterator_tag;
@@ -106,7 +106,7 @@ namespace boost { namespace text { namespace detail {
     struct const_reverse_char_iterator
     {
         using value_type = char;
-        using difference_type = int;
+        using difference_type = std::ptrdiff_t;
         using pointer = char const *;
         using reference = char const;
         using iterator_category = std::random_access_iterator_tag;
@@ -6,6 +6,10 @@
 
 #include <boost/text/detail/btree.hpp>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 
 namespace boost { namespace text { namespace detail {
 
@@ -23,19 +27,30 @@ namespace boost { namespace text { namespace detail {
         text_view ref_;
     };
 
-    constexpr int rope_node_buf_size () noexcept
+    // A repeated_text_view, and, if the rope owns the chars it repeats,
+    // the text leaf that holds them.
+    struct repeated_segment
+    {
+        repeated_text_view rtv_;
+        node_ptr<rope_tag> text_;
+    };
+
+    constexpr int rope_node_buf_align () noexcept
     {
         return
             max_(alignof(text),
                  max_(alignof(text_view),
-                      max_(alignof(repeated_text_view),
-                           alignof(reference<rope_tag>))))
-            +
+                      max_(alignof(repeated_segment),
+                           alignof(reference<rope_tag>))));
+    }
+
+    constexpr int rope_node_buf_size () noexcept
+    {
+        return
             max_(sizeof(text),
                  max_(sizeof(text_view),
-                      max_(sizeof(repeated_text_view),
-                           sizeof(reference<rope_tag>))))
-            ;
+                      max_(sizeof(repeated_segment),
+                           sizeof(reference<rope_tag>))));
     }
 
     enum class which : char { t, rtv, ref };
@@ -69,14 +84,14 @@ namespace boost { namespace text { namespace detail {
             buf_ptr_ = new (at) text(tv);
         }
 
-        leaf_node_t (repeated_text_view rtv) noexcept :
+        leaf_node_t (repeated_text_view rtv, node_ptr<rope_tag> const & text_node) noexcept :
             node_t (true),
             buf_ptr_ (nullptr),
             which_ (which::rtv)
         {
-            auto at = placement_address<repeated_text_view>(buf_, sizeof(buf_));
+            auto at = placement_address<repeated_segment>(buf_, sizeof(buf_));
             assert(at);
-            buf_ptr_ = new (at) repeated_text_view(rtv);
+            buf_ptr_ = new (at) repeated_segment{rtv, text_node};
         }
 
         leaf_node_t (leaf_node_t const & rhs) :
@@ -92,9 +107,9 @@ namespace boost { namespace text { namespace detail {
                 break;
             }
             case which::rtv: {
-                auto at = placement_address<repeated_text_view>(buf_, sizeof(buf_));
+                auto at = placement_address<repeated_segment>(buf_, sizeof(buf_));
                 assert(at);
-                buf_ptr_ = new (at) repeated_text_view(rhs.as_repeated_text_view());
+                buf_ptr_ = new (at) repeated_segment(rhs.as_repeated_segment());
                 break;
             }
             case which::ref: {
@@ -118,13 +133,13 @@ namespace boost { namespace text { namespace detail {
 
             switch (which_) {
             case which::t: as_text().~text(); break;
-            case which::rtv: as_repeated_text_view().~repeated_text_view(); break;
+            case which::rtv: as_repeated_segment().~repeated_segment(); break;
             case which::ref: as_reference().~reference(); break;
             default: assert(!"unhandled rope node case"); break;
             }
         }
 
-        int size () const noexcept
+        std::ptrdiff_t size () const noexcept
         {
             switch (which_) {
             case which::t: return as_text().size(); break;
@@ -142,9 +157,12 @@ namespace boost { namespace text { namespace detail {
         }
 
         repeated_text_view const & as_repeated_text_view () const noexcept
+        { return as_repeated_segment().rtv_; }
+
+        repeated_segment const & as_repeated_segment () const noexcept
         {
             assert(which_ == which::rtv);
-            return *static_cast<repeated_text_view *>(buf_ptr_);
+            return *static_cast<repeated_segment *>(buf_ptr_);
         }
 
         reference<rope_tag> const & as_reference () const noexcept
@@ -160,9 +178,12 @@ namespace boost { namespace text { namespace detail {
         }
 
         repeated_text_view & as_repeated_text_view () noexcept
+        { return as_repeated_segment().rtv_; }
+
+        repeated_segment & as_repeated_segment () noexcept
         {
             assert(which_ == which::rtv);
-            return *static_cast<repeated_text_view *>(buf_ptr_);
+            return *static_cast<repeated_segment *>(buf_ptr_);
         }
 
         reference<rope_tag> & as_reference () noexcept
@@ -171,7 +192,7 @@ namespace boost { namespace text { namespace detail {
             return *static_cast<reference<rope_tag> *>(buf_ptr_);
         }
 
-        char buf_[rope_node_buf_size()];
+        alignas(rope_node_buf_align()) char buf_[rope_node_buf_size()];
         void * buf_ptr_;
         which which_;
     };
@@ -216,16 +237,20 @@ namespace boost { namespace text { namespace detail {
     enum encoding_note_t { check_encoding_breakage, encoding_breakage_ok };
 
     inline node_ptr<rope_tag> make_node (text const & t)
-    { return node_ptr<rope_tag>(new leaf_node_t<rope_tag>(t)); }
+    { return node_ptr<rope_tag>(new_node<leaf_node_t<rope_tag>>(t)); }
 
     inline node_ptr<rope_tag> make_node (text && t)
-    { return node_ptr<rope_tag>(new leaf_node_t<rope_tag>(std::move(t))); }
+    { return node_ptr<rope_tag>(new_node<leaf_node_t<rope_tag>>(std::move(t))); }
 
     inline node_ptr<rope_tag> make_node (text_view tv)
-    { return node_ptr<rope_tag>(new leaf_node_t<rope_tag>(tv)); }
+    { return node_ptr<rope_tag>(new_node<leaf_node_t<rope_tag>>(tv)); }
 
-    inline node_ptr<rope_tag> make_node (repeated_text_view rtv)
-    { return node_ptr<rope_tag>(new leaf_node_t<rope_tag>(rtv)); }
+    // text_node is the text leaf that holds the chars of rtv, if the rope
+    // owns them.
+    inline node_ptr<rope_tag> make_node (
+        repeated_text_view rtv,
+        node_ptr<rope_tag> const & text_node = node_ptr<rope_tag>()
+    ) { return node_ptr<rope_tag>(new_node<leaf_node_t<rope_tag>>(rtv, text_node)); }
 
     inline node_ptr<rope_tag> make_ref (
         leaf_node_t<rope_tag> const * t,
@@ -240,7 +265,7 @@ namespace boost { namespace text { namespace detail {
             t->as_text()(lo, hi);
 
         leaf_node_t<rope_tag> * leaf = nullptr;
-        node_ptr<rope_tag> retval(leaf = new leaf_node_t<rope_tag>);
+        node_ptr<rope_tag> retval(leaf = new_node<leaf_node_t<rope_tag>>());
         leaf->which_ = which::ref;
         auto at = placement_address<reference<rope_tag>>(leaf->buf_, sizeof(leaf->buf_));
         assert(at);
@@ -288,8 +313,8 @@ namespace boost { namespace text { namespace detail {
             return node;
         case which::rtv: {
             repeated_text_view const & crtv = node.as_leaf()->as_repeated_text_view();
-            int const mod_lo = lo % crtv.view().size();
-            int const mod_hi = hi % crtv.view().size();
+            std::ptrdiff_t const mod_lo = lo % crtv.view().size();
+            std::ptrdiff_t const mod_hi = hi % crtv.view().size();
             if (mod_lo != 0 || mod_hi != 0) {
                 if (encoding_note == check_encoding_breakage) {
                     text_view const tv = crtv.view()(
@@ -301,8 +326,12 @@ namespace boost { namespace text { namespace detail {
                 return make_node(text(crtv.begin() + lo, crtv.begin() + hi));
             } else {
                 auto const count = (hi - lo) / crtv.view().size();
-                if (!leaf_mutable)
-                    return make_node(repeated_text_view(crtv.view(), count));
+                if (!leaf_mutable) {
+                    return make_node(
+                        repeated_text_view(crtv.view(), count),
+                        node.as_leaf()->as_repeated_segment().text_
+                    );
+                }
                 auto mut_node = node.write();
                 repeated_text_view & rtv = mut_node.as_leaf()->as_repeated_text_view();
                 rtv = repeated_text_view(rtv.view(), count);
@@ -385,6 +414,15 @@ namespace boost { namespace text { namespace detail {
         std::ostream & os_;
     };
 
+    struct segment_copier
+    {
+        template <typename Segment>
+        void operator() (Segment const & s) const
+        { out_ = std::copy(s.begin(), s.end(), out_); }
+
+        char * & out_;
+    };
+
     template <typename Segment>
     bool encoded (Segment const & segment)
     { return utf8::encoded(segment.begin(), segment.end()); }
@@ -409,6 +447,184 @@ namespace boost { namespace text { namespace detail {
         repeated_text_view::const_iterator end () const { return last; }
     };
 
+    // Counts and skips code points.
+    struct code_point_units
+    {
+        template <typename Iter>
+        static std::ptrdiff_t count (Iter first, Iter last) noexcept
+        { return utf8::count_code_points(first, last); }
+
+        template <typename Iter>
+        static Iter advance (Iter first, Iter last, std::ptrdiff_t n) noexcept
+        { return utf8::advance_code_points(first, last, n); }
+    };
+
+    // Counts and skips the UTF-16 code units the UTF-8 would transcode to.
+    struct utf16_units
+    {
+        template <typename Iter>
+        static std::ptrdiff_t count (Iter first, Iter last) noexcept
+        { return utf8::count_utf16_code_units(first, last); }
+
+        template <typename Iter>
+        static Iter advance (Iter first, Iter last, std::ptrdiff_t n) noexcept
+        { return utf8::advance_utf16_code_units(first, last, n); }
+    };
+
+    template <typename Units>
+    struct segment_counter
+    {
+        void operator() (text_view tv) const
+        { count_ += Units::count(tv.begin(), tv.end()); }
+
+        void operator() (repeated_text_view rtv) const
+        {
+            text_view const tv = rtv.view();
+            count_ += Units::count(tv.begin(), tv.end()) * rtv.count();
+        }
+
+        template <typename Segment>
+        void operator() (Segment const & s) const
+        { count_ += Units::count(s.begin(), s.end()); }
+
+        std::ptrdiff_t & count_;
+    };
+
+    // Skips whole segments until the one containing the n_-th unit,
+    // accumulating the number of chars skipped in offset_.
+    template <typename Units>
+    struct segment_advancer
+    {
+        bool operator() (text_view tv) const
+        {
+            std::ptrdiff_t const count = Units::count(tv.begin(), tv.end());
+            if (count <= n_) {
+                n_ -= count;
+                offset_ += tv.size();
+                return true;
+            }
+            offset_ += Units::advance(tv.begin(), tv.end(), n_) - tv.begin();
+            return false;
+        }
+
+        bool operator() (repeated_text_view rtv) const
+        {
+            text_view const tv = rtv.view();
+            std::ptrdiff_t const count = Units::count(tv.begin(), tv.end());
+            if (count * rtv.count() <= n_) {
+                n_ -= count * rtv.count();
+                offset_ += rtv.size();
+                return true;
+            }
+            std::ptrdiff_t const repetitions = n_ / count;
+            offset_ += repetitions * tv.size();
+            n_ -= repetitions * count;
+            return (*this)(tv);
+        }
+
+        template <typename Segment>
+        bool operator() (Segment const & s) const
+        {
+            std::ptrdiff_t const count = Units::count(s.begin(), s.end());
+            if (count <= n_) {
+                n_ -= count;
+                offset_ += s.end() - s.begin();
+                return true;
+            }
+            offset_ += Units::advance(s.begin(), s.end(), n_) - s.begin();
+            return false;
+        }
+
+        std::ptrdiff_t & n_;
+        std::ptrdiff_t & offset_;
+    };
+
+    using segment_code_point_counter = segment_counter<code_point_units>;
+    using segment_code_point_advancer = segment_advancer<code_point_units>;
+    using segment_utf16_counter = segment_counter<utf16_units>;
+    using segment_utf16_advancer = segment_advancer<utf16_units>;
+
+    struct segment_repair
+    {
+        std::ptrdiff_t lo_;
+        std::ptrdiff_t hi_;
+        text repaired_;
+        // The number of times repaired_ is repeated, or 0 if it replaces
+        // [lo_, hi_) just once.
+        std::ptrdiff_t count_;
+    };
+
+    // Records the offsets and repaired contents of each segment that is not
+    // valid UTF-8.
+    struct segment_encoding_repairer
+    {
+        void operator() (text_view tv) const
+        {
+            if (!utf8::encoded(tv.begin(), tv.end()))
+                repairs_.push_back({offset_, offset_ + tv.size(), repair_encoding(tv), 0});
+            offset_ += tv.size();
+        }
+
+        // The repaired view is repeated in place of the segment, unless a
+        // code point or invalid sequence spans the seam between two
+        // repetitions.  Since each is at most 4 chars, checking the first
+        // 2 + 3 / view().size() repetitions covers every way they can span
+        // seams.
+        void operator() (repeated_text_view rtv) const
+        {
+            text_view const tv = rtv.view();
+            if (!utf8::encoded(tv.begin(), tv.end())) {
+                text repaired_tv = repair_encoding(tv);
+                std::ptrdiff_t const count =
+                    (std::min)(rtv.count(), 2 + 3 / tv.size());
+                if (repaired(rtv.begin(), rtv.begin() + count * tv.size()) ==
+                    text(repeated_text_view(repaired_tv, count))) {
+                    repairs_.push_back(
+                        {offset_, offset_ + rtv.size(), std::move(repaired_tv), rtv.count()}
+                    );
+                } else {
+                    repairs_.push_back(
+                        {offset_, offset_ + rtv.size(), repaired(rtv.begin(), rtv.end()), 0}
+                    );
+                }
+            }
+            offset_ += rtv.size();
+        }
+
+        static text repaired (repeated_text_view::iterator first, repeated_text_view::iterator last)
+        {
+            std::string const s(first, last);
+            return repair_encoding(text_view(s.data(), s.size(), utf8::unchecked));
+        }
+
+        std::ptrdiff_t & offset_;
+        std::vector<segment_repair> & repairs_;
+    };
+
+    template <typename Fn, typename Segment>
+    bool visit_segment_impl (Fn && f, Segment const & s, std::true_type)
+    {
+        f(s);
+        return true;
+    }
+
+    template <typename Fn, typename Segment>
+    bool visit_segment_impl (Fn && f, Segment const & s, std::false_type)
+    { return static_cast<bool>(f(s)); }
+
+    /** Calls f(s), and returns false if the segment visitation f is part of
+        should stop.  This is only the case when f returns a value that
+        converts to false; an f that returns void visits every segment. */
+    template <typename Fn, typename Segment>
+    bool visit_segment (Fn && f, Segment const & s)
+    {
+        return visit_segment_impl(
+            f,
+            s,
+            typename std::is_void<decltype(f(s))>::type{}
+        );
+    }
+
     inline std::ostream & operator<< (std::ostream & os, repeated_range rr)
     {
         for (char c : rr) {
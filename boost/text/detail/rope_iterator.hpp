@@ -155,6 +155,7 @@ namespace boost { namespace text { namespace detail {
         mutable difference_type leaf_start_;
 
         friend struct ::boost::text::rope_view;
+        friend char * copy_chars (const_rope_iterator first, const_rope_iterator last, char * out);
     };
 
     struct const_reverse_rope_iterator
@@ -375,6 +376,8 @@ namespace boost { namespace text { namespace detail {
         const_repeated_chars_iterator rtv_;
 
         which which_;
+
+        friend char * copy_chars (const_rope_view_iterator first, const_rope_view_iterator last, char * out);
     };
 
     struct const_reverse_rope_view_iterator
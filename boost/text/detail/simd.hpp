@@ -0,0 +1,147 @@
+#ifndef BOOST_TEXT_DETAIL_SIMD_HPP
+#define BOOST_TEXT_DETAIL_SIMD_HPP
+
+#include <boost/text/config.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#if BOOST_TEXT_USE_SIMD
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP)
+#   define BOOST_TEXT_SSE2 1
+#   include <emmintrin.h>
+#   if defined(__clang__) || (defined(__GNUC__) && (5 <= __GNUC__))
+#     define BOOST_TEXT_AVX2 1
+#     define BOOST_TEXT_TARGET_AVX2 __attribute__((target("avx2")))
+#     include <immintrin.h>
+#   elif defined(_MSC_VER)
+#     define BOOST_TEXT_AVX2 1
+#     define BOOST_TEXT_TARGET_AVX2
+#     include <immintrin.h>
+#     include <intrin.h>
+#   endif
+# endif
+#endif
+
+#ifndef BOOST_TEXT_SSE2
+# define BOOST_TEXT_SSE2 0
+#endif
+#ifndef BOOST_TEXT_AVX2
+# define BOOST_TEXT_AVX2 0
+#endif
+
+
+namespace boost { namespace text { namespace detail {
+
+    /** Returns true when called during constant evaluation.  Without
+        compiler support, this always returns true, so callers fall back to
+        their constexpr implementations. */
+    constexpr bool constant_evaluated () noexcept
+    {
+#ifdef BOOST_TEXT_HAS_CONSTANT_EVALUATED
+        return __builtin_is_constant_evaluated();
+#else
+        return true;
+#endif
+    }
+
+    /** Returns the index of the lowest set bit in x.
+
+        \pre x != 0 */
+    inline int countr_zero (uint32_t x) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctz(x);
+#else
+        int retval = 0;
+        while (!(x & 1u)) {
+            x >>= 1;
+            ++retval;
+        }
+        return retval;
+#endif
+    }
+
+    /** Returns the index of the lowest set bit in x.
+
+        \pre x != 0 */
+    inline int countr_zero64 (uint64_t x) noexcept
+    {
+        uint32_t const lo = (uint32_t)x;
+        return lo ? countr_zero(lo) : 32 + countr_zero((uint32_t)(x >> 32));
+    }
+
+    /** Returns the number of unset bits above the highest set bit in x.
+
+        \pre x != 0 */
+    inline int countl_zero (uint32_t x) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clz(x);
+#else
+        int retval = 0;
+        while (!(x & 0x80000000u)) {
+            x <<= 1;
+            ++retval;
+        }
+        return retval;
+#endif
+    }
+
+    /** Returns the number of set bits in x. */
+    inline int popcount (uint64_t x) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+#else
+        int retval = 0;
+        while (x) {
+            x &= x - 1;
+            ++retval;
+        }
+        return retval;
+#endif
+    }
+
+    /** Loads 8 bytes from an arbitrarily aligned address. */
+    inline uint64_t load_u64 (char const * p) noexcept
+    {
+        uint64_t retval;
+        memcpy(&retval, p, sizeof(retval));
+        return retval;
+    }
+
+#if BOOST_TEXT_AVX2
+
+    /** Returns true if the running CPU (and OS) support AVX2.  The check is
+        done once; later calls are a load and a branch. */
+    inline bool cpu_has_avx2 () noexcept
+    {
+# if defined(__AVX2__)
+        return true;
+# elif defined(_MSC_VER) && !defined(__clang__)
+        static bool const retval = [] {
+            int regs[4];
+            __cpuid(regs, 0);
+            if (regs[0] < 7)
+                return false;
+            __cpuid(regs, 1);
+            bool const osxsave = (regs[2] & (1 << 27)) != 0;
+            bool const avx = (regs[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+                return false;
+            __cpuidex(regs, 7, 0);
+            return (regs[1] & (1 << 5)) != 0;
+        }();
+        return retval;
+# else
+        static bool const retval = __builtin_cpu_supports("avx2");
+        return retval;
+# endif
+    }
+
+#endif
+
+} } }
+
+#endif
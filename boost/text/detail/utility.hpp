@@ -2,6 +2,7 @@
 #define BOOST_TEXT_DETAIL_UTILITY_HPP
 
 #include <boost/text/config.hpp>
+#include <boost/text/detail/simd.hpp>
 
 #include <boost/algorithm/cxx14/mismatch.hpp>
 
@@ -9,8 +10,8 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
-#include <climits>
 
 
 namespace boost { namespace text { namespace detail {
@@ -25,6 +26,8 @@ namespace boost { namespace text { namespace detail {
     inline constexpr std::ptrdiff_t strlen (char const * c_str) noexcept
     {
         assert(c_str);
+        if (!detail::constant_evaluated())
+            return ::strlen(c_str);
         std::size_t retval = 0;
         while (*c_str) {
             ++retval;
@@ -69,26 +72,24 @@ namespace boost { namespace text { namespace detail {
     constexpr T max_ (T lhs, T rhs) noexcept
     { return lhs < rhs ? rhs : lhs; }
 
+    // Chars are compared as unsigned chars, as memcmp() compares them,
+    // which orders UTF-8 sequences by code point.
+
 #ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
 
     inline int compare_impl (
         char const * l_first, char const * l_last,
         char const * r_first, char const * r_last
     ) noexcept {
-        auto const iters =
-            algorithm::mismatch(l_first, l_last, r_first, r_last);
-        if (iters.first == l_last) {
-            if (iters.second == r_last)
-                return 0;
-            else
-                return -1;
-        } else if (iters.second == r_last) {
-            return 1;
-        } else if (*iters.first < *iters.second) {
+        auto const l_size = l_last - l_first;
+        auto const r_size = r_last - r_first;
+        auto const size = l_size < r_size ? l_size : r_size;
+        int const retval = size ? memcmp(l_first, r_first, size) : 0;
+        if (retval)
+            return retval < 0 ? -1 : 1;
+        if (l_size < r_size)
             return -1;
-        } else {
-            return 1;
-        }
+        return l_size == r_size ? 0 : 1;
     }
 
 #else
@@ -99,35 +100,32 @@ namespace boost { namespace text { namespace detail {
     ) noexcept {
         auto const l_size = l_last - l_first;
         auto const r_size = r_last - r_first;
-        assert(l_size <= INT_MAX);
-        assert(r_size <= INT_MAX);
-
-        int retval = 0;
-
-        int const size = (int)detail::min_(l_size, r_size);
+        auto const size = detail::min_(l_size, r_size);
         if (size != 0) {
-            char const * l_it = l_first;
-            char const * l_it_end = l_first + size;
-            char const * r_it = r_first;
-            while (l_it != l_it_end) {
-                char const l_c = *l_it;
-                char const r_c = *r_it;
-                if (l_c < r_c)
-                    return -1;
-                if (r_c < l_c)
-                    return 1;
-                ++l_it;
-                ++r_it;
+            if (!detail::constant_evaluated()) {
+                int const retval = memcmp(l_first, r_first, size);
+                if (retval)
+                    return retval < 0 ? -1 : 1;
+            } else {
+                char const * l_it = l_first;
+                char const * l_it_end = l_first + size;
+                char const * r_it = r_first;
+                while (l_it != l_it_end) {
+                    unsigned char const l_c = *l_it;
+                    unsigned char const r_c = *r_it;
+                    if (l_c < r_c)
+                        return -1;
+                    if (r_c < l_c)
+                        return 1;
+                    ++l_it;
+                    ++r_it;
+                }
             }
         }
 
-        if (retval == 0) {
-            if (l_size < r_size) return -1;
-            if (l_size == r_size) return 0;
-            return 1;
-        }
-
-        return retval;
+        if (l_size < r_size) return -1;
+        if (l_size == r_size) return 0;
+        return 1;
     }
 
 #endif
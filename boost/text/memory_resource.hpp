@@ -0,0 +1,256 @@
+#ifndef BOOST_TEXT_MEMORY_RESOURCE_HPP
+#define BOOST_TEXT_MEMORY_RESOURCE_HPP
+
+#include <boost/align/align.hpp>
+#include <boost/align/aligned_alloc.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+#include <cassert>
+
+
+namespace boost { namespace text {
+
+    /** A source of memory for text, rope, and segmented_vector, after
+        std::pmr::memory_resource.  The heap storage of a text and the nodes
+        of a rope or segmented_vector are allocated from the calling
+        thread's default resource (see get_default_resource()), and each
+        allocation is returned to the resource it came from, whatever the
+        default is by then. */
+    struct memory_resource
+    {
+        memory_resource () noexcept {}
+        memory_resource (memory_resource const &) = delete;
+        memory_resource & operator= (memory_resource const &) = delete;
+
+        virtual ~memory_resource () {}
+
+        /** Returns at least bytes bytes of storage, aligned to alignment.
+
+            \pre alignment is a power of two
+            \throw std::bad_alloc if the storage cannot be obtained. */
+        void * allocate (
+            std::size_t bytes,
+            std::size_t alignment = alignof(std::max_align_t)
+        ) { return do_allocate(bytes, alignment); }
+
+        /** Returns storage obtained from allocate(bytes, alignment) on this
+            resource. */
+        void deallocate (
+            void * p,
+            std::size_t bytes,
+            std::size_t alignment = alignof(std::max_align_t)
+        ) noexcept { do_deallocate(p, bytes, alignment); }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        virtual void * do_allocate (std::size_t bytes, std::size_t alignment) = 0;
+        virtual void do_deallocate (void * p, std::size_t bytes, std::size_t alignment) noexcept = 0;
+
+#endif
+
+    };
+
+    namespace detail {
+
+        struct new_delete_memory_resource : memory_resource
+        {
+        private:
+            void * do_allocate (std::size_t bytes, std::size_t alignment) override
+            {
+                if (alignment <= alignof(std::max_align_t))
+                    return ::operator new(bytes);
+                void * const retval = boost::alignment::aligned_alloc(alignment, bytes);
+                if (!retval)
+                    throw std::bad_alloc();
+                return retval;
+            }
+
+            void do_deallocate (void * p, std::size_t, std::size_t alignment) noexcept override
+            {
+                if (alignment <= alignof(std::max_align_t))
+                    ::operator delete(p);
+                else
+                    boost::alignment::aligned_free(p);
+            }
+        };
+
+    }
+
+    /** Returns the resource that allocates with operator new, the default
+        resource of each thread until it is changed. */
+    inline memory_resource * new_delete_resource () noexcept
+    {
+        // Never destroyed, so that objects with static storage duration
+        // can return their storage to it, however late they are
+        // destroyed.
+        static memory_resource * const retval = new detail::new_delete_memory_resource;
+        return retval;
+    }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    namespace detail {
+
+        inline memory_resource *& default_resource () noexcept
+        {
+            thread_local memory_resource * retval = new_delete_resource();
+            return retval;
+        }
+
+    }
+
+#endif
+
+    /** Returns the calling thread's default resource.
+
+        Unlike std::pmr::get_default_resource(), the default resource is per
+        thread, so that each thread can direct its allocations to its own
+        resource, such as one monotonic_buffer_resource per request. */
+    inline memory_resource * get_default_resource () noexcept
+    { return detail::default_resource(); }
+
+    /** Makes r the calling thread's default resource, or
+        new_delete_resource() if r is null, and returns the previous
+        default.  The caller must keep r alive for as long as anything
+        allocated from it is. */
+    inline memory_resource * set_default_resource (memory_resource * r) noexcept
+    {
+        memory_resource * const retval = detail::default_resource();
+        detail::default_resource() = r ? r : new_delete_resource();
+        return retval;
+    }
+
+    /** Makes a resource the calling thread's default resource for the
+        lifetime of the guard, and then restores the previous default. */
+    struct default_resource_guard
+    {
+        explicit default_resource_guard (memory_resource * r) noexcept :
+            prev_ (set_default_resource(r))
+        {}
+
+        default_resource_guard (default_resource_guard const &) = delete;
+        default_resource_guard & operator= (default_resource_guard const &) = delete;
+
+        ~default_resource_guard ()
+        { set_default_resource(prev_); }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        memory_resource * prev_;
+
+#endif
+
+    };
+
+    /** A resource that hands out storage from ever larger chunks obtained
+        from an upstream resource, and frees nothing until release() is
+        called or the resource is destroyed, after
+        std::pmr::monotonic_buffer_resource.  This makes allocation very
+        cheap, and lets all the storage used for some task be freed at
+        once.  Not thread safe.
+
+        Every text, rope, and segmented_vector whose storage came from the
+        resource must be destroyed before release() is called. */
+    struct monotonic_buffer_resource : memory_resource
+    {
+        /** Constructs a resource whose first chunk holds initial_size
+            bytes, and whose chunks come from upstream.
+
+            \pre 0 < initial_size */
+        explicit monotonic_buffer_resource (
+            std::size_t initial_size = 1024,
+            memory_resource * upstream = get_default_resource()
+        ) noexcept :
+            upstream_ (upstream),
+            chunks_ (nullptr),
+            next_chunk_size_ (initial_size),
+            first_ (nullptr),
+            last_ (nullptr)
+        { assert(0 < initial_size); }
+
+        ~monotonic_buffer_resource ()
+        { release(); }
+
+        /** Returns all the storage obtained from upstream to it. */
+        void release () noexcept
+        {
+            while (chunks_) {
+                chunk * const next = chunks_->next_;
+                upstream_->deallocate(chunks_, chunks_->size_, alignof(chunk));
+                chunks_ = next;
+            }
+            first_ = last_ = nullptr;
+        }
+
+        /** Returns the resource chunks are obtained from. */
+        memory_resource * upstream_resource () const noexcept
+        { return upstream_; }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        struct chunk
+        {
+            chunk * next_;
+            std::size_t size_;
+        };
+
+        void * do_allocate (std::size_t bytes, std::size_t alignment) override
+        {
+            void * retval = align(bytes, alignment);
+            if (!retval) {
+                new_chunk(bytes + alignment);
+                retval = align(bytes, alignment);
+                assert(retval);
+            }
+            first_ = static_cast<char *>(retval) + bytes;
+            return retval;
+        }
+
+        void do_deallocate (void *, std::size_t, std::size_t) noexcept override
+        {}
+
+        // Returns storage for bytes bytes within the current chunk, or
+        // null if there is not enough.
+        void * align (std::size_t bytes, std::size_t alignment) const noexcept
+        {
+            if (!first_)
+                return nullptr;
+            std::size_t space = last_ - first_;
+            void * retval = first_;
+            return boost::alignment::align(alignment, bytes, retval, space);
+        }
+
+        void new_chunk (std::size_t min_bytes)
+        {
+            // Each chunk is at least twice the size of the previous one.
+            std::size_t const size =
+                sizeof(chunk) + (std::max)(next_chunk_size_, min_bytes);
+            chunk * const c =
+                static_cast<chunk *>(upstream_->allocate(size, alignof(chunk)));
+            c->next_ = chunks_;
+            c->size_ = size;
+            chunks_ = c;
+            first_ = reinterpret_cast<char *>(c + 1);
+            last_ = reinterpret_cast<char *>(c) + size;
+            next_chunk_size_ = 2 * (size - sizeof(chunk));
+        }
+
+        memory_resource * upstream_;
+        chunk * chunks_;
+        std::size_t next_chunk_size_;
+        char * first_;
+        char * last_;
+
+#endif
+
+    };
+
+} }
+
+#endif
@@ -0,0 +1,598 @@
+#ifndef BOOST_TEXT_MULTI_SEARCHER_HPP
+#define BOOST_TEXT_MULTI_SEARCHER_HPP
+
+#include <boost/text/algorithm.hpp>
+#include <boost/text/rope.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cstring>
+
+
+namespace boost { namespace text {
+
+    /** An occurance of pattern number pattern of a multi_searcher, at
+        offsets [lo, hi) of the searched sequence. */
+    struct multi_match
+    {
+        int pattern;
+        std::ptrdiff_t lo;
+        std::ptrdiff_t hi;
+    };
+
+    namespace detail {
+
+        template <typename Fn>
+        bool report_match_impl (Fn & f, multi_match m, std::true_type)
+        {
+            f(m);
+            return true;
+        }
+
+        template <typename Fn>
+        bool report_match_impl (Fn & f, multi_match m, std::false_type)
+        { return static_cast<bool>(f(m)); }
+
+        /** Calls f(m), and returns false if the search f is part of should
+            stop. */
+        template <typename Fn>
+        bool report_match (Fn & f, multi_match m)
+        {
+            return report_match_impl(
+                f,
+                m,
+                typename std::is_void<decltype(f(m))>::type{}
+            );
+        }
+
+        /** Sets of no more than this many patterns are searched with the
+            Teddy filter, when AVX2 is available. */
+        constexpr int teddy_patterns_max = 32;
+
+        /** The number of buckets the Teddy filter sorts patterns into; one
+            per bit of a byte. */
+        constexpr int teddy_buckets = 8;
+
+        /** The Teddy filter looks at no more than this many chars at the
+            end of each pattern. */
+        constexpr int teddy_fingerprint_max = 3;
+
+        /** In its start state, the automaton looks at no more than this
+            many chars one at a time for the start of a pattern, before
+            using a vectorized search. */
+        constexpr std::ptrdiff_t automaton_skip_max = 16;
+
+    }
+
+    /** A compiled search for any of a set of patterns, for searching many
+        sequences for many patterns in a single pass.  The patterns are
+        copied, and the precomputation is done once, at construction.
+
+        All matches are reported, including overlapping ones, and matches of
+        patterns that occur within other patterns.  Matches are reported in
+        order of their ends; matches with the same end are reported longest
+        first, and matches of equal patterns in the order of the patterns.
+
+        Sets of a few patterns are searched in contiguous sequences with a
+        vectorized "Teddy" filter, when AVX2 is available.  It compares the
+        last few chars of each pattern at 32 positions at once, and compares
+        whole patterns only where that succeeds.  Otherwise, and for ropes,
+        the search is done with an Aho-Corasick automaton.  Its transitions
+        are indexed by classes of chars, with one class per char used in
+        the patterns, and one for all the others, to keep the table small. */
+    struct multi_searcher
+    {
+        /** Constructs a multi_searcher with no patterns. */
+        multi_searcher () : multi_searcher (std::initializer_list<text_view>()) {}
+
+        /** Constructs a multi_searcher for the patterns in [first, last).
+            Pattern number i is the i-th element of [first, last).
+
+            \throw std::invalid_argument if any of the patterns is empty. */
+        template <typename Iter>
+        multi_searcher (Iter first, Iter last) :
+            classes_size_ (1),
+            outputs_first_ (0),
+            starts_ (detail::char_set()),
+            teddy_ (false),
+            fingerprint_size_ (0)
+        {
+            offsets_.push_back(0);
+            for (; first != last; ++first) {
+                text_view const p(*first);
+                if (p.empty())
+                    throw std::invalid_argument("Empty multi_searcher pattern.");
+                chars_.append(p.begin(), p.end());
+                offsets_.push_back(chars_.size());
+            }
+            build_automaton();
+            build_teddy();
+        }
+
+        /** Constructs a multi_searcher for the given patterns.
+
+            \throw std::invalid_argument if any of the patterns is empty. */
+        multi_searcher (std::initializer_list<text_view> patterns) :
+            multi_searcher (patterns.begin(), patterns.end())
+        {}
+
+        /** Returns the number of patterns. */
+        int size () const noexcept
+        { return (int)offsets_.size() - 1; }
+
+        /** Returns pattern number i.
+
+            \pre 0 <= i && i < size() */
+        text_view operator[] (int i) const noexcept
+        {
+            return text_view(
+                chars_.data() + offsets_[i],
+                offsets_[i + 1] - offsets_[i],
+                utf8::unchecked
+            );
+        }
+
+        /** Calls f(m) for each match m of any of the patterns of s within
+            r, as a multi_match.  If f returns a value convertible to bool,
+            the search stops after the first call that returns false. */
+        template <typename Fn>
+        friend void foreach_match (text_view r, multi_searcher const & s, Fn && f)
+        {
+#if BOOST_TEXT_AVX2
+            if (s.teddy_ && detail::cpu_has_avx2()) {
+                s.search_teddy_avx2(r.begin(), r.end(), f);
+                return;
+            }
+#endif
+            int state = 0;
+            s.search_automaton(r.begin(), r.end(), 0, state, f);
+        }
+
+        /** Calls f(m) for each match m of any of the patterns of s within
+            r, as a multi_match.  If f returns a value convertible to bool,
+            the search stops after the first call that returns false.
+
+            This function only participates in overload resolution if
+            CharRange models the Char_range concept. */
+        template <typename CharRange, typename Fn>
+        friend auto foreach_match (CharRange const & r, multi_searcher const & s, Fn && f)
+            -> detail::rng_alg_ret_t<void, CharRange>
+        { foreach_match(text_view(r), s, f); }
+
+        /** Calls f(m) for each match m of any of the patterns of s within
+            r, as a multi_match.  If f returns a value convertible to bool,
+            the search stops after the first call that returns false.  Each
+            segment of r is searched in turn, and the state of the search is
+            carried from each segment to the next, so matches that span
+            segments are found as well. */
+        template <typename Fn>
+        friend void foreach_match (rope const & r, multi_searcher const & s, Fn && f)
+        { s.search_segments(r, f); }
+
+        /** Calls f(m) for each match m of any of the patterns of s within
+            rv, as a multi_match.  If f returns a value convertible to bool,
+            the search stops after the first call that returns false.  Each
+            segment of rv is searched in turn, and the state of the search
+            is carried from each segment to the next, so matches that span
+            segments are found as well. */
+        template <typename Fn>
+        friend void foreach_match (rope_view rv, multi_searcher const & s, Fn && f)
+        { s.search_segments(rv, f); }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        std::ptrdiff_t pattern_size (int i) const noexcept
+        { return offsets_[i + 1] - offsets_[i]; }
+
+        // state is an index into delta_, not a state number.
+        template <typename Fn>
+        bool report_outputs (int state, std::ptrdiff_t hi, Fn & f) const
+        {
+            for (int s = outputs_[state / classes_size_]; s != -1; s = output_links_[s]) {
+                for (int i = state_patterns_[s]; i != -1; i = next_patterns_[i]) {
+                    if (!detail::report_match(f, multi_match{i, hi - pattern_size(i), hi}))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        // Runs the automaton over [first, last), which starts at offset in
+        // the searched sequence, from state.  Returns false if f stopped
+        // the search.
+        template <typename Iter, typename Fn>
+        bool search_automaton (
+            Iter first, Iter last,
+            std::ptrdiff_t offset,
+            int & state,
+            Fn & f
+        ) const {
+            int const * const delta = delta_.data();
+            int const outputs_first = outputs_first_;
+            int s = state;
+            for (Iter it = first; it != last; ++it) {
+                s = delta[s + classes_[(unsigned char)*it]];
+                if (outputs_first <= s && !report_outputs(s, offset + (it - first) + 1, f))
+                    return false;
+            }
+            state = s;
+            return true;
+        }
+
+        // As above, but in the start state, chars that start no pattern are
+        // skipped, a few at a time and then with a vectorized search.
+        template <typename Fn>
+        bool search_automaton (
+            char const * first, char const * last,
+            std::ptrdiff_t offset,
+            int & state,
+            Fn & f
+        ) const {
+            int const * const delta = delta_.data();
+            int const outputs_first = outputs_first_;
+            int s = state;
+            for (char const * it = first; it != last; ++it) {
+                if (!s) {
+                    char const * const skip_last =
+                        it + (std::min)(last - it, detail::automaton_skip_max);
+                    while (it != skip_last && !starts_.set_.contains(*it)) {
+                        ++it;
+                    }
+                    if (it == skip_last && it != last)
+                        it = detail::find_in_set_runtime<true>(it, last, starts_);
+                    if (!it || it == last)
+                        break;
+                }
+                s = delta[s + classes_[(unsigned char)*it]];
+                if (outputs_first <= s && !report_outputs(s, offset + (it - first) + 1, f))
+                    return false;
+            }
+            state = s;
+            return true;
+        }
+
+        template <typename Fn>
+        struct segment_matcher
+        {
+            template <typename Segment>
+            bool operator() (Segment const & segment) const
+            {
+                if (!s_.search_automaton(segment.begin(), segment.end(), offset_, state_, f_))
+                    return false;
+                offset_ += segment.end() - segment.begin();
+                return true;
+            }
+
+            multi_searcher const & s_;
+            Fn & f_;
+            std::ptrdiff_t & offset_;
+            int & state_;
+        };
+
+        template <typename Rope, typename Fn>
+        void search_segments (Rope const & r, Fn & f) const
+        {
+            std::ptrdiff_t offset = 0;
+            int state = 0;
+            r.foreach_segment(segment_matcher<Fn>{*this, f, offset, state});
+        }
+
+        // Verifies the patterns in buckets that may end at *end.  Returns
+        // false if f stopped the search.
+        template <typename Fn>
+        bool verify_teddy (
+            char const * first,
+            char const * end,
+            unsigned int buckets,
+            Fn & f
+        ) const {
+            char const * const hi = end + 1;
+            for (int const i : teddy_order_) {
+                if (!((buckets >> buckets_[i]) & 1))
+                    continue;
+                std::ptrdiff_t const size = pattern_size(i);
+                if (hi - first < size ||
+                    memcmp(hi - size, chars_.data() + offsets_[i], size)) {
+                    continue;
+                }
+                if (!detail::report_match(f, multi_match{i, hi - size - first, hi - first}))
+                    return false;
+            }
+            return true;
+        }
+
+        // Filters and verifies the candidate match ends in [it, last).
+        template <typename Fn>
+        bool search_teddy_scalar (
+            char const * first, char const * it, char const * last,
+            Fn & f
+        ) const {
+            int const m = fingerprint_size_;
+            for (; it < last; ++it) {
+                unsigned int buckets = 0xff;
+                for (int k = 0; k < m; ++k) {
+                    unsigned char const c = it[k - (m - 1)];
+                    buckets &= teddy_lo_[k][c & 0xf] & teddy_hi_[k][c >> 4];
+                }
+                if (buckets && !verify_teddy(first, it, buckets, f))
+                    return false;
+            }
+            return true;
+        }
+
+#if BOOST_TEXT_AVX2
+        // Each block holds 32 candidate match ends.  Fingerprint char k of
+        // each candidate is looked up in teddy_lo_[k] and teddy_hi_[k] by
+        // its low and high nibbles, and the results are ANDed, leaving the
+        // buckets of the patterns that may end there.
+        template <typename Fn>
+        BOOST_TEXT_TARGET_AVX2 void search_teddy_avx2 (
+            char const * first, char const * last,
+            Fn & f
+        ) const {
+            int const m = fingerprint_size_;
+            if (last - first < m)
+                return;
+
+            __m256i lo[detail::teddy_fingerprint_max];
+            __m256i hi[detail::teddy_fingerprint_max];
+            for (int k = 0; k < m; ++k) {
+                lo[k] = _mm256_broadcastsi128_si256(
+                    _mm_loadu_si128((__m128i const *)teddy_lo_[k])
+                );
+                hi[k] = _mm256_broadcastsi128_si256(
+                    _mm_loadu_si128((__m128i const *)teddy_hi_[k])
+                );
+            }
+            __m256i const nibble = _mm256_set1_epi8(0xf);
+
+            char const * it = first + m - 1;
+            for (; 32 <= last - it; it += 32) {
+                __m256i buckets = _mm256_set1_epi8(-1);
+                for (int k = 0; k < m; ++k) {
+                    __m256i const v =
+                        _mm256_loadu_si256((__m256i const *)(it + k - (m - 1)));
+                    __m256i const lo_bits =
+                        _mm256_shuffle_epi8(lo[k], _mm256_and_si256(v, nibble));
+                    __m256i const hi_bits = _mm256_shuffle_epi8(
+                        hi[k],
+                        _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)
+                    );
+                    buckets = _mm256_and_si256(
+                        buckets,
+                        _mm256_and_si256(lo_bits, hi_bits)
+                    );
+                }
+                uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(buckets, _mm256_setzero_si256())
+                );
+                if (!mask)
+                    continue;
+                alignas(32) unsigned char block_buckets[32];
+                _mm256_store_si256((__m256i *)block_buckets, buckets);
+                do {
+                    int const i = detail::countr_zero(mask);
+                    if (!verify_teddy(first, it + i, block_buckets[i], f))
+                        return;
+                    mask &= mask - 1;
+                } while (mask);
+            }
+            search_teddy_scalar(first, it, last, f);
+        }
+#endif
+
+        void build_automaton ()
+        {
+            std::fill(classes_, classes_ + 256, 0);
+            for (char const c : chars_) {
+                unsigned char & class_ = classes_[(unsigned char)c];
+                if (!class_)
+                    class_ = classes_size_++;
+            }
+
+            // The trie of the patterns; -1 marks a missing transition.
+            delta_.assign(classes_size_, -1);
+            state_patterns_.assign(1, -1);
+            next_patterns_.assign(size(), -1);
+            for (int i = 0, n = size(); i < n; ++i) {
+                int s = 0;
+                for (char const c : (*this)[i]) {
+                    std::size_t const t = s * classes_size_ + classes_[(unsigned char)c];
+                    if (delta_[t] < 0) {
+                        delta_[t] = state_patterns_.size();
+                        delta_.resize(delta_.size() + classes_size_, -1);
+                        state_patterns_.push_back(-1);
+                    }
+                    s = delta_[t];
+                }
+                int * last = &state_patterns_[s];
+                while (*last != -1) {
+                    last = &next_patterns_[*last];
+                }
+                *last = i;
+            }
+
+            // Breadth-first, so that the failure state of each state, and
+            // that state's transitions, are complete before they are used.
+            int const states = state_patterns_.size();
+            std::vector<int> failures(states, 0);
+            outputs_.assign(states, -1);
+            output_links_.assign(states, -1);
+            std::vector<int> queue;
+            queue.reserve(states);
+            for (int c = 0; c < classes_size_; ++c) {
+                if (delta_[c] < 0)
+                    delta_[c] = 0;
+                else
+                    queue.push_back(delta_[c]);
+            }
+            for (std::size_t i = 0; i < queue.size(); ++i) {
+                int const s = queue[i];
+                int const failure = failures[s];
+                output_links_[s] = outputs_[failure];
+                outputs_[s] = state_patterns_[s] != -1 ? s : output_links_[s];
+                for (int c = 0; c < classes_size_; ++c) {
+                    int & t = delta_[s * classes_size_ + c];
+                    int const failure_t = delta_[failure * classes_size_ + c];
+                    if (t < 0) {
+                        t = failure_t;
+                    } else {
+                        failures[t] = failure_t;
+                        queue.push_back(t);
+                    }
+                }
+            }
+
+            renumber_states();
+
+            detail::char_set starts;
+            for (int i = 0, n = size(); i < n; ++i) {
+                starts.insert(chars_[offsets_[i]]);
+            }
+            starts_ = detail::char_set_tables(starts);
+        }
+
+        // Renumbers the states so that the ones with outputs come last,
+        // and replaces each state number s in delta_ with the index of its
+        // row, s * classes_size_.  The search loop then tells whether a
+        // state has outputs with a single comparison to outputs_first_, and
+        // does not multiply.  The start state stays at 0.
+        void renumber_states ()
+        {
+            int const states = state_patterns_.size();
+            std::vector<int> new_states(states);
+            int next = 0;
+            for (int pass = 0; pass < 2; ++pass) {
+                for (int s = 0; s < states; ++s) {
+                    if ((outputs_[s] != -1) == (pass == 1))
+                        new_states[s] = next++;
+                }
+                if (!pass)
+                    outputs_first_ = next * classes_size_;
+            }
+
+            auto const renumber = [&new_states](std::vector<int> & v) {
+                std::vector<int> renumbered(v.size());
+                std::size_t const row_size = v.size() / new_states.size();
+                for (std::size_t s = 0; s < new_states.size(); ++s) {
+                    std::copy(
+                        v.begin() + s * row_size,
+                        v.begin() + (s + 1) * row_size,
+                        renumbered.begin() + new_states[s] * row_size
+                    );
+                }
+                for (int & t : renumbered) {
+                    if (t != -1)
+                        t = new_states[t];
+                }
+                v.swap(renumbered);
+            };
+            renumber(delta_);
+            renumber(outputs_);
+            renumber(output_links_);
+            std::vector<int> state_patterns(states);
+            for (int s = 0; s < states; ++s) {
+                state_patterns[new_states[s]] = state_patterns_[s];
+            }
+            state_patterns_.swap(state_patterns);
+
+            for (int & t : delta_) {
+                t *= classes_size_;
+            }
+        }
+
+        void build_teddy ()
+        {
+            int const n = size();
+            if (!n || detail::teddy_patterns_max < n)
+                return;
+            teddy_ = true;
+
+            fingerprint_size_ = detail::teddy_fingerprint_max;
+            for (int i = 0; i < n; ++i) {
+                fingerprint_size_ =
+                    (int)(std::min)(std::ptrdiff_t(fingerprint_size_), pattern_size(i));
+            }
+            int const m = fingerprint_size_;
+            auto const fingerprint = [this, m](int i) {
+                return text_view(
+                    chars_.data() + offsets_[i + 1] - m,
+                    m,
+                    utf8::unchecked
+                );
+            };
+
+            // Patterns with equal fingerprints share buckets, so that they
+            // do not cause false matches in other buckets.
+            std::vector<int> by_fingerprint(n);
+            for (int i = 0; i < n; ++i) {
+                by_fingerprint[i] = i;
+            }
+            std::sort(
+                by_fingerprint.begin(), by_fingerprint.end(),
+                [&fingerprint](int lhs, int rhs) {
+                    return fingerprint(lhs) < fingerprint(rhs);
+                }
+            );
+            buckets_.resize(n);
+            for (int i = 0; i < n; ++i) {
+                buckets_[by_fingerprint[i]] = i * detail::teddy_buckets / n;
+            }
+
+            memset(teddy_lo_, 0, sizeof(teddy_lo_));
+            memset(teddy_hi_, 0, sizeof(teddy_hi_));
+            for (int i = 0; i < n; ++i) {
+                unsigned char const bit = 1 << buckets_[i];
+                text_view const f = fingerprint(i);
+                for (int k = 0; k < m; ++k) {
+                    unsigned char const c = f[k];
+                    teddy_lo_[k][c & 0xf] |= bit;
+                    teddy_hi_[k][c >> 4] |= bit;
+                }
+            }
+
+            // Longest first, to match the order of the automaton.
+            teddy_order_ = by_fingerprint;
+            std::sort(
+                teddy_order_.begin(), teddy_order_.end(),
+                [this](int lhs, int rhs) {
+                    std::ptrdiff_t const lhs_size = pattern_size(lhs);
+                    std::ptrdiff_t const rhs_size = pattern_size(rhs);
+                    return rhs_size < lhs_size ||
+                        (lhs_size == rhs_size && lhs < rhs);
+                }
+            );
+        }
+
+        std::string chars_;
+        std::vector<std::ptrdiff_t> offsets_;
+
+        unsigned char classes_[256];
+        int classes_size_;
+        int outputs_first_;
+        detail::char_set_tables starts_;
+        std::vector<int> delta_;
+        std::vector<int> outputs_;
+        std::vector<int> output_links_;
+        std::vector<int> state_patterns_;
+        std::vector<int> next_patterns_;
+
+        bool teddy_;
+        int fingerprint_size_;
+        std::vector<int> teddy_order_;
+        std::vector<unsigned char> buckets_;
+        unsigned char teddy_lo_[detail::teddy_fingerprint_max][16];
+        unsigned char teddy_hi_[detail::teddy_fingerprint_max][16];
+#endif
+
+    };
+
+} }
+
+#endif
@@ -0,0 +1,359 @@
+#ifndef BOOST_TEXT_PARALLEL_ALGORITHM_HPP
+#define BOOST_TEXT_PARALLEL_ALGORITHM_HPP
+
+#include <boost/text/split.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+
+namespace boost { namespace text {
+
+    namespace detail {
+
+        // Sequences shorter than this are not split any further; searching
+        // less than this takes about as long as starting a thread.
+        constexpr std::ptrdiff_t parallel_chunk_min = 1 << 20;
+
+        // The number of chunks per thread.  More, smaller chunks let the
+        // threads that finish early take on the work of the others.
+        constexpr int parallel_chunks_per_thread = 4;
+
+        inline int parallel_thread_count (int threads) noexcept
+        {
+            if (0 < threads)
+                return threads;
+            int const hardware = std::thread::hardware_concurrency();
+            return hardware ? hardware : 1;
+        }
+
+        // Divides [0, size) into equal chunks, one for each
+        // parallel_chunk_min chars (rounded up), and at most
+        // parallel_chunks_per_thread for each thread.
+        struct parallel_chunks
+        {
+            parallel_chunks (std::ptrdiff_t size, int threads) noexcept :
+                size_ (size),
+                count_ (1),
+                chunk_size_ (size)
+            {
+                std::ptrdiff_t const max_count =
+                    (std::ptrdiff_t)threads * parallel_chunks_per_thread;
+                std::ptrdiff_t const count = (std::min)(
+                    (size + parallel_chunk_min - 1) / parallel_chunk_min,
+                    max_count
+                );
+                if (1 < count) {
+                    count_ = (int)count;
+                    chunk_size_ = (size + count - 1) / count;
+                }
+            }
+
+            int size () const noexcept
+            { return count_; }
+
+            std::ptrdiff_t lo (int i) const noexcept
+            { return (std::min)(i * chunk_size_, size_); }
+
+            std::ptrdiff_t hi (int i) const noexcept
+            { return (std::min)((i + 1) * chunk_size_, size_); }
+
+            std::ptrdiff_t size_;
+            int count_;
+            std::ptrdiff_t chunk_size_;
+        };
+
+        // Calls f(i) for each i in [0, n), on up to threads threads,
+        // including the calling thread.  Each thread claims the lowest
+        // unclaimed i, so chunks are started in order, and a thread that
+        // finishes its chunks early takes on chunks that would otherwise
+        // wait for a slower thread.  If f throws, no further chunks are
+        // started, and the first exception thrown is rethrown on the
+        // calling thread once all the threads are done.
+        template <typename Fn>
+        void parallel_for_each_chunk (int n, int threads, Fn const & f)
+        {
+            std::atomic<int> next(0);
+            std::mutex exception_mutex;
+            std::exception_ptr exception;
+            auto const work = [&next, n, &f, &exception_mutex, &exception] {
+                try {
+                    for (int i = next++; i < n; i = next++) {
+                        f(i);
+                    }
+                } catch (...) {
+                    next = n;
+                    std::lock_guard<std::mutex> lock(exception_mutex);
+                    if (!exception)
+                        exception = std::current_exception();
+                }
+            };
+            threads = (std::min)(threads, n);
+            std::vector<std::thread> pool;
+            pool.reserve(threads - 1);
+            for (int i = 1; i < threads; ++i) {
+                // With fewer threads than requested, the work still gets
+                // done, just more slowly.
+                try {
+                    pool.emplace_back(work);
+                } catch (std::system_error const &) {
+                    break;
+                }
+            }
+            work();
+            for (std::thread & thread : pool) {
+                thread.join();
+            }
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+
+        // The non-overlapping matches of a pattern that start in one chunk
+        // [lo, hi), found in order starting at lo, as find_all() would.
+        // Matches may extend past hi.
+        struct chunk_matches
+        {
+            chunk_matches () noexcept :
+                first_ (-1),
+                count_ (0),
+                end_ (0)
+            {}
+
+            std::ptrdiff_t first_;
+            std::ptrdiff_t count_;
+            std::ptrdiff_t end_;
+            std::vector<std::ptrdiff_t> offsets_;
+        };
+
+        // Finds the matches of finder's pattern in rv that start in [lo,
+        // hi), with each search limited to the chars a match starting
+        // before hi could use.
+        struct chunk_searcher
+        {
+            chunk_searcher (rope_view rv, rope_view_finder const & finder, std::ptrdiff_t lo, std::ptrdiff_t hi) :
+                finder_ (finder),
+                lo_ (lo),
+                hi_ (hi),
+                window_ (rv(
+                    lo,
+                    (std::min)(hi + finder.size() - 1, (std::ptrdiff_t)rv.size()),
+                    utf8::unchecked
+                ))
+            {}
+
+            // Returns the offset of the first match at or after offset
+            // from, or -1 if there is none that starts before hi_.
+            std::ptrdiff_t next (std::ptrdiff_t from) const
+            {
+                if (hi_ <= from)
+                    return -1;
+                std::ptrdiff_t const match = finder_(window_, from - lo_);
+                return match < 0 ? -1 : lo_ + match;
+            }
+
+            rope_view_finder const & finder_;
+            std::ptrdiff_t lo_;
+            std::ptrdiff_t hi_;
+            rope_view window_;
+        };
+
+        inline void find_chunk_matches (
+            chunk_searcher const & searcher,
+            chunk_matches & matches,
+            bool keep_offsets
+        ) {
+            std::ptrdiff_t const p_len = searcher.finder_.size();
+            matches.first_ = searcher.next(searcher.lo_);
+            for (std::ptrdiff_t match = matches.first_; 0 <= match;
+                 match = searcher.next(match + p_len)) {
+                ++matches.count_;
+                matches.end_ = match + p_len;
+                if (keep_offsets)
+                    matches.offsets_.push_back(match);
+            }
+        }
+
+        // Finds the matches of a chunk, given that the last match before
+        // the chunk ends at end.  If that match overlaps the chunk's first
+        // match, the chunk's matches are found again, starting at end,
+        // until they coincide with the ones found starting at the
+        // beginning of the chunk; from then on, both are the same.  Adds
+        // the count of matches to count, and returns the new end.
+        inline std::ptrdiff_t join_chunk_matches (
+            chunk_searcher const & searcher,
+            chunk_matches const & matches,
+            std::ptrdiff_t end,
+            std::ptrdiff_t & count,
+            std::vector<std::ptrdiff_t> * offsets
+        ) {
+            if (!matches.count_)
+                return end;
+
+            if (end <= matches.first_) {
+                count += matches.count_;
+                if (offsets) {
+                    offsets->insert(
+                        offsets->end(),
+                        matches.offsets_.begin(), matches.offsets_.end()
+                    );
+                }
+                return matches.end_;
+            }
+
+            std::ptrdiff_t const p_len = searcher.finder_.size();
+            std::ptrdiff_t const none = (std::numeric_limits<std::ptrdiff_t>::max)();
+            auto const or_none = [none](std::ptrdiff_t match) {
+                return match < 0 ? none : match;
+            };
+
+            // a is the chunk's own sequence of matches, a_index of them
+            // before a; b is the sequence that starts at end.
+            std::ptrdiff_t a = matches.first_;
+            std::ptrdiff_t a_index = 0;
+            std::ptrdiff_t b = or_none(searcher.next(end));
+            while (b != none) {
+                while (a < b) {
+                    a = or_none(searcher.next(a + p_len));
+                    ++a_index;
+                }
+                if (a == b) {
+                    count += matches.count_ - a_index;
+                    if (offsets) {
+                        offsets->insert(
+                            offsets->end(),
+                            matches.offsets_.begin() + a_index,
+                            matches.offsets_.end()
+                        );
+                    }
+                    return matches.end_;
+                }
+                ++count;
+                if (offsets)
+                    offsets->push_back(b);
+                end = b + p_len;
+                b = or_none(searcher.next(end));
+            }
+            return end;
+        }
+
+        inline std::ptrdiff_t parallel_find_all_impl (
+            rope_view rv,
+            text_view p,
+            int threads,
+            std::vector<std::ptrdiff_t> * offsets
+        ) {
+            if (p.empty())
+                return 0;
+
+            threads = parallel_thread_count(threads);
+            parallel_chunks const chunks(rv.size(), threads);
+            rope_view_finder const finder(p);
+            std::vector<chunk_matches> matches(chunks.size());
+
+            parallel_for_each_chunk(chunks.size(), threads, [&](int i) {
+                chunk_searcher const searcher(rv, finder, chunks.lo(i), chunks.hi(i));
+                find_chunk_matches(searcher, matches[i], offsets != nullptr);
+            });
+
+            std::ptrdiff_t count = 0;
+            std::ptrdiff_t end = 0;
+            for (int i = 0; i < chunks.size(); ++i) {
+                chunk_searcher const searcher(rv, finder, chunks.lo(i), chunks.hi(i));
+                end = join_chunk_matches(searcher, matches[i], end, count, offsets);
+            }
+            return count;
+        }
+
+    }
+
+    /** Returns the offset of the first occurance of pattern p within rv, or
+        a value < 0 if p is not found in rv.  An empty p is always
+        considered to match the beginning of rv.  The result is the same as
+        that of find(rv, p).
+
+        rv is divided into chunks, which are searched on up to threads
+        threads; if threads is 0, std::thread::hardware_concurrency()
+        threads are used.  Matches that span chunks are found as well.
+        Chunks are searched in order, and chunks after the first one with
+        a match are not searched.  There is one chunk per 1MB of rv, up to
+        four chunks per thread, so a sequence of 1MB or less is searched on
+        the calling thread alone. */
+    inline std::ptrdiff_t parallel_find (rope_view rv, text_view p, int threads = 0)
+    {
+        if (p.empty())
+            return 0;
+
+        threads = detail::parallel_thread_count(threads);
+        detail::parallel_chunks const chunks(rv.size(), threads);
+        detail::rope_view_finder const finder(p);
+        std::vector<std::ptrdiff_t> firsts(chunks.size(), -1);
+        std::atomic<int> found(chunks.size());
+
+        detail::parallel_for_each_chunk(chunks.size(), threads, [&](int i) {
+            if (found < i)
+                return;
+            detail::chunk_searcher const searcher(rv, finder, chunks.lo(i), chunks.hi(i));
+            firsts[i] = searcher.next(chunks.lo(i));
+            if (firsts[i] < 0)
+                return;
+            int prev_found = found;
+            while (i < prev_found && !found.compare_exchange_weak(prev_found, i))
+                ;
+        });
+
+        return found < chunks.size() ? firsts[found] : -1;
+    }
+
+    /** Returns the offset of the first occurance of pattern p within r, or a
+        value < 0 if p is not found in r.  See parallel_find(rope_view,
+        text_view, int). */
+    inline std::ptrdiff_t parallel_find (rope const & r, text_view p, int threads = 0)
+    { return parallel_find(rope_view(r), p, threads); }
+
+    /** Returns the number of non-overlapping occurances of pattern p within
+        rv; this is the number of elements of find_all(rv, p).
+
+        rv is divided into chunks, which are searched on up to threads
+        threads; if threads is 0, std::thread::hardware_concurrency()
+        threads are used.  Matches that span chunks are found as well.  The
+        count does not depend on the number of threads. */
+    inline std::ptrdiff_t parallel_count (rope_view rv, text_view p, int threads = 0)
+    { return detail::parallel_find_all_impl(rv, p, threads, nullptr); }
+
+    /** Returns the number of non-overlapping occurances of pattern p within
+        r.  See parallel_count(rope_view, text_view, int). */
+    inline std::ptrdiff_t parallel_count (rope const & r, text_view p, int threads = 0)
+    { return parallel_count(rope_view(r), p, threads); }
+
+    /** Returns the offsets of the non-overlapping occurances of pattern p
+        within rv, in order; these are the offsets of the elements of
+        find_all(rv, p).
+
+        rv is divided into chunks, which are searched on up to threads
+        threads; if threads is 0, std::thread::hardware_concurrency()
+        threads are used.  Matches that span chunks are found as well.  The
+        result does not depend on the number of threads. */
+    inline std::vector<std::ptrdiff_t>
+    parallel_find_all (rope_view rv, text_view p, int threads = 0)
+    {
+        std::vector<std::ptrdiff_t> retval;
+        detail::parallel_find_all_impl(rv, p, threads, &retval);
+        return retval;
+    }
+
+    /** Returns the offsets of the non-overlapping occurances of pattern p
+        within r, in order.  See parallel_find_all(rope_view, text_view,
+        int). */
+    inline std::vector<std::ptrdiff_t>
+    parallel_find_all (rope const & r, text_view p, int threads = 0)
+    { return parallel_find_all(rope_view(r), p, threads); }
+
+} }
+
+#endif
@@ -17,6 +17,7 @@ namespace boost { namespace text {
         using const_iterator = detail::const_repeated_chars_iterator;
         using reverse_iterator = detail::const_reverse_repeated_chars_iterator;
         using const_reverse_iterator = detail::const_reverse_repeated_chars_iterator;
+        using size_type = std::ptrdiff_t;
 
         /** Default ctor.
 
@@ -31,7 +32,7 @@ namespace boost { namespace text {
 
             \post view() == tv && count() == count */
         BOOST_TEXT_CXX14_CONSTEXPR
-        repeated_text_view (text_view tv, std::ptrdiff_t count) noexcept :
+        repeated_text_view (text_view tv, size_type count) noexcept :
             view_ (tv),
             count_ (count)
         {
@@ -54,7 +55,7 @@ namespace boost { namespace text {
         { return view_; }
 
         /** Returns the number of times the view is repeated. */
-        constexpr std::ptrdiff_t count () const noexcept
+        constexpr size_type count () const noexcept
         { return count_; }
 
         /** Returns the i-th char of *this (not a reference).
@@ -62,7 +63,7 @@ namespace boost { namespace text {
             This function is constexpr in C++14 and later.
 
             \pre i < size() */
-        BOOST_TEXT_CXX14_CONSTEXPR char operator[] (int i) const noexcept
+        BOOST_TEXT_CXX14_CONSTEXPR char operator[] (size_type i) const noexcept
         {
             assert(i < size());
             return begin()[i];
@@ -83,7 +84,7 @@ namespace boost { namespace text {
             \pre lo <= hi
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        rope_view operator() (int lo, int hi) const;
+        rope_view operator() (size_type lo, size_type hi) const;
 
         /** Returns a substring of *this, taken from the first cut chars when
             cut => 0, or the last -cut chars when cut < 0.
@@ -93,12 +94,12 @@ namespace boost { namespace text {
             \pre 0 <= cut && cut <= size() || 0 <= -cut && -cut <= size()
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        rope_view operator() (int cut) const;
+        rope_view operator() (size_type cut) const;
 
         constexpr bool empty () const noexcept
         { return view_.empty(); }
 
-        constexpr std::ptrdiff_t size () const noexcept
+        constexpr size_type size () const noexcept
         { return count_ * view_.size(); }
 
 
@@ -16,6 +16,7 @@ namespace boost { namespace text {
     namespace detail {
         struct const_rope_iterator;
         struct const_reverse_rope_iterator;
+        struct rope_splicer;
     }
 
     // TODO: Figure out the best value for detail::text_insert_max by
@@ -123,7 +124,7 @@ namespace boost { namespace text {
             \pre lo <= hi
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        rope_view operator() (int lo, int hi) const;
+        rope_view operator() (size_type lo, size_type hi) const;
 
         /** Returns a substring of *this as a rope_view, taken from the first
             cut chars when cut => 0, or the last -cut chars when cut < 0.
@@ -131,7 +132,7 @@ namespace boost { namespace text {
             \pre 0 <= cut && cut <= size() || 0 <= -cut && -cut <= size()
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        rope_view operator() (int cut) const;
+        rope_view operator() (size_type cut) const;
 
         /** Returns the maximum size a rope can have. */
         size_type max_size () const noexcept
@@ -163,7 +164,9 @@ namespace boost { namespace text {
         /** Visits each segment s of *this and calls f(s).  Each segment is a
             text_view or repeated_text_view.  Depending of the operation
             performed on each segment, this may be more efficient than
-            iterating over [begin(), end()).
+            iterating over [begin(), end()).  If f returns a value convertible
+            to bool, the visitation stops after the first call that returns
+            false.
 
             \pre Fn is an Invocable accepting a single argument of any of the
             types listed above. */
@@ -173,14 +176,33 @@ namespace boost { namespace text {
             detail::foreach_leaf(ptr_, [&](detail::leaf_node_t<detail::rope_tag> const * leaf) {
                 switch (leaf->which_) {
                 case detail::which::t:
-                    f(text_view(leaf->as_text()));
-                    break;
+                    return detail::visit_segment(f, text_view(leaf->as_text()));
                 case detail::which::rtv:
-                    f(leaf->as_repeated_text_view());
-                    break;
+                    return detail::visit_segment(f, leaf->as_repeated_text_view());
                 case detail::which::ref:
-                    f(leaf->as_reference().ref_);
-                    break;
+                    return detail::visit_segment(f, leaf->as_reference().ref_);
+                default: assert(!"unhandled rope node case"); break;
+                }
+                return true;
+            });
+        }
+
+        /** Visits each segment s of *this in reverse order, and calls f(s).
+            Otherwise the same as foreach_segment().
+
+            \pre Fn is an Invocable accepting a single argument of any of the
+            types listed for foreach_segment(). */
+        template <typename Fn>
+        void foreach_segment_reverse (Fn && f) const
+        {
+            detail::foreach_leaf_reverse(ptr_, [&](detail::leaf_node_t<detail::rope_tag> const * leaf) {
+                switch (leaf->which_) {
+                case detail::which::t:
+                    return detail::visit_segment(f, text_view(leaf->as_text()));
+                case detail::which::rtv:
+                    return detail::visit_segment(f, leaf->as_repeated_text_view());
+                case detail::which::ref:
+                    return detail::visit_segment(f, leaf->as_reference().ref_);
                 default: assert(!"unhandled rope node case"); break;
                 }
                 return true;
@@ -343,6 +365,19 @@ namespace boost { namespace text {
 
 #endif
 
+        /** Replaces each invalid UTF-8 sequence in *this with the
+            replacement character, as utf8::repair_encoding() does.  Each
+            segment is checked separately, and only the segments that are
+            not valid UTF-8 are replaced; all other segments remain shared
+            with any other ropes that refer to them.  A code point split
+            between two segments is treated as invalid.  A repeated segment
+            is replaced by a repetition of its repaired view, which *this
+            owns, unless a code point or invalid sequence spans the seam
+            between two repetitions.
+
+            \post utf8::encoded(begin(), end()) */
+        rope & repair_encoding ();
+
         /** Swaps *this with rhs. */
         void swap (rope & rhs)
         { ptr_.swap(rhs.ptr_); }
@@ -451,11 +486,7 @@ namespace boost { namespace text {
             check_encoding_from(at);
 
             if (text_insertion insertion = mutable_insertion_leaf(at, t.size(), allocation_note)) {
-                auto const t_size = t.size();
-                for (auto node : insertion.found_.path_) {
-                    auto from = detail::find_child(node, at);
-                    detail::bump_keys(const_cast<detail::interior_node_t<detail::rope_tag> *>(node), from, t_size);
-                }
+                detail::bump_along_path_to_leaf(insertion.found_, at, t.size());
                 insertion.text_->insert(insertion.found_.offset_, t);
             } else {
                 ptr_ = detail::btree_insert(
@@ -472,6 +503,7 @@ namespace boost { namespace text {
         detail::node_ptr<detail::rope_tag> ptr_;
 
         friend struct detail::const_rope_iterator;
+        friend struct detail::rope_splicer;
         friend struct rope_view;
 
 #endif
@@ -754,6 +786,29 @@ namespace boost { namespace text {
         return erase(old_first, old_last).insert(old_first, new_first, new_last);
     }
 
+    inline rope & rope::repair_encoding ()
+    {
+        std::vector<detail::segment_repair> repairs;
+        std::ptrdiff_t offset = 0;
+        foreach_segment(detail::segment_encoding_repairer{offset, repairs});
+
+        // Back to front, so that the offsets of the remaining repairs stay
+        // valid.
+        for (auto it = repairs.rbegin(), end = repairs.rend(); it != end; ++it) {
+            ptr_ = detail::btree_erase(ptr_, it->lo_, it->hi_, detail::encoding_breakage_ok);
+            detail::node_ptr<detail::rope_tag> node =
+                detail::make_node(std::move(it->repaired_));
+            if (it->count_) {
+                // The repeated segment keeps the text leaf alive.
+                text const & repaired = node.as_leaf()->as_text();
+                node = detail::make_node(repeated_text_view(repaired, it->count_), node);
+            }
+            ptr_ = detail::btree_insert(ptr_, it->lo_, std::move(node), detail::encoding_breakage_ok);
+        }
+
+        return *this;
+    }
+
     inline rope & rope::operator+= (rope_view rv)
     { return insert(size(), rv); }
 
@@ -770,7 +825,7 @@ namespace boost { namespace text {
     inline rope::const_reverse_iterator rope::rend () const noexcept
     { return const_reverse_iterator(const_iterator(*this, -1)); }
 
-    inline rope_view rope::operator() (int lo, int hi) const
+    inline rope_view rope::operator() (size_type lo, size_type hi) const
     {
         if (lo < 0)
             lo += size();
@@ -782,10 +837,10 @@ namespace boost { namespace text {
         return rope_view(*this, lo, hi);
     }
 
-    inline rope_view rope::operator() (int cut) const
+    inline rope_view rope::operator() (size_type cut) const
     {
-        int lo = 0;
-        int hi = cut;
+        size_type lo = 0;
+        size_type hi = cut;
         if (cut < 0) {
             lo = cut + size();
             hi = size();
@@ -841,8 +896,8 @@ namespace boost { namespace text {
 
     inline rope rope::substr (size_type cut) const
     {
-        int lo = 0;
-        int hi = cut;
+        size_type lo = 0;
+        size_type hi = cut;
         if (cut < 0) {
             lo = cut + size();
             hi = size();
@@ -914,7 +969,7 @@ namespace boost { namespace text {
         which_ (which::r)
     {}
 
-    inline rope_view::rope_view (rope const & r, int lo, int hi) :
+    inline rope_view::rope_view (rope const & r, size_type lo, size_type hi) :
         ref_ (rope_ref(&r, lo, hi)),
         which_ (which::r)
     {
@@ -924,7 +979,7 @@ namespace boost { namespace text {
             throw std::invalid_argument("The end of the given string is not valid UTF-8.");
     }
 
-    inline rope_view::rope_view (rope const & r, int lo, int hi, utf8::unchecked_t) noexcept :
+    inline rope_view::rope_view (rope const & r, size_type lo, size_type hi, utf8::unchecked_t) noexcept :
         ref_ (rope_ref(&r, lo, hi)),
         which_ (which::r)
     {}
@@ -934,17 +989,17 @@ namespace boost { namespace text {
         which_ (which::tv)
     {}
 
-    inline rope_view::rope_view (text const & r, int lo, int hi) :
+    inline rope_view::rope_view (text const & r, size_type lo, size_type hi) :
         ref_ (r(lo, hi)),
         which_ (which::tv)
     {}
 
-    inline rope_view::rope_view (text const & r, int lo, int hi, utf8::unchecked_t) noexcept :
+    inline rope_view::rope_view (text const & r, size_type lo, size_type hi, utf8::unchecked_t) noexcept :
         ref_ (text_view(r.begin() + lo, hi - lo, utf8::unchecked)),
         which_ (which::tv)
     {}
 
-    inline rope_view::rope_view (repeated_text_view rtv, int lo, int hi) :
+    inline rope_view::rope_view (repeated_text_view rtv, size_type lo, size_type hi) :
         ref_ (repeated_ref(rtv, lo, hi)),
         which_ (which::rtv)
     {
@@ -985,13 +1040,13 @@ namespace boost { namespace text {
     inline rope_view::size_type rope_view::size () const noexcept
     { return end() - begin(); }
 
-    inline char rope_view::operator[] (int i) const noexcept
+    inline char rope_view::operator[] (size_type i) const noexcept
     {
         assert(1 < size());
         return begin()[i];
     }
 
-    inline rope_view rope_view::operator() (int lo, int hi) const
+    inline rope_view rope_view::operator() (size_type lo, size_type hi) const
     {
         if (lo < 0)
             lo += size();
@@ -1008,10 +1063,27 @@ namespace boost { namespace text {
         return *this; // This should never execute.
     }
 
+    inline rope_view rope_view::operator() (size_type lo, size_type hi, utf8::unchecked_t) const noexcept
+    {
+        if (lo < 0)
+            lo += size();
+        if (hi < 0)
+            hi += size();
+        assert(0 <= lo && lo <= size());
+        assert(0 <= hi && hi <= size());
+        assert(lo <= hi);
+        switch (which_) {
+        case which::r: return rope_view(ref_.r_.r_, ref_.r_.lo_ + lo, ref_.r_.lo_ + hi);
+        case which::tv: return rope_view(text_view(ref_.tv_.begin() + lo, hi - lo, utf8::unchecked));
+        case which::rtv: return rope_view(ref_.rtv_.rtv_, ref_.rtv_.lo_ + lo, ref_.rtv_.lo_ + hi, utf8::unchecked);
+        }
+        return *this; // This should never execute.
+    }
+
     namespace detail {
 
         template <typename Fn>
-        void apply_to_segment (
+        bool apply_to_segment (
             detail::leaf_node_t<detail::rope_tag> const * leaf,
             std::ptrdiff_t lo,
             std::ptrdiff_t hi,
@@ -1019,19 +1091,17 @@ namespace boost { namespace text {
         ) {
             switch (leaf->which_) {
             case detail::which::t:
-                f(leaf->as_text()(lo, hi));
-                break;
+                return detail::visit_segment(f, leaf->as_text()(lo, hi));
             case detail::which::rtv:
-                f(detail::repeated_range{
+                return detail::visit_segment(f, detail::repeated_range{
                     leaf->as_repeated_text_view().begin() + lo,
                     leaf->as_repeated_text_view().begin() + hi
                 });
-                break;
             case detail::which::ref:
-                f(leaf->as_reference().ref_(lo, hi));
-                break;
+                return detail::visit_segment(f, leaf->as_reference().ref_(lo, hi));
             default: assert(!"unhandled rope node case"); break;
             }
+            return true;
         }
 
     }
@@ -1054,7 +1124,7 @@ namespace boost { namespace text {
 
         rope_ref r_ref = ref_.r_;
 
-        if (!r_ref.r_)
+        if (!r_ref.r_ || !r_ref.r_->ptr_)
             return;
 
         detail::found_leaf<detail::rope_tag> found_lo;
@@ -1074,12 +1144,12 @@ namespace boost { namespace text {
         }
 
         bool before_lo = true;
-        detail::foreach_leaf(r_ref.r_->ptr_, [&](detail::leaf_node_t<detail::rope_tag> const * leaf) {
+        detail::foreach_leaf_from(r_ref.r_->ptr_, r_ref.lo_, [&](detail::leaf_node_t<detail::rope_tag> const * leaf) {
             if (before_lo) {
                 if (leaf == found_lo.leaf_->as_leaf()) {
                     auto const leaf_size = detail::size(leaf);
-                    detail::apply_to_segment(leaf, found_lo.offset_, leaf_size, f);
                     before_lo = false;
+                    return detail::apply_to_segment(leaf, found_lo.offset_, leaf_size, f);
                 }
                 return true; // continue
             }
@@ -1091,9 +1161,58 @@ namespace boost { namespace text {
             }
 
             auto const leaf_size = detail::size(leaf);
-            detail::apply_to_segment(leaf, 0, leaf_size, f);
+            return detail::apply_to_segment(leaf, 0, leaf_size, f);
+        });
+    }
 
-            return true;
+    template <typename Fn>
+    void rope_view::foreach_segment_reverse (Fn && f) const
+    {
+        if (which_ != which::r) {
+            foreach_segment(f);
+            return;
+        }
+
+        rope_ref r_ref = ref_.r_;
+
+        if (!r_ref.r_ || !r_ref.r_->ptr_ || r_ref.lo_ == r_ref.hi_)
+            return;
+
+        detail::found_leaf<detail::rope_tag> found_lo;
+        detail::find_leaf(r_ref.r_->ptr_, r_ref.lo_, found_lo);
+
+        // The leaf containing the last char, rather than the one that starts
+        // at hi.
+        detail::found_leaf<detail::rope_tag> found_hi;
+        detail::find_leaf(r_ref.r_->ptr_, r_ref.hi_ - 1, found_hi);
+
+        if (found_lo.leaf_->as_leaf() == found_hi.leaf_->as_leaf()) {
+            detail::apply_to_segment(
+                found_lo.leaf_->as_leaf(),
+                found_lo.offset_,
+                found_hi.offset_ + 1,
+                f
+            );
+            return;
+        }
+
+        bool after_hi = true;
+        detail::foreach_leaf_reverse_from(r_ref.r_->ptr_, r_ref.hi_ - 1, [&](detail::leaf_node_t<detail::rope_tag> const * leaf) {
+            if (after_hi) {
+                if (leaf == found_hi.leaf_->as_leaf()) {
+                    after_hi = false;
+                    return detail::apply_to_segment(leaf, 0, found_hi.offset_ + 1, f);
+                }
+                return true; // continue
+            }
+
+            auto const leaf_size = detail::size(leaf);
+            if (leaf == found_lo.leaf_->as_leaf()) {
+                detail::apply_to_segment(leaf, found_lo.offset_, leaf_size, f);
+                return false; // break
+            }
+
+            return detail::apply_to_segment(leaf, 0, leaf_size, f);
         });
     }
 
@@ -1116,39 +1235,215 @@ namespace boost { namespace text {
                     return -1;
             } else if (iters.second == rhs_last) {
                 return 1;
-            } else if (*iters.first < *iters.second) {
+            } else if ((unsigned char)*iters.first < (unsigned char)*iters.second) {
                 return -1;
             } else {
                 return 1;
             }
         }
 
-    }
+        // The chars of a rope_view, as contiguous chunks.  The chunks of a
+        // rope are the parts of its leaves; those of a text_view or
+        // repeated_text_view are the parts of each repetition.  A text_view
+        // is a repeated_text_view with one repetition.
+        struct rope_view_chunks
+        {
+            using node_ptr_t = node_ptr<rope_tag>;
+            using chain_t = container::static_vector<node_t<rope_tag> const *, 24>;
+
+            rope_view_chunks (
+                char const * first,
+                std::ptrdiff_t period,
+                std::ptrdiff_t lo,
+                std::ptrdiff_t hi
+            ) noexcept :
+                root_ (nullptr),
+                first_ (first),
+                period_ (period),
+                lo_ (lo),
+                hi_ (hi),
+                leaf_ (nullptr),
+                leaf_lo_ (0),
+                leaf_hi_ (0)
+            {}
+
+            rope_view_chunks (
+                node_ptr_t const & root,
+                std::ptrdiff_t lo,
+                std::ptrdiff_t hi
+            ) noexcept :
+                root_ (&root),
+                first_ (nullptr),
+                period_ (0),
+                lo_ (lo),
+                hi_ (hi),
+                leaf_ (nullptr),
+                leaf_lo_ (0),
+                leaf_hi_ (0)
+            {}
+
+            std::ptrdiff_t size () const noexcept
+            { return hi_ - lo_; }
+
+            // Returns true if view offset o is the first char of a leaf.
+            // \pre o < size()
+            bool at_leaf_start (std::ptrdiff_t o) noexcept
+            {
+                if (!root_)
+                    return false;
+                find(lo_ + o);
+                return lo_ + o == leaf_lo_;
+            }
 
-    inline int rope_view::compare (rope_view rhs) const noexcept
-    {
-        if (which_ == which::tv && rhs.which_ == which::tv)
-            return ref_.tv_.compare(rhs.ref_.tv_);
+            // Returns the chars from view offset o to the end of their chunk,
+            // or of the view, and their number in size.
+            // \pre o < size()
+            char const * chunk (std::ptrdiff_t o, std::ptrdiff_t & size) noexcept
+            {
+                std::ptrdiff_t const n = lo_ + o;
+                if (!root_) {
+                    std::ptrdiff_t const k = n % period_;
+                    size = (std::min)(period_ - k, hi_ - n);
+                    return first_ + k;
+                }
+
+                find(n);
+                std::ptrdiff_t const offset = n - leaf_lo_;
+                size = (std::min)(leaf_hi_, hi_) - n;
+                switch (leaf_->which_) {
+                case which::t:
+                    return leaf_->as_text().begin() + offset;
+                case which::rtv: {
+                    text_view const v = leaf_->as_repeated_text_view().view();
+                    std::ptrdiff_t const k = offset % v.size();
+                    size = (std::min)(size, v.size() - k);
+                    return v.begin() + k;
+                }
+                case which::ref:
+                    return leaf_->as_reference().ref_.begin() + offset;
+                default: assert(!"unhandled rope node case"); break;
+                }
+                return nullptr;
+            }
 
-        if (empty())
-            return rhs.empty() ? 0 : -1;
+            // Appends to chain the nodes of the tree that start at view
+            // offset o and hold at most n chars, largest first.
+            // \pre at_leaf_start(o)
+            void starting_nodes (std::ptrdiff_t o, std::ptrdiff_t n, chain_t & chain) const noexcept
+            {
+                std::ptrdiff_t const pos = lo_ + o;
+                node_ptr_t const * node = root_;
+                std::ptrdiff_t node_lo = 0;
+                while (true) {
+                    if (node_lo == pos && detail::size(node->get()) <= n)
+                        chain.push_back(node->get());
+                    if ((*node)->leaf_)
+                        break;
+                    auto const i = find_child(node->as_interior(), pos - node_lo);
+                    node_lo += offset(*node, i);
+                    node = &children(*node)[i];
+                }
+            }
+
+            // Makes leaf_ the leaf that holds the char at n.
+            void find (std::ptrdiff_t n) noexcept
+            {
+                if (leaf_lo_ <= n && n < leaf_hi_)
+                    return;
+                found_leaf<rope_tag> found;
+                find_leaf(*root_, n, found);
+                leaf_ = found.leaf_->as_leaf();
+                leaf_lo_ = n - found.offset_;
+                leaf_hi_ = leaf_lo_ + detail::size(leaf_);
+            }
+
+            node_ptr_t const * root_;
+            char const * first_;
+            std::ptrdiff_t period_;
+            std::ptrdiff_t lo_;
+            std::ptrdiff_t hi_;
+            leaf_node_t<rope_tag> const * leaf_;
+            std::ptrdiff_t leaf_lo_;
+            std::ptrdiff_t leaf_hi_;
+        };
 
-        // TODO: This could probably be optimized quite a bit by doing
-        // something equivalent to mismatch, segment-wise.
-        auto const iters =
-            algorithm::mismatch(begin(), end(), rhs.begin(), rhs.end());
-        if (iters.first == end()) {
-            if (iters.second == rhs.end())
+        // Returns the size of the largest subtree that both l and r have at
+        // view offset o, holding at most n chars, or 0 if there is none.
+        // Such a subtree holds the same chars in both, and so need not be
+        // compared.
+        inline std::ptrdiff_t shared_subtree_size (
+            rope_view_chunks & l,
+            rope_view_chunks & r,
+            std::ptrdiff_t o,
+            std::ptrdiff_t n
+        ) noexcept {
+            if (!l.at_leaf_start(o) || !r.at_leaf_start(o))
                 return 0;
-            else
+            rope_view_chunks::chain_t l_chain;
+            rope_view_chunks::chain_t r_chain;
+            l.starting_nodes(o, n, l_chain);
+            r.starting_nodes(o, n, r_chain);
+            for (auto node : l_chain) {
+                if (std::find(r_chain.begin(), r_chain.end(), node) != r_chain.end())
+                    return size(node);
+            }
+            return 0;
+        }
+
+        // Walks the chunks of l and r together, comparing each overlapping
+        // pair of chunks with memcmp(), and skipping subtrees they share.
+        inline int compare_chunks (rope_view_chunks l, rope_view_chunks r) noexcept
+        {
+            std::ptrdiff_t const n = (std::min)(l.size(), r.size());
+            std::ptrdiff_t o = 0;
+            while (o < n) {
+                std::ptrdiff_t const shared = shared_subtree_size(l, r, o, n - o);
+                if (shared) {
+                    o += shared;
+                    continue;
+                }
+                std::ptrdiff_t l_size = 0;
+                std::ptrdiff_t r_size = 0;
+                char const * const l_first = l.chunk(o, l_size);
+                char const * const r_first = r.chunk(o, r_size);
+                std::ptrdiff_t const size = (std::min)((std::min)(l_size, r_size), n - o);
+                int const retval = memcmp(l_first, r_first, size);
+                if (retval)
+                    return retval < 0 ? -1 : 1;
+                o += size;
+            }
+            if (l.size() < r.size())
                 return -1;
-        } else if (iters.second == rhs.end()) {
-            return 1;
-        } else if (*iters.first < *iters.second) {
-            return -1;
-        } else {
-            return 1;
+            return l.size() == r.size() ? 0 : 1;
+        }
+
+    }
+
+    inline detail::rope_view_chunks rope_view::chunks () const noexcept
+    {
+        switch (which_) {
+        case which::r:
+            if (!ref_.r_.r_)
+                break;
+            return detail::rope_view_chunks(ref_.r_.r_->ptr_, ref_.r_.lo_, ref_.r_.hi_);
+        case which::tv:
+            return detail::rope_view_chunks(
+                ref_.tv_.begin(), ref_.tv_.size(), 0, ref_.tv_.size()
+            );
+        case which::rtv:
+            return detail::rope_view_chunks(
+                ref_.rtv_.rtv_.view().begin(), ref_.rtv_.rtv_.view().size(),
+                ref_.rtv_.lo_, ref_.rtv_.hi_
+            );
         }
+        return detail::rope_view_chunks(nullptr, 0, 0, 0);
+    }
+
+    inline int rope_view::compare (rope_view rhs) const noexcept
+    {
+        if (which_ == which::tv && rhs.which_ == which::tv)
+            return ref_.tv_.compare(rhs.ref_.tv_);
+        return detail::compare_chunks(chunks(), rhs.chunks());
     }
 
     inline rope_view::iterator begin (rope_view rv) noexcept
@@ -1175,12 +1470,149 @@ namespace boost { namespace text {
         return retval += rhs;
     }
 
+    namespace detail {
+
+        inline char * copy_chars (const_rope_iterator first, const_rope_iterator last, char * out)
+        {
+            if (first == last)
+                return out;
+            rope_view(*first.rope_, first.n_, last.n_, utf8::unchecked)
+                .foreach_segment(segment_copier{out});
+            return out;
+        }
+
+        inline char * copy_chars (const_rope_view_iterator first, const_rope_view_iterator last, char * out)
+        {
+            assert(first.which_ == last.which_);
+            switch (first.which_) {
+            case const_rope_view_iterator::which::r: return copy_chars(first.r_, last.r_, out);
+            case const_rope_view_iterator::which::tv: return std::copy(first.tv_, last.tv_, out);
+            case const_rope_view_iterator::which::rtv: return std::copy(first.rtv_, last.rtv_, out);
+            }
+            return out; // This should never execute.
+        }
+
+    }
+
     inline text & text::operator+= (rope r)
     { return insert(size(), r.begin(), r.end()); }
 
     inline text & text::operator+= (rope_view rv)
     { return insert(size(), rv.begin(), rv.end()); }
 
+    namespace utf8 {
+
+        /** Returns the number of code points in r.  Each segment of r is
+            counted as a whole, using the SIMD implementation for
+            contiguous segments, and each repeated segment is counted once.
+            As with count_code_points(char const *, char const *), the result
+            is exact only when r is valid UTF-8. */
+        inline std::ptrdiff_t count_code_points (rope const & r) noexcept
+        {
+            std::ptrdiff_t retval = 0;
+            r.foreach_segment(boost::text::detail::segment_code_point_counter{retval});
+            return retval;
+        }
+
+        /** Returns the number of code points in rv.  Each segment of rv is
+            counted as a whole, using the SIMD implementation for contiguous
+            segments.  As with count_code_points(char const *, char const *),
+            the result is exact only when rv is valid UTF-8. */
+        inline std::ptrdiff_t count_code_points (rope_view rv) noexcept
+        {
+            std::ptrdiff_t retval = 0;
+            rv.foreach_segment(boost::text::detail::segment_code_point_counter{retval});
+            return retval;
+        }
+
+        /** Returns an iterator n code points past r.begin(), or r.end() if r
+            contains n or fewer code points.  Segments that lie entirely
+            before the result are skipped by counting their code points,
+            without iterating over r.
+
+            \pre 0 <= n */
+        inline rope::const_iterator
+        advance_code_points (rope const & r, std::ptrdiff_t n) noexcept
+        {
+            assert(0 <= n);
+            std::ptrdiff_t offset = 0;
+            r.foreach_segment(boost::text::detail::segment_code_point_advancer{n, offset});
+            return r.begin() + offset;
+        }
+
+        /** Returns an iterator n code points past rv.begin(), or rv.end() if
+            rv contains n or fewer code points.  Segments that lie entirely
+            before the result are skipped by counting their code points,
+            without iterating over rv.
+
+            \pre 0 <= n */
+        inline rope_view::const_iterator
+        advance_code_points (rope_view rv, std::ptrdiff_t n) noexcept
+        {
+            assert(0 <= n);
+            std::ptrdiff_t offset = 0;
+            rv.foreach_segment(boost::text::detail::segment_code_point_advancer{n, offset});
+            return rv.begin() + offset;
+        }
+
+        /** Returns the number of UTF-16 code units needed to encode the code
+            points in r.  Each segment of r is counted as a whole, as in
+            count_code_points(rope const &).  The result is exact only when
+            r is valid UTF-8. */
+        inline std::ptrdiff_t count_utf16_code_units (rope const & r) noexcept
+        {
+            std::ptrdiff_t retval = 0;
+            r.foreach_segment(boost::text::detail::segment_utf16_counter{retval});
+            return retval;
+        }
+
+        /** Returns the number of UTF-16 code units needed to encode the code
+            points in rv.  Each segment of rv is counted as a whole, as in
+            count_code_points(rope_view).  The result is exact only when rv
+            is valid UTF-8. */
+        inline std::ptrdiff_t count_utf16_code_units (rope_view rv) noexcept
+        {
+            std::ptrdiff_t retval = 0;
+            rv.foreach_segment(boost::text::detail::segment_utf16_counter{retval});
+            return retval;
+        }
+
+        /** Returns an iterator to the code point that would start n UTF-16
+            code units past r.begin(), or r.end() if r would encode as n or
+            fewer UTF-16 code units.  If n falls between the two halves of a
+            surrogate pair, the result is the start of that pair's code
+            point.  Segments that lie entirely before the result are skipped
+            by counting, without iterating over r.
+
+            \pre 0 <= n */
+        inline rope::const_iterator
+        advance_utf16_code_units (rope const & r, std::ptrdiff_t n) noexcept
+        {
+            assert(0 <= n);
+            std::ptrdiff_t offset = 0;
+            r.foreach_segment(boost::text::detail::segment_utf16_advancer{n, offset});
+            return r.begin() + offset;
+        }
+
+        /** Returns an iterator to the code point that would start n UTF-16
+            code units past rv.begin(), or rv.end() if rv would encode as n
+            or fewer UTF-16 code units.  If n falls between the two halves of
+            a surrogate pair, the result is the start of that pair's code
+            point.  Segments that lie entirely before the result are skipped
+            by counting, without iterating over rv.
+
+            \pre 0 <= n */
+        inline rope_view::const_iterator
+        advance_utf16_code_units (rope_view rv, std::ptrdiff_t n) noexcept
+        {
+            assert(0 <= n);
+            std::ptrdiff_t offset = 0;
+            rv.foreach_segment(boost::text::detail::segment_utf16_advancer{n, offset});
+            return rv.begin() + offset;
+        }
+
+    }
+
     namespace detail {
 
 #ifdef BOOST_TEXT_TESTING
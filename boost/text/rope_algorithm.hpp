@@ -0,0 +1,518 @@
+#ifndef BOOST_TEXT_ROPE_ALGORITHM_HPP
+#define BOOST_TEXT_ROPE_ALGORITHM_HPP
+
+#include <boost/text/split.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+
+namespace boost { namespace text {
+
+    namespace detail {
+
+        // Returns the offset of the last occurance of p in segment s, or -1.
+        // \pre !p.empty()
+        inline std::ptrdiff_t rfind_segment (text_view tv, text_view p) noexcept
+        { return rfind_impl(tv.begin(), tv.end(), p.begin(), p.end()); }
+
+        // A match in a repeated sequence implies a match one period later,
+        // if there is room for it.  So the last match, if any, ends in the
+        // last repetition, and only the last period + pattern size - 1 chars
+        // need to be searched.
+        inline std::ptrdiff_t rfind_segment (repeated_text_view rtv, text_view p)
+        {
+            std::ptrdiff_t const suffix_size = (std::min)(
+                rtv.size(),
+                (std::ptrdiff_t)rtv.view().size() + p.size() - 1
+            );
+            auto const last = rtv.end();
+            auto const it =
+                std::find_end(last - suffix_size, last, p.begin(), p.end());
+            return it == last ? -1 : it - rtv.begin();
+        }
+
+        template <typename Segment>
+        std::ptrdiff_t rfind_segment (Segment const & s, text_view p)
+        {
+            auto const it = std::find_end(s.begin(), s.end(), p.begin(), p.end());
+            return it == s.end() ? -1 : it - s.begin();
+        }
+
+        // The search for carry_segment_finder for rfind().
+        struct rfind_segment_search
+        {
+            std::ptrdiff_t operator() (char const * first, char const * last) const noexcept
+            { return rfind_impl(first, last, p_.begin(), p_.end()); }
+
+            template <typename Segment>
+            std::ptrdiff_t operator() (Segment const & s) const
+            { return rfind_segment(s, p_); }
+
+            text_view p_;
+        };
+
+        template <typename Rope>
+        std::ptrdiff_t rfind_segments (Rope const & r, text_view p)
+        {
+            if (p.empty())
+                return r.size();
+            return carry_find_segments<true>(r, p.size(), rfind_segment_search{p});
+        }
+
+        // Finds the first (or for Reverse, last) char c in the segments of a
+        // rope or rope_view for which (c is in the set) == In.  offset_ is
+        // the offset of the beginning (or for Reverse, end) of the current
+        // segment.
+        template <bool In, bool Reverse>
+        struct segment_set_finder
+        {
+            char const * search (char const * first, char const * last) const noexcept
+            {
+                if (last - first < char_set_tables_min) {
+                    return Reverse ?
+                        rfind_in_set_scalar<In>(first, last, tables_.set_) :
+                        find_in_set_scalar<In>(first, last, tables_.set_);
+                }
+                return Reverse ?
+                    rfind_in_set_runtime<In>(first, last, tables_) :
+                    find_in_set_runtime<In>(first, last, tables_);
+            }
+
+            bool visit (std::ptrdiff_t size, std::ptrdiff_t match) const
+            {
+                if (Reverse)
+                    offset_ -= size;
+                if (0 <= match) {
+                    result_ = offset_ + match;
+                    return false;
+                }
+                if (!Reverse)
+                    offset_ += size;
+                return true;
+            }
+
+            bool operator() (text_view tv) const
+            {
+                char const * const it = search(tv.begin(), tv.end());
+                return visit(tv.size(), it ? it - tv.begin() : -1);
+            }
+
+            // Whether a char is in the set is the same in every repetition,
+            // so only one repetition needs to be searched.
+            bool operator() (repeated_text_view rtv) const
+            {
+                text_view const v = rtv.view();
+                char const * const it =
+                    rtv.count() ? search(v.begin(), v.end()) : nullptr;
+                std::ptrdiff_t match = -1;
+                if (it)
+                    match = (Reverse ? rtv.size() - v.size() : 0) + (it - v.begin());
+                return visit(rtv.size(), match);
+            }
+
+            template <typename Segment>
+            bool operator() (Segment const & s) const
+            {
+                auto const first = s.begin();
+                auto const last = s.end();
+                std::ptrdiff_t match = -1;
+                if (Reverse) {
+                    for (auto it = last; it != first;) {
+                        if (tables_.set_.contains(*--it) == In) {
+                            match = it - first;
+                            break;
+                        }
+                    }
+                } else {
+                    for (auto it = first; it != last; ++it) {
+                        if (tables_.set_.contains(*it) == In) {
+                            match = it - first;
+                            break;
+                        }
+                    }
+                }
+                return visit(last - first, match);
+            }
+
+            char_set_tables const & tables_;
+            std::ptrdiff_t & offset_;
+            std::ptrdiff_t & result_;
+        };
+
+        template <bool In, bool Reverse, typename Rope>
+        std::ptrdiff_t find_in_set_segments (Rope const & r, text_view p)
+        {
+            if (p.empty())
+                return Reverse ? r.size() : 0;
+            char_set_tables const tables(char_set(p.begin(), p.end()));
+            std::ptrdiff_t offset = Reverse ? r.size() : 0;
+            std::ptrdiff_t result = -1;
+            segment_set_finder<In, Reverse> finder{tables, offset, result};
+            if (Reverse)
+                r.foreach_segment_reverse(finder);
+            else
+                r.foreach_segment(finder);
+            return result;
+        }
+
+        struct ascii_icase_equal_to
+        {
+            bool operator() (char l, char r) const noexcept
+            { return ascii_lower(l) == ascii_lower(r); }
+        };
+
+        // The search for carry_segment_finder for find_ascii_icase().
+        struct ascii_icase_segment_search
+        {
+            std::ptrdiff_t operator() (char const * first, char const * last) const noexcept
+            { return find_ascii_icase_impl(first, last, p_.begin(), p_.end()); }
+
+            std::ptrdiff_t operator() (text_view tv) const noexcept
+            { return (*this)(tv.begin(), tv.end()); }
+
+            // As with find_repeated(), only the first period + pattern size
+            // - 1 chars need to be searched.
+            std::ptrdiff_t operator() (repeated_text_view rtv) const
+            {
+                std::ptrdiff_t const prefix_size = (std::min)(
+                    rtv.size(),
+                    (std::ptrdiff_t)rtv.view().size() + p_.size() - 1
+                );
+                return search(rtv.begin(), rtv.begin() + prefix_size);
+            }
+
+            template <typename Segment>
+            std::ptrdiff_t operator() (Segment const & s) const
+            { return search(s.begin(), s.end()); }
+
+            template <typename Iter>
+            std::ptrdiff_t search (Iter first, Iter last) const
+            {
+                Iter const it = std::search(
+                    first, last, p_.begin(), p_.end(), ascii_icase_equal_to()
+                );
+                return it == last ? -1 : it - first;
+            }
+
+            text_view p_;
+        };
+
+        template <typename Rope>
+        std::ptrdiff_t find_ascii_icase_segments (Rope const & r, text_view p)
+        {
+            if (p.empty())
+                return 0;
+            return carry_find_segments<false>(r, p.size(), ascii_icase_segment_search{p});
+        }
+
+        template <typename LIter, typename RIter>
+        std::ptrdiff_t mismatch_ascii_icase_segments (LIter l, RIter r, std::ptrdiff_t n)
+        {
+            for (std::ptrdiff_t i = 0; i < n; ++i) {
+                if (ascii_lower(l[i]) != ascii_lower(r[i]))
+                    return i;
+            }
+            return n;
+        }
+
+        inline std::ptrdiff_t mismatch_ascii_icase_segments (
+            char const * l, char const * r, std::ptrdiff_t n
+        ) noexcept {
+            return mismatch_ascii_icase_runtime(l, r, n);
+        }
+
+        // Compares the chars at l_ to each segment of the rhs, in turn,
+        // ignoring the case of ASCII letters.  Sets result_ at the first
+        // mismatch.
+        template <typename LIter>
+        struct ascii_icase_rhs_comparer
+        {
+            template <typename Segment>
+            bool operator() (Segment const & s) const
+            {
+                auto const first = s.begin();
+                std::ptrdiff_t const n = s.end() - first;
+                std::ptrdiff_t const i = mismatch_ascii_icase_segments(l_, first, n);
+                if (i < n) {
+                    result_ = compare_ascii_icase_char(l_[i], first[i]);
+                    return false;
+                }
+                l_ += n;
+                return true;
+            }
+
+            LIter & l_;
+            int & result_;
+        };
+
+        // Compares each segment of the lhs to the chars of rhs_ at the same
+        // offsets, ignoring the case of ASCII letters, until the shorter of
+        // the two ends or result_ is set at a mismatch.
+        struct ascii_icase_comparer
+        {
+            template <typename Segment>
+            bool operator() (Segment const & s) const
+            {
+                auto first = s.begin();
+                std::ptrdiff_t const hi = (std::min)(
+                    offset_ + (s.end() - first),
+                    (std::ptrdiff_t)rhs_.size()
+                );
+                rhs_(offset_, hi, utf8::unchecked).foreach_segment(
+                    ascii_icase_rhs_comparer<decltype(first)>{first, result_}
+                );
+                offset_ = hi;
+                return !result_ && hi < rhs_.size();
+            }
+
+            rope_view rhs_;
+            std::ptrdiff_t & offset_;
+            int & result_;
+        };
+
+        inline int compare_ascii_icase_segments (rope_view l, rope_view r)
+        {
+            std::ptrdiff_t offset = 0;
+            int result = 0;
+            l.foreach_segment(ascii_icase_comparer{r, offset, result});
+            if (result)
+                return result;
+            if (l.size() < r.size())
+                return -1;
+            return l.size() == r.size() ? 0 : 1;
+        }
+
+        // Builds a new tree for a rope out of the leaves of its old one,
+        // with replacements spliced in.  The parts of the old leaves that
+        // are kept become references to them, or the old leaves
+        // themselves, rather than copies.
+        struct rope_splicer
+        {
+            using node_ptr_t = node_ptr<rope_tag>;
+
+            // Replaces the match_size chars at each of offsets with
+            // replacement, or with nothing if replacement is null.
+            static void splice (
+                rope & r,
+                std::vector<std::ptrdiff_t> const & offsets,
+                std::ptrdiff_t match_size,
+                node_ptr_t const & replacement
+            ) {
+                std::vector<node_ptr_t> nodes;
+                auto match = offsets.begin();
+                std::ptrdiff_t leaf_lo = 0;
+                std::ptrdiff_t kept_lo = 0; // The end of the last match.
+
+                foreach_leaf(r.ptr_, [&](leaf_node_t<rope_tag> const * leaf) {
+                    std::ptrdiff_t const leaf_hi = leaf_lo + size(leaf);
+                    node_ptr_t const leaf_ptr(leaf);
+                    std::ptrdiff_t lo = (std::max)(kept_lo, leaf_lo);
+                    for (; match != offsets.end() && *match < leaf_hi; ++match) {
+                        if (lo < *match)
+                            nodes.push_back(slice(leaf_ptr, lo - leaf_lo, *match - leaf_lo));
+                        if (replacement)
+                            nodes.push_back(replacement);
+                        kept_lo = *match + match_size;
+                        lo = (std::max)(kept_lo, leaf_lo);
+                    }
+                    if (lo == leaf_lo)
+                        nodes.push_back(leaf_ptr);
+                    else if (lo < leaf_hi)
+                        nodes.push_back(slice(leaf_ptr, lo - leaf_lo, leaf_hi - leaf_lo));
+                    leaf_lo = leaf_hi;
+                    return true;
+                });
+
+                r.ptr_ = btree_build(std::move(nodes));
+            }
+
+            // Match boundaries of a valid UTF-8 pattern never split a code
+            // point, so there is no need to check the slices' encoding.
+            static node_ptr_t slice (node_ptr_t const & leaf, std::ptrdiff_t lo, std::ptrdiff_t hi)
+            { return slice_leaf(leaf, lo, hi, true, encoding_breakage_ok); }
+        };
+
+    }
+
+    /** Returns the offset of the first occurance of pattern p within r, or a
+        value < 0 if p is not found in r.  An empty p is always considered to
+        match the beginning of r.  Each segment of r is searched as a whole,
+        as are matches that span segments. */
+    inline std::ptrdiff_t find (rope const & r, text_view p)
+    { return detail::find_segments(r, searcher(p)); }
+
+    /** Returns the offset of the first occurance of pattern p within rv, or
+        a value < 0 if p is not found in rv.  An empty p is always considered
+        to match the beginning of rv.  Each segment of rv is searched as a
+        whole, as are matches that span segments. */
+    inline std::ptrdiff_t find (rope_view rv, text_view p)
+    { return detail::find_segments(rv, searcher(p)); }
+
+    /** Returns the first occurance of pattern p within r as a rope_view, or
+        rope_view() if p is not found in r.  An empty p is always considered
+        to match the beginning of r. */
+    inline rope_view find_view (rope const & r, text_view p)
+    {
+        std::ptrdiff_t const n = find(r, p);
+        if (n < 0)
+            return rope_view();
+        return rope_view(r, n, n + p.size());
+    }
+
+    /** Returns the first occurance of pattern p within rv as a rope_view, or
+        rope_view() if p is not found in rv.  An empty p is always considered
+        to match the beginning of rv. */
+    inline rope_view find_view (rope_view rv, text_view p)
+    {
+        std::ptrdiff_t const n = find(rv, p);
+        if (n < 0)
+            return rope_view();
+        return rv(n, n + p.size());
+    }
+
+    /** Returns the offset of the last occurance of pattern p within r, or a
+        value < 0 if p is not found in r.  An empty p is always considered to
+        match the end of r.  The segments of r are searched in reverse,
+        each as a whole, as are matches that span segments. */
+    inline std::ptrdiff_t rfind (rope const & r, text_view p)
+    { return detail::rfind_segments(r, p); }
+
+    /** Returns the offset of the last occurance of pattern p within rv, or a
+        value < 0 if p is not found in rv.  An empty p is always considered
+        to match the end of rv.  The segments of rv are searched in reverse,
+        each as a whole, as are matches that span segments. */
+    inline std::ptrdiff_t rfind (rope_view rv, text_view p)
+    { return detail::rfind_segments(rv, p); }
+
+    /** Returns the last occurance of pattern p within r as a rope_view, or
+        rope_view() if p is not found in r.  An empty p is always considered
+        to match the end of r. */
+    inline rope_view rfind_view (rope const & r, text_view p)
+    {
+        std::ptrdiff_t const n = rfind(r, p);
+        if (n < 0)
+            return rope_view();
+        return rope_view(r, n, n + p.size());
+    }
+
+    /** Returns the last occurance of pattern p within rv as a rope_view, or
+        rope_view() if p is not found in rv.  An empty p is always considered
+        to match the end of rv. */
+    inline rope_view rfind_view (rope_view rv, text_view p)
+    {
+        std::ptrdiff_t const n = rfind(rv, p);
+        if (n < 0)
+            return rope_view();
+        return rv(n, n + p.size());
+    }
+
+    /** Returns the offset of the first occurance within r of any of the chars
+        in p, or a value < 0 if none of the chars in p is found in r. */
+    inline std::ptrdiff_t find_first_of (rope const & r, text_view p)
+    { return detail::find_in_set_segments<true, false>(r, p); }
+
+    /** Returns the offset of the first occurance within rv of any of the
+        chars in p, or a value < 0 if none of the chars in p is found in rv. */
+    inline std::ptrdiff_t find_first_of (rope_view rv, text_view p)
+    { return detail::find_in_set_segments<true, false>(rv, p); }
+
+    /** Returns the offset of the last occurance within r of any of the chars
+        in p, or a value < 0 if none of the chars in p is found in r. */
+    inline std::ptrdiff_t find_last_of (rope const & r, text_view p)
+    { return detail::find_in_set_segments<true, true>(r, p); }
+
+    /** Returns the offset of the last occurance within rv of any of the chars
+        in p, or a value < 0 if none of the chars in p is found in rv. */
+    inline std::ptrdiff_t find_last_of (rope_view rv, text_view p)
+    { return detail::find_in_set_segments<true, true>(rv, p); }
+
+    /** Returns the offset of the first char within r that does not
+        match any char in p, or a value < 0 if every char in r is in p. */
+    inline std::ptrdiff_t find_first_not_of (rope const & r, text_view p)
+    { return detail::find_in_set_segments<false, false>(r, p); }
+
+    /** Returns the offset of the first char within rv that does not
+        match any char in p, or a value < 0 if every char in rv is in p. */
+    inline std::ptrdiff_t find_first_not_of (rope_view rv, text_view p)
+    { return detail::find_in_set_segments<false, false>(rv, p); }
+
+    /** Returns the offset of the last char within r that does not
+        match any char in p, or a value < 0 if every char in r is in p. */
+    inline std::ptrdiff_t find_last_not_of (rope const & r, text_view p)
+    { return detail::find_in_set_segments<false, true>(r, p); }
+
+    /** Returns the offset of the last char within rv that does not
+        match any char in p, or a value < 0 if every char in rv is in p. */
+    inline std::ptrdiff_t find_last_not_of (rope_view rv, text_view p)
+    { return detail::find_in_set_segments<false, true>(rv, p); }
+
+    /** Lexicographical compare, ignoring the case of ASCII letters.  Returns
+        a value < 0 when l is lexicographically less than r, 0 if l and r are
+        equal, and a value > 0 if l is lexicographically greater than r.
+        Chars are compared as in compare_ascii_icase(text_view, text_view);
+        each segment of l is compared as a whole to the segments of r it
+        lines up with. */
+    inline int compare_ascii_icase (rope_view l, rope_view r)
+    { return detail::compare_ascii_icase_segments(l, r); }
+
+    /** Returns true if l and r are equal, ignoring the case of ASCII
+        letters.  Sequences of different sizes are never equal, and are not
+        compared further. */
+    inline bool equal_ascii_icase (rope_view l, rope_view r)
+    { return l.size() == r.size() && !detail::compare_ascii_icase_segments(l, r); }
+
+    /** Returns the offset of the first occurance of pattern p within r,
+        ignoring the case of ASCII letters, or a value < 0 if p is not found
+        in r.  An empty p is always considered to match the beginning of r.
+        Each segment of r is searched as a whole, as are matches that span
+        segments. */
+    inline std::ptrdiff_t find_ascii_icase (rope const & r, text_view p)
+    { return detail::find_ascii_icase_segments(r, p); }
+
+    /** Returns the offset of the first occurance of pattern p within rv,
+        ignoring the case of ASCII letters, or a value < 0 if p is not found
+        in rv.  An empty p is always considered to match the beginning of
+        rv.  Each segment of rv is searched as a whole, as are matches that
+        span segments. */
+    inline std::ptrdiff_t find_ascii_icase (rope_view rv, text_view p)
+    { return detail::find_ascii_icase_segments(rv, p); }
+
+    /** Replaces each of the non-overlapping occurances of pattern p within r
+        with replacement, and returns the number of occurances replaced.  The
+        occurances are the elements of find_all(r, p); an empty p has none.
+
+        No chars are copied, except from repeated_text_view segments cut at
+        other than a multiple of their view's size.  Instead, the result is
+        spliced together from references to the parts of r's segments that
+        remain, and from a single segment holding replacement, shared by each
+        replacement.  The result's tree is built bottom-up and balanced.
+        Any other ropes sharing segments with r are unaffected.
+
+        \pre p and replacement are valid UTF-8. */
+    inline std::ptrdiff_t replace_all (rope & r, text_view p, text_view replacement)
+    {
+        if (p.empty())
+            return 0;
+
+        std::vector<std::ptrdiff_t> offsets;
+        rope_view const all(r);
+        detail::rope_view_finder const finder(p);
+        for (std::ptrdiff_t match = finder(all, 0); 0 <= match;
+             match = finder(all, match + p.size())) {
+            offsets.push_back(match);
+        }
+        if (offsets.empty())
+            return 0;
+
+        detail::node_ptr<detail::rope_tag> replacement_node;
+        if (!replacement.empty())
+            replacement_node = detail::make_node(replacement);
+        detail::rope_splicer::splice(r, offsets, p.size(), replacement_node);
+        return offsets.size();
+    }
+
+} }
+
+#endif
@@ -11,6 +11,7 @@ namespace boost { namespace text {
     namespace detail {
         struct const_rope_view_iterator;
         struct const_reverse_rope_view_iterator;
+        struct rope_view_chunks;
     }
 
     /** A reference to a substring of a rope, text, or repeated_text_view.
@@ -51,7 +52,7 @@ namespace boost { namespace text {
             valid UTF-8.
             \post size() == r.size() && begin() == r.begin() + lo && end() ==
             r.begin() + hi */
-        rope_view (rope const & r, int lo, int hi);
+        rope_view (rope const & r, size_type lo, size_type hi);
 
         /** Constructs a substring of r, taken from the range of chars at
             offsets [lo, hi).  If either of lo or hi is a negative value x, x
@@ -66,7 +67,7 @@ namespace boost { namespace text {
             \pre lo <= hi
             \post size() == r.size() && begin() == r.begin() + lo && end() ==
             r.begin() + hi */
-        rope_view (rope const & r, int lo, int hi, utf8::unchecked_t) noexcept;
+        rope_view (rope const & r, size_type lo, size_type hi, utf8::unchecked_t) noexcept;
 
         /** Constructs a rope_view covering the entire given rope.  The UTF-8
             encoding is not checked. */
@@ -89,7 +90,7 @@ namespace boost { namespace text {
             valid UTF-8.
             \post size() == r.size() && begin() == r.begin() + lo && end() ==
             r.begin() + hi */
-        rope_view (text const & r, int lo, int hi);
+        rope_view (text const & r, size_type lo, size_type hi);
 
         /** Constructs a substring of r, taken from the range of chars at
             offsets [lo, hi).  If either of lo or hi is a negative value x, x
@@ -104,7 +105,7 @@ namespace boost { namespace text {
             \pre lo <= hi
             \post size() == r.size() && begin() == r.begin() + lo && end() ==
             r.begin() + hi */
-        rope_view (text const & r, int lo, int hi, utf8::unchecked_t) noexcept;
+        rope_view (text const & r, size_type lo, size_type hi, utf8::unchecked_t) noexcept;
 
         /** Constructs a rope_view from a null-terminated C string.  The UTF-8
             encoding is checked only at the beginning and end of the string,
@@ -146,7 +147,7 @@ namespace boost { namespace text {
             valid UTF-8.
             \post size() == r.size() && begin() == r.begin() + lo && end() ==
             r.begin() + hi */
-        rope_view (repeated_text_view rtv, int lo, int hi);
+        rope_view (repeated_text_view rtv, size_type lo, size_type hi);
 
         /** Constructs a substring of rtv, taken from the range of chars at
             offsets [lo, hi).  If either of lo or hi is a negative value x, x
@@ -161,7 +162,7 @@ namespace boost { namespace text {
             \pre lo <= hi
             \post size() == r.size() && begin() == r.begin() + lo && end() ==
             r.begin() + hi */
-        rope_view (repeated_text_view rtv, int lo, int hi, utf8::unchecked_t) noexcept :
+        rope_view (repeated_text_view rtv, size_type lo, size_type hi, utf8::unchecked_t) noexcept :
             ref_ (repeated_ref(rtv, lo, hi)),
             which_ (which::rtv)
         {}
@@ -178,7 +179,7 @@ namespace boost { namespace text {
         /** Returns the i-th char of *this (not a reference).
 
             \pre i < size() */
-        char operator[] (int i) const noexcept;
+        char operator[] (size_type i) const noexcept;
 
         /** Returns a substring of *this, taken from the range of chars at
             offsets [lo, hi).  If either of lo or hi is a negative value x, x
@@ -188,12 +189,21 @@ namespace boost { namespace text {
             These preconditions apply to the values used after size() is added
             to any negative arguments.
 
-            \pre 0 <= lo && lo <= size()
-            \pre 0 <= hi && lhi <= size()
-            \pre lo <= hi
+            \pre 0 <= lo && lo <= hi && hi <= size()
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        rope_view operator() (int lo, int hi) const;
+        rope_view operator() (size_type lo, size_type hi) const;
+
+        /** Returns a substring of *this, taken from the range of chars at
+            offsets [lo, hi).  If either of lo or hi is a negative value x, x
+            is taken to be an offset from the end, and so x + size() is used
+            instead.  The UTF-8 encoding is not checked.
+
+            These preconditions apply to the values used after size() is added
+            to any negative arguments.
+
+            \pre 0 <= lo && lo <= hi && hi <= size() */
+        rope_view operator() (size_type lo, size_type hi, utf8::unchecked_t) const noexcept;
 
         /** Returns a substring of *this, taken from the first cut chars when
             cut => 0, or the last -cut chars when cut < 0.
@@ -201,10 +211,10 @@ namespace boost { namespace text {
             \pre 0 <= cut && cut <= size() || 0 <= -cut && -cut <= size()
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        rope_view operator() (int cut) const
+        rope_view operator() (size_type cut) const
         {
-            int lo = 0;
-            int hi = cut;
+            size_type lo = 0;
+            size_type hi = cut;
             if (cut < 0) {
                 lo = cut + size();
                 hi = size();
@@ -222,16 +232,30 @@ namespace boost { namespace text {
             segment is a value whose type models a Char_iterator
             iterator-range.  Depending of the operation performed on each
             segment, this may be more efficient than iterating over [begin(),
-            end()).
+            end()).  If f returns a value convertible to bool, the visitation
+            stops after the first call that returns false.
 
             \pre Fn is an Invocable accepting a single argument whose begin
             and end model Char_iterator. */
         template <typename Fn>
         void foreach_segment (Fn && f) const;
 
+        /** Visits each segment s of the underlying rope in reverse order, and
+            calls f(s).  Otherwise the same as foreach_segment().
+
+            \pre Fn is an Invocable accepting a single argument whose begin
+            and end model Char_iterator. */
+        template <typename Fn>
+        void foreach_segment_reverse (Fn && f) const;
+
         /** Lexicographical compare.  Returns a value < 0 when *this is
             lexicographically less than rhs, 0 if *this == rhs, and a value >
-            0 if *this is lexicographically greater than rhs. */
+            0 if *this is lexicographically greater than rhs.
+
+            The segments of *this and rhs are walked together, and each
+            overlapping pair is compared with memcmp(), so chars compare as
+            unsigned chars.  Subtrees of a rope that both sides share at the
+            same offset are skipped without being compared. */
         int compare (rope_view rhs) const noexcept;
 
         /** Swaps *this with rhs. */
@@ -249,25 +273,25 @@ namespace boost { namespace text {
         struct rope_ref
         {
             rope_ref () : r_ (nullptr), lo_ (0), hi_ (0) {}
-            rope_ref (rope const * r, int lo, int hi) :
+            rope_ref (rope const * r, size_type lo, size_type hi) :
                 r_ (r), lo_ (lo), hi_ (hi)
             {}
 
             rope const * r_;
-            int lo_;
-            int hi_;
+            size_type lo_;
+            size_type hi_;
         };
 
         struct repeated_ref
         {
             repeated_ref () : rtv_ (), lo_ (0), hi_ (0) {}
-            repeated_ref (repeated_text_view rtv, int lo, int hi) :
+            repeated_ref (repeated_text_view rtv, size_type lo, size_type hi) :
                 rtv_ (rtv), lo_ (lo), hi_ (hi)
             {}
 
             repeated_text_view rtv_;
-            int lo_;
-            int hi_;
+            size_type lo_;
+            size_type hi_;
         };
 
         union ref
@@ -290,11 +314,13 @@ namespace boost { namespace text {
             repeated_ref rtv_;
         };
 
-        rope_view (rope const * r, int lo, int hi) :
+        rope_view (rope const * r, size_type lo, size_type hi) :
             ref_ (rope_ref(r, lo, hi)),
             which_ (which::r)
         {}
 
+        detail::rope_view_chunks chunks () const noexcept;
+
         ref ref_;
         which which_;
 
@@ -330,10 +356,10 @@ namespace boost { namespace text {
 
 namespace boost { namespace text {
 
-    inline rope_view repeated_text_view::operator() (int lo, int hi) const
-    { return rope_view(*this)(hi, lo); }
+    inline rope_view repeated_text_view::operator() (size_type lo, size_type hi) const
+    { return rope_view(*this)(lo, hi); }
 
-    inline rope_view repeated_text_view::operator() (int cut) const
+    inline rope_view repeated_text_view::operator() (size_type cut) const
     { return rope_view(*this)(cut); }
 
 } }
@@ -0,0 +1,387 @@
+#ifndef BOOST_TEXT_SEARCHER_HPP
+#define BOOST_TEXT_SEARCHER_HPP
+
+#include <boost/text/algorithm.hpp>
+#include <boost/text/rope.hpp>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+
+namespace boost { namespace text {
+
+    namespace detail {
+
+        // Lowercase letters, from most to least common in English text.
+        constexpr char letters_by_frequency[] = "etaoinshrdlcumwfgypbvkjxqz";
+
+        constexpr int letter_frequency_rank (unsigned char c, int i = 0) noexcept
+        {
+            return letters_by_frequency[i] == c ?
+                230 - 4 * i : letter_frequency_rank(c, i + 1);
+        }
+
+        // A rough rank of how often byte c occurs in text, from 0 (rarely)
+        // to 255 (very often).
+        constexpr int byte_frequency_rank (unsigned char c) noexcept
+        {
+            return
+                c == ' ' ? 255 :
+                'a' <= c && c <= 'z' ? letter_frequency_rank(c) :
+                c == '\n' || c == ',' || c == '.' ? 160 :
+                0x80 <= c && c < 0xc0 ? 150 : // Continuation bytes.
+                '0' <= c && c <= '9' ? 100 :
+                'A' <= c && c <= 'Z' ? 90 :
+                0xc0 <= c && c < 0xf5 ? 90 :
+                0x20 < c && c < 0x7f ? 60 :
+                10;
+        }
+
+    }
+
+    /** A precompiled search for a single pattern, for searching many
+        haystacks for the same pattern.  The precomputation is done once, at
+        construction.
+
+        Contiguous haystacks are searched with the vectorized search that
+        find() uses.  Where find() first compares the pattern's first and
+        last chars at each position, a searcher compares the two chars of
+        the pattern that are expected to be rarest in text, so fewer
+        positions need to be compared in full.  Non-contiguous haystacks,
+        such as repeated_text_views and ropes, are searched with a
+        Boyer-Moore-Horspool skip table.
+
+        A searcher refers to its pattern without copying it, so the pattern
+        must outlive the searcher.  A searcher is also a C++17 searcher,
+        usable as the last argument to std::search(). */
+    struct searcher
+    {
+        /** Constructs a searcher for pattern p.
+
+            \post pattern() == p */
+        explicit searcher (text_view p) noexcept :
+            pattern_ (p),
+            rarest_ (0),
+            next_rarest_ (0)
+        {
+            std::ptrdiff_t const p_len = p.size();
+            std::fill(skip_, skip_ + 256, (std::max)(p_len, std::ptrdiff_t(1)));
+            for (std::ptrdiff_t i = 0; i < p_len - 1; ++i) {
+                skip_[(unsigned char)p[i]] = p_len - 1 - i;
+            }
+
+            if (2 <= p_len) {
+                auto const rank = [p](std::ptrdiff_t i) {
+                    return detail::byte_frequency_rank(p[i]);
+                };
+                next_rarest_ = 1;
+                if (rank(1) < rank(0))
+                    std::swap(rarest_, next_rarest_);
+                for (std::ptrdiff_t i = 2; i < p_len; ++i) {
+                    if (rank(i) < rank(rarest_)) {
+                        next_rarest_ = rarest_;
+                        rarest_ = i;
+                    } else if (rank(i) < rank(next_rarest_)) {
+                        next_rarest_ = i;
+                    }
+                }
+            }
+        }
+
+        /** Returns the pattern this searcher searches for. */
+        text_view pattern () const noexcept
+        { return pattern_; }
+
+        /** Returns the first occurrence of pattern() in [first, last), as a
+            pair of pointers to its beginning and end.  Returns (last, last)
+            if there is no occurrence.  An empty pattern() always matches at
+            first. */
+        std::pair<char const *, char const *>
+        operator() (char const * first, char const * last) const noexcept
+        {
+            std::ptrdiff_t const p_len = pattern_.size();
+            if (!p_len)
+                return std::make_pair(first, first);
+            if (last - first < p_len)
+                return std::make_pair(last, last);
+
+            char const * const it = detail::find_filtered(
+                first, last, pattern_.begin(), p_len, rarest_, next_rarest_
+            );
+            return it ? std::make_pair(it, it + p_len) :
+                std::make_pair(last, last);
+        }
+
+        /** Returns the first occurrence of pattern() in [first, last), as a
+            pair of iterators to its beginning and end.  Returns (last,
+            last) if there is no occurrence.  An empty pattern() always
+            matches at first.
+
+            This function only participates in overload resolution if Iter
+            is a random access iterator whose value_type is char. */
+        template <typename Iter>
+        auto operator() (Iter first, Iter last) const
+            -> detail::char_iter_ret_t<std::pair<Iter, Iter>, Iter>
+        {
+            std::ptrdiff_t const p_len = pattern_.size();
+            if (!p_len)
+                return std::make_pair(first, first);
+            if (last - first < p_len)
+                return std::make_pair(last, last);
+            Iter const it = skip_search(first, last);
+            return it == last ? std::make_pair(last, last) :
+                std::make_pair(it, it + p_len);
+        }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        // Boyer-Moore-Horspool.  Returns the start of the first match, or
+        // last if there is none.
+        // \pre pattern_.size() <= last - first
+        template <typename Iter>
+        Iter skip_search (Iter first, Iter last) const
+        {
+            std::ptrdiff_t const p_len = pattern_.size();
+            char const * const p_first = pattern_.begin();
+            char const p_tail = p_first[p_len - 1];
+            Iter const search_last = last - p_len;
+            Iter it = first;
+            while (true) {
+                char const c = it[p_len - 1];
+                if (c == p_tail && std::equal(p_first, p_first + p_len - 1, it))
+                    return it;
+                std::ptrdiff_t const skip = skip_[(unsigned char)c];
+                if (search_last - it < skip)
+                    return last;
+                it += skip;
+            }
+        }
+
+        text_view pattern_;
+        std::ptrdiff_t rarest_;
+        std::ptrdiff_t next_rarest_;
+        std::ptrdiff_t skip_[256];
+#endif
+
+    };
+
+    namespace detail {
+
+        // A match in a repeated sequence implies a match one period
+        // earlier, if there is room for it.  So the first match, if any,
+        // starts in the first repetition, and only the first
+        // period + pattern size - 1 chars need to be searched.
+        inline std::ptrdiff_t find_repeated (
+            repeated_text_view rtv,
+            searcher const & s
+        ) {
+            if (!s.pattern().size())
+                return 0;
+            std::ptrdiff_t const prefix_size = (std::min)(
+                rtv.size(),
+                (std::ptrdiff_t)rtv.view().size() + s.pattern().size() - 1
+            );
+            auto const first = rtv.begin();
+            auto const last = first + prefix_size;
+            auto const it = s(first, last).first;
+            return it == last ? -1 : it - first;
+        }
+
+        // Searches the segments of a rope or rope_view in order (or for
+        // Reverse, in reverse order) for a pattern of pattern_size_ chars.
+        // The pattern_size_ - 1 chars already seen next to the current
+        // segment are kept in carry_, so that matches that span segments
+        // are found as well.  offset_ is the offset of the beginning (or
+        // for Reverse, the end) of the current segment.
+        //
+        // search_(s) returns the offset of the first (or for Reverse, last)
+        // match within segment s, or -1 if there is none.
+        // search_(first, last) does the same for the chars in [first,
+        // last).
+        template <bool Reverse, typename Search>
+        struct carry_segment_finder
+        {
+            // A match within carry_ alone is not possible, since carry_ is
+            // shorter than the pattern.  So a match found here that starts
+            // in carry_ (or for Reverse, in [first, last)) spans segments.
+            template <typename Iter>
+            bool search_carry (Iter first, Iter last) const
+            {
+                std::ptrdiff_t const carry_size = carry_.size();
+                std::ptrdiff_t const n = (std::min)(last - first, pattern_size_ - 1);
+                if (Reverse)
+                    carry_.insert(carry_.begin(), last - n, last);
+                else
+                    carry_.append(first, first + n);
+                char const * const carry_first = carry_.data();
+                std::ptrdiff_t const match =
+                    search_(carry_first, carry_first + carry_.size());
+                if (Reverse)
+                    carry_.erase(0, n);
+                else
+                    carry_.resize(carry_size);
+                if (Reverse && 0 <= match) {
+                    result_ = offset_ - n + match;
+                    return true;
+                }
+                if (!Reverse && 0 <= match && match < carry_size) {
+                    result_ = offset_ - carry_size + match;
+                    return true;
+                }
+                return false;
+            }
+
+            template <typename Iter>
+            void update_carry (Iter first, Iter last) const
+            {
+                std::ptrdiff_t const keep = pattern_size_ - 1;
+                if (keep <= last - first) {
+                    if (Reverse)
+                        carry_.assign(first, first + keep);
+                    else
+                        carry_.assign(last - keep, last);
+                } else if (Reverse) {
+                    carry_.insert(carry_.begin(), first, last);
+                    if (keep < (std::ptrdiff_t)carry_.size())
+                        carry_.resize(keep);
+                } else {
+                    carry_.append(first, last);
+                    if (keep < (std::ptrdiff_t)carry_.size())
+                        carry_.erase(0, carry_.size() - keep);
+                }
+                if (Reverse)
+                    offset_ -= last - first;
+                else
+                    offset_ += last - first;
+            }
+
+            template <typename Segment>
+            bool operator() (Segment const & s) const
+            {
+                if (!carry_.empty() && search_carry(s.begin(), s.end()))
+                    return false;
+                std::ptrdiff_t const match = search_(s);
+                if (0 <= match) {
+                    result_ = (Reverse ? offset_ - (s.end() - s.begin()) : offset_) + match;
+                    return false;
+                }
+                update_carry(s.begin(), s.end());
+                return true;
+            }
+
+            Search search_;
+            std::ptrdiff_t pattern_size_;
+            std::string & carry_;
+            std::ptrdiff_t & offset_;
+            std::ptrdiff_t & result_;
+        };
+
+        // Searches the segments of a rope or rope_view in order (or for
+        // Reverse, in reverse order) with search, which finds a pattern of
+        // pattern_size chars as carry_segment_finder requires.
+        // \pre 0 < pattern_size
+        template <bool Reverse, typename Rope, typename Search>
+        std::ptrdiff_t carry_find_segments (
+            Rope const & r,
+            std::ptrdiff_t pattern_size,
+            Search const & search
+        ) {
+            std::string carry;
+            std::ptrdiff_t offset = Reverse ? r.size() : 0;
+            std::ptrdiff_t result = -1;
+            carry_segment_finder<Reverse, Search> const finder{
+                search, pattern_size, carry, offset, result
+            };
+            if (Reverse)
+                r.foreach_segment_reverse(finder);
+            else
+                r.foreach_segment(finder);
+            return result;
+        }
+
+        // The search for carry_segment_finder that uses a searcher.
+        struct searcher_segment_search
+        {
+            std::ptrdiff_t operator() (char const * first, char const * last) const
+            {
+                char const * const it = s_(first, last).first;
+                return it == last ? -1 : it - first;
+            }
+
+            std::ptrdiff_t operator() (text_view tv) const
+            { return (*this)(tv.begin(), tv.end()); }
+
+            std::ptrdiff_t operator() (repeated_text_view rtv) const
+            { return find_repeated(rtv, s_); }
+
+            template <typename Segment>
+            std::ptrdiff_t operator() (Segment const & s) const
+            {
+                auto const it = s_(s.begin(), s.end()).first;
+                return it == s.end() ? -1 : it - s.begin();
+            }
+
+            searcher const & s_;
+        };
+
+        template <typename Rope>
+        std::ptrdiff_t find_segments (Rope const & r, searcher const & s)
+        {
+            if (!s.pattern().size())
+                return 0;
+            return carry_find_segments<false>(
+                r, s.pattern().size(), searcher_segment_search{s}
+            );
+        }
+
+    }
+
+    /** Returns the offset of the first occurance of s.pattern() within
+        range r, or a value < 0 if it is not found in r.  An empty pattern
+        is always considered to match the beginning of r. */
+    inline std::ptrdiff_t find (text_view r, searcher const & s) noexcept
+    {
+        char const * const it = s(r.begin(), r.end()).first;
+        if (it == r.end())
+            return s.pattern().size() ? -1 : 0;
+        return it - r.begin();
+    }
+
+    /** Returns the offset of the first occurance of s.pattern() within
+        range r, or a value < 0 if it is not found in r.  An empty pattern
+        is always considered to match the beginning of r.
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept. */
+    template <typename CharRange>
+    auto find (CharRange const & r, searcher const & s) noexcept
+        -> detail::rng_alg_ret_t<std::ptrdiff_t, CharRange>
+    { return find(text_view(r), s); }
+
+    /** Returns the offset of the first occurance of s.pattern() within rtv,
+        or a value < 0 if it is not found in rtv.  An empty pattern is always
+        considered to match the beginning of rtv.  Only the first
+        repetition of rtv.view(), plus enough of the next to hold a match
+        that starts in the first, is searched. */
+    inline std::ptrdiff_t find (repeated_text_view rtv, searcher const & s)
+    { return detail::find_repeated(rtv, s); }
+
+    /** Returns the offset of the first occurance of s.pattern() within r,
+        or a value < 0 if it is not found in r.  An empty pattern is always
+        considered to match the beginning of r.  Each segment of r is
+        searched as a whole, as are matches that span segments. */
+    inline std::ptrdiff_t find (rope const & r, searcher const & s)
+    { return detail::find_segments(r, s); }
+
+    /** Returns the offset of the first occurance of s.pattern() within rv,
+        or a value < 0 if it is not found in rv.  An empty pattern is always
+        considered to match the beginning of rv.  Each segment of rv is
+        searched as a whole, as are matches that span segments. */
+    inline std::ptrdiff_t find (rope_view rv, searcher const & s)
+    { return detail::find_segments(rv, s); }
+
+} }
+
+#endif
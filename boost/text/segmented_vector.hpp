@@ -160,10 +160,7 @@ namespace boost { namespace text {
             assert(begin() <= at && at <= end());
 
             if (vec_insertion insertion = mutable_insertion_leaf(at, 1, would_allocate)) {
-                for (auto node : insertion.found_.path_) {
-                    auto from = detail::find_child(node, at - begin());
-                    detail::bump_keys(const_cast<detail::interior_node_t<T> *>(node), from, 1);
-                }
+                detail::bump_along_path_to_leaf(insertion.found_, at - begin(), 1);
                 insertion.vec_->insert(
                     insertion.vec_->begin() + insertion.found_.offset_,
                     std::move(t)
@@ -330,11 +327,7 @@ namespace boost { namespace text {
                 return *this;
 
             if (vec_insertion insertion = mutable_insertion_leaf(at, u.size(), allocation_note)) {
-                auto const u_size = u.size();
-                for (auto node : insertion.found_.path_) {
-                    auto from = detail::find_child(node, at - begin());
-                    detail::bump_keys(const_cast<detail::interior_node_t<T> *>(node), from, u_size);
-                }
+                detail::bump_along_path_to_leaf(insertion.found_, at - begin(), u.size());
                 insertion.vec_->insert(insertion.found_.offset_, u.begin(), u.end());
             } else {
                 ptr_ = detail::btree_insert(
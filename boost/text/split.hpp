@@ -0,0 +1,358 @@
+#ifndef BOOST_TEXT_SPLIT_HPP
+#define BOOST_TEXT_SPLIT_HPP
+
+#include <boost/text/searcher.hpp>
+
+#include <iterator>
+
+
+namespace boost { namespace text {
+
+    namespace detail {
+
+        // Finds the first occurance of a pattern in r at or after offset
+        // lo, using the vectorized find().
+        struct view_finder
+        {
+            explicit view_finder (text_view p) noexcept : p_ (p) {}
+
+            std::ptrdiff_t size () const noexcept
+            { return p_.size(); }
+
+            // \pre !p_.empty()
+            std::ptrdiff_t operator() (text_view r, std::ptrdiff_t lo) const noexcept
+            {
+                std::ptrdiff_t const n = find_impl(r.begin() + lo, r.end(), p_.begin(), p_.end());
+                return n < 0 ? -1 : lo + n;
+            }
+
+            text_view p_;
+        };
+
+        // Finds the first occurance of a pattern in r at or after offset
+        // lo, searching each segment of r as a whole.
+        struct rope_view_finder
+        {
+            explicit rope_view_finder (text_view p) noexcept : s_ (p) {}
+
+            std::ptrdiff_t size () const noexcept
+            { return s_.pattern().size(); }
+
+            // \pre !s_.pattern().empty()
+            std::ptrdiff_t operator() (rope_view r, std::ptrdiff_t lo) const
+            {
+                std::ptrdiff_t const n =
+                    find_segments(r(lo, r.size(), utf8::unchecked), s_);
+                return n < 0 ? -1 : lo + n;
+            }
+
+            searcher s_;
+        };
+
+        template <typename View>
+        struct view_finder_for
+        { using type = view_finder; };
+
+        template <>
+        struct view_finder_for<rope_view>
+        { using type = rope_view_finder; };
+
+        template <typename View>
+        using view_finder_t = typename view_finder_for<View>::type;
+
+        // The offsets passed to slice() are always the ends of the view, of
+        // matches of a pattern that is itself valid UTF-8, or of newlines,
+        // and so never split a code point.
+        inline text_view slice (text_view r, std::ptrdiff_t lo, std::ptrdiff_t hi) noexcept
+        { return text_view(r.begin() + lo, hi - lo, utf8::unchecked); }
+
+        inline rope_view slice (rope_view r, std::ptrdiff_t lo, std::ptrdiff_t hi) noexcept
+        { return r(lo, hi, utf8::unchecked); }
+
+        /** The iterator type of find_all_range, split_range, and
+            lines_range.  Each Range computes its elements one at a time, in
+            Range::next().  An iterator refers to its range, so the range
+            must outlive it. */
+        template <typename Range, typename View>
+        struct piece_iterator
+        {
+            using value_type = View;
+            using difference_type = std::ptrdiff_t;
+            using pointer = View const *;
+            using reference = View;
+            using iterator_category = std::forward_iterator_tag;
+
+            piece_iterator () noexcept :
+                range_ (nullptr),
+                lo_ (-1),
+                hi_ (-1),
+                next_ (-1)
+            {}
+
+            reference operator* () const noexcept
+            { return slice(range_->r_, lo_, hi_); }
+
+            piece_iterator & operator++ ()
+            {
+                range_->next(lo_, hi_, next_);
+                return *this;
+            }
+            piece_iterator operator++ (int)
+            {
+                piece_iterator retval = *this;
+                ++*this;
+                return retval;
+            }
+
+            // The elements of each range start at strictly increasing
+            // offsets, and the end iterator has lo_ == -1.
+            friend bool operator== (piece_iterator lhs, piece_iterator rhs) noexcept
+            { return lhs.lo_ == rhs.lo_; }
+            friend bool operator!= (piece_iterator lhs, piece_iterator rhs) noexcept
+            { return lhs.lo_ != rhs.lo_; }
+
+        private:
+            piece_iterator (Range const * range, std::ptrdiff_t next) :
+                range_ (range),
+                lo_ (-1),
+                hi_ (-1),
+                next_ (next)
+            { range_->next(lo_, hi_, next_); }
+
+            Range const * range_;
+            std::ptrdiff_t lo_;
+            std::ptrdiff_t hi_;
+            std::ptrdiff_t next_;
+
+            friend Range;
+        };
+
+    }
+
+    /** A lazy range of the non-overlapping occurances of a pattern in a
+        text_view or rope_view, each as a View.  Each occurance is found as
+        the range is iterated, and no memory is allocated.  The range refers
+        to the searched sequence and to the pattern, and so both must
+        outlive it; its iterators refer to the range. */
+    template <typename View>
+    struct find_all_range
+    {
+        using value_type = View;
+        using iterator = detail::piece_iterator<find_all_range, View>;
+        using const_iterator = iterator;
+
+        /** Constructs a range of the occurances of p in r.  An empty p has no
+            occurances. */
+        find_all_range (View r, text_view p) : r_ (r), p_ (p) {}
+
+        iterator begin () const
+        { return iterator(this, p_.size() ? 0 : -1); }
+        iterator end () const noexcept
+        { return iterator(); }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        void next (std::ptrdiff_t & lo, std::ptrdiff_t & hi, std::ptrdiff_t & next) const
+        {
+            lo = next < 0 ? -1 : p_(r_, next);
+            hi = lo + p_.size();
+            next = lo < 0 ? -1 : hi;
+        }
+
+        View r_;
+        detail::view_finder_t<View> p_;
+
+        friend iterator;
+#endif
+
+    };
+
+    /** A lazy range of the pieces of a text_view or rope_view between the
+        occurances of a delimiter, each as a View.  A sequence with n
+        occurances of the delimiter has n + 1 pieces, some of which may be
+        empty; an empty sequence has one empty piece.  Each piece is found as
+        the range is iterated, and no memory is allocated.  The range refers
+        to the split sequence and to the delimiter, and so both must outlive
+        it; its iterators refer to the range. */
+    template <typename View>
+    struct split_range
+    {
+        using value_type = View;
+        using iterator = detail::piece_iterator<split_range, View>;
+        using const_iterator = iterator;
+
+        /** Constructs a range of the pieces of r between the occurances of
+            delimiter.  An empty delimiter has no occurances, and so r is
+            the only piece. */
+        split_range (View r, text_view delimiter) : r_ (r), delimiter_ (delimiter) {}
+
+        iterator begin () const
+        { return iterator(this, 0); }
+        iterator end () const noexcept
+        { return iterator(); }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        void next (std::ptrdiff_t & lo, std::ptrdiff_t & hi, std::ptrdiff_t & next) const
+        {
+            lo = next;
+            if (next < 0)
+                return;
+            std::ptrdiff_t const match =
+                delimiter_.size() ? delimiter_(r_, next) : -1;
+            hi = match < 0 ? r_.size() : match;
+            next = match < 0 ? -1 : match + delimiter_.size();
+        }
+
+        View r_;
+        detail::view_finder_t<View> delimiter_;
+
+        friend iterator;
+#endif
+
+    };
+
+    /** A lazy range of the lines of a text_view or rope_view, each as a
+        View.  Lines end in "\n" or "\r\n", and the lines do not include
+        their endings.  A final line with no ending is a line too, but
+        nothing after a final line ending is; an empty sequence has no
+        lines.  Each line is found as the range is iterated, and no memory is
+        allocated.  The range refers to the sequence, and so it must outlive
+        the range; its iterators refer to the range. */
+    template <typename View>
+    struct lines_range
+    {
+        using value_type = View;
+        using iterator = detail::piece_iterator<lines_range, View>;
+        using const_iterator = iterator;
+
+        /** Constructs a range of the lines of r. */
+        explicit lines_range (View r) :
+            r_ (r),
+            newline_ (text_view("\n", 1, utf8::unchecked))
+        {}
+
+        iterator begin () const
+        { return iterator(this, 0); }
+        iterator end () const noexcept
+        { return iterator(); }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        void next (std::ptrdiff_t & lo, std::ptrdiff_t & hi, std::ptrdiff_t & next) const
+        {
+            if (next < 0 || next == r_.size()) {
+                lo = -1;
+                return;
+            }
+            std::ptrdiff_t const newline = newline_(r_, next);
+            lo = next;
+            if (newline < 0) {
+                hi = r_.size();
+                next = -1;
+            } else {
+                hi = lo < newline && r_[newline - 1] == '\r' ? newline - 1 : newline;
+                next = newline + 1;
+            }
+        }
+
+        View r_;
+        detail::view_finder_t<View> newline_;
+
+        friend iterator;
+#endif
+
+    };
+
+    /** Returns a lazy range of the non-overlapping occurances of pattern p
+        within range r, each as a text_view.  An empty p has no occurances.
+        The occurances are found with the same vectorized search as
+        find(). */
+    inline find_all_range<text_view> find_all (text_view r, text_view p)
+    { return find_all_range<text_view>(r, p); }
+
+    /** Returns a lazy range of the non-overlapping occurances of pattern p
+        within range r, each as a text_view.  An empty p has no occurances.
+        The occurances are found with the same vectorized search as find().
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept. */
+    template <typename CharRange>
+    auto find_all (CharRange const & r, text_view p)
+        -> detail::rng_alg_ret_t<find_all_range<text_view>, CharRange>
+    { return find_all(text_view(r), p); }
+
+    /** Returns a lazy range of the non-overlapping occurances of pattern p
+        within r, each as a rope_view.  An empty p has no occurances.  Each
+        segment of r is searched as a whole, as are occurances that span
+        segments. */
+    inline find_all_range<rope_view> find_all (rope const & r, text_view p)
+    { return find_all_range<rope_view>(rope_view(r), p); }
+
+    /** Returns a lazy range of the non-overlapping occurances of pattern p
+        within rv, each as a rope_view.  An empty p has no occurances.  Each
+        segment of rv is searched as a whole, as are occurances that span
+        segments. */
+    inline find_all_range<rope_view> find_all (rope_view rv, text_view p)
+    { return find_all_range<rope_view>(rv, p); }
+
+    /** Returns a lazy range of the pieces of range r between the occurances
+        of delimiter, each as a text_view.  See split_range for which pieces
+        there are. */
+    inline split_range<text_view> split (text_view r, text_view delimiter)
+    { return split_range<text_view>(r, delimiter); }
+
+    /** Returns a lazy range of the pieces of range r between the occurances
+        of delimiter, each as a text_view.  See split_range for which pieces
+        there are.
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept. */
+    template <typename CharRange>
+    auto split (CharRange const & r, text_view delimiter)
+        -> detail::rng_alg_ret_t<split_range<text_view>, CharRange>
+    { return split(text_view(r), delimiter); }
+
+    /** Returns a lazy range of the pieces of r between the occurances of
+        delimiter, each as a rope_view.  See split_range for which pieces
+        there are. */
+    inline split_range<rope_view> split (rope const & r, text_view delimiter)
+    { return split_range<rope_view>(rope_view(r), delimiter); }
+
+    /** Returns a lazy range of the pieces of rv between the occurances of
+        delimiter, each as a rope_view.  See split_range for which pieces
+        there are. */
+    inline split_range<rope_view> split (rope_view rv, text_view delimiter)
+    { return split_range<rope_view>(rv, delimiter); }
+
+    /** Returns a lazy range of the lines of range r, each as a text_view.
+        See lines_range for which lines there are. */
+    inline lines_range<text_view> lines (text_view r)
+    { return lines_range<text_view>(r); }
+
+    /** Returns a lazy range of the lines of range r, each as a text_view.
+        See lines_range for which lines there are.
+
+        This function only participates in overload resolution if CharRange
+        models the Char_range concept. */
+    template <typename CharRange>
+    auto lines (CharRange const & r)
+        -> detail::rng_alg_ret_t<lines_range<text_view>, CharRange>
+    { return lines(text_view(r)); }
+
+    /** Returns a lazy range of the lines of r, each as a rope_view.  See
+        lines_range for which lines there are. */
+    inline lines_range<rope_view> lines (rope const & r)
+    { return lines_range<rope_view>(rope_view(r)); }
+
+    /** Returns a lazy range of the lines of rv, each as a rope_view.  See
+        lines_range for which lines there are. */
+    inline lines_range<rope_view> lines (rope_view rv)
+    { return lines_range<rope_view>(rv); }
+
+} }
+
+#endif
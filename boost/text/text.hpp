@@ -1,17 +1,20 @@
 #ifndef BOOST_TEXT_TEXT_HPP
 #define BOOST_TEXT_TEXT_HPP
 
-#include <boost/text/utf8.hpp>
+#include <boost/text/memory_resource.hpp>
+#include <boost/text/transcode.hpp>
 
 #include <boost/text/detail/algorithm.hpp>
 #include <boost/text/detail/iterator.hpp>
 #include <boost/text/detail/utility.hpp>
 
 #include <algorithm>
-#include <list>
+#include <iterator>
+#include <limits>
 #include <memory>
 
 #include <cassert>
+#include <cstring>
 
 
 namespace boost { namespace text {
@@ -20,32 +23,106 @@ namespace boost { namespace text {
     struct repeated_text_view;
     struct rope;
     struct rope_view;
+    struct text_builder;
 
     // TODO: text should use the more efficient versions of the
     // constexpr-friendly-but-slower operations that text_view does.
 
-    // TODO: text needs SBO.
+    namespace detail {
+
+        // Copies [first, last) to out, and returns the end of the copy.
+        // Iterators over segmented sequences, like those of rope, overload
+        // this to copy a segment at a time; callers find those overloads by
+        // ADL, after a using-declaration of this one.
+        template <typename Iter>
+        char * copy_chars (Iter first, Iter last, char * out)
+        { return std::copy(first, last, out); }
+
+        // The number of bytes of storage in a text itself, null terminator
+        // included.
+        constexpr int text_local_size = 16;
+
+        // The heap storage of a text is preceded by the memory_resource it
+        // came from.
+        constexpr int text_heap_prefix_size = sizeof(memory_resource *);
+
+        inline memory_resource * text_heap_resource (char const * p) noexcept
+        {
+            memory_resource * retval;
+            std::memcpy(&retval, p - text_heap_prefix_size, sizeof(retval));
+            return retval;
+        }
+
+        inline void delete_text_heap (char * p, std::ptrdiff_t cap) noexcept
+        {
+            text_heap_resource(p)->deallocate(
+                p - text_heap_prefix_size,
+                text_heap_prefix_size + cap,
+                alignof(memory_resource *)
+            );
+        }
+
+        struct text_heap_deleter
+        {
+            void operator() (char * p) const noexcept
+            { delete_text_heap(p, cap_); }
+
+            std::ptrdiff_t cap_;
+        };
+
+        using text_heap_ptr = std::unique_ptr<char [], text_heap_deleter>;
+
+        // Returns cap bytes of heap storage from resource.
+        inline text_heap_ptr new_text_heap (std::ptrdiff_t cap, memory_resource * resource)
+        {
+            char * const p = static_cast<char *>(resource->allocate(
+                text_heap_prefix_size + cap,
+                alignof(memory_resource *)
+            ));
+            std::memcpy(p, &resource, sizeof(resource));
+            return text_heap_ptr(p + text_heap_prefix_size, text_heap_deleter{cap});
+        }
+
+    }
 
     /** A mutable contiguous null-terminated sequence of char.  The sequence
         is assumed to be UTF-8 encoded, though it is possible to construct a
-        sequence which is not.  Strongly exception safe. */
+        sequence which is not.  Strongly exception safe.
+
+        Sequences of up to 15 chars are stored within the text object itself,
+        and so need no heap allocation.  Longer ones are stored on the heap,
+        allocated from the memory_resource that is the default when the text
+        first needs heap storage, and that resource is used to grow it from
+        then on; see get_default_resource(). */
     struct text
     {
         using iterator = char *;
         using const_iterator = char const *;
         using reverse_iterator = detail::reverse_char_iterator;
         using const_reverse_iterator = detail::const_reverse_char_iterator;
+        using size_type = std::ptrdiff_t;
 
         /** Default ctor.
 
-            \post size() == 0 && capacity() == 0; begin(), end() delimit a
+            \post size() == 0 && capacity() == 15; begin(), end() delimit a
             valid, null-terminated empty string */
-        text () noexcept : data_ (), size_ (0), cap_ (0) {}
+        text () noexcept :
+            storage_ (),
+            size_ (0)
+        {}
 
         text (text const & t);
 
-        text (text && rhs) noexcept : data_ (), size_ (0), cap_ (0)
-        { swap(rhs); }
+        text (text && rhs) noexcept :
+            storage_ (rhs.storage_),
+            size_ (rhs.size_)
+        { rhs.reset(); }
+
+        ~text ()
+        {
+            if (heap())
+                detail::delete_text_heap(storage_.heap_.ptr_, storage_.heap_.cap_);
+        }
 
         /** Constructs a text from a text_view. */
         explicit text (text_view tv);
@@ -81,14 +158,14 @@ namespace boost { namespace text {
         explicit text (
             CharRange const & r,
             detail::rng_alg_ret_t<int *, CharRange> = 0
-        ) : data_ (), size_ (0), cap_ (0)
+        ) : storage_ (), size_ (0)
         { insert(0, r); }
 
         template <typename Iter>
         text (
             Iter first, Iter last,
             detail::char_iter_ret_t<void *, Iter> = 0
-        ) : data_ (), size_ (0), cap_ (0)
+        ) : storage_ (), size_ (0)
         { insert(0, first, last); }
 
 #endif
@@ -127,31 +204,11 @@ namespace boost { namespace text {
         /** Assignment from a repeated_text_view. */
         text & operator= (repeated_text_view tv);
 
-        iterator begin () noexcept
-        {
-            if (!data_)
-                return reinterpret_cast<char *>(&cap_);
-            return data_.get();
-        }
-        iterator end () noexcept
-        {
-            if (!data_)
-                return reinterpret_cast<char *>(&cap_);
-            return data_.get() + size_;
-        }
+        iterator begin () noexcept { return ptr(); }
+        iterator end () noexcept { return ptr() + size(); }
 
-        const_iterator begin () const noexcept
-        {
-            if (!data_)
-                return reinterpret_cast<char const *>(&cap_);
-            return data_.get();
-        }
-        const_iterator end () const noexcept
-        {
-            if (!data_)
-                return reinterpret_cast<char const *>(&cap_);
-            return data_.get() + size_;
-        }
+        const_iterator begin () const noexcept { return ptr(); }
+        const_iterator end () const noexcept { return ptr() + size(); }
 
         const_iterator cbegin () const noexcept { return begin(); }
         const_iterator cend () const noexcept { return end(); }
@@ -169,29 +226,28 @@ namespace boost { namespace text {
 
             An empty text is still a valid null-terminated empty string. */
         bool empty () const noexcept
-        { return size_ == 0; }
+        { return size() == 0; }
 
         /** Returns the number of characters controlled by *this, not
             including the null terminator. */
-        int size () const noexcept
-        { return size_; }
+        size_type size () const noexcept
+        { return size_ & ~heap_flag; }
 
-        /** Returns the number of bytes of storage currently in use by *this.
-
-            Even if the capcity is 0, the text is still a valid
-            null-terminated empty string. */
-        int capacity () const noexcept
-        { return cap_ - 1; }
+        /** Returns the number of chars *this can hold without allocating,
+            not including the null terminator.  This is never less than 15,
+            the number of chars that fit within the text object itself. */
+        size_type capacity () const noexcept
+        { return cap() - 1; }
 
         /** Returns the i-th char of *this (not a reference).
 
             \pre 0 <= i && i < size() */
-        char operator[] (int i) const noexcept
+        char operator[] (size_type i) const noexcept
         {
 #ifndef BOOST_TEXT_TESTING
-            assert(0 <= i && i < size_);
+            assert(0 <= i && i < size());
 #endif
-            return data_[i];
+            return ptr()[i];
         }
 
         /** Returns a substring of *this, taken from the range of chars at
@@ -207,7 +263,7 @@ namespace boost { namespace text {
             \pre lo <= hi
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        text_view operator() (int lo, int hi) const;
+        text_view operator() (size_type lo, size_type hi) const;
 
         /** Returns a substring of *this, taken from the first cut chars when
             cut => 0, or the last -cut chars when cut < 0.
@@ -215,11 +271,11 @@ namespace boost { namespace text {
             \pre 0 <= cut && cut <= size() || 0 <= -cut && -cut <= size()
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        text_view operator() (int cut) const;
+        text_view operator() (size_type cut) const;
 
         /** Returns the maximum size a text can have. */
-        int max_size () const noexcept
-        { return INT_MAX; }
+        size_type max_size () const noexcept
+        { return PTRDIFF_MAX - 1; }
 
         /** Lexicographical compare.  Returns a value < 0 when *this is
             lexicographically less than rhs, 0 if *this == rhs, and a value >
@@ -233,27 +289,26 @@ namespace boost { namespace text {
         bool operator> (text_view rhs) const noexcept;
         bool operator>= (text_view rhs) const noexcept;
 
-        /** Clear.
+        /** Clear.  The capacity is unchanged.
 
-            \post size() == 0 && capacity() == 0; begin(), end() delimit a
-            valid, null-terminated empty string */
+            \post size() == 0; begin(), end() delimit a valid,
+            null-terminated empty string */
         void clear () noexcept
         {
-            size_ = 0;
-            if (data_)
-                data_[0] = '\0';
+            set_size(0);
+            ptr()[0] = '\0';
         }
 
         /** Returns a reference to the i-th char of *this.
 
             No check is made (or could be made) to check that writes through
             the returned reference do not break UTF-8 encoding. */
-        char & operator[] (int i) noexcept
+        char & operator[] (size_type i) noexcept
         {
 #ifndef BOOST_TEXT_TESTING
-            assert(0 <= 0 && i < size_);
+            assert(0 <= 0 && i < size());
 #endif
-            return data_[i];
+            return ptr()[i];
         }
 
         /** Inserts the sequence of char from tv into *this starting at offset
@@ -261,14 +316,14 @@ namespace boost { namespace text {
 
             \throw std::invalid_argument if insertion at offset at would break
             UTF-8 encoding. */
-        text & insert (int at, text_view tv);
+        text & insert (size_type at, text_view tv);
 
         /** Inserts the sequence of char from rtv into *this starting at
             offset at.
 
             \throw std::invalid_argument if insertion at offset at would break
             UTF-8 encoding. */
-        text & insert (int at, repeated_text_view rtv);
+        text & insert (size_type at, repeated_text_view rtv);
 
 #ifdef BOOST_TEXT_DOXYGEN
 
@@ -281,7 +336,7 @@ namespace boost { namespace text {
             UTF-8 encoding, or if the ends of the range are not valid
             UTF-8. */
         template <typename CharRange>
-        text & insert (int at, CharRange const & r);
+        text & insert (size_type at, CharRange const & r);
 
         /** Inserts the char sequence [first, last) into *this starting at
             offset at.
@@ -295,7 +350,7 @@ namespace boost { namespace text {
             \throw std::invalid_argument if insertion at offset at would break
             UTF-8 encoding. */
         template <typename Iter>
-        text & insert (int at, Iter first, Iter last);
+        text & insert (size_type at, Iter first, Iter last);
 
         /** Inserts the char sequence [first, last) into *this starting at
             position at.
@@ -313,14 +368,14 @@ namespace boost { namespace text {
 #else
 
         template <typename CharRange>
-        auto insert (int at, CharRange const & r)
+        auto insert (size_type at, CharRange const & r)
             -> detail::rng_alg_ret_t<text &, CharRange>;
 
         template <typename Iter>
-        auto insert (int at, Iter first, Iter last)
+        auto insert (size_type at, Iter first, Iter last)
             -> detail::char_iter_ret_t<text &, Iter>
         {
-            assert(0 <= at && at <= size_);
+            assert(0 <= at && at <= size());
 
             if (first == last)
                 return *this;
@@ -331,9 +386,14 @@ namespace boost { namespace text {
             return insert_iter_impl(at, first, last);
         }
 
-        template <typename Iter>
-        auto insert (iterator at, Iter first, Iter last)
-            -> detail::char_iter_ret_t<text &, Iter>
+        // A template on the type of at, so that a literal 0 offset does not
+        // make insert(size_type, Iter, Iter) ambiguous with this overload.
+        template <typename Iter, typename CharIter>
+        auto insert (CharIter at, Iter first, Iter last)
+            -> detail::char_iter_ret_t<
+                typename std::enable_if<std::is_same<CharIter, iterator>::value, text &>::type,
+                Iter
+            >
         {
             assert(begin() <= at && at <= end());
 
@@ -364,7 +424,7 @@ namespace boost { namespace text {
 
             std::copy(last, end(), first);
             size_ -= last - first;
-            data_[size_] = '\0';
+            ptr()[size()] = '\0';
 
             return *this;
         }
@@ -437,8 +497,6 @@ namespace boost { namespace text {
         auto replace (text_view old_substr, Iter first, Iter last)
             -> detail::char_iter_ret_t<text &, Iter>;
 
-        // TODO: Perf test replace(Iter) against insert(Iter), and replace the
-        // insert(Iter) implementation if that is warranted.
         template <typename Iter>
         auto replace (iterator old_first, iterator old_last, Iter new_first, Iter new_last)
             -> detail::char_iter_ret_t<text &, Iter>
@@ -446,31 +504,11 @@ namespace boost { namespace text {
             assert(begin() <= old_first && old_last <= end());
             assert(old_first <= old_last);
 
-            char stack_buf[1024];
-            std::list<text> heap_bufs;
-            int const chars_pushed =
-                read_iters(stack_buf, sizeof(stack_buf), heap_bufs, new_first, new_last);
-            int const stack_buf_bytes = (std::min)(chars_pushed, (int)sizeof(stack_buf));
-
-            int const delta = chars_pushed - (old_last - old_first);
-            int const available = cap_ - 1 - size_;
-            if (available < delta) {
-                std::unique_ptr<char []> new_data = get_new_data(delta - available);
-                char * buf = new_data.get();
-                buf = std::copy(begin(), old_first, buf);
-                buf = copy_bufs(stack_buf, stack_buf_bytes, heap_bufs, buf);
-                std::copy(old_last, end(), buf);
-                new_data.swap(data_);
-            } else {
-                if (0 < delta)
-                    std::copy_backward(old_last, end(), end() + delta);
-                else if (delta < 0)
-                    std::copy(old_last, end(), old_last + delta);
-                copy_bufs(stack_buf, stack_buf_bytes, heap_bufs, old_first);
-            }
-
-            size_ += delta;
-            data_[size_] = '\0';
+            replace_iters(
+                old_first - begin(), old_last - begin(), new_first, new_last,
+                typename std::iterator_traits<Iter>::iterator_category{}
+            );
+            ptr()[size()] = '\0';
 
             return *this;
         }
@@ -484,72 +522,80 @@ namespace boost { namespace text {
             \throw std::invalid_argument if truncating to new_size would break
             UTF-8 encoding.
             \post size() == new_size */
-        void resize (int new_size, char c)
+        void resize (size_type new_size, char c)
         {
             assert(0 <= new_size);
 
             if (c & 0x80)
                 throw std::invalid_argument("Given character is not a valid UTF-8 1-character code point");
 
-            int const prev_size = size_;
-            int const delta = new_size - prev_size;
+            size_type const prev_size = size();
+            size_type const delta = new_size - prev_size;
             if (!delta)
                 return;
 
-            int const available = cap_ - 1 - size_;
+            size_type const available = cap() - 1 - size();
             if (available < delta) {
-                std::unique_ptr<char []> new_data = get_new_data(delta - available);
+                detail::text_heap_ptr new_data = get_new_data(delta - available);
                 std::copy(begin(), begin() + prev_size, new_data.get());
-                new_data.swap(data_);
+                set_data(new_data);
             } else if (delta < 0 &&
                        !utf8::ends_encoded(cbegin(), cbegin() + new_size)) {
                 throw std::invalid_argument("Resizing to the given size breaks UTF-8 encoding.");
             }
 
-            size_ = new_size;
+            set_size(new_size);
 
             if (0 < delta)
                 std::fill(begin() + prev_size, end(), c);
 
-            data_[size_] = '\0';
+            ptr()[size()] = '\0';
         }
 
         /** Reserves storage enough for a string of at least new_size
             bytes.
 
             \post capacity() >= new_size + 1 */
-        void reserve (int new_size)
+        void reserve (size_type new_size)
         {
             assert(0 <= new_size);
-            int const new_cap = new_size + 1;
-            if (new_cap <= cap_)
+            size_type const new_cap = new_size + 1;
+            if (new_cap <= cap())
                 return;
-            std::unique_ptr<char []> new_data(new char[new_cap]);
+            detail::text_heap_ptr new_data = detail::new_text_heap(new_cap, resource());
             *std::copy(cbegin(), cend(), new_data.get()) = '\0';
-            data_.swap(new_data);
-            cap_ = new_cap;
+            set_data(new_data);
         }
 
         /** Reduces storage used by *this to just the amount necessary to
-            contain size() chars.
+            contain size() chars.  A text of up to 15 chars moves them back
+            within the text object itself, and frees its heap storage.
 
-            \post capacity() == 0 || capacity() == size() + 1 */
+            \post capacity() == 15 || capacity() == size() */
         void shrink_to_fit ()
         {
-            if (cap_ == 0 || cap_ == size_ + 1)
+            if (!heap() || cap() == size() + 1)
                 return;
-            std::unique_ptr<char []> new_data(new char[size_ + 1]);
+            if (size() < detail::text_local_size) {
+                detail::text_heap_ptr const heap_data(
+                    storage_.heap_.ptr_,
+                    detail::text_heap_deleter{storage_.heap_.cap_});
+                std::copy(heap_data.get(), heap_data.get() + size() + 1, storage_.local_);
+                size_ &= ~heap_flag;
+                return;
+            }
+            detail::text_heap_ptr new_data = detail::new_text_heap(size() + 1, resource());
             *std::copy(cbegin(), cend(), new_data.get()) = '\0';
-            data_.swap(new_data);
-            cap_ = size_ + 1;
+            set_data(new_data);
         }
 
-        /** Swaps *this with rhs. */
+        /** Swaps *this with rhs.  As with a move, iterators into a text
+            whose chars are stored within the text object itself are
+            invalidated. */
         void swap (text & rhs) noexcept
         {
-            data_.swap(rhs.data_);
+            std::swap(storage_, rhs.storage_);
             std::swap(size_, rhs.size_);
-            std::swap(cap_, rhs.cap_);
         }
 
         /** Appends c_str to *this. */
@@ -587,136 +633,312 @@ namespace boost { namespace text {
 
 #endif
 
+        /** Replaces each invalid UTF-8 sequence in *this with the
+            replacement character, as utf8::repair_encoding() does.  When
+            *this is already valid UTF-8, it is left unchanged and no
+            allocation is performed.
+
+            \post utf8::encoded(begin(), end()) */
+        text & repair_encoding ();
+
         /** Stream inserter; performs unformatted output. */
         friend std::ostream & operator<< (std::ostream & os, text const & t)
         { return os.write(t.begin(), t.size()); }
 
 #ifndef BOOST_TEXT_DOXYGEN
 
+        friend text repair_encoding (text_view tv);
+        friend struct text_builder;
+
     private:
         bool self_reference (text_view tv) const;
 
-        int grow_cap (int min_new_cap) const
+        // Appends [first, last) without checking its encoding.  Unlike
+        // insert(), this keeps a trailing null.
+        void append_unchecked (char const * first, char const * last)
+        {
+            size_type const delta = last - first;
+            size_type const available = cap() - 1 - size();
+            if (available < delta) {
+                detail::text_heap_ptr new_data = get_new_data(delta - available);
+                std::copy(cbegin(), cend(), new_data.get());
+                set_data(new_data);
+            }
+            std::copy(first, last, ptr() + size());
+            size_ += delta;
+            ptr()[size()] = '\0';
+        }
+
+        void append_repaired (char const * first, char const * last)
+        {
+            utf8::detail::foreach_repaired_span(first, last, [this](char const * f, char const * l) {
+                append_unchecked(f, l);
+            });
+        }
+
+        bool heap () const noexcept
+        { return (size_ & heap_flag) != 0; }
+
+        // The bytes of storage in use, null terminator included.
+        size_type cap () const noexcept
+        { return heap() ? storage_.heap_.cap_ : detail::text_local_size; }
+
+        void set_size (size_type new_size) noexcept
+        { size_ = (size_ & heap_flag) | new_size; }
+
+        char * ptr () noexcept
+        { return heap() ? storage_.heap_.ptr_ : storage_.local_; }
+        char const * ptr () const noexcept
+        { return heap() ? storage_.heap_.ptr_ : storage_.local_; }
+
+        // Leaves *this empty, without freeing its storage.
+        void reset () noexcept
+        {
+            storage_.local_[0] = '\0';
+            size_ = 0;
+        }
+
+        // The resource heap storage comes from: that of the current heap
+        // storage, if any, so that a text stays with the resource it was
+        // first allocated from.
+        memory_resource * resource () const noexcept
+        {
+            return heap() ?
+                detail::text_heap_resource(storage_.heap_.ptr_) :
+                get_default_resource();
+        }
+
+        // Frees the current storage, if it is on the heap, and takes
+        // ownership of new_data.
+        void set_data (detail::text_heap_ptr & new_data) noexcept
+        {
+            size_type const new_cap = new_data.get_deleter().cap_;
+            assert(detail::text_local_size < new_cap);
+            if (heap())
+                detail::delete_text_heap(storage_.heap_.ptr_, storage_.heap_.cap_);
+            storage_.heap_.ptr_ = new_data.release();
+            storage_.heap_.cap_ = new_cap;
+            size_ |= heap_flag;
+        }
+
+        size_type grow_cap (size_type min_new_cap) const
         {
             assert(0 < min_new_cap);
-            int retval = (std::max)(8, cap_);
+            size_type retval = cap();
             while (retval < min_new_cap) {
                 retval = retval / 2 * 3;
             }
-            // Leave very short strings very short (8 bytes -- even though
-            // this is not portably achievable), but have the rest end on a
-            // 16-byte bundary.
-            if (8 < retval) {
-                int const rem = (retval + 16) % 16;
-                retval += 16 - rem;
-            }
+            // Have heap storage end on a 16-byte bundary.
+            size_type const rem = (retval + 16) % 16;
+            retval += 16 - rem;
             return retval;
         }
 
-        std::unique_ptr<char []> get_new_data (int resize_amount)
+        // Returns new heap storage, to be passed to set_data(), with room
+        // for resize_amount more bytes than the current storage.  New
+        // storage is always on the heap, even when resize_amount <= 0.
+        detail::text_heap_ptr get_new_data (size_type resize_amount) const
         {
-            int const new_cap =
-                0 < resize_amount ? grow_cap(cap_ + resize_amount) : cap_;
-            std::unique_ptr<char []> retval(new char [new_cap]);
-            cap_ = new_cap;
-            return retval;
+            size_type const new_cap = 0 < resize_amount || !heap() ?
+                grow_cap(cap() + (std::max)(resize_amount, size_type(1))) : cap();
+            return detail::new_text_heap(new_cap, resource());
         }
 
-        void push_char (char c, std::unique_ptr<char []> & initial_data)
+        template <typename Iter>
+        auto insert_iter_impl (size_type at, Iter first, Iter last)
+            -> detail::char_iter_ret_t<text &, Iter>
         {
-            int const available = cap_ - 1 - size_;
-            if (available < 1) {
-                std::unique_ptr<char []> new_data = get_new_data(1 - available);
-                std::copy(cbegin(), cend(), new_data.get());
-                if (!initial_data) {
-                    initial_data = std::move(data_);
-                    data_ = std::move(new_data);
-                } else {
-                    new_data.swap(data_);
+            insert_iters(
+                at, first, last,
+                typename std::iterator_traits<Iter>::iterator_category{}
+            );
+            ptr()[size()] = '\0';
+            return *this;
+        }
+
+        // Inserts [first, last) at offset at, without a null terminator.  If
+        // an exception is thrown, *this is left as it was.
+        template <typename Iter>
+        void insert_iters (size_type at, Iter first, Iter last, std::random_access_iterator_tag)
+        {
+            using detail::copy_chars;
+
+            size_type const delta = last - first;
+            size_type const available = cap() - 1 - size();
+            if (late_self_reference(at, first, last) ||
+                available < delta) {
+                // [first, last) is read before the old storage is freed, so
+                // it may refer to *this.
+                detail::text_heap_ptr new_data = get_new_data(delta - available);
+                char * buf = std::copy(cbegin(), cbegin() + at, new_data.get());
+                buf = copy_chars(first, last, buf);
+                std::copy(cbegin() + at, cend(), buf);
+                set_data(new_data);
+            } else {
+                std::copy_backward(cbegin() + at, cend(), end() + delta);
+                try {
+                    copy_chars(first, last, begin() + at);
+                } catch (...) {
+                    std::copy(cbegin() + at + delta, cend() + delta, begin() + at);
+                    ptr()[size()] = '\0';
+                    throw;
                 }
             }
-            data_[size_] = c;
-            ++size_;
+            size_ += delta;
         }
 
+        // The length of [first, last) is not known in advance.  An append
+        // writes the chars directly into the spare capacity, which doubles
+        // whenever it runs out; any other insertion reads them into a
+        // scratch text first, so that the chars after at move only once.
         template <typename Iter>
-        auto insert_iter_impl (int at, Iter first, Iter last)
-            -> detail::char_iter_ret_t<text &, Iter>
+        void insert_iters (size_type at, Iter first, Iter last, std::input_iterator_tag)
         {
-            std::unique_ptr<char []> initial_data;
-            int const initial_size = size_;
-            int const initial_cap = cap_;
+            if (at != size()) {
+                text scratch;
+                scratch.insert_iters(0, first, last, std::input_iterator_tag{});
+                insert_iters(
+                    at, scratch.cbegin(), scratch.cend(),
+                    std::random_access_iterator_tag{}
+                );
+                return;
+            }
+
+            // Reallocation copies the initial chars, so they are intact
+            // whenever an exception is thrown.  [first, last) may read the
+            // initial chars, so their storage outlives the loop: the
+            // initial heap storage is freed only afterward, and local
+            // storage, which the heap pointer would overwrite, spills the
+            // rest of the range into a scratch text instead.
+            size_type const initial_size = size();
+            detail::text_heap_ptr initial_data;
             try {
                 while (first != last) {
-                    push_char(*first, initial_data);
-                    ++first;
+                    if (size() == cap() - 1) {
+                        if (!heap()) {
+                            text scratch;
+                            scratch.insert_iters(0, first, last, std::input_iterator_tag{});
+                            insert_iters(
+                                size(), scratch.cbegin(), scratch.cend(),
+                                std::random_access_iterator_tag{}
+                            );
+                            return;
+                        }
+                        detail::text_heap_ptr new_data = get_new_data(cap());
+                        std::copy(cbegin(), cend(), new_data.get());
+                        if (!initial_data) {
+                            initial_data = detail::text_heap_ptr(
+                                storage_.heap_.ptr_,
+                                detail::text_heap_deleter{storage_.heap_.cap_}
+                            );
+                            // Keeps set_data() from freeing initial_data.
+                            size_ &= ~heap_flag;
+                        }
+                        set_data(new_data);
+                    }
+                    char * it = ptr() + size();
+                    char * const storage_last = ptr() + cap() - 1;
+                    while (first != last && it != storage_last) {
+                        *it = *first;
+                        ++it;
+                        ++first;
+                    }
+                    set_size(it - ptr());
                 }
-            } catch (std::bad_alloc const &) {
-                data_.swap(initial_data);
-                size_ = initial_size;
-                cap_ = initial_cap;
+            } catch (...) {
+                set_size(initial_size);
+                ptr()[size()] = '\0';
                 throw;
             }
+        }
 
-            std::rotate(begin() + at, begin() + initial_size, end());
-            data_[size_] = '\0';
+        // Replaces the chars in [lo, hi) with [first, last), without a null
+        // terminator.  If an exception is thrown, *this is left as it was.
+        template <typename Iter>
+        void replace_iters (size_type lo, size_type hi, Iter first, Iter last, std::random_access_iterator_tag)
+        {
+            using detail::copy_chars;
 
-            return *this;
+            size_type const delta = (last - first) - (hi - lo);
+            size_type const available = cap() - 1 - size();
+            if (available < delta) {
+                detail::text_heap_ptr new_data = get_new_data(delta - available);
+                char * buf = std::copy(cbegin(), cbegin() + lo, new_data.get());
+                buf = copy_chars(first, last, buf);
+                std::copy(cbegin() + hi, cend(), buf);
+                set_data(new_data);
+                size_ += delta;
+            } else {
+                // Inserting after the old chars before erasing them keeps a
+                // [first, last) that refers to them valid.
+                insert_iters(hi, first, last, std::random_access_iterator_tag{});
+                std::copy(cbegin() + hi, cend(), begin() + lo);
+                size_ -= hi - lo;
+            }
         }
 
         template <typename Iter>
-        struct buf_ptr_iterator
+        void replace_iters (size_type lo, size_type hi, Iter first, Iter last, std::input_iterator_tag)
         {
-            char * buf_;
-            Iter it_;
-        };
+            text scratch;
+            scratch.insert_iters(0, first, last, std::input_iterator_tag{});
+            replace_iters(
+                lo, hi, scratch.cbegin(), scratch.cend(),
+                std::random_access_iterator_tag{}
+            );
+        }
 
+        // Only pointers and reverse iterators can refer to the chars of
+        // *this; this is true if [first, last) does, and includes chars
+        // that an insertion at offset at would move.
         template <typename Iter>
-        buf_ptr_iterator<Iter> fill_buf (char * buf, int size, Iter first, Iter last)
+        bool late_self_reference (size_type at, Iter first, Iter last) const noexcept
+        { return late_self_reference(at, first, last, std::is_pointer<Iter>{}); }
+
+        bool late_self_reference (size_type at, reverse_iterator first, reverse_iterator last) const noexcept
         {
-            char * const buf_end = buf + size;
-            while (first != last && buf != buf_end) {
-                *buf = *first;
-                ++buf;
-                ++first;
-            }
-            return {buf, first};
+            return late_self_reference(
+                at, const_reverse_iterator(first), const_reverse_iterator(last)
+            );
         }
 
-        char * copy_bufs (char * buf, int size, std::list<text> const & bufs, char * it)
+        bool late_self_reference (size_type at, const_reverse_iterator first, const_reverse_iterator last) const noexcept
+        { return late_self_reference(at, last.base(), first.base(), std::true_type{}); }
+
+        template <typename Iter>
+        bool late_self_reference (size_type, Iter, Iter, std::false_type) const noexcept
+        { return false; }
+
+        template <typename Iter>
+        bool late_self_reference (size_type at, Iter first, Iter last, std::true_type) const noexcept
         {
-            it = std::copy_n(buf, size, it);
-            for (text const & t : bufs) {
-                it = std::copy_n(t.data_.get(), t.size_, it);
-            }
-            return it;
+            using less_t = std::less<char const *>;
+            less_t less;
+            return !less(first, cbegin()) && !less(cend(), last) &&
+                at < last - cbegin();
         }
 
-        template <typename Iter>
-        int read_iters (char * buf, int size, std::list<text> & bufs, Iter first, Iter last)
+        // Chars are stored within the text object itself when they fit,
+        // null terminator included, and on the heap otherwise.  The local
+        // chars overlap the heap pointer and capacity, which only mean
+        // anything while heap_flag is set in size_; size() masks it off.
+        static constexpr size_type heap_flag =
+            (std::numeric_limits<size_type>::min)();
+
+        struct heap_storage
         {
-            buf_ptr_iterator<Iter> buf_first = fill_buf(buf, size, first, last);
-
-            int chars_pushed = buf_first.buf_ - buf;
-            int buf_size = size;
-
-            while (buf_first.it_ != last) {
-                buf_size *= 2;
-                bufs.push_back(text());
-                text & temp = bufs.back();
-                temp.data_.reset(new char[buf_size]);
-                temp.cap_ = buf_size;
-                buf_first = fill_buf(temp.data_.get(), buf_size, buf_first.it_, last);
-                temp.size_ = buf_first.buf_ - temp.data_.get();
-                chars_pushed += temp.size_;
-            }
+            char * ptr_;
+            size_type cap_;
+        };
 
-            return chars_pushed;
-        }
+        union storage
+        {
+            char local_[detail::text_local_size];
+            heap_storage heap_;
+        };
 
-        std::unique_ptr<char []> data_;
-        int size_;
-        int cap_;
+        storage storage_;
+        size_type size_;
 
 #endif // Doxygen
     };
@@ -767,6 +989,13 @@ namespace boost { namespace text {
         return std::move(t);
     }
 
+    /** Returns a copy of tv in which each invalid UTF-8 sequence is
+        replaced with the replacement character, as utf8::repair_encoding()
+        does.
+
+        \post utf8::encoded(result.begin(), result.end()) */
+    text repair_encoding (text_view tv);
+
 } }
 
 #include <boost/text/repeated_text_view.hpp>
@@ -781,7 +1010,7 @@ namespace boost { namespace text {
             valid UTF-8. */
         inline text operator"" _t (char const * str, std::size_t len)
         {
-            assert(len < INT_MAX);
+            assert(len < PTRDIFF_MAX);
             return text(text_view(str, len));
         }
 
@@ -790,7 +1019,7 @@ namespace boost { namespace text {
             \throw std::invalid_argument if the string is not valid UTF-16. */
         inline text operator"" _t (char16_t const * str, std::size_t len)
         {
-            assert(len < INT_MAX / 2);
+            assert(len < PTRDIFF_MAX / 2);
             return text(
                 utf8::from_utf16_iterator<char16_t const *>(str),
                 utf8::from_utf16_iterator<char16_t const *>(str + len)
@@ -802,7 +1031,7 @@ namespace boost { namespace text {
             \throw std::invalid_argument if the string is not valid UTF-32. */
         inline text operator"" _t (char32_t const * str, std::size_t len)
         {
-            assert(len < INT_MAX / 4);
+            assert(len < PTRDIFF_MAX / 4);
             return text(
                 utf8::from_utf32_iterator<char32_t const *>(str),
                 utf8::from_utf32_iterator<char32_t const *>(str + len)
@@ -813,13 +1042,19 @@ namespace boost { namespace text {
 
 #ifndef BOOST_TEXT_DOXYGEN
 
-    inline text::text (text const & t) : data_ (), size_ (0), cap_ (0)
+    inline text::text (text const & t) :
+        storage_ (),
+        size_ (0)
     { insert(0, text_view(t.begin(), t.size(), utf8::unchecked)); }
 
-    inline text::text (text_view tv) : data_ (), size_ (0), cap_ (0)
+    inline text::text (text_view tv) :
+        storage_ (),
+        size_ (0)
     { insert(0, tv); }
 
-    inline text::text (repeated_text_view rtv) : data_ (), size_ (0), cap_ (0)
+    inline text::text (repeated_text_view rtv) :
+        storage_ (),
+        size_ (0)
     { insert(0, rtv); }
 
     inline text & text::operator= (text const & t)
@@ -870,10 +1105,10 @@ namespace boost { namespace text {
         return *this;
     }
 
-    inline text_view text::operator() (int lo, int hi) const
+    inline text_view text::operator() (size_type lo, size_type hi) const
     { return text_view(*this)(lo, hi); }
 
-    inline text_view text::operator() (int cut) const
+    inline text_view text::operator() (size_type cut) const
     { return text_view(*this)(cut); }
 
     inline int text::compare (text_view rhs) const noexcept
@@ -898,13 +1133,13 @@ namespace boost { namespace text {
     { return compare(rhs) >= 0; }
 
     template <typename CharRange>
-    auto text::insert (int at, CharRange const & r)
+    auto text::insert (size_type at, CharRange const & r)
         -> detail::rng_alg_ret_t<text &, CharRange>
     { return insert(at, text_view(r)); }
 
-    inline text & text::insert (int at, text_view tv)
+    inline text & text::insert (size_type at, text_view tv)
     {
-        assert(0 <= at && at <= size_);
+        assert(0 <= at && at <= size());
         assert(0 <= tv.size());
 
         if (!utf8::starts_encoded(cbegin() + at, cend()))
@@ -914,20 +1149,20 @@ namespace boost { namespace text {
         if (tv_null_terminated)
             tv = tv(0, -1);
 
-        int const delta = tv.size();
+        size_type const delta = tv.size();
         if (!delta)
             return *this;
 
         bool const late_self_ref =
             self_reference(tv) && at < tv.end() - begin();
-        int const available = cap_ - 1 - size_;
+        size_type const available = cap() - 1 - size();
         if (late_self_ref || available < delta) {
-            std::unique_ptr<char []> new_data = get_new_data(delta - available);
+            detail::text_heap_ptr new_data = get_new_data(delta - available);
             char * buf = new_data.get();
             buf = std::copy(cbegin(), cbegin() + at, buf);
             buf = std::copy(tv.begin(), tv.end(), buf);
             buf = std::copy(cbegin() + at, cend(), buf);
-            new_data.swap(data_);
+            set_data(new_data);
         } else {
             std::copy_backward(cbegin() + at, cend(), end() + delta);
             char * buf = begin() + at;
@@ -935,14 +1170,14 @@ namespace boost { namespace text {
         }
 
         size_ += delta;
-        data_[size_] = '\0';
+        ptr()[size()] = '\0';
 
         return *this;
     }
 
-    inline text & text::insert (int at, repeated_text_view rtv)
+    inline text & text::insert (size_type at, repeated_text_view rtv)
     {
-        assert(0 <= at && at <= size_);
+        assert(0 <= at && at <= size());
         assert(0 <= rtv.size());
 
         if (!utf8::starts_encoded(cbegin() + at, cend()))
@@ -952,32 +1187,32 @@ namespace boost { namespace text {
         if (rtv_null_terminated)
             rtv = repeat(rtv.view()(0, -1), rtv.count());
 
-        int const delta = rtv.size();
+        size_type const delta = rtv.size();
         if (!delta)
             return *this;
 
         bool const late_self_ref =
             self_reference(rtv.view()) && at < rtv.view().end() - begin();
-        int const available = cap_ - 1 - size_;
+        size_type const available = cap() - 1 - size();
         if (late_self_ref || available < delta) {
-            std::unique_ptr<char []> new_data = get_new_data(delta - available);
+            detail::text_heap_ptr new_data = get_new_data(delta - available);
             char * buf = new_data.get();
             buf = std::copy(cbegin(), cbegin() + at, buf);
-            for (int i = 0; i < rtv.count(); ++i) {
+            for (size_type i = 0; i < rtv.count(); ++i) {
                 buf = std::copy(rtv.view().begin(), rtv.view().end(), buf);
             }
             std::copy(cbegin() + at, cend(), buf);
-            new_data.swap(data_);
+            set_data(new_data);
         } else {
             std::copy_backward(cbegin() + at, cend(), end() + delta);
             char * buf = begin() + at;
-            for (int i = 0; i < rtv.count(); ++i) {
+            for (size_type i = 0; i < rtv.count(); ++i) {
                 buf = std::copy(rtv.view().begin(), rtv.view().end(), buf);
             }
         }
 
         size_ += delta;
-        data_[size_] = '\0';
+        ptr()[size()] = '\0';
 
         return *this;
     }
@@ -1018,7 +1253,7 @@ namespace boost { namespace text {
                 text_view check_after(old_substr.begin(), end() - old_substr.begin());
                 (void)check_after;
             } else {
-                text_view check_before(data_.get(), old_substr.begin() - begin());
+                text_view check_before(begin(), old_substr.begin() - begin());
                 (void)check_before;
             }
         }
@@ -1032,15 +1267,15 @@ namespace boost { namespace text {
 
         bool const late_self_ref =
             self_reference(new_substr) && old_substr.begin() < new_substr.end();
-        int const delta = new_substr.size() - old_substr.size();
-        int const available = cap_ - 1 - size_;
+        size_type const delta = new_substr.size() - old_substr.size();
+        size_type const available = cap() - 1 - size();
         if (late_self_ref || available < delta) {
-            std::unique_ptr<char []> new_data = get_new_data(delta - available);
+            detail::text_heap_ptr new_data = get_new_data(delta - available);
             char * buf = new_data.get();
             buf = std::copy(cbegin(), old_substr.begin(), buf);
             buf = std::copy(new_substr.begin(), new_substr.end(), buf);
             std::copy(old_substr.end(), cend(), buf);
-            new_data.swap(data_);
+            set_data(new_data);
         } else {
             if (0 < delta) {
                 std::copy_backward(
@@ -1058,7 +1293,7 @@ namespace boost { namespace text {
         }
 
         size_ += delta;
-        data_[size_] = '\0';
+        ptr()[size()] = '\0';
 
         return *this;
     }
@@ -1080,7 +1315,7 @@ namespace boost { namespace text {
                 text_view check_after(old_substr.begin(), end() - old_substr.begin());
                 (void)check_after;
             } else {
-                text_view check_before(data_.get(), old_substr.begin() - begin());
+                text_view check_before(begin(), old_substr.begin() - begin());
                 (void)check_before;
             }
         }
@@ -1094,17 +1329,17 @@ namespace boost { namespace text {
 
         bool const late_self_ref =
             self_reference(new_substr.view()) && old_substr.begin() < new_substr.view().end();
-        int const delta = new_substr.size() - old_substr.size();
-        int const available = cap_ - 1 - size_;
+        size_type const delta = new_substr.size() - old_substr.size();
+        size_type const available = cap() - 1 - size();
         if (late_self_ref || available < delta) {
-            std::unique_ptr<char []> new_data = get_new_data(delta - available);
+            detail::text_heap_ptr new_data = get_new_data(delta - available);
             char * buf = new_data.get();
             buf = std::copy(cbegin(), old_substr.begin(), buf);
-            for (int i = 0; i < new_substr.count(); ++i) {
+            for (size_type i = 0; i < new_substr.count(); ++i) {
                 buf = std::copy(new_substr.view().begin(), new_substr.view().end(), buf);
             }
             std::copy(old_substr.end(), cend(), buf);
-            new_data.swap(data_);
+            set_data(new_data);
         } else {
             if (0 < delta) {
                 std::copy_backward(
@@ -1118,18 +1353,17 @@ namespace boost { namespace text {
                 );
             }
             char * buf = const_cast<char *>(old_substr.begin());
-            for (int i = 0; i < new_substr.count(); ++i) {
+            for (size_type i = 0; i < new_substr.count(); ++i) {
                 buf = std::copy(new_substr.view().begin(), new_substr.view().end(), buf);
             }
         }
 
         size_ += delta;
-        data_[size_] = '\0';
+        ptr()[size()] = '\0';
 
         return *this;
     }
 
-    // TODO: Add a noncontiguous random_access Iter overload, here and elsewhere.
     template <typename Iter>
     auto text::replace (text_view old_substr, Iter first, Iter last)
         -> detail::char_iter_ret_t<text &, Iter>
@@ -1153,6 +1387,27 @@ namespace boost { namespace text {
     inline text & text::operator+= (text_view tv)
     { return insert(size(), tv); }
 
+    inline text repair_encoding (text_view tv)
+    {
+        text retval;
+        retval.reserve(tv.size());
+        retval.append_repaired(tv.begin(), tv.end());
+        return retval;
+    }
+
+    inline text & text::repair_encoding ()
+    {
+        char const * const invalid = utf8::find_invalid_encoding(cbegin(), cend());
+        if (invalid == cend())
+            return *this;
+        text repaired;
+        repaired.reserve(size() + 2);
+        repaired.append_unchecked(cbegin(), invalid);
+        repaired.append_repaired(invalid, cend());
+        swap(repaired);
+        return *this;
+    }
+
     inline text & text::operator+= (repeated_text_view rtv)
     {
         assert(0 <= rtv.size());
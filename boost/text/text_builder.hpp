@@ -0,0 +1,296 @@
+#ifndef BOOST_TEXT_TEXT_BUILDER_HPP
+#define BOOST_TEXT_TEXT_BUILDER_HPP
+
+#include <boost/text/rope.hpp>
+#include <boost/text/text.hpp>
+#include <boost/text/utf8.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include <cassert>
+
+
+namespace boost { namespace text {
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    namespace detail {
+
+        // Writes the decimal digits of x to out, and returns the end of
+        // them.  out must have room for std::numeric_limits<T>::digits10 + 2
+        // chars.
+        template <typename T>
+        char * write_integer (T x, char * out) noexcept
+        {
+            using unsigned_t = typename std::make_unsigned<T>::type;
+            unsigned_t u = static_cast<unsigned_t>(x);
+            if (x < T(0)) {
+                *out++ = '-';
+                u = unsigned_t(0) - u;
+            }
+            char buf[std::numeric_limits<unsigned_t>::digits10 + 1];
+            char * const buf_last = buf + sizeof(buf);
+            char * it = buf_last;
+            do {
+                *--it = static_cast<char>('0' + u % 10);
+                u /= 10;
+            } while (u);
+            return std::copy(it, buf_last, out);
+        }
+
+        // Writes the UTF-8 encoding of cp to out, and returns the end of it.
+        // out must have room for 4 chars.
+        inline char * write_code_point (uint32_t cp, char * out) noexcept
+        {
+            if (!utf8::valid_code_point(cp))
+                cp = utf8::replacement_character();
+            if (cp < 0x80) {
+                *out++ = static_cast<char>(cp);
+            } else if (cp < 0x800) {
+                *out++ = static_cast<char>(0xc0 + (cp >> 6));
+                *out++ = static_cast<char>(0x80 + (cp & 0x3f));
+            } else if (cp < 0x10000) {
+                *out++ = static_cast<char>(0xe0 + (cp >> 12));
+                *out++ = static_cast<char>(0x80 + ((cp >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 + (cp & 0x3f));
+            } else {
+                *out++ = static_cast<char>(0xf0 + (cp >> 18));
+                *out++ = static_cast<char>(0x80 + ((cp >> 12) & 0x3f));
+                *out++ = static_cast<char>(0x80 + ((cp >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 + (cp & 0x3f));
+            }
+            return out;
+        }
+
+        template <typename T, typename R>
+        using integer_ret_t = typename std::enable_if<
+            std::is_integral<T>::value &&
+            !std::is_same<T, char>::value &&
+            !std::is_same<T, char16_t>::value &&
+            !std::is_same<T, char32_t>::value &&
+            !std::is_same<T, wchar_t>::value &&
+            !std::is_same<T, bool>::value,
+            R
+        >::type;
+
+        template <typename T, typename R>
+        using floating_point_ret_t = typename std::enable_if<
+            std::is_floating_point<T>::value,
+            R
+        >::type;
+
+    }
+
+#endif
+
+    /** An append-only buffer for building a text out of many small pieces,
+        such as the fragments of a large JSON or HTML document.
+
+        Unlike text::operator+=(), the append functions check neither the
+        encoding at the end of the buffer nor whether what is appended
+        refers to the buffer, and the storage doubles whenever it runs out.
+        The UTF-8 encoding of the whole buffer is checked once, by finish()
+        or finish_rope(), which move the buffer into the result without
+        copying it.
+
+        What is appended must not refer to the builder's own buffer. */
+    struct text_builder
+    {
+        using size_type = std::ptrdiff_t;
+
+        /** Default ctor. */
+        text_builder () noexcept {}
+
+        /** Constructs an empty builder with storage for at least size_hint
+            chars. */
+        explicit text_builder (size_type size_hint)
+        { reserve(size_hint); }
+
+        /** Returns the number of chars appended so far. */
+        size_type size () const noexcept
+        { return t_.size(); }
+
+        bool empty () const noexcept
+        { return t_.size() == 0; }
+
+        /** Returns the number of chars the builder can hold before it
+            allocates again. */
+        size_type capacity () const noexcept
+        { return t_.cap() - 1; }
+
+        /** Reserves storage for at least new_size chars, so that appends
+            up to that size do not allocate. */
+        void reserve (size_type new_size)
+        {
+            assert(0 <= new_size);
+            if (capacity() < new_size)
+                reallocate(new_size + 1);
+        }
+
+        /** Removes the chars appended so far, keeping the storage. */
+        void clear () noexcept
+        { t_.set_size(0); }
+
+        /** Appends the bytes [first, last), whatever their encoding. */
+        text_builder & append (char const * first, char const * last)
+        {
+            assert(first <= last);
+            size_type const n = last - first;
+            if (n)
+                std::memcpy(prepare(n), first, n);
+            t_.size_ += n;
+            return *this;
+        }
+
+        /** Appends the bytes of c_str, up to its null terminator. */
+        text_builder & append (char const * c_str)
+        { return append(c_str, c_str + std::strlen(c_str)); }
+
+        text_builder & append (text_view tv)
+        { return append(tv.begin(), tv.end()); }
+
+        text_builder & append (repeated_text_view rtv)
+        {
+            for (std::ptrdiff_t i = 0; i < rtv.count(); ++i) {
+                append(rtv.view());
+            }
+            return *this;
+        }
+
+        /** Appends the single byte c. */
+        text_builder & append (char c)
+        {
+            *prepare(1) = c;
+            ++t_.size_;
+            return *this;
+        }
+
+        /** Appends the UTF-8 encoding of cp, or of the replacement
+            character if cp is not a valid code point. */
+        text_builder & append_code_point (uint32_t cp)
+        {
+            char * const out = prepare(4);
+            t_.size_ += detail::write_code_point(cp, out) - out;
+            return *this;
+        }
+
+        /** Appends the UTF-8 encoding of c, as append_code_point() does. */
+        text_builder & append (char16_t c)
+        { return append_code_point(c); }
+
+        /** Appends the UTF-8 encoding of c, as append_code_point() does. */
+        text_builder & append (char32_t c)
+        { return append_code_point(c); }
+
+        /** Appends the UTF-8 encoding of c, as append_code_point() does. */
+        text_builder & append (wchar_t c)
+        { return append_code_point(static_cast<uint32_t>(c)); }
+
+#ifdef BOOST_TEXT_DOXYGEN
+
+        /** Appends the decimal representation of x.
+
+            This function only participates in overload resolution if T is
+            an integral type other than bool and the character types char,
+            char16_t, char32_t and wchar_t. */
+        template <typename T>
+        text_builder & append (T x);
+
+        /** Appends the representation of x produced by printf()'s %g
+            conversion, with enough digits to round-trip; the decimal point
+            is that of the current C locale.
+
+            This function only participates in overload resolution if T is a
+            floating point type. */
+        template <typename T>
+        text_builder & append (T x);
+
+#else
+
+        template <typename T>
+        auto append (T x) -> detail::integer_ret_t<T, text_builder &>
+        {
+            char * const out = prepare(std::numeric_limits<T>::digits10 + 2);
+            t_.size_ += detail::write_integer(x, out) - out;
+            return *this;
+        }
+
+        template <typename T>
+        auto append (T x) -> detail::floating_point_ret_t<T, text_builder &>
+        {
+            // Enough for the sign, max_digits10 digits, the decimal point,
+            // and an exponent, plus snprintf()'s null terminator.
+            int const buf_size = std::numeric_limits<T>::max_digits10 + 16;
+            char * const out = prepare(buf_size - 1);
+            int const n = std::is_same<T, long double>::value ?
+                std::snprintf(out, buf_size, "%.*Lg", std::numeric_limits<T>::max_digits10, (long double)x) :
+                std::snprintf(out, buf_size, "%.*g", std::numeric_limits<T>::max_digits10, (double)x);
+            assert(0 <= n && n < buf_size);
+            t_.size_ += n;
+            return *this;
+        }
+
+#endif
+
+        /** Returns the chars appended so far as a text, and leaves *this
+            empty.  The buffer becomes the text's storage without being
+            copied.
+
+            \throw std::invalid_argument if the chars are not valid UTF-8;
+            *this is then left unchanged. */
+        text finish ()
+        {
+            char const * const invalid =
+                utf8::find_invalid_encoding(t_.cbegin(), t_.cend());
+            if (invalid != t_.cend())
+                throw std::invalid_argument("The built text is not valid UTF-8.");
+            t_.ptr()[t_.size()] = '\0';
+            return std::move(t_);
+        }
+
+        /** Returns the chars appended so far as a rope with a single
+            segment (none if *this is empty), and leaves *this empty.  The
+            buffer becomes the segment without being copied.
+
+            \throw std::invalid_argument if the chars are not valid UTF-8;
+            *this is then left unchanged. */
+        rope finish_rope ()
+        {
+            text t = finish();
+            return t.empty() ? rope() : rope(std::move(t));
+        }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        // Returns the end of the chars appended so far, with room for at
+        // least n more after it.
+        char * prepare (size_type n)
+        {
+            if (capacity() - t_.size() < n)
+                reallocate((std::max)(2 * t_.cap(), t_.size() + n + 1));
+            return t_.ptr() + t_.size();
+        }
+
+        void reallocate (size_type new_cap)
+        {
+            detail::text_heap_ptr new_data =
+                detail::new_text_heap(new_cap, t_.resource());
+            std::copy(t_.cbegin(), t_.cend(), new_data.get());
+            t_.set_data(new_data);
+        }
+
+        text t_;
+
+#endif
+
+    };
+
+} }
+
+#endif
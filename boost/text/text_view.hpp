@@ -23,6 +23,7 @@ namespace boost { namespace text {
         using const_iterator = char const *;
         using reverse_iterator = detail::const_reverse_char_iterator;
         using const_reverse_iterator = detail::const_reverse_char_iterator;
+        using size_type = std::ptrdiff_t;
 
         /** Default ctor.
 
@@ -65,7 +66,7 @@ namespace boost { namespace text {
             \throw std::invalid_argument if the ends of the string are not valid UTF-8.
             \pre len >= 0
             \post data() == c_str && size() == len */
-        BOOST_TEXT_CXX14_CONSTEXPR text_view (char const * c_str, int len) :
+        BOOST_TEXT_CXX14_CONSTEXPR text_view (char const * c_str, size_type len) :
             data_ (c_str),
             size_ (len)
         {
@@ -97,7 +98,7 @@ namespace boost { namespace text {
             \pre len >= 0
             \post data() == c_str && size() == len */
         BOOST_TEXT_CXX14_CONSTEXPR
-        text_view (char const * c_str, int len, utf8::unchecked_t) noexcept :
+        text_view (char const * c_str, size_type len, utf8::unchecked_t) noexcept :
             data_ (c_str),
             size_ (len)
         { assert(0 <= len); }
@@ -155,7 +156,7 @@ namespace boost { namespace text {
         constexpr bool empty () const noexcept
         { return size_ == 0; }
 
-        constexpr int size () const noexcept
+        constexpr size_type size () const noexcept
         { return size_; }
 
         /** Returns the i-th char of *this (not a reference).
@@ -163,7 +164,7 @@ namespace boost { namespace text {
             This function is constexpr in C++14 and later.
 
             \pre i < size() */
-        BOOST_TEXT_CXX14_CONSTEXPR char operator[] (int i) const noexcept
+        BOOST_TEXT_CXX14_CONSTEXPR char operator[] (size_type i) const noexcept
         {
             assert(i < size_);
             return data_[i];
@@ -184,7 +185,7 @@ namespace boost { namespace text {
             \pre lo <= hi
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        BOOST_TEXT_CXX14_CONSTEXPR text_view operator() (int lo, int hi) const
+        BOOST_TEXT_CXX14_CONSTEXPR text_view operator() (size_type lo, size_type hi) const
         {
             if (lo < 0)
                 lo += size_;
@@ -204,10 +205,10 @@ namespace boost { namespace text {
             \pre 0 <= cut && cut <= size() || 0 <= -cut && -cut <= size()
             \throw std::invalid_argument if the ends of the string are not
             valid UTF-8. */
-        BOOST_TEXT_CXX14_CONSTEXPR text_view operator() (int cut) const
+        BOOST_TEXT_CXX14_CONSTEXPR text_view operator() (size_type cut) const
         {
-            int lo = 0;
-            int hi = cut;
+            size_type lo = 0;
+            size_type hi = cut;
             if (cut < 0) {
                 lo = cut + size_;
                 hi = size_;
@@ -218,8 +219,8 @@ namespace boost { namespace text {
         }
 
         /** Returns the maximum size a text_view can have. */
-        constexpr int max_size () const noexcept
-        { return INT_MAX; }
+        constexpr size_type max_size () const noexcept
+        { return PTRDIFF_MAX; }
 
         /** Lexicographical compare.  Returns a value < 0 when *this is
             lexicographically less than rhs, 0 if *this == rhs, and a value >
@@ -240,7 +241,7 @@ namespace boost { namespace text {
                 rhs.data_ = tmp;
             }
             {
-                int tmp = size_;
+                size_type tmp = size_;
                 size_ = rhs.size_;
                 rhs.size_ = tmp;
             }
@@ -252,9 +253,39 @@ namespace boost { namespace text {
 
     private:
         char const * data_;
-        int size_;
+        size_type size_;
     };
 
+#ifdef BOOST_TEXT_DOXYGEN
+
+    /** Expands to a text_view of the char string literal str.  The entire
+        literal is checked for valid UTF-8 encoding, and its length is
+        computed, during constant evaluation; an invalid literal fails to
+        compile.  The resulting text_view needs no further checking, so
+        constructing a text or rope from it performs no scan of the string
+        beyond the copy itself.
+
+        Without C++14 constexpr support, the check is done at run time
+        instead, using checked_encoding().
+
+        The expansion is a constant expression. */
+#define BOOST_TEXT_LITERAL(str)
+
+#else
+
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+#define BOOST_TEXT_LITERAL(str)                                         \
+    ::boost::text::checked_encoding(::boost::text::text_view(           \
+        str, sizeof(str) - 1, ::boost::text::utf8::unchecked))
+#else
+#define BOOST_TEXT_LITERAL(str)                                         \
+    ::boost::text::detail::checked_literal<                             \
+        ::boost::text::detail::literal_encoded(str)                     \
+    >(str)
+#endif
+
+#endif
+
     namespace literals {
 
         /** Creates a text_view from a char string literal.
@@ -266,12 +297,28 @@ namespace boost { namespace text {
         inline BOOST_TEXT_CXX14_CONSTEXPR
         text_view operator"" _tv (char const * str, std::size_t len) noexcept
         {
-            assert(len < INT_MAX);
+            assert(len < PTRDIFF_MAX);
             return text_view(str, len);
         }
 
     }
 
+    namespace detail {
+
+        template <std::size_t N>
+        constexpr bool literal_encoded (char const (&str)[N]) noexcept
+        { return utf8::encoded(str, str + N - 1); }
+
+        template <bool Encoded, std::size_t N>
+        constexpr text_view checked_literal (char const (&str)[N]) noexcept
+        {
+            static_assert(Encoded, "The string literal is not valid UTF-8.");
+            static_assert(N - 1 <= PTRDIFF_MAX, "The string literal is too long.");
+            return text_view(str, N - 1, utf8::unchecked);
+        }
+
+    }
+
     /** This function is constexpr in C++14 and later. */
     inline BOOST_TEXT_CXX14_CONSTEXPR
     bool operator== (text_view lhs, text_view rhs) noexcept
@@ -0,0 +1,795 @@
+#ifndef BOOST_TEXT_TRANSCODE_HPP
+#define BOOST_TEXT_TRANSCODE_HPP
+
+#include <boost/text/utf8.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+#include <cassert>
+
+
+namespace boost { namespace text { namespace utf8 {
+
+    /** The result of a bulk transcoding operation.  in is the position in
+        the input at which transcoding stopped, and out is the position in
+        the output one past the last code unit written. */
+    template <typename InIter, typename OutIter>
+    struct transcode_result
+    {
+        InIter in;
+        OutIter out;
+    };
+
+    namespace detail {
+
+        template <typename T, std::size_t Size>
+        using enable_if_code_unit_t = typename std::enable_if<
+            std::is_integral<T>::value && sizeof(T) == Size
+        >::type;
+
+        // Decodes the code point starting at first, and advances first past
+        // it.  Errors are handled exactly as to_utf32_iterator handles them
+        // (one replacement character per maximal invalid subpart), except
+        // that no code unit at or after last is read.
+        inline uint32_t decode_code_point (char const *& first, char const * last) noexcept
+        {
+            unsigned char const c = *first++;
+            if (c < 0x80)
+                return c;
+
+            int continuations = 0;
+            uint32_t retval = 0;
+            unsigned char lo = 0x80;
+            unsigned char hi = 0xbf;
+            if (in(0xc2, c, 0xdf)) {
+                continuations = 1;
+                retval = c & 0b00011111;
+            } else if (in(0xe0, c, 0xef)) {
+                continuations = 2;
+                retval = c & 0b00001111;
+                if (c == 0xe0)
+                    lo = 0xa0;
+                else if (c == 0xed)
+                    hi = 0x9f;
+            } else if (in(0xf0, c, 0xf4)) {
+                continuations = 3;
+                retval = c & 0b00000111;
+                if (c == 0xf0)
+                    lo = 0x90;
+                else if (c == 0xf4)
+                    hi = 0x8f;
+            } else {
+                return replacement_character();
+            }
+
+            for (int i = 0; i < continuations; ++i) {
+                if (first == last || !continuation(*first, lo, hi))
+                    return replacement_character();
+                retval = (retval << 6) + (*first & 0b00111111);
+                ++first;
+                lo = 0x80;
+                hi = 0xbf;
+            }
+
+            return valid_code_point(retval) ? retval : replacement_character();
+        }
+
+        // Decodes the UTF-16 code point starting at first, and advances
+        // first past it.  Unpaired surrogates become replacement characters.
+        template <typename Char16>
+        uint32_t decode_utf16_code_point (Char16 const *& first, Char16 const * last) noexcept
+        {
+            uint32_t retval = static_cast<uint16_t>(*first++);
+            if (retval < 0xd800)
+                return retval;
+            if (retval <= 0xdbff) {
+                if (first == last)
+                    return replacement_character();
+                uint32_t const low = static_cast<uint16_t>(*first);
+                if (low < 0xdc00 || 0xdfff < low)
+                    return replacement_character();
+                ++first;
+                retval = (retval << 10) + low + (0x10000 - (0xd800 << 10) - 0xdc00);
+            } else if (surrogate(retval)) {
+                return replacement_character();
+            }
+            return valid_code_point(retval) ? retval : replacement_character();
+        }
+
+        // Writes the UTF-8 encoding of c (replaced if invalid) to out, if it
+        // fits in [out, out_last).  Returns the new out, or nullptr if c
+        // does not fit.
+        inline char * encode_code_point (uint32_t c, char * out, char * out_last) noexcept
+        {
+            if (0xd800 <= c && !valid_code_point(c))
+                c = replacement_character();
+            std::ptrdiff_t const space = out_last - out;
+            if (c < 0x80) {
+                if (space < 1)
+                    return nullptr;
+                *out++ = static_cast<char>(c);
+            } else if (c < 0x800) {
+                if (space < 2)
+                    return nullptr;
+                *out++ = static_cast<char>(0xc0 + (c >> 6));
+                *out++ = static_cast<char>(0x80 + (c & 0x3f));
+            } else if (c < 0x10000) {
+                if (space < 3)
+                    return nullptr;
+                *out++ = static_cast<char>(0xe0 + (c >> 12));
+                *out++ = static_cast<char>(0x80 + ((c >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 + (c & 0x3f));
+            } else {
+                if (space < 4)
+                    return nullptr;
+                *out++ = static_cast<char>(0xf0 + (c >> 18));
+                *out++ = static_cast<char>(0x80 + ((c >> 12) & 0x3f));
+                *out++ = static_cast<char>(0x80 + ((c >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 + (c & 0x3f));
+            }
+            return out;
+        }
+
+#if BOOST_TEXT_SSE2
+
+        // Returns the number of ASCII bytes at the start of v.
+        inline int sse2_ascii_prefix (__m128i v) noexcept
+        {
+            int const mask = _mm_movemask_epi8(v);
+            return mask ? boost::text::detail::countr_zero(mask) : 16;
+        }
+
+        // Returns the number n of well-formed 2-byte sequences at the start
+        // of v, and writes the n decoded code points into the first n 16-bit
+        // lanes of code_points.
+        inline int sse2_two_byte_prefix (__m128i v, __m128i & code_points) noexcept
+        {
+            // Lead bytes are 0xc2..0xdf, and continuations are 0x80..0xbf;
+            // as signed chars, that is (-63, -32) and [-128, -64).
+            __m128i const lead = _mm_and_si128(
+                _mm_cmpgt_epi8(v, _mm_set1_epi8((char)0xc1)),
+                _mm_cmplt_epi8(v, _mm_set1_epi8((char)0xe0))
+            );
+            __m128i const cont = _mm_cmplt_epi8(v, _mm_set1_epi8((char)0xc0));
+            __m128i const pairs = _mm_and_si128(lead, _mm_srli_epi16(cont, 8));
+            int const not_pairs = ~_mm_movemask_epi8(pairs) & 0x5555;
+            int const n =
+                not_pairs ? boost::text::detail::countr_zero(not_pairs) / 2 : 8;
+            __m128i const low_bits = _mm_slli_epi16(
+                _mm_and_si128(v, _mm_set1_epi16(0x1f)),
+                6
+            );
+            __m128i const high_bits = _mm_and_si128(
+                _mm_srli_epi16(v, 8),
+                _mm_set1_epi16(0x3f)
+            );
+            code_points = _mm_or_si128(low_bits, high_bits);
+            return n;
+        }
+
+#endif
+
+        template <typename Char32>
+        transcode_result<char const *, Char32 *> transcode_to_utf32_impl (
+            char const * first,
+            char const * last,
+            Char32 * out,
+            Char32 * out_last
+        ) noexcept {
+            while (first != last) {
+#if BOOST_TEXT_SSE2
+                if (16 <= last - first && 16 <= out_last - out) {
+                    __m128i const v = _mm_loadu_si128((__m128i const *)first);
+                    __m128i const zero = _mm_setzero_si128();
+                    // Every byte is widened and stored, but only the
+                    // transcoded prefix is kept.
+                    if (int const n = sse2_ascii_prefix(v)) {
+                        __m128i const lo16 = _mm_unpacklo_epi8(v, zero);
+                        __m128i const hi16 = _mm_unpackhi_epi8(v, zero);
+                        _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(lo16, zero));
+                        _mm_storeu_si128((__m128i *)out + 1, _mm_unpackhi_epi16(lo16, zero));
+                        _mm_storeu_si128((__m128i *)out + 2, _mm_unpacklo_epi16(hi16, zero));
+                        _mm_storeu_si128((__m128i *)out + 3, _mm_unpackhi_epi16(hi16, zero));
+                        first += n;
+                        out += n;
+                        continue;
+                    }
+                    __m128i code_points;
+                    if (int const n = sse2_two_byte_prefix(v, code_points)) {
+                        _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(code_points, zero));
+                        _mm_storeu_si128((__m128i *)out + 1, _mm_unpackhi_epi16(code_points, zero));
+                        first += 2 * n;
+                        out += n;
+                        continue;
+                    }
+                }
+#endif
+                if (out == out_last)
+                    break;
+                *out++ = decode_code_point(first, last);
+            }
+            return transcode_result<char const *, Char32 *>{first, out};
+        }
+
+        template <typename Char16>
+        transcode_result<char const *, Char16 *> transcode_to_utf16_impl (
+            char const * first,
+            char const * last,
+            Char16 * out,
+            Char16 * out_last
+        ) noexcept {
+            while (first != last) {
+#if BOOST_TEXT_SSE2
+                if (16 <= last - first && 16 <= out_last - out) {
+                    __m128i const v = _mm_loadu_si128((__m128i const *)first);
+                    // Every byte is widened and stored, but only the
+                    // transcoded prefix is kept.
+                    if (int const n = sse2_ascii_prefix(v)) {
+                        __m128i const zero = _mm_setzero_si128();
+                        _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi8(v, zero));
+                        _mm_storeu_si128((__m128i *)out + 1, _mm_unpackhi_epi8(v, zero));
+                        first += n;
+                        out += n;
+                        continue;
+                    }
+                    __m128i code_points;
+                    if (int const n = sse2_two_byte_prefix(v, code_points)) {
+                        _mm_storeu_si128((__m128i *)out, code_points);
+                        first += 2 * n;
+                        out += n;
+                        continue;
+                    }
+                }
+#endif
+                if (out == out_last)
+                    break;
+                char const * const prev_first = first;
+                uint32_t const c = decode_code_point(first, last);
+                if (c < 0x10000) {
+                    *out++ = static_cast<uint16_t>(c);
+                } else {
+                    if (out_last - out < 2) {
+                        first = prev_first;
+                        break;
+                    }
+                    *out++ = static_cast<uint16_t>((c >> 10) + 0xd7c0);
+                    *out++ = static_cast<uint16_t>((c & 0x3ff) + 0xdc00);
+                }
+            }
+            return transcode_result<char const *, Char16 *>{first, out};
+        }
+
+#if BOOST_TEXT_SSE2
+
+        // Encodes 8 code units in units16 as UTF-8, writing 8 or 16 bytes to
+        // out.  Returns the number of bytes written, or 0 if units16 is not
+        // all ASCII or all 2-byte code points.
+        inline int sse2_encode_block (__m128i units16, char * out) noexcept
+        {
+            __m128i const zero = _mm_setzero_si128();
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(
+                    _mm_and_si128(units16, _mm_set1_epi16((short)0xff80)),
+                    zero)) == 0xffff) {
+                _mm_storel_epi64((__m128i *)out, _mm_packus_epi16(units16, zero));
+                return 8;
+            }
+            __m128i const is_two_byte = _mm_and_si128(
+                _mm_cmpeq_epi16(
+                    _mm_and_si128(units16, _mm_set1_epi16((short)0xf800)),
+                    zero
+                ),
+                _mm_cmpgt_epi16(units16, _mm_set1_epi16(0x7f))
+            );
+            if (_mm_movemask_epi8(is_two_byte) == 0xffff) {
+                __m128i const lead = _mm_or_si128(
+                    _mm_srli_epi16(units16, 6),
+                    _mm_set1_epi16(0xc0)
+                );
+                __m128i const cont = _mm_or_si128(
+                    _mm_and_si128(units16, _mm_set1_epi16(0x3f)),
+                    _mm_set1_epi16(0x80)
+                );
+                _mm_storeu_si128(
+                    (__m128i *)out,
+                    _mm_or_si128(lead, _mm_slli_epi16(cont, 8))
+                );
+                return 16;
+            }
+            return 0;
+        }
+
+#endif
+
+        template <typename Char32>
+        transcode_result<Char32 const *, char *> transcode_from_utf32_impl (
+            Char32 const * first,
+            Char32 const * last,
+            char * out,
+            char * out_last
+        ) noexcept {
+            while (first != last) {
+#if BOOST_TEXT_SSE2
+                if (8 <= last - first && 16 <= out_last - out) {
+                    // packs_epi32 saturates, but only blocks of values below
+                    // 0x800 are used.
+                    __m128i const a = _mm_loadu_si128((__m128i const *)first);
+                    __m128i const b = _mm_loadu_si128((__m128i const *)first + 1);
+                    __m128i const high = _mm_and_si128(
+                        _mm_or_si128(a, b),
+                        _mm_set1_epi32(~0x7ff)
+                    );
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) == 0xffff) {
+                        if (int const bytes = sse2_encode_block(_mm_packs_epi32(a, b), out)) {
+                            first += 8;
+                            out += bytes;
+                            continue;
+                        }
+                    }
+                    // The block is mixed; encode it one code point at a
+                    // time before trying again.  There is room for it,
+                    // since 8 code points never take more than 32 bytes.
+                    if (32 <= out_last - out) {
+                        for (Char32 const * const block_last = first + 8; first != block_last; ++first) {
+                            out = encode_code_point(static_cast<uint32_t>(*first), out, out_last);
+                        }
+                        continue;
+                    }
+                }
+#endif
+                char * const next = encode_code_point(static_cast<uint32_t>(*first), out, out_last);
+                if (!next)
+                    break;
+                out = next;
+                ++first;
+            }
+            return transcode_result<Char32 const *, char *>{first, out};
+        }
+
+        template <typename Char16>
+        transcode_result<Char16 const *, char *> transcode_from_utf16_impl (
+            Char16 const * first,
+            Char16 const * last,
+            char * out,
+            char * out_last
+        ) noexcept {
+            while (first != last) {
+#if BOOST_TEXT_SSE2
+                if (8 <= last - first && 16 <= out_last - out) {
+                    __m128i const units = _mm_loadu_si128((__m128i const *)first);
+                    if (int const bytes = sse2_encode_block(units, out)) {
+                        first += 8;
+                        out += bytes;
+                        continue;
+                    }
+                    // The block is mixed; encode it one code point at a
+                    // time before trying again.  There is room for it,
+                    // since 8 code units (plus the low surrogate that may
+                    // follow them) never take more than 28 bytes.
+                    if (28 <= out_last - out) {
+                        Char16 const * const block_last = first + 8;
+                        while (first < block_last) {
+                            uint32_t const c = decode_utf16_code_point(first, last);
+                            out = encode_code_point(c, out, out_last);
+                        }
+                        continue;
+                    }
+                }
+#endif
+                Char16 const * next_first = first;
+                uint32_t const c = decode_utf16_code_point(next_first, last);
+                char * const next = encode_code_point(c, out, out_last);
+                if (!next)
+                    break;
+                out = next;
+                first = next_first;
+            }
+            return transcode_result<Char16 const *, char *>{first, out};
+        }
+
+        // Transcodes through a small buffer, so that the bounded, pointer
+        // based implementations can serve arbitrary output iterators.
+        template <typename Buf, typename InIter, typename OutIter, typename Impl>
+        transcode_result<InIter, OutIter> transcode_buffered (
+            InIter first,
+            InIter last,
+            OutIter out,
+            Impl impl
+        ) {
+            Buf buf[256];
+            Buf * const buf_last = buf + sizeof(buf) / sizeof(buf[0]);
+            while (first != last) {
+                auto const result = impl(first, last, buf, buf_last);
+                out = std::copy(buf, result.out, out);
+                first = result.in;
+            }
+            return transcode_result<InIter, OutIter>{first, out};
+        }
+
+    }
+
+    /** Transcodes the UTF-8 sequence [first, last) to UTF-32, writing the
+        result to [out_first, out_last).  Transcoding stops at last, or
+        before the first code point that does not fit in the remaining
+        output.  Transcoding can be resumed with a new output buffer by
+        calling this function again with the returned in.
+
+        Invalid sequences produce replacement characters, exactly as
+        to_utf32_iterator produces them, except that no code unit at or after
+        last is read.  Code units in [result.out, out_last) may be
+        overwritten.
+
+        This function only participates in overload resolution if Char32 is
+        an integral type of size 4.
+
+        \pre first <= last
+        \pre out_first <= out_last */
+    template <
+        typename Char32,
+        typename Enable = detail::enable_if_code_unit_t<Char32, 4>
+    >
+    transcode_result<char const *, Char32 *> transcode_to_utf32 (
+        char const * first,
+        char const * last,
+        Char32 * out_first,
+        Char32 * out_last
+    ) noexcept {
+        return detail::transcode_to_utf32_impl(first, last, out_first, out_last);
+    }
+
+    /** Transcodes the UTF-8 sequence [first, last) to UTF-32, writing the
+        result to out.  Invalid sequences produce replacement characters, as
+        described above.
+
+        \pre first <= last */
+    template <typename OutIter>
+    transcode_result<char const *, OutIter> transcode_to_utf32 (
+        char const * first,
+        char const * last,
+        OutIter out
+    ) {
+        return detail::transcode_buffered<uint32_t>(
+            first, last, out,
+            [](char const * f, char const * l, uint32_t * o, uint32_t * ol) {
+                return detail::transcode_to_utf32_impl(f, l, o, ol);
+            }
+        );
+    }
+
+    /** Transcodes the UTF-8 sequence [first, last) to UTF-16, writing the
+        result to [out_first, out_last).  Transcoding stops at last, or
+        before the first code point that does not fit in the remaining
+        output; a surrogate pair is never split.  Transcoding can be resumed
+        with a new output buffer by calling this function again with the
+        returned in.
+
+        Invalid sequences produce replacement characters, exactly as
+        to_utf32_iterator produces them, except that no code unit at or after
+        last is read.  Code units in [result.out, out_last) may be
+        overwritten.
+
+        This function only participates in overload resolution if Char16 is
+        an integral type of size 2.
+
+        \pre first <= last
+        \pre out_first <= out_last */
+    template <
+        typename Char16,
+        typename Enable = detail::enable_if_code_unit_t<Char16, 2>
+    >
+    transcode_result<char const *, Char16 *> transcode_to_utf16 (
+        char const * first,
+        char const * last,
+        Char16 * out_first,
+        Char16 * out_last
+    ) noexcept {
+        return detail::transcode_to_utf16_impl(first, last, out_first, out_last);
+    }
+
+    /** Transcodes the UTF-8 sequence [first, last) to UTF-16, writing the
+        result to out.  Invalid sequences produce replacement characters, as
+        described above.
+
+        \pre first <= last */
+    template <typename OutIter>
+    transcode_result<char const *, OutIter> transcode_to_utf16 (
+        char const * first,
+        char const * last,
+        OutIter out
+    ) {
+        return detail::transcode_buffered<uint16_t>(
+            first, last, out,
+            [](char const * f, char const * l, uint16_t * o, uint16_t * ol) {
+                return detail::transcode_to_utf16_impl(f, l, o, ol);
+            }
+        );
+    }
+
+    /** Transcodes the UTF-32 sequence [first, last) to UTF-8, writing the
+        result to [out_first, out_last).  Transcoding stops at last, or
+        before the first code point that does not fit in the remaining
+        output.  Transcoding can be resumed with a new output buffer by
+        calling this function again with the returned in.
+
+        Invalid code points produce replacement characters, as they do in
+        from_utf32_iterator.  Code units in [result.out, out_last) may be
+        overwritten.
+
+        This function only participates in overload resolution if Char32 is
+        an integral type of size 4.
+
+        \pre first <= last
+        \pre out_first <= out_last */
+    template <
+        typename Char32,
+        typename Enable = detail::enable_if_code_unit_t<Char32, 4>
+    >
+    transcode_result<Char32 const *, char *> transcode_from_utf32 (
+        Char32 const * first,
+        Char32 const * last,
+        char * out_first,
+        char * out_last
+    ) noexcept {
+        return detail::transcode_from_utf32_impl(first, last, out_first, out_last);
+    }
+
+    /** Transcodes the UTF-32 sequence [first, last) to UTF-8, writing the
+        result to out.  Invalid code points produce replacement characters.
+
+        This function only participates in overload resolution if Char32 is
+        an integral type of size 4.
+
+        \pre first <= last */
+    template <
+        typename Char32,
+        typename OutIter,
+        typename Enable = detail::enable_if_code_unit_t<Char32, 4>
+    >
+    transcode_result<Char32 const *, OutIter> transcode_from_utf32 (
+        Char32 const * first,
+        Char32 const * last,
+        OutIter out
+    ) {
+        return detail::transcode_buffered<char>(
+            first, last, out,
+            [](Char32 const * f, Char32 const * l, char * o, char * ol) {
+                return detail::transcode_from_utf32_impl(f, l, o, ol);
+            }
+        );
+    }
+
+    /** Transcodes the UTF-16 sequence [first, last) to UTF-8, writing the
+        result to [out_first, out_last).  Transcoding stops at last, or
+        before the first code point that does not fit in the remaining
+        output.  Transcoding can be resumed with a new output buffer by
+        calling this function again with the returned in.
+
+        Unpaired surrogates and invalid code points produce replacement
+        characters.  Code units in [result.out, out_last) may be overwritten.
+
+        This function only participates in overload resolution if Char16 is
+        an integral type of size 2.
+
+        \pre first <= last
+        \pre out_first <= out_last */
+    template <
+        typename Char16,
+        typename Enable = detail::enable_if_code_unit_t<Char16, 2>
+    >
+    transcode_result<Char16 const *, char *> transcode_from_utf16 (
+        Char16 const * first,
+        Char16 const * last,
+        char * out_first,
+        char * out_last
+    ) noexcept {
+        return detail::transcode_from_utf16_impl(first, last, out_first, out_last);
+    }
+
+    /** Transcodes the UTF-16 sequence [first, last) to UTF-8, writing the
+        result to out.  Unpaired surrogates and invalid code points produce
+        replacement characters.
+
+        This function only participates in overload resolution if Char16 is
+        an integral type of size 2.
+
+        \pre first <= last */
+    template <
+        typename Char16,
+        typename OutIter,
+        typename Enable = detail::enable_if_code_unit_t<Char16, 2>
+    >
+    transcode_result<Char16 const *, OutIter> transcode_from_utf16 (
+        Char16 const * first,
+        Char16 const * last,
+        OutIter out
+    ) {
+        return detail::transcode_buffered<char>(
+            first, last, out,
+            [](Char16 const * f, Char16 const * l, char * o, char * ol) {
+                return detail::transcode_from_utf16_impl(f, l, o, ol);
+            }
+        );
+    }
+
+    namespace detail {
+
+        // Calls f(span_first, span_last) for each span of the repaired form
+        // of [first, last): each maximal well-formed span of the input, and
+        // the encoding of the replacement character in place of each
+        // maximal invalid subpart.
+        template <typename Fn>
+        void foreach_repaired_span (char const * first, char const * last, Fn && f)
+        {
+            static char const replacement[] = "\xef\xbf\xbd";
+            while (first != last) {
+                char const * const invalid = find_invalid_encoding(first, last);
+                if (first != invalid)
+                    f(first, invalid);
+                if (invalid == last)
+                    break;
+                first = invalid;
+                decode_code_point(first, last);
+                f(replacement, replacement + 3);
+            }
+        }
+
+    }
+
+    /** Copies the UTF-8 sequence [first, last) to out, writing the encoding
+        of the replacement character in place of each invalid sequence.
+        Invalid sequences are found just as to_utf32_iterator finds them (one
+        replacement character per maximal invalid subpart), and everything
+        between them is copied in bulk.  The result is a sequence for which
+        encoded() is true.  Unlike a round trip through to_utf32_iterator
+        and from_utf32_iterator, this keeps well-formed noncharacters
+        unchanged.  Returns the final value of out.
+
+        \pre first <= last */
+    template <typename OutIter>
+    OutIter repair_encoding (char const * first, char const * last, OutIter out)
+    {
+        detail::foreach_repaired_span(first, last, [&](char const * f, char const * l) {
+            out = std::copy(f, l, out);
+        });
+        return out;
+    }
+
+    /** A forward-only UTF-8 to UTF-32 decoding iterator over a sequence of
+        char.  Each increment decodes the next code point and records both its
+        value and where it ends, so dereferencing and incrementing never read
+        any code unit twice.  Code points below 0x80 skip the general decoder
+        entirely.  Invalid UTF-8 produces replacement characters in the same
+        places as to_utf32_iterator, except that nothing at or after the end
+        of the sequence is read.
+
+        Use to_utf32_iterator when you need to traverse a sequence in both
+        directions, or when the end of the sequence is not known. */
+    struct forward_code_point_iterator
+    {
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = uint32_t const *;
+        using reference = uint32_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        /** Default ctor.
+
+            \post base() == nullptr */
+        forward_code_point_iterator () noexcept :
+            it_ (nullptr),
+            next_ (nullptr),
+            last_ (nullptr),
+            value_ (0)
+        {}
+
+        /** Constructs an iterator to the code point starting at it, within
+            the sequence ending at last.
+
+            \pre it <= last
+            \post base() == it */
+        forward_code_point_iterator (char const * it, char const * last) noexcept :
+            it_ (it),
+            next_ (it),
+            last_ (last),
+            value_ (0)
+        {
+            assert(it <= last);
+            read();
+        }
+
+        /** \pre base() != last */
+        reference operator* () const noexcept
+        {
+            assert(it_ != last_);
+            return value_;
+        }
+
+        /** \pre base() != last */
+        forward_code_point_iterator & operator++ () noexcept
+        {
+            assert(it_ != last_);
+            it_ = next_;
+            read();
+            return *this;
+        }
+
+        /** \pre base() != last */
+        forward_code_point_iterator operator++ (int) noexcept
+        {
+            forward_code_point_iterator retval = *this;
+            ++*this;
+            return retval;
+        }
+
+        /** Returns the position of the current code point's first code
+            unit. */
+        char const * base () const noexcept
+        { return it_; }
+
+        friend bool operator== (
+            forward_code_point_iterator lhs,
+            forward_code_point_iterator rhs
+        ) noexcept
+        { return lhs.it_ == rhs.it_; }
+
+        friend bool operator!= (
+            forward_code_point_iterator lhs,
+            forward_code_point_iterator rhs
+        ) noexcept
+        { return lhs.it_ != rhs.it_; }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        void read () noexcept
+        {
+            if (next_ == last_)
+                return;
+            unsigned char const c = *next_;
+            if (c < 0x80) {
+                value_ = c;
+                ++next_;
+            } else {
+                value_ = detail::decode_code_point(next_, last_);
+            }
+        }
+
+        char const * it_;
+        char const * next_;
+        char const * last_;
+        uint32_t value_;
+#endif
+
+    };
+
+    /** The code points of a UTF-8 sequence, as returned by
+        forward_code_points(). */
+    struct forward_code_point_range
+    {
+        using iterator = forward_code_point_iterator;
+
+        iterator begin () const noexcept
+        { return iterator(first_, last_); }
+        iterator end () const noexcept
+        { return iterator(last_, last_); }
+
+        char const * first_;
+        char const * last_;
+    };
+
+    /** Returns a range of the code points in the UTF-8 sequence [first,
+        last), for a single forward pass such as a range-based for loop.
+        See forward_code_point_iterator.
+
+        \pre first <= last */
+    inline forward_code_point_range
+    forward_code_points (char const * first, char const * last) noexcept
+    {
+        assert(first <= last);
+        return forward_code_point_range{first, last};
+    }
+
+} } }
+
+#endif
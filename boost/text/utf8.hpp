@@ -2,7 +2,9 @@
 #define BOOST_TEXT_UTF8_HPP
 
 #include <boost/text/config.hpp>
+#include <boost/text/detail/simd.hpp>
 
+#include <algorithm>
 #include <iterator>
 #include <type_traits>
 #include <stdexcept>
@@ -190,25 +192,315 @@ namespace boost { namespace text { namespace utf8 {
 
     }
 
+    namespace detail {
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR char const *
+        find_invalid_encoding_scalar (char const * first, char const * last) noexcept
+        {
+            while (first != last) {
+                int const cp_bytes = code_point_bytes(*first);
+                if (cp_bytes == -1 || last - first < cp_bytes)
+                    return first;
+
+                if (end_of_invalid_utf8(first))
+                    return first;
+
+                first += cp_bytes;
+            }
+
+            return last;
+        }
+
+        /** Returns the start of the code point that it falls within, or it
+            if it is already on a code point boundary.  An invalid initial
+            code unit just before it is treated as the start of a code point.
+
+            \pre [first, it) is valid UTF-8, except possibly for its final
+            (truncated or invalid) code point. */
+        inline char const *
+        code_point_boundary (char const * first, char const * it) noexcept
+        {
+            char const * retval = it;
+            for (int n = 1; n <= 4 && retval != first; ++n) {
+                --retval;
+                if (!continuation(*retval)) {
+                    int const cp_bytes = code_point_bytes(*retval);
+                    return cp_bytes < 0 || n < cp_bytes ? retval : it;
+                }
+            }
+            return it;
+        }
+
+#if BOOST_TEXT_SSE2
+
+        // Skips 16-byte blocks of ASCII; any other block is checked one code
+        // point at a time until the scan reaches the block's end.
+        inline char const *
+        find_invalid_encoding_sse2 (char const * first, char const * last) noexcept
+        {
+            while (16 <= last - first) {
+                int const mask = _mm_movemask_epi8(
+                    _mm_loadu_si128((__m128i const *)first)
+                );
+                if (!mask) {
+                    first += 16;
+                    continue;
+                }
+                char const * const block_last = first + 16;
+                first += boost::text::detail::countr_zero(mask);
+                while (first < block_last) {
+                    int const cp_bytes = code_point_bytes(*first);
+                    if (cp_bytes == -1 || last - first < cp_bytes ||
+                        end_of_invalid_utf8(first)) {
+                        return first;
+                    }
+                    first += cp_bytes;
+                }
+            }
+            return find_invalid_encoding_scalar(first, last);
+        }
+
+#else
+
+        // Skips 8-byte words of ASCII; any other word is checked one code
+        // point at a time until the scan reaches the word's end.
+        inline char const *
+        find_invalid_encoding_words (char const * first, char const * last) noexcept
+        {
+            uint64_t const high_bits = 0x8080808080808080ull;
+            while (8 <= last - first) {
+                if (!(boost::text::detail::load_u64(first) & high_bits)) {
+                    first += 8;
+                    continue;
+                }
+                char const * const word_last = first + 8;
+                while (first < word_last) {
+                    int const cp_bytes = code_point_bytes(*first);
+                    if (cp_bytes == -1 || last - first < cp_bytes ||
+                        end_of_invalid_utf8(first)) {
+                        return first;
+                    }
+                    first += cp_bytes;
+                }
+            }
+            return find_invalid_encoding_scalar(first, last);
+        }
+
+#endif
+
+#if BOOST_TEXT_AVX2
+
+        // The AVX2 validator below is the "lookup" algorithm from Keiser and
+        // Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"
+        // (2021).  Each byte is classified by the high and low nibbles of the
+        // byte before it and by its own high nibble; the three lookups are
+        // ANDed together, so that a nonzero result marks an error.
+
+        template <int N>
+        BOOST_TEXT_TARGET_AVX2 inline __m256i
+        avx2_prev (__m256i input, __m256i prev_input) noexcept
+        {
+            return _mm256_alignr_epi8(
+                input,
+                _mm256_permute2x128_si256(prev_input, input, 0x21),
+                16 - N
+            );
+        }
+
+        BOOST_TEXT_TARGET_AVX2 inline __m256i
+        avx2_high_nibbles (__m256i x) noexcept
+        {
+            return _mm256_and_si256(
+                _mm256_srli_epi16(x, 4),
+                _mm256_set1_epi8(0x0f)
+            );
+        }
+
+        BOOST_TEXT_TARGET_AVX2 inline __m256i
+        avx2_lookup16 (
+            __m256i indices,
+            char t0, char t1, char t2, char t3,
+            char t4, char t5, char t6, char t7,
+            char t8, char t9, char t10, char t11,
+            char t12, char t13, char t14, char t15
+        ) noexcept {
+            return _mm256_shuffle_epi8(
+                _mm256_setr_epi8(
+                    t0, t1, t2, t3, t4, t5, t6, t7,
+                    t8, t9, t10, t11, t12, t13, t14, t15,
+                    t0, t1, t2, t3, t4, t5, t6, t7,
+                    t8, t9, t10, t11, t12, t13, t14, t15
+                ),
+                indices
+            );
+        }
+
+        // Returns a nonzero byte for each byte of input that is part of an
+        // invalid sequence, given the 32 bytes that precede input.
+        BOOST_TEXT_TARGET_AVX2 inline __m256i
+        avx2_utf8_errors (__m256i input, __m256i prev_input) noexcept
+        {
+            char const too_short = 1 << 0;  // 11______ 0_______
+                                            // 11______ 11______
+            char const too_long = 1 << 1;   // 0_______ 10______
+            char const overlong_3 = 1 << 2; // 11100000 100_____
+            char const too_large = 1 << 3;  // 11110100 1001____, etc.
+            char const surrogate = 1 << 4;  // 11101101 101_____
+            char const overlong_2 = 1 << 5; // 1100000_ 10______
+            char const too_large_1000 = 1 << 6; // 11110101 1000____, etc.
+            char const overlong_4 = 1 << 6; // 11110000 1000____
+            char const two_conts = (char)(1 << 7); // 10______ 10______
+            char const carry = too_short | too_long | two_conts;
+
+            __m256i const prev1 = avx2_prev<1>(input, prev_input);
+
+            __m256i const byte_1_high = avx2_lookup16(
+                avx2_high_nibbles(prev1),
+                too_long, too_long, too_long, too_long,
+                too_long, too_long, too_long, too_long,
+                two_conts, two_conts, two_conts, two_conts,
+                too_short | overlong_2,
+                too_short,
+                too_short | overlong_3 | surrogate,
+                too_short | too_large | too_large_1000 | overlong_4
+            );
+            __m256i const byte_1_low = avx2_lookup16(
+                _mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)),
+                carry | overlong_3 | overlong_2 | overlong_4,
+                carry | overlong_2,
+                carry,
+                carry,
+                carry | too_large,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000 | surrogate,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000
+            );
+            __m256i const byte_2_high = avx2_lookup16(
+                avx2_high_nibbles(input),
+                too_short, too_short, too_short, too_short,
+                too_short, too_short, too_short, too_short,
+                too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+                too_long | overlong_2 | two_conts | overlong_3 | too_large,
+                too_long | overlong_2 | two_conts | surrogate | too_large,
+                too_long | overlong_2 | two_conts | surrogate | too_large,
+                too_short, too_short, too_short, too_short
+            );
+            __m256i const special_cases = _mm256_and_si256(
+                _mm256_and_si256(byte_1_high, byte_1_low),
+                byte_2_high
+            );
+
+            // The third and fourth bytes of 3- and 4-byte sequences must be
+            // continuations; that is the only place two_conts is allowed.
+            __m256i const prev2 = avx2_prev<2>(input, prev_input);
+            __m256i const prev3 = avx2_prev<3>(input, prev_input);
+            __m256i const third_byte =
+                _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xe0 - 0x80)));
+            __m256i const fourth_byte =
+                _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xf0 - 0x80)));
+            __m256i const must_be_continuation = _mm256_and_si256(
+                _mm256_or_si256(third_byte, fourth_byte),
+                _mm256_set1_epi8((char)0x80)
+            );
+
+            return _mm256_xor_si256(must_be_continuation, special_cases);
+        }
+
+        // Returns a nonzero byte if input ends with the beginning of a
+        // multi-byte sequence.
+        BOOST_TEXT_TARGET_AVX2 inline __m256i
+        avx2_incomplete (__m256i input) noexcept
+        {
+            __m256i const max_values = _mm256_setr_epi8(
+                -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1,
+                (char)(0xf0 - 1), (char)(0xe0 - 1), (char)(0xc0 - 1)
+            );
+            return _mm256_subs_epu8(input, max_values);
+        }
+
+        BOOST_TEXT_TARGET_AVX2 inline char const *
+        find_invalid_encoding_avx2 (char const * first, char const * last) noexcept
+        {
+            char const * it = first;
+            __m256i prev_input = _mm256_setzero_si256();
+            __m256i prev_incomplete = _mm256_setzero_si256();
+
+            // Any error stops the loop; the exact location is then found by
+            // the scalar code, starting from the nearest code point boundary
+            // at or before the block in which the error was detected.
+            while (32 <= last - it) {
+                __m256i const input = _mm256_loadu_si256((__m256i const *)it);
+                if (!_mm256_movemask_epi8(input)) {
+                    if (!_mm256_testz_si256(prev_incomplete, prev_incomplete))
+                        break;
+                    prev_incomplete = _mm256_setzero_si256();
+                } else {
+                    __m256i const errors = avx2_utf8_errors(input, prev_input);
+                    if (!_mm256_testz_si256(errors, errors))
+                        break;
+                    prev_incomplete = avx2_incomplete(input);
+                }
+                prev_input = input;
+                it += 32;
+            }
+
+            return find_invalid_encoding_scalar(
+                code_point_boundary(first, it),
+                last
+            );
+        }
+
+#endif
+
+        /** The runtime implementation of find_invalid_encoding(); it uses the
+            fastest code path available on the running CPU. */
+        inline char const *
+        find_invalid_encoding_runtime (char const * first, char const * last) noexcept
+        {
+#if BOOST_TEXT_AVX2
+            if (boost::text::detail::cpu_has_avx2())
+                return find_invalid_encoding_avx2(first, last);
+#endif
+#if BOOST_TEXT_SSE2
+            return find_invalid_encoding_sse2(first, last);
+#elif BOOST_TEXT_USE_SIMD
+            return find_invalid_encoding_words(first, last);
+#else
+            return find_invalid_encoding_scalar(first, last);
+#endif
+        }
+
+    }
+
     /** Returns the first code unit in [first, last) that is not properly
         UTF-8 encoded, or last if no such code unit is found.
 
+        At runtime, this uses SIMD instructions when they are available (see
+        BOOST_TEXT_USE_SIMD); during constant evaluation it examines one code
+        point at a time.
+
         This function is constexpr in C++14 and later. */
     inline BOOST_TEXT_CXX14_CONSTEXPR char const *
     find_invalid_encoding (char const * first, char const * last) noexcept
     {
-        while (first != last) {
-            int const cp_bytes = code_point_bytes(*first);
-            if (cp_bytes == -1 || last - first < cp_bytes)
-                return first;
-
-            if (detail::end_of_invalid_utf8(first))
-                return first;
-
-            first += cp_bytes;
-        }
-
-        return last;
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+        return detail::find_invalid_encoding_runtime(first, last);
+#else
+        if (!boost::text::detail::constant_evaluated())
+            return detail::find_invalid_encoding_runtime(first, last);
+        return detail::find_invalid_encoding_scalar(first, last);
+#endif
     }
 
     /** Returns true if [first, last) is properly UTF-8 encoded, or false
@@ -290,6 +582,559 @@ namespace boost { namespace text { namespace utf8 {
         return starts_encoded(it, last);
     }
 
+    namespace detail {
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t
+        count_code_points_scalar (char const * first, char const * last) noexcept
+        {
+            std::ptrdiff_t retval = 0;
+            for (; first != last; ++first) {
+                if (!continuation(*first))
+                    ++retval;
+            }
+            return retval;
+        }
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR char const * advance_code_points_scalar (
+            char const * first,
+            char const * last,
+            std::ptrdiff_t n
+        ) noexcept {
+            for (; first != last; ++first) {
+                if (!continuation(*first) && n-- == 0)
+                    return first;
+            }
+            return last;
+        }
+
+#if BOOST_TEXT_SSE2
+
+        // Returns a mask with bit i set iff block[i] is not a continuation
+        // code unit (that is, not in [0x80, 0xbf]).
+        inline uint32_t sse2_lead_mask (char const * block) noexcept
+        {
+            __m128i const v = _mm_loadu_si128((__m128i const *)block);
+            __m128i const continuations =
+                _mm_cmplt_epi8(v, _mm_set1_epi8((char)0xc0));
+            return ~(uint32_t)_mm_movemask_epi8(continuations) & 0xffffu;
+        }
+
+        // Counts continuation code units by subtracting the 0/-1 compare
+        // results into per-lane byte counters, which are summed with
+        // _mm_sad_epu8 before they can overflow.
+        inline std::ptrdiff_t
+        count_code_points_sse2 (char const * first, char const * last) noexcept
+        {
+            std::ptrdiff_t continuations = 0;
+            std::ptrdiff_t const size = last - first;
+            __m128i const zero = _mm_setzero_si128();
+            __m128i const limit = _mm_set1_epi8((char)0xc0);
+            while (16 <= last - first) {
+                std::ptrdiff_t const blocks =
+                    (std::min)((last - first) / 16, std::ptrdiff_t(255));
+                char const * const chunk_last = first + blocks * 16;
+                __m128i counts = zero;
+                for (; first != chunk_last; first += 16) {
+                    __m128i const v = _mm_loadu_si128((__m128i const *)first);
+                    counts = _mm_sub_epi8(counts, _mm_cmplt_epi8(v, limit));
+                }
+                __m128i const sums = _mm_sad_epu8(counts, zero);
+                continuations += _mm_cvtsi128_si32(sums) +
+                    _mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums));
+            }
+            std::ptrdiff_t const tail = last - first;
+            return size - tail - continuations +
+                count_code_points_scalar(first, last);
+        }
+
+        inline char const * advance_code_points_sse2 (
+            char const * first,
+            char const * last,
+            std::ptrdiff_t n
+        ) noexcept {
+            while (64 <= last - first) {
+                uint64_t const mask = sse2_lead_mask(first) |
+                    (uint64_t)sse2_lead_mask(first + 16) << 16 |
+                    (uint64_t)sse2_lead_mask(first + 32) << 32 |
+                    (uint64_t)sse2_lead_mask(first + 48) << 48;
+                int const leads = boost::text::detail::popcount(mask);
+                if (n < leads)
+                    break;
+                n -= leads;
+                first += 64;
+            }
+            while (16 <= last - first) {
+                uint32_t mask = sse2_lead_mask(first);
+                int const leads = boost::text::detail::popcount(mask);
+                if (leads <= n) {
+                    n -= leads;
+                    first += 16;
+                    continue;
+                }
+                for (; 0 < n; --n) {
+                    mask &= mask - 1;
+                }
+                return first + boost::text::detail::countr_zero(mask);
+            }
+            return advance_code_points_scalar(first, last, n);
+        }
+
+#else
+
+        // A byte is a continuation iff its top two bits are 10.
+        inline uint64_t continuation_bits (uint64_t word) noexcept
+        { return word & ~(word << 1) & 0x8080808080808080ull; }
+
+        inline std::ptrdiff_t
+        count_code_points_words (char const * first, char const * last) noexcept
+        {
+            std::ptrdiff_t retval = 0;
+            while (8 <= last - first) {
+                uint64_t const word = boost::text::detail::load_u64(first);
+                retval +=
+                    8 - boost::text::detail::popcount(continuation_bits(word));
+                first += 8;
+            }
+            return retval + count_code_points_scalar(first, last);
+        }
+
+        inline char const * advance_code_points_words (
+            char const * first,
+            char const * last,
+            std::ptrdiff_t n
+        ) noexcept {
+            while (8 <= last - first) {
+                uint64_t const word = boost::text::detail::load_u64(first);
+                int const leads =
+                    8 - boost::text::detail::popcount(continuation_bits(word));
+                if (n < leads)
+                    break;
+                n -= leads;
+                first += 8;
+            }
+            return advance_code_points_scalar(first, last, n);
+        }
+
+#endif
+
+#if BOOST_TEXT_AVX2
+
+        BOOST_TEXT_TARGET_AVX2 inline std::ptrdiff_t
+        count_code_points_avx2 (char const * first, char const * last) noexcept
+        {
+            std::ptrdiff_t continuations = 0;
+            std::ptrdiff_t const size = last - first;
+            __m256i const zero = _mm256_setzero_si256();
+            __m256i const limit = _mm256_set1_epi8((char)0xc0);
+            while (32 <= last - first) {
+                std::ptrdiff_t const blocks =
+                    (std::min)((last - first) / 32, std::ptrdiff_t(255));
+                char const * const chunk_last = first + blocks * 32;
+                __m256i counts = zero;
+                for (; first != chunk_last; first += 32) {
+                    __m256i const v =
+                        _mm256_loadu_si256((__m256i const *)first);
+                    counts =
+                        _mm256_sub_epi8(counts, _mm256_cmpgt_epi8(limit, v));
+                }
+                __m256i const sums = _mm256_sad_epu8(counts, zero);
+                __m128i const halves = _mm_add_epi64(
+                    _mm256_castsi256_si128(sums),
+                    _mm256_extracti128_si256(sums, 1)
+                );
+                continuations += _mm_cvtsi128_si32(halves) +
+                    _mm_cvtsi128_si32(_mm_unpackhi_epi64(halves, halves));
+            }
+            std::ptrdiff_t const tail = last - first;
+            return size - tail - continuations +
+                count_code_points_sse2(first, last);
+        }
+
+#endif
+
+        inline std::ptrdiff_t
+        count_code_points_runtime (char const * first, char const * last) noexcept
+        {
+#if BOOST_TEXT_AVX2
+            if (boost::text::detail::cpu_has_avx2())
+                return count_code_points_avx2(first, last);
+#endif
+#if BOOST_TEXT_SSE2
+            return count_code_points_sse2(first, last);
+#elif BOOST_TEXT_USE_SIMD
+            return count_code_points_words(first, last);
+#else
+            return count_code_points_scalar(first, last);
+#endif
+        }
+
+        inline char const * advance_code_points_runtime (
+            char const * first,
+            char const * last,
+            std::ptrdiff_t n
+        ) noexcept {
+#if BOOST_TEXT_SSE2
+            return advance_code_points_sse2(first, last, n);
+#elif BOOST_TEXT_USE_SIMD
+            return advance_code_points_words(first, last, n);
+#else
+            return advance_code_points_scalar(first, last, n);
+#endif
+        }
+
+    }
+
+    /** Returns the number of code points in [first, last).  Code points are
+        counted by counting the code units that are not continuation code
+        units, so the result is exact only when [first, last) is valid UTF-8;
+        use find_invalid_encoding() first if this is in doubt.
+
+        At runtime, this uses SIMD instructions when they are available (see
+        BOOST_TEXT_USE_SIMD).
+
+        This function is constexpr in C++14 and later. */
+    inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t
+    count_code_points (char const * first, char const * last) noexcept
+    {
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+        return detail::count_code_points_runtime(first, last);
+#else
+        if (!boost::text::detail::constant_evaluated())
+            return detail::count_code_points_runtime(first, last);
+        return detail::count_code_points_scalar(first, last);
+#endif
+    }
+
+    /** Returns the number of code points in [first, last).  Code points are
+        counted by counting the code units that are not continuation code
+        units, so the result is exact only when [first, last) is valid
+        UTF-8. */
+    template <typename Iter>
+    std::ptrdiff_t count_code_points (Iter first, Iter last) noexcept
+    {
+        std::ptrdiff_t retval = 0;
+        for (; first != last; ++first) {
+            if (!continuation(*first))
+                ++retval;
+        }
+        return retval;
+    }
+
+    /** Returns an iterator n code points past first, or last if [first,
+        last) contains n or fewer code points.  As with count_code_points(),
+        code points are found by skipping continuation code units, so first
+        should be at the start of a code point.
+
+        At runtime, this uses SIMD instructions when they are available (see
+        BOOST_TEXT_USE_SIMD).
+
+        This function is constexpr in C++14 and later.
+
+        \pre 0 <= n */
+    inline BOOST_TEXT_CXX14_CONSTEXPR char const * advance_code_points (
+        char const * first,
+        char const * last,
+        std::ptrdiff_t n
+    ) noexcept {
+        assert(0 <= n);
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+        return detail::advance_code_points_runtime(first, last, n);
+#else
+        if (!boost::text::detail::constant_evaluated())
+            return detail::advance_code_points_runtime(first, last, n);
+        return detail::advance_code_points_scalar(first, last, n);
+#endif
+    }
+
+    /** Returns an iterator n code points past first, or last if [first,
+        last) contains n or fewer code points.  As with count_code_points(),
+        code points are found by skipping continuation code units, so first
+        should be at the start of a code point.
+
+        \pre 0 <= n */
+    template <typename Iter>
+    Iter advance_code_points (Iter first, Iter last, std::ptrdiff_t n) noexcept
+    {
+        assert(0 <= n);
+        for (; first != last; ++first) {
+            if (!continuation(*first) && n-- == 0)
+                return first;
+        }
+        return last;
+    }
+
+    namespace detail {
+
+        // Only the initial code units of 4-byte sequences, [0xf0, 0xff], start
+        // code points that become surrogate pairs in UTF-16.
+        inline BOOST_TEXT_CXX14_CONSTEXPR bool four_byte_lead (char c) noexcept
+        { return 0xf0 <= (unsigned char)c; }
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t
+        count_utf16_code_units_scalar (char const * first, char const * last) noexcept
+        {
+            std::ptrdiff_t retval = 0;
+            for (; first != last; ++first) {
+                if (!continuation(*first))
+                    retval += four_byte_lead(*first) ? 2 : 1;
+            }
+            return retval;
+        }
+
+        inline BOOST_TEXT_CXX14_CONSTEXPR char const * advance_utf16_code_units_scalar (
+            char const * first,
+            char const * last,
+            std::ptrdiff_t n
+        ) noexcept {
+            for (; first != last; ++first) {
+                if (continuation(*first))
+                    continue;
+                int const units = four_byte_lead(*first) ? 2 : 1;
+                if (n < units)
+                    return first;
+                n -= units;
+            }
+            return last;
+        }
+
+#if BOOST_TEXT_SSE2
+
+        // Returns a mask with bit i set iff block[i] is in [0xf0, 0xff].
+        inline uint32_t sse2_four_byte_lead_mask (char const * block) noexcept
+        {
+            __m128i const v = _mm_loadu_si128((__m128i const *)block);
+            __m128i const leads =
+                _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8((char)0xf0)), v);
+            return (uint32_t)_mm_movemask_epi8(leads);
+        }
+
+        // Like count_code_points_sse2(), with a second set of byte counters
+        // for the initial code units of 4-byte sequences.
+        inline std::ptrdiff_t
+        count_utf16_code_units_sse2 (char const * first, char const * last) noexcept
+        {
+            std::ptrdiff_t continuations = 0;
+            std::ptrdiff_t four_byte_leads = 0;
+            std::ptrdiff_t const size = last - first;
+            __m128i const zero = _mm_setzero_si128();
+            __m128i const limit = _mm_set1_epi8((char)0xc0);
+            __m128i const four_byte_min = _mm_set1_epi8((char)0xf0);
+            while (16 <= last - first) {
+                std::ptrdiff_t const blocks =
+                    (std::min)((last - first) / 16, std::ptrdiff_t(255));
+                char const * const chunk_last = first + blocks * 16;
+                __m128i counts = zero;
+                __m128i four_byte_counts = zero;
+                for (; first != chunk_last; first += 16) {
+                    __m128i const v = _mm_loadu_si128((__m128i const *)first);
+                    counts = _mm_sub_epi8(counts, _mm_cmplt_epi8(v, limit));
+                    four_byte_counts = _mm_sub_epi8(
+                        four_byte_counts,
+                        _mm_cmpeq_epi8(_mm_max_epu8(v, four_byte_min), v)
+                    );
+                }
+                __m128i const sums = _mm_sad_epu8(counts, zero);
+                continuations += _mm_cvtsi128_si32(sums) +
+                    _mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums));
+                __m128i const four_byte_sums = _mm_sad_epu8(four_byte_counts, zero);
+                four_byte_leads += _mm_cvtsi128_si32(four_byte_sums) +
+                    _mm_cvtsi128_si32(_mm_unpackhi_epi64(four_byte_sums, four_byte_sums));
+            }
+            std::ptrdiff_t const tail = last - first;
+            return size - tail - continuations + four_byte_leads +
+                count_utf16_code_units_scalar(first, last);
+        }
+
+        inline char const * advance_utf16_code_units_sse2 (
+            char const * first,
+            char const * last,
+            std::ptrdiff_t n
+        ) noexcept {
+            while (64 <= last - first) {
+                uint64_t const leads = sse2_lead_mask(first) |
+                    (uint64_t)sse2_lead_mask(first + 16) << 16 |
+                    (uint64_t)sse2_lead_mask(first + 32) << 32 |
+                    (uint64_t)sse2_lead_mask(first + 48) << 48;
+                uint64_t const four_byte_leads = sse2_four_byte_lead_mask(first) |
+                    (uint64_t)sse2_four_byte_lead_mask(first + 16) << 16 |
+                    (uint64_t)sse2_four_byte_lead_mask(first + 32) << 32 |
+                    (uint64_t)sse2_four_byte_lead_mask(first + 48) << 48;
+                int const units = boost::text::detail::popcount(leads) +
+                    boost::text::detail::popcount(four_byte_leads);
+                if (n < units)
+                    break;
+                n -= units;
+                first += 64;
+            }
+            while (16 <= last - first) {
+                int const units =
+                    boost::text::detail::popcount(sse2_lead_mask(first)) +
+                    boost::text::detail::popcount(sse2_four_byte_lead_mask(first));
+                if (n < units)
+                    break;
+                n -= units;
+                first += 16;
+            }
+            return advance_utf16_code_units_scalar(first, last, n);
+        }
+
+#else
+
+        // A byte is the initial code unit of a 4-byte sequence iff its top
+        // four bits are all set.
+        inline uint64_t four_byte_lead_bits (uint64_t word) noexcept
+        { return word & (word << 1) & (word << 2) & (word << 3) & 0x8080808080808080ull; }
+
+        inline int utf16_code_units_word (uint64_t word) noexcept
+        {
+            return 8 - boost::text::detail::popcount(continuation_bits(word)) +
+                boost::text::detail::popcount(four_byte_lead_bits(word));
+        }
+
+        inline std::ptrdiff_t
+        count_utf16_code_units_words (char const * first, char const * last) noexcept
+        {
+            std::ptrdiff_t retval = 0;
+            while (8 <= last - first) {
+                retval += utf16_code_units_word(boost::text::detail::load_u64(first));
+                first += 8;
+            }
+            return retval + count_utf16_code_units_scalar(first, last);
+        }
+
+        inline char const * advance_utf16_code_units_words (
+            char const * first,
+            char const * last,
+            std::ptrdiff_t n
+        ) noexcept {
+            while (8 <= last - first) {
+                int const units =
+                    utf16_code_units_word(boost::text::detail::load_u64(first));
+                if (n < units)
+                    break;
+                n -= units;
+                first += 8;
+            }
+            return advance_utf16_code_units_scalar(first, last, n);
+        }
+
+#endif
+
+        inline std::ptrdiff_t
+        count_utf16_code_units_runtime (char const * first, char const * last) noexcept
+        {
+#if BOOST_TEXT_SSE2
+            return count_utf16_code_units_sse2(first, last);
+#elif BOOST_TEXT_USE_SIMD
+            return count_utf16_code_units_words(first, last);
+#else
+            return count_utf16_code_units_scalar(first, last);
+#endif
+        }
+
+        inline char const * advance_utf16_code_units_runtime (
+            char const * first,
+            char const * last,
+            std::ptrdiff_t n
+        ) noexcept {
+#if BOOST_TEXT_SSE2
+            return advance_utf16_code_units_sse2(first, last, n);
+#elif BOOST_TEXT_USE_SIMD
+            return advance_utf16_code_units_words(first, last, n);
+#else
+            return advance_utf16_code_units_scalar(first, last, n);
+#endif
+        }
+
+    }
+
+    /** Returns the number of UTF-16 code units needed to encode the code
+        points in [first, last).  This is the number of code points, plus one
+        for each 4-byte sequence, since those are exactly the code points
+        that become surrogate pairs.  Nothing is decoded, so the result is
+        exact only when [first, last) is valid UTF-8.
+
+        Given the start s of a line, count_utf16_code_units(s, s + n)
+        converts the UTF-8 column n to a UTF-16 column.
+
+        At runtime, this uses SIMD instructions when they are available (see
+        BOOST_TEXT_USE_SIMD).
+
+        This function is constexpr in C++14 and later. */
+    inline BOOST_TEXT_CXX14_CONSTEXPR std::ptrdiff_t
+    count_utf16_code_units (char const * first, char const * last) noexcept
+    {
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+        return detail::count_utf16_code_units_runtime(first, last);
+#else
+        if (!boost::text::detail::constant_evaluated())
+            return detail::count_utf16_code_units_runtime(first, last);
+        return detail::count_utf16_code_units_scalar(first, last);
+#endif
+    }
+
+    /** Returns the number of UTF-16 code units needed to encode the code
+        points in [first, last).  The result is exact only when [first,
+        last) is valid UTF-8. */
+    template <typename Iter>
+    std::ptrdiff_t count_utf16_code_units (Iter first, Iter last) noexcept
+    {
+        std::ptrdiff_t retval = 0;
+        for (; first != last; ++first) {
+            if (!continuation(*first))
+                retval += detail::four_byte_lead(*first) ? 2 : 1;
+        }
+        return retval;
+    }
+
+    /** Returns an iterator to the code point that would start n UTF-16 code
+        units past first, or last if [first, last) would encode as n or fewer
+        UTF-16 code units.  If n falls between the two halves of a surrogate
+        pair, the result is the start of that pair's code point.  This is the
+        inverse of count_utf16_code_units(), and like it, decodes nothing.
+
+        At runtime, this uses SIMD instructions when they are available (see
+        BOOST_TEXT_USE_SIMD).
+
+        This function is constexpr in C++14 and later.
+
+        \pre 0 <= n */
+    inline BOOST_TEXT_CXX14_CONSTEXPR char const * advance_utf16_code_units (
+        char const * first,
+        char const * last,
+        std::ptrdiff_t n
+    ) noexcept {
+        assert(0 <= n);
+#ifdef BOOST_TEXT_NO_CXX14_CONSTEXPR
+        return detail::advance_utf16_code_units_runtime(first, last, n);
+#else
+        if (!boost::text::detail::constant_evaluated())
+            return detail::advance_utf16_code_units_runtime(first, last, n);
+        return detail::advance_utf16_code_units_scalar(first, last, n);
+#endif
+    }
+
+    /** Returns an iterator to the code point that would start n UTF-16 code
+        units past first, or last if [first, last) would encode as n or fewer
+        UTF-16 code units.  If n falls between the two halves of a surrogate
+        pair, the result is the start of that pair's code point.
+
+        \pre 0 <= n */
+    template <typename Iter>
+    Iter advance_utf16_code_units (Iter first, Iter last, std::ptrdiff_t n) noexcept
+    {
+        assert(0 <= n);
+        for (; first != last; ++first) {
+            if (continuation(*first))
+                continue;
+            int const units = detail::four_byte_lead(*first) ? 2 : 1;
+            if (n < units)
+                return first;
+            n -= units;
+        }
+        return last;
+    }
+
     /** Returns true if c is a Unicode surrogate, or false otherwise.
 
         This function is constexpr in C++14 and later. */
@@ -1449,9 +2294,11 @@ namespace boost { namespace text { namespace utf8 {
             if (continuation(c, lo, hi)) {
                 return true;
             } else {
-                throw std::logic_error(
-                    "Invalid UTF-8 sequence; an expected continuation character is missing."
-                );
+                if (throw_on_error) {
+                    throw std::logic_error(
+                        "Invalid UTF-8 sequence; an expected continuation character is missing."
+                    );
+                }
                 pack_replacement_character();
                 return false;
             }
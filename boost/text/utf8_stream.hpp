@@ -0,0 +1,259 @@
+#ifndef BOOST_TEXT_UTF8_STREAM_HPP
+#define BOOST_TEXT_UTF8_STREAM_HPP
+
+#include <boost/text/transcode.hpp>
+
+#include <algorithm>
+
+#include <cassert>
+#include <cstring>
+
+
+namespace boost { namespace text { namespace utf8 {
+
+    namespace detail {
+
+        /** Returns true if [first, last) is the beginning of a UTF-8 code
+            point that is missing one or more of its code units, and that
+            could still turn out to be valid once they arrive. */
+        inline bool incomplete_code_point (char const * first, char const * last) noexcept
+        {
+            assert(first != last);
+            if (code_point_bytes(*first) <= last - first)
+                return false; // Complete, or an invalid initial code unit.
+            decode_code_point(first, last);
+            return first == last;
+        }
+
+        /** Returns the start of the incomplete code point at the end of
+            [first, last), or last if there is none.  Everything before the
+            result can be processed without looking at later input, because
+            the result is always an initial code unit. */
+        inline char const * incomplete_tail (char const * first, char const * last) noexcept
+        {
+            char const * it = last;
+            for (int i = 0; i < 3 && it != first; ++i) {
+                if (!continuation(*--it))
+                    return incomplete_code_point(it, last) ? it : last;
+            }
+            return last;
+        }
+
+    }
+
+    /** Validates a UTF-8 sequence that arrives in chunks of arbitrary size,
+        such as the blocks read from a file, pipe, or socket.  A code point
+        split across two chunks is held back until the rest of it arrives,
+        so each code unit is examined once, and no input is buffered apart
+        from at most three code units of an incomplete code point.
+
+        Errors are reported as offsets from the start of the first chunk.
+        Like find_invalid_encoding(), the reported offset is that of the
+        first code point that is not properly encoded. */
+    struct stream_validator
+    {
+        /** Default ctor.
+
+            \post valid() && offset() == 0 && pending_size() == 0 */
+        stream_validator () noexcept :
+            offset_ (0),
+            error_offset_ (-1),
+            pending_size_ (0)
+        {}
+
+        /** Validates the next chunk of input, [first, last).  Returns
+            valid().  Once an error has been found, later chunks are counted
+            but not examined.
+
+            \pre first <= last */
+        bool feed (char const * first, char const * last) noexcept
+        {
+            assert(first <= last);
+            std::ptrdiff_t const first_offset = offset_;
+            char const * const chunk_first = first;
+            offset_ += last - first;
+
+            if (!valid())
+                return false;
+
+            if (pending_size_) {
+                char buf[4];
+                int const size = top_up(buf, first, last);
+                if (detail::incomplete_code_point(buf, buf + size)) {
+                    keep_pending(buf, size);
+                    return true;
+                }
+                int const cp_bytes = code_point_bytes(*buf);
+                if (size < cp_bytes || !encoded(buf, buf + cp_bytes)) {
+                    error_offset_ = first_offset - pending_size_;
+                    pending_size_ = 0;
+                    return false;
+                }
+                first += cp_bytes - pending_size_;
+                pending_size_ = 0;
+            }
+
+            char const * const tail = detail::incomplete_tail(first, last);
+            char const * const it = find_invalid_encoding(first, tail);
+            if (it != tail) {
+                error_offset_ = first_offset + (it - chunk_first);
+                return false;
+            }
+            keep_pending(tail, last - tail);
+            return true;
+        }
+
+        /** Indicates that there is no more input.  An incomplete code point
+            at the end of the input is an error.  Returns valid(). */
+        bool finish () noexcept
+        {
+            if (valid() && pending_size_)
+                error_offset_ = offset_ - pending_size_;
+            pending_size_ = 0;
+            return valid();
+        }
+
+        /** Returns true if no error has been found so far. */
+        bool valid () const noexcept
+        { return error_offset_ < 0; }
+
+        /** Returns the offset of the first code point that is not properly
+            encoded, or -1 if no such code point has been found. */
+        std::ptrdiff_t error_offset () const noexcept
+        { return error_offset_; }
+
+        /** Returns the total number of code units passed to feed(). */
+        std::ptrdiff_t offset () const noexcept
+        { return offset_; }
+
+        /** Returns the number of code units at the end of the input so far
+            that form an incomplete code point.  These are validated once
+            the rest of the code point arrives. */
+        int pending_size () const noexcept
+        { return pending_size_; }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        int top_up (char * buf, char const * first, char const * last) const noexcept
+        {
+            int const n = (int)(std::min)(
+                std::ptrdiff_t(4 - pending_size_),
+                last - first
+            );
+            memcpy(buf, pending_, pending_size_);
+            memcpy(buf + pending_size_, first, n);
+            return pending_size_ + n;
+        }
+
+        void keep_pending (char const * first, std::ptrdiff_t n) noexcept
+        {
+            assert(n < 4);
+            memmove(pending_, first, n);
+            pending_size_ = (int)n;
+        }
+
+        std::ptrdiff_t offset_;
+        std::ptrdiff_t error_offset_;
+        char pending_[4];
+        int pending_size_;
+#endif
+
+    };
+
+    /** Decodes a UTF-8 sequence that arrives in chunks of arbitrary size
+        into UTF-32.  A code point split across two chunks is held back
+        until the rest of it arrives.  The resulting sequence of code points
+        is exactly the one to_utf32_iterator would produce from the
+        concatenation of all the chunks, including the replacement characters
+        produced for invalid sequences. */
+    struct stream_decoder
+    {
+        /** Default ctor.
+
+            \post pending_size() == 0 */
+        stream_decoder () noexcept : pending_size_ (0) {}
+
+        /** Decodes the next chunk of input, [first, last), writing the
+            resulting code points to out.  Returns the final value of out.
+
+            \pre first <= last */
+        template <typename OutIter>
+        OutIter feed (char const * first, char const * last, OutIter out)
+        {
+            assert(first <= last);
+
+            while (pending_size_) {
+                char buf[4];
+                int const n = (int)(std::min)(
+                    std::ptrdiff_t(4 - pending_size_),
+                    last - first
+                );
+                memcpy(buf, pending_, pending_size_);
+                memcpy(buf + pending_size_, first, n);
+                int const size = pending_size_ + n;
+                if (detail::incomplete_code_point(buf, buf + size)) {
+                    keep_pending(buf, size);
+                    return out;
+                }
+                char const * it = buf;
+                *out = detail::decode_code_point(it, buf + size);
+                ++out;
+                int const consumed = it - buf;
+                if (consumed < pending_size_) {
+                    keep_pending(pending_ + consumed, pending_size_ - consumed);
+                } else {
+                    first += consumed - pending_size_;
+                    pending_size_ = 0;
+                }
+            }
+
+            char const * const tail = detail::incomplete_tail(first, last);
+            out = transcode_to_utf32(first, tail, out).out;
+            keep_pending(tail, last - tail);
+            return out;
+        }
+
+        /** Indicates that there is no more input, and writes a replacement
+            character to out for any incomplete code point at the end of the
+            input.  Returns the final value of out.
+
+            \post pending_size() == 0 */
+        template <typename OutIter>
+        OutIter finish (OutIter out)
+        {
+            char const * it = pending_;
+            char const * const last = pending_ + pending_size_;
+            while (it != last) {
+                *out = detail::decode_code_point(it, last);
+                ++out;
+            }
+            pending_size_ = 0;
+            return out;
+        }
+
+        /** Returns the number of code units at the end of the input so far
+            that form an incomplete code point.  These are decoded once the
+            rest of the code point arrives, or by finish(). */
+        int pending_size () const noexcept
+        { return pending_size_; }
+
+#ifndef BOOST_TEXT_DOXYGEN
+
+    private:
+        void keep_pending (char const * first, std::ptrdiff_t n) noexcept
+        {
+            assert(n < 4);
+            memmove(pending_, first, n);
+            pending_size_ = (int)n;
+        }
+
+        char pending_[4];
+        int pending_size_;
+#endif
+
+    };
+
+} } }
+
+#endif
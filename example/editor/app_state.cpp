@@ -104,9 +104,8 @@ namespace {
             auto line_size = line_sizes[line];
             auto const line_end = advance_by_code_point(line_it, cols);
             auto const excess_units = line_size.code_units_ - int(line_end - line_it);
-            auto const excess_points = std::distance(
-                boost::text::utf8::to_utf32_iterator<Iter>(line_end),
-                boost::text::utf8::to_utf32_iterator<Iter>(line_end + excess_units)
+            auto const excess_points = boost::text::utf8::count_code_points(
+                line_end, line_end + excess_units
             );
             line_size.code_units_ -= excess_units;
             line_size.code_points_ -= excess_points;
@@ -5,6 +5,7 @@
 
 #include <boost/text/rope.hpp>
 #include <boost/text/segmented_vector.hpp>
+#include <boost/text/utf8_stream.hpp>
 #include <boost/filesystem/fstream.hpp>
 
 #include <vector>
@@ -87,13 +88,27 @@ inline buffer_t load (boost::filesystem::path path, int screen_width)
     snapshot_t snapshot;
     int line_size = 0;
     int line_cps = 0;
+    // The code units of a code point split across two reads are held back
+    // and prepended to the next chunk.
+    boost::text::utf8::stream_validator validator;
+    char carry[4];
+    int carry_size = 0;
     while (ifs.good()) {
         boost::text::text chunk;
         int const chunk_size = 1 << 16;
-        chunk.resize(chunk_size, ' ');
-        ifs.read(chunk.begin(), chunk_size);
-        if (!ifs.good())
-            chunk.resize(ifs.gcount(), ' ');
+        chunk.resize(carry_size + chunk_size, ' ');
+        std::copy(carry, carry + carry_size, chunk.begin());
+        ifs.read(chunk.begin() + carry_size, chunk_size);
+        int const read_size = ifs.gcount();
+        validator.feed(
+            chunk.begin() + carry_size,
+            chunk.begin() + carry_size + read_size
+        );
+        int const pending = ifs.good() ? validator.pending_size() : 0;
+        int const size = carry_size + read_size - pending;
+        std::copy(chunk.begin() + size, chunk.begin() + size + pending, carry);
+        carry_size = pending;
+        chunk.resize(size, ' ');
 
         auto prev_it = chunk.cbegin();
         auto it = prev_it;
@@ -103,10 +118,7 @@ inline buffer_t load (boost::filesystem::path path, int screen_width)
             auto it_for_counting_cps = it;
             if (it != chunk.end() && it != chunk.begin() && it[-1] == '\r')
                 --it_for_counting_cps;
-            line_cps += std::distance(
-                boost::text::utf8::to_utf32_iterator<boost::text::text::const_iterator>(prev_it),
-                boost::text::utf8::to_utf32_iterator<boost::text::text::const_iterator>(it_for_counting_cps)
-            );
+            line_cps += boost::text::utf8::count_code_points(prev_it, it_for_counting_cps);
             if (it != chunk.end())
                 ++it;
             line_size += it - prev_it;
@@ -114,7 +126,9 @@ inline buffer_t load (boost::filesystem::path path, int screen_width)
             auto prev_width_end = prev_it;
             while (screen_width < line_cps) {
                 line_cps -= screen_width;
-                auto const width_end = advance_by_code_point(prev_width_end, screen_width);
+                auto const width_end = boost::text::utf8::advance_code_points(
+                    prev_width_end, it, screen_width
+                );
                 int const code_units = width_end - prev_width_end;
                 line_size -= code_units;
                 snapshot.line_sizes_.push_back({code_units, screen_width});
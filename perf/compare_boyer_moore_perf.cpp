@@ -1,3 +1,6 @@
+#include <boost/text/algorithm.hpp>
+#include <boost/text/multi_searcher.hpp>
+#include <boost/text/searcher.hpp>
 #include <boost/text/text.hpp>
 #include <boost/algorithm/searching/boyer_moore.hpp>
 
@@ -7,6 +10,8 @@
 
 #include <algorithm>
 #include <iostream>
+#include <string>
+#include <vector>
 
 
 void BM_text_view_compare (benchmark::State & state)
@@ -34,6 +39,143 @@ void BM_text_view_boyer_moore (benchmark::State & state)
     }
 }
 
+void BM_text_view_find (benchmark::State & state)
+{
+    boost::text::text_view const pattern("!"); // Not in the string.
+    auto const & tv = text_views[state.range(0)];
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::find(tv, pattern));
+    }
+    state.SetBytesProcessed(state.iterations() * tv.size());
+}
+
+void BM_text_view_rfind (benchmark::State & state)
+{
+    boost::text::text_view const pattern("!"); // Not in the string.
+    auto const & tv = text_views[state.range(0)];
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::rfind(tv, pattern));
+    }
+    state.SetBytesProcessed(state.iterations() * tv.size());
+}
+
+// The string is all '.', so each position partially matches this pattern.
+char const long_pattern[] = "................!";
+
+void BM_text_view_boyer_moore_long (benchmark::State & state)
+{
+    auto const & tv = text_views[state.range(0)];
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::algorithm::boyer_moore_search(
+                tv.begin(), tv.end(),
+                long_pattern, long_pattern + sizeof(long_pattern) - 1
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * tv.size());
+}
+
+void BM_text_view_find_long (benchmark::State & state)
+{
+    boost::text::text_view const pattern(long_pattern);
+    auto const & tv = text_views[state.range(0)];
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::find(tv, pattern));
+    }
+    state.SetBytesProcessed(state.iterations() * tv.size());
+}
+
+void BM_text_view_rfind_long (benchmark::State & state)
+{
+    boost::text::text_view const pattern(long_pattern);
+    auto const & tv = text_views[state.range(0)];
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::rfind(tv, pattern));
+    }
+    state.SetBytesProcessed(state.iterations() * tv.size());
+}
+
+void BM_text_view_searcher_long (benchmark::State & state)
+{
+    boost::text::searcher const searcher((boost::text::text_view(long_pattern)));
+    auto const & tv = text_views[state.range(0)];
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::find(tv, searcher));
+    }
+    state.SetBytesProcessed(state.iterations() * tv.size());
+}
+
+void BM_rope_searcher_long (benchmark::State & state)
+{
+    boost::text::searcher const searcher((boost::text::text_view(long_pattern)));
+    boost::text::rope const r(text_views[state.range(0)]);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::find(r, searcher));
+    }
+    state.SetBytesProcessed(state.iterations() * r.size());
+}
+
+// Keywords, none of which are in the text.
+std::vector<std::string> make_keywords (int n)
+{
+    std::vector<std::string> retval;
+    for (int i = 0; i < n; ++i) {
+        retval.push_back("keyword" + std::to_string(i));
+    }
+    return retval;
+}
+
+std::vector<std::string> const keywords_8 = make_keywords(8);
+std::vector<std::string> const keywords_100 = make_keywords(100);
+
+void BM_text_view_find_each_keyword_8 (benchmark::State & state)
+{
+    auto const & tv = text_views[state.range(0)];
+    while (state.KeepRunning()) {
+        for (auto const & keyword : keywords_8) {
+            benchmark::DoNotOptimize(boost::text::find(tv, keyword));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * tv.size());
+}
+
+void BM_text_view_multi_searcher_8 (benchmark::State & state)
+{
+    boost::text::multi_searcher const searcher(keywords_8.begin(), keywords_8.end());
+    auto const & tv = text_views[state.range(0)];
+    int matches = 0;
+    while (state.KeepRunning()) {
+        foreach_match(tv, searcher, [&matches](boost::text::multi_match) { ++matches; });
+    }
+    benchmark::DoNotOptimize(matches);
+    state.SetBytesProcessed(state.iterations() * tv.size());
+}
+
+void BM_text_view_multi_searcher_100 (benchmark::State & state)
+{
+    boost::text::multi_searcher const searcher(keywords_100.begin(), keywords_100.end());
+    auto const & tv = text_views[state.range(0)];
+    int matches = 0;
+    while (state.KeepRunning()) {
+        foreach_match(tv, searcher, [&matches](boost::text::multi_match) { ++matches; });
+    }
+    benchmark::DoNotOptimize(matches);
+    state.SetBytesProcessed(state.iterations() * tv.size());
+}
+
+void BM_rope_multi_searcher_100 (benchmark::State & state)
+{
+    boost::text::multi_searcher const searcher(keywords_100.begin(), keywords_100.end());
+    boost::text::rope const r(text_views[state.range(0)]);
+    int matches = 0;
+    while (state.KeepRunning()) {
+        foreach_match(r, searcher, [&matches](boost::text::multi_match) { ++matches; });
+    }
+    benchmark::DoNotOptimize(matches);
+    state.SetBytesProcessed(state.iterations() * r.size());
+}
+
 void BM_text_compare (benchmark::State & state)
 {
     auto const & current = text_views[state.range(0)];
@@ -111,6 +253,17 @@ void BM_rope_view_boyer_moore (benchmark::State & state)
 
 BENCHMARK(BM_text_view_compare) BENCHMARK_ARGS();
 BENCHMARK(BM_text_view_boyer_moore) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_find) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_rfind) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_boyer_moore_long) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_find_long) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_rfind_long) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_searcher_long) BENCHMARK_ARGS();
+BENCHMARK(BM_rope_searcher_long) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_find_each_keyword_8) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_multi_searcher_8) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_multi_searcher_100) BENCHMARK_ARGS();
+BENCHMARK(BM_rope_multi_searcher_100) BENCHMARK_ARGS();
 BENCHMARK(BM_text_compare) BENCHMARK_ARGS();
 BENCHMARK(BM_text_boyer_moore) BENCHMARK_ARGS();
 BENCHMARK(BM_rope_compare) BENCHMARK_ARGS();
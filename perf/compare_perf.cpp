@@ -0,0 +1,100 @@
+#include <boost/text/rope.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+    // A rope of about 1MB, in segments of 4KB.
+    boost::text::rope make_rope (char last)
+    {
+        boost::text::rope retval;
+        for (int i = 0; i < 256; ++i) {
+            std::string s(4096, 'a');
+            s[i % 4096] = 'b';
+            retval += boost::text::text(s);
+        }
+        retval += boost::text::text(std::string(1000, 'a') + last);
+        return retval;
+    }
+
+    boost::text::rope const rope_1 = make_rope('x');
+
+    // The same chars as rope_1, in a different tree.
+    boost::text::rope const rope_2 = make_rope('x');
+
+    // Differs from rope_1 only in its last char.
+    boost::text::rope const rope_3 = make_rope('y');
+
+    // Shares all but its last leaf with rope_1.
+    boost::text::rope const rope_4 = [] {
+        boost::text::rope retval = rope_1;
+        retval.replace(
+            boost::text::rope_view(retval, retval.size() - 1, retval.size()),
+            "y"
+        );
+        return retval;
+    }();
+
+    // Many short ropes, most with the same long prefix.
+    std::vector<boost::text::rope> make_ropes ()
+    {
+        std::mt19937 gen(1);
+        std::vector<boost::text::rope> retval;
+        for (int i = 0; i < 10000; ++i) {
+            boost::text::rope r(boost::text::text(std::string(300, 'a')));
+            r += boost::text::text(std::to_string(gen() % 5000));
+            retval.push_back(r);
+        }
+        return retval;
+    }
+
+    std::vector<boost::text::rope> const ropes = make_ropes();
+
+}
+
+void BM_rope_compare_same_chars (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(rope_1.compare(rope_2));
+    }
+    state.SetBytesProcessed(state.iterations() * rope_1.size());
+}
+
+void BM_rope_compare_last_char_differs (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(rope_1.compare(rope_3));
+    }
+    state.SetBytesProcessed(state.iterations() * rope_1.size());
+}
+
+void BM_rope_compare_shared_tree (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(rope_1.compare(rope_4));
+    }
+    state.SetBytesProcessed(state.iterations() * rope_1.size());
+}
+
+void BM_rope_sort_unique (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        std::vector<boost::text::rope> v = ropes;
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+        benchmark::DoNotOptimize(v.size());
+    }
+}
+
+BENCHMARK(BM_rope_compare_same_chars);
+BENCHMARK(BM_rope_compare_last_char_differs);
+BENCHMARK(BM_rope_compare_shared_tree);
+BENCHMARK(BM_rope_sort_unique);
+
+BENCHMARK_MAIN()
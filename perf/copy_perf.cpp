@@ -25,6 +25,28 @@ void BM_text_copy (benchmark::State & state)
     }
 }
 
+// Copies of a text of up to 15 chars do not allocate; range(0) is the
+// length.
+void BM_text_copy_short (benchmark::State & state)
+{
+    boost::text::text const t(std::string(state.range(0), '.'));
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::text(t));
+    }
+}
+
+// Moves never allocate, but a short text's chars are copied along with
+// it.
+void BM_text_move (benchmark::State & state)
+{
+    boost::text::text t(std::string(state.range(0), '.'));
+    while (state.KeepRunning()) {
+        boost::text::text moved(std::move(t));
+        benchmark::DoNotOptimize(moved.begin());
+        t = std::move(moved);
+    }
+}
+
 void BM_rope_copy (benchmark::State & state)
 {
     while (state.KeepRunning()) {
@@ -45,6 +67,8 @@ void BM_rope_view_copy (benchmark::State & state)
 
 BENCHMARK(BM_text_view_copy) BENCHMARK_ARGS();
 BENCHMARK(BM_text_copy) BENCHMARK_ARGS();
+BENCHMARK(BM_text_copy_short)->Arg(1)->Arg(8)->Arg(15)->Arg(16)->Arg(24);
+BENCHMARK(BM_text_move)->Arg(8)->Arg(24);
 BENCHMARK(BM_rope_copy) BENCHMARK_ARGS();
 BENCHMARK(BM_rope_view_copy) BENCHMARK_ARGS();
 
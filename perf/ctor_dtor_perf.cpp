@@ -5,6 +5,7 @@
 #include <benchmark/benchmark.h>
 
 #include <iostream>
+#include <vector>
 
 
 void BM_text_view_ctor_dtor (benchmark::State & state)
@@ -41,6 +42,34 @@ void BM_text_ctor_dtor (benchmark::State & state)
     }
 }
 
+// A text of up to 15 chars is stored within the text object, so it is
+// constructed and destroyed without allocating; range(0) is the length.
+void BM_text_ctor_dtor_short (benchmark::State & state)
+{
+    std::string const s(state.range(0), '.');
+    boost::text::text_view const tv(s);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::text(tv));
+    }
+}
+
+// Builds a vector of 1000 short texts, as when splitting a line into
+// fields.
+void BM_text_vector_of_short (benchmark::State & state)
+{
+    std::string const s(state.range(0), '.');
+    boost::text::text_view const tv(s);
+    std::vector<boost::text::text> texts;
+    texts.reserve(1000);
+    while (state.KeepRunning()) {
+        texts.clear();
+        for (int i = 0; i < 1000; ++i) {
+            texts.emplace_back(tv);
+        }
+        benchmark::DoNotOptimize(texts.data());
+    }
+}
+
 void BM_rope_ctor_dtor (benchmark::State & state)
 {
     while (state.KeepRunning()) {
@@ -59,10 +88,34 @@ void BM_rope_view_ctor_dtor (benchmark::State & state)
     }
 }
 
+#define LITERAL_64 \
+    "When writing a specialization, be careful about its location; or"
+
+void BM_text_from_c_str_literal (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::text(LITERAL_64));
+    }
+}
+
+void BM_text_from_checked_literal (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::text(BOOST_TEXT_LITERAL(LITERAL_64))
+        );
+    }
+}
+
 BENCHMARK(BM_text_view_ctor_dtor) BENCHMARK_ARGS();
 BENCHMARK(BM_text_view_ctor_dtor_unchecked) BENCHMARK_ARGS();
 
 BENCHMARK(BM_text_ctor_dtor) BENCHMARK_ARGS();
+BENCHMARK(BM_text_ctor_dtor_short)->Arg(1)->Arg(8)->Arg(15)->Arg(16)->Arg(24);
+BENCHMARK(BM_text_vector_of_short)->Arg(8)->Arg(15)->Arg(16)->Arg(24);
+
+BENCHMARK(BM_text_from_c_str_literal);
+BENCHMARK(BM_text_from_checked_literal);
 
 BENCHMARK(BM_rope_ctor_dtor) BENCHMARK_ARGS();
 
@@ -1,3 +1,6 @@
+#include <boost/text/algorithm.hpp>
+#include <boost/text/rope_algorithm.hpp>
+#include <boost/text/split.hpp>
 #include <boost/text/text.hpp>
 
 #include "text_objects.hpp"
@@ -6,6 +9,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <string>
 
 
 void BM_text_view_for (benchmark::State & state)
@@ -104,13 +108,324 @@ void BM_rope_view_std_find (benchmark::State & state)
     }
 }
 
+void BM_text_view_find_first_of (benchmark::State & state)
+{
+    // None of these delimiters are in the string.
+    boost::text::text_view const delimiters(",;|\t\n\"'");
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::find_first_of(text_views[state.range(0)], delimiters)
+        );
+    }
+}
+
+void BM_text_view_find_last_not_of (benchmark::State & state)
+{
+    // All of the string is in this set.
+    boost::text::text_view const set(".,;:!?-_ ");
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::find_last_not_of(text_views[state.range(0)], set)
+        );
+    }
+}
+
+void BM_text_view_find_first_of_code_point_set (benchmark::State & state)
+{
+    // None of these code points are in the string.
+    boost::text::code_point_set const set{0xa7, 0x2014, 0x2026, 0x1f600};
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::find_first_of(text_views[state.range(0)], set)
+        );
+    }
+}
+
+void BM_rope_find (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::find(ropes[state.range(0)], "!") // Not in the string.
+        );
+    }
+}
+
+void BM_rope_rfind (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::rfind(ropes[state.range(0)], "..!") // Not in the string.
+        );
+    }
+}
+
+void BM_rope_find_first_of (benchmark::State & state)
+{
+    // None of these delimiters are in the string.
+    boost::text::text_view const delimiters(",;|\t\n\"'");
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::find_first_of(ropes[state.range(0)], delimiters)
+        );
+    }
+}
+
+void BM_rope_view_find (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::find(rope_views[state.range(0)], "!") // Not in the string.
+        );
+    }
+}
+
+namespace {
+
+    // About 1MB of short words separated by spaces, in lines of about 70
+    // chars.
+    std::string make_words ()
+    {
+        char const * const words[] = {
+            "the", "quick", "brown", "fox", "jumps", "over", "a", "lazy",
+            "dog", "and", "then", "sleeps"
+        };
+        std::string retval;
+        int line_size = 0;
+        for (int i = 0; retval.size() < 1u << 20; ++i) {
+            std::string const word = words[(i * 7) % 12];
+            retval += word;
+            line_size += word.size() + 1;
+            if (70 < line_size) {
+                retval += '\n';
+                line_size = 0;
+            } else {
+                retval += ' ';
+            }
+        }
+        return retval;
+    }
+
+    std::string const words_string = make_words();
+    boost::text::text_view const words(words_string.c_str());
+
+    boost::text::rope make_words_rope ()
+    {
+        // Chunks larger than text_insert_max stay separate segments.
+        boost::text::rope retval;
+        for (std::ptrdiff_t i = 0; i < words.size(); i += 4096) {
+            std::ptrdiff_t const hi = (std::min)(i + 4096, words.size());
+            retval += boost::text::text(words(i, hi));
+        }
+        return retval;
+    }
+
+}
+
+void BM_text_view_split_find_loop (benchmark::State & state)
+{
+    int x = 0;
+    while (state.KeepRunning()) {
+        boost::text::text_view remaining = words;
+        while (true) {
+            int const n = boost::text::find(remaining, " ");
+            if (n < 0) {
+                x += remaining.size();
+                break;
+            }
+            x += remaining(0, n).size();
+            remaining = remaining(n + 1, remaining.size());
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+    benchmark::DoNotOptimize(x);
+}
+
+void BM_text_view_split (benchmark::State & state)
+{
+    int x = 0;
+    while (state.KeepRunning()) {
+        for (boost::text::text_view word : boost::text::split(words, " ")) {
+            x += word.size();
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+    benchmark::DoNotOptimize(x);
+}
+
+void BM_text_view_find_all (benchmark::State & state)
+{
+    int x = 0;
+    while (state.KeepRunning()) {
+        for (boost::text::text_view match : boost::text::find_all(words, "fox")) {
+            x += match.size();
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+    benchmark::DoNotOptimize(x);
+}
+
+void BM_text_view_lines (benchmark::State & state)
+{
+    int x = 0;
+    while (state.KeepRunning()) {
+        for (boost::text::text_view line : boost::text::lines(words)) {
+            x += line.size();
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+    benchmark::DoNotOptimize(x);
+}
+
+void BM_rope_lines (benchmark::State & state)
+{
+    boost::text::rope const r = make_words_rope();
+    int x = 0;
+    while (state.KeepRunning()) {
+        for (boost::text::rope_view line : boost::text::lines(r)) {
+            x += line.size();
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+    benchmark::DoNotOptimize(x);
+}
+
+void BM_rope_replace_find_loop (benchmark::State & state)
+{
+    boost::text::rope const original = make_words_rope();
+    boost::text::text_view const replacement("cat");
+    int x = 0;
+    while (state.KeepRunning()) {
+        boost::text::rope r = original;
+        std::ptrdiff_t n = 0;
+        while (true) {
+            std::ptrdiff_t const match = boost::text::find(r(n, r.size()), "fox");
+            if (match < 0)
+                break;
+            n += match;
+            r.replace(r(n, n + 3), replacement);
+            n += replacement.size();
+        }
+        x += r.size();
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+    benchmark::DoNotOptimize(x);
+}
+
+void BM_rope_replace_all (benchmark::State & state)
+{
+    boost::text::rope const original = make_words_rope();
+    int x = 0;
+    while (state.KeepRunning()) {
+        boost::text::rope r = original;
+        boost::text::replace_all(r, "fox", "cat");
+        x += r.size();
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+    benchmark::DoNotOptimize(x);
+}
+
+namespace {
+
+    char const * const header_names[] = {
+        "Host", "User-Agent", "Accept", "Accept-Language", "Accept-Encoding",
+        "Connection", "Content-Type", "Content-Length", "Cache-Control",
+        "Cookie"
+    };
+
+    boost::text::text lower_copy (boost::text::text_view tv)
+    {
+        boost::text::text retval(tv);
+        for (char & c : retval) {
+            if ('A' <= c && c <= 'Z')
+                c = c - 'A' + 'a';
+        }
+        return retval;
+    }
+
+}
+
+void BM_header_equal_lower_copy (benchmark::State & state)
+{
+    boost::text::text_view const name("content-length");
+    int x = 0;
+    while (state.KeepRunning()) {
+        for (char const * header : header_names) {
+            x += lower_copy(header) == name;
+        }
+    }
+    benchmark::DoNotOptimize(x);
+}
+
+void BM_header_equal_ascii_icase (benchmark::State & state)
+{
+    boost::text::text_view const name("content-length");
+    int x = 0;
+    while (state.KeepRunning()) {
+        for (char const * header : header_names) {
+            x += boost::text::equal_ascii_icase(boost::text::text_view(header), name);
+        }
+    }
+    benchmark::DoNotOptimize(x);
+}
+
+void BM_text_view_find_lower_copy (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::find(lower_copy(words), "lazy dog and then fox"));
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+}
+
+void BM_text_view_find_ascii_icase (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::find_ascii_icase(words, "LAZY Dog and then fox"));
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+}
+
+void BM_text_view_compare_ascii_icase (benchmark::State & state)
+{
+    boost::text::text const upper = [] {
+        boost::text::text retval(words);
+        for (char & c : retval) {
+            if ('a' <= c && c <= 'z')
+                c = c - 'a' + 'A';
+        }
+        return retval;
+    }();
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(boost::text::compare_ascii_icase(words, upper));
+    }
+    state.SetBytesProcessed(state.iterations() * words.size());
+}
+
 BENCHMARK(BM_text_view_for) BENCHMARK_ARGS();
 BENCHMARK(BM_text_view_std_find) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_find_first_of) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_find_last_not_of) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_find_first_of_code_point_set) BENCHMARK_ARGS();
 BENCHMARK(BM_text_for) BENCHMARK_ARGS();
 BENCHMARK(BM_text_std_find) BENCHMARK_ARGS();
 BENCHMARK(BM_rope_for) BENCHMARK_ARGS();
 BENCHMARK(BM_rope_std_find) BENCHMARK_ARGS();
+BENCHMARK(BM_rope_find) BENCHMARK_ARGS();
+BENCHMARK(BM_rope_rfind) BENCHMARK_ARGS();
+BENCHMARK(BM_rope_find_first_of) BENCHMARK_ARGS();
 BENCHMARK(BM_rope_view_for) BENCHMARK_ARGS();
+BENCHMARK(BM_rope_view_find) BENCHMARK_ARGS();
 BENCHMARK(BM_rope_view_std_find) BENCHMARK_ARGS();
+BENCHMARK(BM_text_view_split_find_loop);
+BENCHMARK(BM_text_view_split);
+BENCHMARK(BM_text_view_find_all);
+BENCHMARK(BM_text_view_lines);
+BENCHMARK(BM_rope_lines);
+BENCHMARK(BM_rope_replace_find_loop);
+BENCHMARK(BM_rope_replace_all);
+BENCHMARK(BM_header_equal_lower_copy);
+BENCHMARK(BM_header_equal_ascii_icase);
+BENCHMARK(BM_text_view_find_lower_copy);
+BENCHMARK(BM_text_view_find_ascii_icase);
+BENCHMARK(BM_text_view_compare_ascii_icase);
 
 BENCHMARK_MAIN()
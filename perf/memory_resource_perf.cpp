@@ -0,0 +1,76 @@
+#include <boost/text/memory_resource.hpp>
+#include <boost/text/rope.hpp>
+#include <boost/text/segmented_vector.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+
+namespace {
+
+    std::vector<std::string> make_pieces ()
+    {
+        std::vector<std::string> retval;
+        for (int i = 0; i < 64; ++i) {
+            retval.push_back(std::string(20 + i * 3, 'a' + i % 26));
+        }
+        return retval;
+    }
+
+    std::vector<std::string> const pieces = make_pieces();
+
+    // The work of one request: editing a rope made of many small inserts
+    // and erases, building texts from pieces of it, and indexing them.
+    void edit_workload ()
+    {
+        boost::text::rope r;
+        for (int i = 0; i < 400; ++i) {
+            std::string const & piece = pieces[i % pieces.size()];
+            r.insert(r.size() / 3, boost::text::text(piece));
+            if (i % 8 == 7)
+                r.erase(r(r.size() / 2, r.size() / 2 + 50));
+        }
+
+        std::vector<boost::text::text> texts;
+        texts.reserve(200);
+        for (int i = 0; i < 200; ++i) {
+            int const lo = i * 37 % (r.size() - 200);
+            texts.push_back(boost::text::text());
+            texts.back() += r(lo, lo + 100 + i % 50);
+        }
+
+        boost::text::segmented_vector<int> offsets;
+        for (int i = 0; i < 2000; ++i) {
+            offsets.insert(offsets.begin() + offsets.size() / 2, i);
+        }
+
+        benchmark::DoNotOptimize(r.size());
+        benchmark::DoNotOptimize(texts.data());
+        benchmark::DoNotOptimize(offsets.size());
+    }
+
+}
+
+void BM_edit_heap (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        edit_workload();
+    }
+}
+
+// One monotonic arena per request, freed all at once at the end of it.
+void BM_edit_arena (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        boost::text::monotonic_buffer_resource arena(1 << 16);
+        boost::text::default_resource_guard guard(&arena);
+        edit_workload();
+    }
+}
+
+BENCHMARK(BM_edit_heap);
+BENCHMARK(BM_edit_arena);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,87 @@
+#include <boost/text/parallel_algorithm.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <thread>
+
+
+namespace {
+
+    // 1GB of short words separated by spaces and newlines, in 1MB texts,
+    // none of which is a copy of another.
+    boost::text::rope make_rope ()
+    {
+        char const * const words[] = {
+            "the", "quick", "brown", "fox", "jumps", "over", "a", "lazy",
+            "dog", "and", "then", "sleeps"
+        };
+        boost::text::rope retval;
+        int i = 0;
+        for (int j = 0; j < 1024; ++j) {
+            std::string s;
+            while (s.size() < 1u << 20) {
+                s += words[(i * 7) % 12];
+                s += ++i % 12 ? ' ' : '\n';
+            }
+            retval += boost::text::text(s);
+        }
+        return retval;
+    }
+
+    boost::text::rope const & rope_1gb ()
+    {
+        static boost::text::rope const retval = make_rope();
+        return retval;
+    }
+
+}
+
+void BM_rope_parallel_find (benchmark::State & state)
+{
+    boost::text::rope const & r = rope_1gb();
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::parallel_find(r, "!", state.range(0)) // Not in the rope.
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * r.size());
+}
+
+void BM_rope_parallel_count (benchmark::State & state)
+{
+    boost::text::rope const & r = rope_1gb();
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::parallel_count(r, "lazy dog", state.range(0))
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * r.size());
+}
+
+void BM_rope_parallel_find_all (benchmark::State & state)
+{
+    boost::text::rope const & r = rope_1gb();
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::parallel_find_all(r, "lazy dog", state.range(0))
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * r.size());
+}
+
+// From 1 thread up to twice the number of cores.
+void thread_counts (benchmark::internal::Benchmark * b)
+{
+    int const cores = (std::max)(std::thread::hardware_concurrency(), 1u);
+    for (int threads = 1; threads < 2 * cores; threads *= 2) {
+        b->Arg(threads);
+    }
+    b->Arg(2 * cores);
+}
+
+BENCHMARK(BM_rope_parallel_find)->Apply(thread_counts)->UseRealTime();
+BENCHMARK(BM_rope_parallel_count)->Apply(thread_counts)->UseRealTime();
+BENCHMARK(BM_rope_parallel_find_all)->Apply(thread_counts)->UseRealTime();
+
+BENCHMARK_MAIN()
@@ -31,3 +31,4 @@ copy_file('copy_perf.json')
 copy_file('insert_erase_perf.json')
 copy_file('for_find_perf.json')
 copy_file('compare_boyer_moore_perf.json')
+copy_file('utf8_perf.json')
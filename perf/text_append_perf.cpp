@@ -0,0 +1,87 @@
+#include <boost/text/rope.hpp>
+#include <boost/text/utf8.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+    // A 100 MB rope of 64 KB text segments.
+    boost::text::rope make_rope ()
+    {
+        boost::text::rope retval;
+        for (int i = 0; i < 1600; ++i) {
+            retval += boost::text::text(std::string(1 << 16, 'a' + i % 26));
+        }
+        return retval;
+    }
+
+    boost::text::rope const big_rope = make_rope();
+
+    std::vector<uint32_t> make_utf32 ()
+    {
+        uint32_t const cps[] = {0x4d, 0x430, 0x4e8c, 0x10302};
+        std::vector<uint32_t> retval;
+        for (int i = 0; i < (1 << 18); ++i) {
+            retval.push_back(cps[i % 4]);
+        }
+        return retval;
+    }
+
+    std::vector<uint32_t> const utf32 = make_utf32();
+
+}
+
+void BM_append_rope (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        boost::text::text t("prefix");
+        t += big_rope;
+        benchmark::DoNotOptimize(t.begin());
+    }
+    state.SetBytesProcessed(state.iterations() * big_rope.size());
+}
+
+void BM_insert_rope_view_middle (benchmark::State & state)
+{
+    boost::text::rope_view const rv = big_rope(1000, 1000 + (1 << 20));
+    boost::text::text const initial(std::string(1 << 16, 'x'));
+    while (state.KeepRunning()) {
+        boost::text::text t = initial;
+        t.insert(t.size() / 2, rv.begin(), rv.end());
+        benchmark::DoNotOptimize(t.begin());
+    }
+    state.SetBytesProcessed(state.iterations() * rv.size());
+}
+
+void BM_append_from_utf32 (benchmark::State & state)
+{
+    using iter_t = boost::text::utf8::from_utf32_iterator<uint32_t const *>;
+    while (state.KeepRunning()) {
+        boost::text::text t;
+        t.insert(0, iter_t(utf32.data()), iter_t(utf32.data() + utf32.size()));
+        benchmark::DoNotOptimize(t.begin());
+    }
+}
+
+void BM_replace_from_utf32 (benchmark::State & state)
+{
+    using iter_t = boost::text::utf8::from_utf32_iterator<uint32_t const *>;
+    boost::text::text const initial(std::string(1 << 16, 'x'));
+    while (state.KeepRunning()) {
+        boost::text::text t = initial;
+        t.replace(t.begin() + 100, t.begin() + 200, iter_t(utf32.data()), iter_t(utf32.data() + 4096));
+        benchmark::DoNotOptimize(t.begin());
+    }
+}
+
+BENCHMARK(BM_append_rope);
+BENCHMARK(BM_insert_rope_view_middle);
+BENCHMARK(BM_append_from_utf32);
+BENCHMARK(BM_replace_from_utf32);
+
+BENCHMARK_MAIN()
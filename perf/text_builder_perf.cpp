@@ -0,0 +1,91 @@
+#include <boost/text/text_builder.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+
+
+namespace {
+
+    // A JSON array of records, each made of a dozen small fragments.
+    int const records = 10000;
+
+    boost::text::text_view const names[] = {"alpha", "beta", "gamma", "δέλτα"};
+
+}
+
+void BM_json_text_append (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        boost::text::text t;
+        t += "[";
+        for (int i = 0; i < records; ++i) {
+            char buf[32];
+            t += "{\"id\":";
+            t += boost::text::text_view(buf, std::snprintf(buf, sizeof(buf), "%d", i));
+            t += ",\"name\":\"";
+            t += names[i % 4];
+            t += "\",\"score\":";
+            t += boost::text::text_view(buf, std::snprintf(buf, sizeof(buf), "%.17g", i * 0.25));
+            t += "},";
+        }
+        t += "]";
+        benchmark::DoNotOptimize(t.begin());
+    }
+}
+
+void BM_json_text_builder (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        boost::text::text_builder b;
+        b.append('[');
+        for (int i = 0; i < records; ++i) {
+            b.append("{\"id\":").append(i)
+                .append(",\"name\":\"").append(names[i % 4])
+                .append("\",\"score\":").append(i * 0.25)
+                .append("},");
+        }
+        b.append(']');
+        boost::text::text const t = b.finish();
+        benchmark::DoNotOptimize(t.begin());
+    }
+}
+
+void BM_json_text_builder_no_numbers (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        boost::text::text_builder b;
+        b.append('[');
+        for (int i = 0; i < records; ++i) {
+            b.append("{\"id\":").append(",\"name\":\"").append(names[i % 4])
+                .append("\",\"score\":").append("},");
+        }
+        b.append(']');
+        boost::text::text const t = b.finish();
+        benchmark::DoNotOptimize(t.begin());
+    }
+}
+
+void BM_json_text_append_no_numbers (benchmark::State & state)
+{
+    while (state.KeepRunning()) {
+        boost::text::text t;
+        t += "[";
+        for (int i = 0; i < records; ++i) {
+            t += "{\"id\":";
+            t += ",\"name\":\"";
+            t += names[i % 4];
+            t += "\",\"score\":";
+            t += "},";
+        }
+        t += "]";
+        benchmark::DoNotOptimize(t.begin());
+    }
+}
+
+BENCHMARK(BM_json_text_append);
+BENCHMARK(BM_json_text_builder);
+BENCHMARK(BM_json_text_append_no_numbers);
+BENCHMARK(BM_json_text_builder_no_numbers);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,745 @@
+#include <boost/text/code_point_index.hpp>
+#include <boost/text/text.hpp>
+#include <boost/text/transcode.hpp>
+#include <boost/text/utf8_stream.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+    std::string make_corpus (char const * sample, int size)
+    {
+        std::string retval;
+        while ((int)retval.size() < size)
+            retval += sample;
+        // Don't leave a partial code point at the end.
+        while (!boost::text::utf8::ends_encoded(
+                   &*retval.begin(), &*retval.begin() + size)) {
+            --size;
+        }
+        retval.resize(size);
+        return retval;
+    }
+
+    int const corpus_size = 1 << 20;
+
+    std::string const ascii_corpus = make_corpus(
+        "The quick brown fox jumps over the lazy dog. ",
+        corpus_size
+    );
+
+    std::string const mixed_corpus = make_corpus(
+        "English text, "
+        "\xd0\xa0\xd1\x83\xd1\x81\xd1\x81\xd0\xba\xd0\xb8\xd0\xb9 "   // Русский
+        "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e "                       // 日本語
+        "\xf0\x9f\x98\x80\xf0\x9f\x8e\x89 ",                          // emoji
+        corpus_size
+    );
+
+    std::string const cyrillic_corpus = make_corpus(
+        "\xd0\xa0\xd1\x83\xd1\x81\xd1\x81\xd0\xba\xd0\xb8\xd0\xb9 "   // Русский
+        "\xd1\x82\xd0\xb5\xd0\xba\xd1\x81\xd1\x82, ",                   // текст,
+        corpus_size
+    );
+
+    std::string const latin1_corpus = make_corpus(
+        "\xc3\x87" "a \xc3\xa9t\xc3\xa9 tr\xc3\xa8s na\xc3\xafve, "          // Ça été très naïve,
+        "\xc3\xa0 la fa\xc3\xa7on d'une cr\xc3\xa8me br\xc3\xbbl\xc3\xa9" "e. " // à la façon d'une crème brûlée.
+        "Stra\xc3\x9f" "e, \xc3\x98resund, se\xc3\xb1or. ",                  // Straße, Øresund, señor.
+        corpus_size
+    );
+
+    std::string const cjk_corpus = make_corpus(
+        "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe3\x83\x86\xe3\x82\xad"  // 日本語のテキ
+        "\xe3\x82\xb9\xe3\x83\x88\xe3\x81\xa8\xe4\xb8\xad\xe6\x96\x87\xe6\x96\x87"  // ストと中文文
+        "\xe6\x9c\xac\xef\xbc\x8c\xed\x95\x9c\xea\xb5\xad\xec\x96\xb4 "             // 本，한국어
+        "\xed\x85\x8d\xec\x8a\xa4\xed\x8a\xb8\xe3\x80\x82",                         // 텍스트。
+        corpus_size
+    );
+
+    std::string const emoji_corpus = make_corpus(
+        "\xf0\x9f\x98\x80\xf0\x9f\x8e\x89\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd"  // 😀🎉👍🏽
+        "\xf0\x9f\x9a\x80\xe2\x9d\xa4\xef\xb8\x8f\xf0\x9f\x8c\x8d ",         // 🚀❤️🌍
+        corpus_size
+    );
+
+    // mixed_corpus, with a stray initial code unit and an invalid code unit
+    // in every 100 code units.  These may land inside other code points,
+    // leaving orphaned continuation code units behind as well.
+    std::string make_invalid_corpus ()
+    {
+        std::string retval = mixed_corpus;
+        for (std::size_t i = 0; i + 50 < retval.size(); i += 100) {
+            retval[i] = '\xe4';
+            retval[i + 50] = '\xff';
+        }
+        return retval;
+    }
+
+    std::string const invalid_corpus = make_invalid_corpus();
+
+    // Benchmarks that take a corpus index accept the values below.  Only
+    // invalid_corpus is not valid UTF-8.
+    std::string const & corpus (int i)
+    {
+        switch (i) {
+        case 0: return ascii_corpus;
+        case 1: return cyrillic_corpus;
+        case 2: return mixed_corpus;
+        case 3: return latin1_corpus;
+        case 4: return cjk_corpus;
+        case 5: return emoji_corpus;
+        default: return invalid_corpus;
+        }
+    }
+
+}
+
+void BM_find_invalid_encoding_scalar_ascii (benchmark::State & state)
+{
+    char const * const first = ascii_corpus.c_str();
+    char const * const last = first + state.range(0);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::detail::find_invalid_encoding_scalar(first, last)
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_find_invalid_encoding_ascii (benchmark::State & state)
+{
+    char const * const first = ascii_corpus.c_str();
+    char const * const last = first + state.range(0);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::find_invalid_encoding(first, last)
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_find_invalid_encoding_scalar_mixed (benchmark::State & state)
+{
+    char const * const first = mixed_corpus.c_str();
+    char const * const last = first + state.range(0);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::detail::find_invalid_encoding_scalar(first, last)
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_find_invalid_encoding_mixed (benchmark::State & state)
+{
+    char const * const first = mixed_corpus.c_str();
+    char const * const last = first + state.range(0);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::find_invalid_encoding(first, last)
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// The remaining benchmarks take a corpus index: 0 = ASCII, 1 = Cyrillic, 2
+// = mixed, 3 = Latin-1, 4 = CJK, 5 = emoji, 6 = mixed with invalid code
+// units.
+
+void BM_encoded (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::encoded(str.c_str(), str.c_str() + str.size())
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+// Finds every invalid code point, not just the first one, so that the
+// invalid corpus is scanned all the way through.
+void BM_find_all_invalid_encodings (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    char const * const last = str.c_str() + str.size();
+    while (state.KeepRunning()) {
+        int invalid = 0;
+        char const * it = str.c_str();
+        while ((it = boost::text::utf8::find_invalid_encoding(it, last)) != last) {
+            ++invalid;
+            ++it;
+        }
+        benchmark::DoNotOptimize(invalid);
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+
+void BM_to_utf32_iterator (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint32_t> out(str.size());
+    using iter_t = boost::text::utf8::to_utf32_iterator<char const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            std::copy(
+                iter_t(str.c_str()), iter_t(str.c_str() + str.size()),
+                out.begin()
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_forward_code_points (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint32_t> out(str.size());
+    auto const range = boost::text::utf8::forward_code_points(
+        str.c_str(), str.c_str() + str.size()
+    );
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            std::copy(range.begin(), range.end(), out.begin())
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+// The distance benchmarks count code points by decoding them, as
+// single-pass consumers such as tokenizers do.
+
+void BM_to_utf32_iterator_distance (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    using iter_t = boost::text::utf8::to_utf32_iterator<char const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            std::distance(iter_t(str.c_str()), iter_t(str.c_str() + str.size()))
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_forward_code_points_distance (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    auto const range = boost::text::utf8::forward_code_points(
+        str.c_str(), str.c_str() + str.size()
+    );
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(std::distance(range.begin(), range.end()));
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_transcode_to_utf32 (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint32_t> out(str.size());
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::transcode_to_utf32(
+                str.c_str(), str.c_str() + str.size(),
+                out.data(), out.data() + out.size()
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_to_utf16_iterator (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint16_t> out(str.size());
+    using iter_t = boost::text::utf8::to_utf16_iterator<char const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            std::copy(
+                iter_t(str.c_str()), iter_t(str.c_str() + str.size()),
+                out.begin()
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_transcode_to_utf16 (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint16_t> out(str.size());
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::transcode_to_utf16(
+                str.c_str(), str.c_str() + str.size(),
+                out.data(), out.data() + out.size()
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_from_utf16_iterator (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint16_t> utf16;
+    boost::text::utf8::transcode_to_utf16(
+        str.c_str(), str.c_str() + str.size(), std::back_inserter(utf16)
+    );
+    std::string out(str.size(), '\0');
+    using iter_t = boost::text::utf8::from_utf16_iterator<uint16_t const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            std::copy(
+                iter_t(utf16.data()), iter_t(utf16.data() + utf16.size()),
+                out.begin()
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_transcode_from_utf16 (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint16_t> utf16;
+    boost::text::utf8::transcode_to_utf16(
+        str.c_str(), str.c_str() + str.size(), std::back_inserter(utf16)
+    );
+    std::string out(str.size(), '\0');
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::transcode_from_utf16(
+                utf16.data(), utf16.data() + utf16.size(),
+                &out[0], &out[0] + out.size()
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_from_utf32_iterator (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint32_t> utf32;
+    boost::text::utf8::transcode_to_utf32(
+        str.c_str(), str.c_str() + str.size(), std::back_inserter(utf32)
+    );
+    std::string out(str.size(), '\0');
+    using iter_t = boost::text::utf8::from_utf32_iterator<uint32_t const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            std::copy(
+                iter_t(utf32.data()), iter_t(utf32.data() + utf32.size()),
+                out.begin()
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_transcode_from_utf32 (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint32_t> utf32;
+    boost::text::utf8::transcode_to_utf32(
+        str.c_str(), str.c_str() + str.size(), std::back_inserter(utf32)
+    );
+    std::string out(str.size(), '\0');
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::transcode_from_utf32(
+                utf32.data(), utf32.data() + utf32.size(),
+                &out[0], &out[0] + out.size()
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+// The reverse traversal benchmarks decrement each converting iterator from
+// the end of its sequence to the beginning.
+
+template <typename Iter>
+uint32_t sum_reverse (Iter first, Iter it)
+{
+    uint32_t retval = 0;
+    while (it != first) {
+        retval += *--it;
+    }
+    return retval;
+}
+
+void BM_to_utf32_iterator_reverse (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    using iter_t = boost::text::utf8::to_utf32_iterator<char const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            sum_reverse(iter_t(str.c_str()), iter_t(str.c_str() + str.size()))
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_to_utf16_iterator_reverse (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    using iter_t = boost::text::utf8::to_utf16_iterator<char const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            sum_reverse(iter_t(str.c_str()), iter_t(str.c_str() + str.size()))
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_from_utf16_iterator_reverse (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint16_t> utf16;
+    boost::text::utf8::transcode_to_utf16(
+        str.c_str(), str.c_str() + str.size(), std::back_inserter(utf16)
+    );
+    using iter_t = boost::text::utf8::from_utf16_iterator<uint16_t const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            sum_reverse(iter_t(utf16.data()), iter_t(utf16.data() + utf16.size()))
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_from_utf32_iterator_reverse (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<uint32_t> utf32;
+    boost::text::utf8::transcode_to_utf32(
+        str.c_str(), str.c_str() + str.size(), std::back_inserter(utf32)
+    );
+    using iter_t = boost::text::utf8::from_utf32_iterator<uint32_t const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            sum_reverse(iter_t(utf32.data()), iter_t(utf32.data() + utf32.size()))
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_count_code_points_iterator (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    using iter_t = boost::text::utf8::to_utf32_iterator<char const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            std::distance(iter_t(str.c_str()), iter_t(str.c_str() + str.size()))
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_count_code_points (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::count_code_points(
+                str.c_str(), str.c_str() + str.size()
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_advance_code_points (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    char const * const first = str.c_str();
+    char const * const last = first + str.size();
+    std::ptrdiff_t const n = boost::text::utf8::count_code_points(first, last) - 1;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::advance_code_points(first, last, n)
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+// The UTF-16 offset benchmarks convert the offset of the last code point of
+// a line of mixed_corpus with the given length, as a language server does
+// with each position it sends or receives.
+
+char const * line_last_code_point (std::string const & str, int length)
+{
+    char const * it = str.c_str() + length;
+    while (boost::text::utf8::continuation(*--it))
+        ;
+    return it;
+}
+
+void BM_utf16_offset_iterator (benchmark::State & state)
+{
+    char const * const first = mixed_corpus.c_str();
+    char const * const cp = line_last_code_point(mixed_corpus, state.range(0));
+    using iter_t = boost::text::utf8::to_utf16_iterator<char const *>;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(std::distance(iter_t(first), iter_t(cp)));
+    }
+    state.SetBytesProcessed(state.iterations() * (cp - first));
+}
+
+void BM_utf16_offset (benchmark::State & state)
+{
+    char const * const first = mixed_corpus.c_str();
+    char const * const cp = line_last_code_point(mixed_corpus, state.range(0));
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::count_utf16_code_units(first, cp)
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * (cp - first));
+}
+
+void BM_utf8_offset_iterator (benchmark::State & state)
+{
+    char const * const first = mixed_corpus.c_str();
+    char const * const last = first + state.range(0);
+    char const * const cp = line_last_code_point(mixed_corpus, state.range(0));
+    std::ptrdiff_t const n = boost::text::utf8::count_utf16_code_units(first, cp);
+    using iter_t = boost::text::utf8::to_utf16_iterator<char const *>;
+    while (state.KeepRunning()) {
+        iter_t it(first);
+        std::advance(it, n);
+        benchmark::DoNotOptimize(*it);
+    }
+    state.SetBytesProcessed(state.iterations() * (last - first));
+}
+
+void BM_utf8_offset (benchmark::State & state)
+{
+    char const * const first = mixed_corpus.c_str();
+    char const * const last = first + state.range(0);
+    char const * const cp = line_last_code_point(mixed_corpus, state.range(0));
+    std::ptrdiff_t const n = boost::text::utf8::count_utf16_code_units(first, cp);
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::utf8::advance_utf16_code_units(first, last, n)
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * (last - first));
+}
+
+// The code point lookup benchmarks each find the code unit offsets of the
+// same 1024 code points, spread across the corpus.
+
+std::vector<int> lookup_code_points (std::string const & str)
+{
+    int const code_points = boost::text::utf8::count_code_points(
+        str.c_str(), str.c_str() + str.size()
+    );
+    std::vector<int> retval(1024);
+    for (int i = 0; i < 1024; ++i) {
+        retval[i] = int((i * 7919ll) % 1024 * code_points / 1024);
+    }
+    return retval;
+}
+
+void BM_code_unit_offset_stepping (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    std::vector<int> const cps = lookup_code_points(str);
+    while (state.KeepRunning()) {
+        for (int cp : cps) {
+            char const * it = str.c_str();
+            for (int i = 0; i < cp; ++i) {
+                it += boost::text::utf8::code_point_bytes(*it);
+            }
+            benchmark::DoNotOptimize(it);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * cps.size());
+}
+
+void BM_code_unit_offset_advance (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    char const * const first = str.c_str();
+    char const * const last = first + str.size();
+    std::vector<int> const cps = lookup_code_points(str);
+    while (state.KeepRunning()) {
+        for (int cp : cps) {
+            benchmark::DoNotOptimize(
+                boost::text::utf8::advance_code_points(first, last, cp)
+            );
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * cps.size());
+}
+
+void BM_code_unit_offset_index (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    boost::text::text_view const tv(str.c_str(), str.size(), boost::text::utf8::unchecked);
+    std::vector<int> const cps = lookup_code_points(str);
+    boost::text::code_point_index index;
+    while (state.KeepRunning()) {
+        for (int cp : cps) {
+            benchmark::DoNotOptimize(index.code_unit_offset(tv, cp));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * cps.size());
+}
+
+// Like BM_code_unit_offset_index, but the index is invalidated halfway
+// through the corpus before each lookup, as if by an edit there.
+void BM_code_unit_offset_index_invalidated (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    boost::text::text_view const tv(str.c_str(), str.size(), boost::text::utf8::unchecked);
+    std::vector<int> const cps = lookup_code_points(str);
+    boost::text::code_point_index index;
+    while (state.KeepRunning()) {
+        for (int cp : cps) {
+            index.invalidate(str.size() / 2);
+            benchmark::DoNotOptimize(index.code_unit_offset(tv, cp));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * cps.size());
+}
+
+// The streaming benchmarks feed the corpus in 4 KiB chunks.
+
+char const * chunk_end (char const * it, char const * last)
+{ return last - it < 4096 ? last : it + 4096; }
+
+void BM_stream_validator (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    char const * const first = str.c_str();
+    char const * const last = first + str.size();
+    while (state.KeepRunning()) {
+        boost::text::utf8::stream_validator v;
+        for (char const * it = first; it != last; it = chunk_end(it, last)) {
+            v.feed(it, chunk_end(it, last));
+        }
+        benchmark::DoNotOptimize(v.finish());
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_stream_decoder (benchmark::State & state)
+{
+    std::string const & str = corpus(state.range(0));
+    char const * const first = str.c_str();
+    char const * const last = first + str.size();
+    std::vector<uint32_t> out(str.size());
+    while (state.KeepRunning()) {
+        boost::text::utf8::stream_decoder d;
+        uint32_t * out_it = out.data();
+        for (char const * it = first; it != last; it = chunk_end(it, last)) {
+            out_it = d.feed(it, chunk_end(it, last), out_it);
+        }
+        benchmark::DoNotOptimize(d.finish(out_it));
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+// The repair benchmarks corrupt one byte in every 1000 of the corpus.
+
+std::string corrupted (std::string s)
+{
+    for (std::size_t i = 500; i < s.size(); i += 1000) {
+        s[i] = '\xff';
+    }
+    return s;
+}
+
+void BM_repair_encoding_round_trip (benchmark::State & state)
+{
+    std::string const str = corrupted(corpus(state.range(0)));
+    std::string out;
+    out.reserve(2 * str.size());
+    using to_iter_t = boost::text::utf8::to_utf32_iterator<char const *>;
+    using from_iter_t = boost::text::utf8::from_utf32_iterator<to_iter_t>;
+    while (state.KeepRunning()) {
+        out.clear();
+        out.insert(
+            out.end(),
+            from_iter_t(to_iter_t(str.c_str())),
+            from_iter_t(to_iter_t(str.c_str() + str.size()))
+        );
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+void BM_repair_encoding (benchmark::State & state)
+{
+    std::string const str = corrupted(corpus(state.range(0)));
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+            boost::text::repair_encoding(
+                boost::text::text_view(str.c_str(), str.size(), boost::text::utf8::unchecked)
+            )
+        );
+    }
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+
+#define UTF8_BENCHMARK_ARGS() ->Arg(64)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20)
+#define UTF8_CORPUS_ARGS() ->DenseRange(0, 6)
+#define UTF8_VALID_CORPUS_ARGS() ->DenseRange(0, 5)
+
+BENCHMARK(BM_find_invalid_encoding_scalar_ascii) UTF8_BENCHMARK_ARGS();
+BENCHMARK(BM_find_invalid_encoding_ascii) UTF8_BENCHMARK_ARGS();
+BENCHMARK(BM_find_invalid_encoding_scalar_mixed) UTF8_BENCHMARK_ARGS();
+BENCHMARK(BM_find_invalid_encoding_mixed) UTF8_BENCHMARK_ARGS();
+
+BENCHMARK(BM_encoded) UTF8_VALID_CORPUS_ARGS();
+BENCHMARK(BM_find_all_invalid_encodings) UTF8_CORPUS_ARGS();
+
+BENCHMARK(BM_to_utf32_iterator) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_forward_code_points) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_transcode_to_utf32) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_to_utf32_iterator_distance) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_forward_code_points_distance) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_to_utf16_iterator) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_transcode_to_utf16) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_from_utf16_iterator) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_transcode_from_utf16) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_from_utf32_iterator) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_transcode_from_utf32) UTF8_CORPUS_ARGS();
+
+BENCHMARK(BM_to_utf32_iterator_reverse) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_to_utf16_iterator_reverse) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_from_utf16_iterator_reverse) UTF8_CORPUS_ARGS();
+BENCHMARK(BM_from_utf32_iterator_reverse) UTF8_CORPUS_ARGS();
+
+BENCHMARK(BM_count_code_points_iterator) UTF8_VALID_CORPUS_ARGS();
+BENCHMARK(BM_count_code_points) UTF8_VALID_CORPUS_ARGS();
+BENCHMARK(BM_advance_code_points) UTF8_VALID_CORPUS_ARGS();
+
+BENCHMARK(BM_utf16_offset_iterator)->Arg(80)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_utf16_offset)->Arg(80)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_utf8_offset_iterator)->Arg(80)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_utf8_offset)->Arg(80)->Arg(1 << 10)->Arg(1 << 16);
+
+BENCHMARK(BM_code_unit_offset_stepping) UTF8_VALID_CORPUS_ARGS();
+BENCHMARK(BM_code_unit_offset_advance) UTF8_VALID_CORPUS_ARGS();
+BENCHMARK(BM_code_unit_offset_index) UTF8_VALID_CORPUS_ARGS();
+BENCHMARK(BM_code_unit_offset_index_invalidated) UTF8_VALID_CORPUS_ARGS();
+
+BENCHMARK(BM_stream_validator) UTF8_VALID_CORPUS_ARGS();
+BENCHMARK(BM_stream_decoder) UTF8_CORPUS_ARGS();
+
+BENCHMARK(BM_repair_encoding_round_trip) UTF8_VALID_CORPUS_ARGS();
+BENCHMARK(BM_repair_encoding) UTF8_VALID_CORPUS_ARGS();
+
+BENCHMARK_MAIN()
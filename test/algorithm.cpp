@@ -3,6 +3,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
 
 using namespace boost;
 
@@ -1005,3 +1010,423 @@ TEST(algorithm, test_view_view_find_last_not_of_constexpr)
 
 #endif
 }
+
+TEST(algorithm, test_find_rfind_partial_matches)
+{
+    // Candidates that start like the pattern but run off the end of r, or
+    // end inside a code point.
+    text::text_view const tv_xxb("xxb");
+    text::text_view const tv_bx("bx");
+    EXPECT_EQ(find(tv_xxb, tv_bx), -1);
+    EXPECT_EQ(rfind(tv_xxb, tv_bx), -1);
+
+    text::text_view const tv_mixed("ab\xd0\xb0" "bb");
+    text::text_view const tv_bb("bb");
+    EXPECT_EQ(find(tv_mixed, tv_bb), 4);
+    EXPECT_EQ(rfind(tv_mixed, tv_bb), 4);
+
+#ifndef BOOST_TEXT_NO_CXX14_CONSTEXPR
+    constexpr text::text_view ce_xxb("xxb");
+    constexpr text::text_view ce_bx("bx");
+    static_assert(find(ce_xxb, ce_bx) == -1, "");
+    static_assert(rfind(ce_xxb, ce_bx) == -1, "");
+    constexpr text::text_view ce_bab("babab");
+    constexpr text::text_view ce_ab("ab");
+    static_assert(find(ce_bab, ce_ab) == 1, "");
+    static_assert(rfind(ce_bab, ce_ab) == 3, "");
+#endif
+}
+
+TEST(algorithm, test_find_rfind_random)
+{
+    // A small alphabet, so that partial matches are common.
+    char const * const chars[] = {"a", "b", "c", "\xd0\xb0", "\xe4\xba\x8c"};
+
+    std::mt19937 gen(1);
+    auto random_string = [&](int max_code_points) {
+        std::string retval;
+        int const n = gen() % (max_code_points + 1);
+        for (int i = 0; i < n; ++i) {
+            retval += chars[gen() % (i % 7 == 0 ? 5 : 2)];
+        }
+        return retval;
+    };
+
+    for (int i = 0; i < 20000; ++i) {
+        std::string const r = random_string(i % 10 == 0 ? 300 : 70);
+        std::string p = random_string(i % 3 == 0 ? 3 : 12);
+        if (p.empty())
+            p = "a";
+        if (i % 4 == 0 && p.size() <= r.size()) {
+            int const at = gen() % (r.size() - p.size() + 1);
+            p = r.substr(at, p.size());
+        }
+
+        text::text_view const r_tv(r.c_str(), r.size(), text::utf8::unchecked);
+        text::text_view const p_tv(p.c_str(), p.size(), text::utf8::unchecked);
+        int const expected_find = r.find(p) == std::string::npos ? -1 : (int)r.find(p);
+        int const expected_rfind = r.rfind(p) == std::string::npos ? -1 : (int)r.rfind(p);
+
+        EXPECT_EQ(find(r_tv, p_tv), expected_find) << r << " " << p;
+        EXPECT_EQ(rfind(r_tv, p_tv), expected_rfind) << r << " " << p;
+
+        char const * const r_first = r.c_str();
+        char const * const r_last = r_first + r.size();
+        char const * const p_first = p.c_str();
+        char const * const p_last = p_first + p.size();
+        EXPECT_EQ(text::detail::find_scalar(r_first, r_last, p_first, p_last), expected_find);
+        EXPECT_EQ(text::detail::rfind_scalar(r_first, r_last, p_first, p_last), expected_rfind);
+    }
+}
+
+TEST(algorithm, test_find_of_random)
+{
+    std::mt19937 gen(2);
+    for (int i = 0; i < 20000; ++i) {
+        // Sets of up to 8 chars, sets of ASCII chars, and sets of arbitrary
+        // chars cover each of the runtime searches.
+        std::string r(gen() % (i % 10 == 0 ? 300 : 70), 'a');
+        std::string p(gen() % 21, 'a');
+        int const range = i % 3 == 0 ? 256 : i % 3 == 1 ? 0x60 : 12;
+        for (char & c : r) {
+            c = char(' ' + gen() % range);
+        }
+        for (char & c : p) {
+            c = char(' ' + gen() % range);
+        }
+
+        std::string::size_type const npos = std::string::npos;
+        auto const expected = [&](std::string::size_type pos, int if_p_empty) {
+            if (p.empty())
+                return if_p_empty;
+            return pos == npos ? -1 : (int)pos;
+        };
+
+        text::text_view const r_tv(r.c_str(), r.size(), text::utf8::unchecked);
+        text::text_view const p_tv(p.c_str(), p.size(), text::utf8::unchecked);
+        int const size = r.size();
+        EXPECT_EQ(find_first_of(r_tv, p_tv), expected(r.find_first_of(p), 0));
+        EXPECT_EQ(find_last_of(r_tv, p_tv), expected(r.find_last_of(p), size));
+        EXPECT_EQ(find_first_not_of(r_tv, p_tv), expected(r.find_first_not_of(p), 0));
+        EXPECT_EQ(find_last_not_of(r_tv, p_tv), expected(r.find_last_not_of(p), size));
+
+        // The searches not chosen at runtime on this machine.
+        if (p.empty())
+            continue;
+        char const * const first = r.c_str();
+        char const * const last = first + r.size();
+        auto const offset = [first](char const * it) {
+            return it ? int(it - first) : -1;
+        };
+        text::detail::char_set const set(p.c_str(), p.c_str() + p.size());
+        EXPECT_EQ(offset(text::detail::find_in_set_scalar<true>(first, last, set)), expected(r.find_first_of(p), -1));
+        EXPECT_EQ(offset(text::detail::rfind_in_set_scalar<false>(first, last, set)), expected(r.find_last_not_of(p), size - 1));
+#if BOOST_TEXT_SSE2
+        text::detail::char_set_tables const tables(set);
+        if (tables.size_ <= text::detail::char_set_compare_max) {
+            EXPECT_EQ(offset(text::detail::find_in_set_sse2<false>(first, last, tables)), expected(r.find_first_not_of(p), 0));
+            EXPECT_EQ(offset(text::detail::rfind_in_set_sse2<true>(first, last, tables)), expected(r.find_last_of(p), -1));
+        }
+#endif
+    }
+}
+
+TEST(algorithm, test_find_of_code_point_set)
+{
+    {
+        // "\xc2\xa7" is U+00A7; "\xc2\x87" is U+0087.
+        text::text_view const r = "a\xc2\x87" "b\xc2\xa7" "c";
+        text::code_point_set const section("\xc2\xa7");
+        EXPECT_EQ(find_first_of(r, text::text_view("\xc2\xa7")), 1);
+        EXPECT_EQ(find_first_of(r, section), 4);
+        EXPECT_EQ(find_last_of(r, section), 4);
+        EXPECT_EQ(find_first_not_of(r, section), 0);
+        EXPECT_EQ(find_last_not_of(r, section), 6);
+        EXPECT_EQ(find_last_not_of("\xc2\x87\xc2\xa7\xc2\xa7", section), 0);
+
+        text::code_point_set const empty;
+        EXPECT_TRUE(empty.empty());
+        EXPECT_EQ(find_first_of(r, empty), -1);
+        EXPECT_EQ(find_first_not_of(r, empty), 0);
+        EXPECT_EQ(find_last_not_of(r, empty), 6);
+        EXPECT_EQ(find_first_not_of(text::text_view(), empty), -1);
+
+        text::code_point_set const set = {',', 0xa7, 0x1f600, 0xd800};
+        EXPECT_FALSE(set.empty());
+        EXPECT_TRUE(set.contains(','));
+        EXPECT_TRUE(set.contains(0x1f600));
+        EXPECT_FALSE(set.contains(0xd800));
+        EXPECT_FALSE(set.contains(0xc2));
+        EXPECT_EQ(find_first_of(std::string("x\xf0\x9f\x98\x80,"), set), 1);
+        EXPECT_EQ(find_last_of(std::string("x\xf0\x9f\x98\x80,y"), set), 5);
+    }
+
+    uint32_t const code_points[] = {
+        ',', ';', ' ', 'a', 'z', 0xa7, 0xc2, 0x430, 0x4e8c, 0x4e8d, 0x1f600, 0x1f601
+    };
+    int const num_code_points = sizeof(code_points) / sizeof(code_points[0]);
+
+    std::mt19937 gen(3);
+    for (int i = 0; i < 5000; ++i) {
+        std::string r;
+        std::vector<int> offsets;
+        std::vector<uint32_t> r_code_points;
+        int const length = gen() % (i % 10 == 0 ? 200 : 40);
+        for (int j = 0; j < length; ++j) {
+            uint32_t const cp = code_points[gen() % num_code_points];
+            offsets.push_back(r.size());
+            r_code_points.push_back(cp);
+            r.insert(
+                r.end(),
+                text::utf8::from_utf32_iterator<uint32_t const *>(&cp),
+                text::utf8::from_utf32_iterator<uint32_t const *>(&cp + 1)
+            );
+        }
+
+        std::vector<uint32_t> members;
+        int const set_size = gen() % 5;
+        for (int j = 0; j < set_size; ++j) {
+            members.push_back(code_points[gen() % num_code_points]);
+        }
+        std::string members_utf8(
+            text::utf8::from_utf32_iterator<uint32_t const *>(members.data()),
+            text::utf8::from_utf32_iterator<uint32_t const *>(members.data() + members.size())
+        );
+        text::code_point_set const set((text::text_view(members_utf8)));
+
+        int first_of = -1, last_of = -1, first_not_of = -1, last_not_of = -1;
+        for (int j = 0; j < length; ++j) {
+            bool const in =
+                std::find(members.begin(), members.end(), r_code_points[j]) !=
+                members.end();
+            int & first = in ? first_of : first_not_of;
+            int & last = in ? last_of : last_not_of;
+            if (first < 0)
+                first = offsets[j];
+            last = offsets[j];
+        }
+
+        text::text_view const r_tv(r);
+        EXPECT_EQ(find_first_of(r_tv, set), first_of) << "iteration " << i;
+        EXPECT_EQ(find_last_of(r_tv, set), last_of) << "iteration " << i;
+        EXPECT_EQ(find_first_not_of(r_tv, set), first_not_of) << "iteration " << i;
+        EXPECT_EQ(find_last_not_of(r_tv, set), last_not_of) << "iteration " << i;
+    }
+}
+
+TEST(algorithm, test_find_of_code_point_set_invalid)
+{
+    auto const unchecked = [](char const * s) {
+        return text::text_view(s, std::char_traits<char>::length(s), text::utf8::unchecked);
+    };
+
+    {
+        text::code_point_set const replacement = {text::utf8::replacement_character()};
+        EXPECT_EQ(find_first_of(unchecked("ab\x80" "cd"), replacement), 2);
+        EXPECT_EQ(find_first_of(unchecked("ab\xe4" "cd"), replacement), 2);
+        EXPECT_EQ(find_last_of(unchecked("ab\x80" "cd"), replacement), 2);
+        EXPECT_EQ(find_first_not_of(unchecked("\x80"), replacement), -1);
+        EXPECT_EQ(find_last_not_of(unchecked("\x80"), replacement), -1);
+        EXPECT_EQ(find_first_of(unchecked("\xc2\xa7\xef\xbf\xbd"), replacement), 2);
+
+        // "\xe4\xb8" is one maximal invalid subsequence; "\xc2\xa7\x80"
+        // is U+00A7 followed by a stray continuation char.
+        EXPECT_EQ(find_last_of(unchecked("a\xe4\xb8"), replacement), 1);
+        EXPECT_EQ(find_last_of(unchecked("\xc2\xa7\x80"), replacement), 2);
+        EXPECT_EQ(find_last_not_of(unchecked("a\xe4\xb8"), replacement), 0);
+
+        text::code_point_set const section("\xc2\xa7");
+        EXPECT_EQ(find_first_of(unchecked("\x80\xc2\xa7"), section), 1);
+        EXPECT_EQ(find_first_not_of(unchecked("\xc2\xa7\x80"), section), 2);
+        EXPECT_EQ(find_last_not_of(unchecked("\xc2\xa7\x80\xc2\xa7"), section), 2);
+    }
+
+    // Random strings of valid and invalid chars, against a decode of each
+    // string.
+    char const chars[] = {'a', ',', '\x80', '\xa7', '\xbd', '\xc2', '\xe4', '\xef', '\xbf', '\xf0'};
+    int const num_chars = sizeof(chars) / sizeof(chars[0]);
+    uint32_t const members[] = {',', 0xa7, 0x4e00, text::utf8::replacement_character()};
+    int const num_members = sizeof(members) / sizeof(members[0]);
+
+    std::mt19937 gen(4);
+    for (int i = 0; i < 5000; ++i) {
+        std::string r;
+        int const length = gen() % 12;
+        for (int j = 0; j < length; ++j) {
+            r += chars[gen() % num_chars];
+        }
+        std::vector<uint32_t> set_members;
+        int const set_size = gen() % 3;
+        for (int j = 0; j < set_size; ++j) {
+            set_members.push_back(members[gen() % num_members]);
+        }
+        std::string set_members_utf8(
+            text::utf8::from_utf32_iterator<uint32_t const *>(set_members.data()),
+            text::utf8::from_utf32_iterator<uint32_t const *>(set_members.data() + set_members.size())
+        );
+        text::code_point_set const set((text::text_view(set_members_utf8)));
+
+        int first_of = -1, last_of = -1, first_not_of = -1, last_not_of = -1;
+        char const * const first = r.data();
+        char const * const last = first + r.size();
+        for (char const * it = first; it != last;) {
+            int const offset = it - first;
+            uint32_t const cp = text::utf8::detail::decode_code_point(it, last);
+            int & first_ = set.contains(cp) ? first_of : first_not_of;
+            int & last_ = set.contains(cp) ? last_of : last_not_of;
+            if (first_ < 0)
+                first_ = offset;
+            last_ = offset;
+        }
+
+        text::text_view const r_tv(r.data(), r.size(), text::utf8::unchecked);
+        EXPECT_EQ(find_first_of(r_tv, set), first_of) << "iteration " << i;
+        EXPECT_EQ(find_last_of(r_tv, set), last_of) << "iteration " << i;
+        EXPECT_EQ(find_first_not_of(r_tv, set), first_not_of) << "iteration " << i;
+        EXPECT_EQ(find_last_not_of(r_tv, set), last_not_of) << "iteration " << i;
+    }
+}
+
+namespace {
+
+    std::string ascii_lower (std::string s)
+    {
+        for (char & c : s) {
+            if ('A' <= c && c <= 'Z')
+                c = c - 'A' + 'a';
+        }
+        return s;
+    }
+
+    int sign (int x)
+    { return x < 0 ? -1 : 0 < x ? 1 : 0; }
+
+    // A fold that covers the ASCII letters, the Latin-1 and Greek capital
+    // letters, and KELVIN SIGN, which folds to an ASCII letter.
+    uint32_t test_case_fold (uint32_t cp)
+    {
+        if (('A' <= cp && cp <= 'Z') || (0xc0 <= cp && cp <= 0xde && cp != 0xd7) ||
+            (0x391 <= cp && cp <= 0x3a9 && cp != 0x3a2)) {
+            return cp + 0x20;
+        }
+        if (cp == 0x212a)
+            return 'k';
+        return cp;
+    }
+
+}
+
+TEST(algorithm, test_ascii_icase)
+{
+    EXPECT_EQ(text::compare_ascii_icase(text::text_view("Content-Length"), "content-length"), 0);
+    EXPECT_TRUE(text::equal_ascii_icase(text::text_view("HOST"), "host"));
+    EXPECT_FALSE(text::equal_ascii_icase(text::text_view("host"), "hosts"));
+    EXPECT_FALSE(text::equal_ascii_icase(text::text_view("@"), "`"));
+    EXPECT_EQ(text::compare_ascii_icase(text::text_view("a"), "B"), -1);
+    EXPECT_EQ(text::compare_ascii_icase(text::text_view("B"), "a"), 1);
+    EXPECT_EQ(text::compare_ascii_icase(text::text_view("ab"), "A"), 1);
+    EXPECT_EQ(text::compare_ascii_icase(text::text_view(), "A"), -1);
+
+    // Non-ASCII chars are compared exactly, as unsigned chars.
+    EXPECT_FALSE(text::equal_ascii_icase(text::text_view(u8"É"), u8"é"));
+    EXPECT_EQ(text::compare_ascii_icase(text::text_view(u8"é"), "z"), 1);
+
+    EXPECT_EQ(text::find_ascii_icase(text::text_view("Accept: text/HTML"), "html"), 13);
+    EXPECT_EQ(text::find_ascii_icase(text::text_view("Accept"), "ACCEPT"), 0);
+    EXPECT_EQ(text::find_ascii_icase(text::text_view("Accept"), "x"), -1);
+    EXPECT_EQ(text::find_ascii_icase(text::text_view("Accept"), ""), 0);
+    EXPECT_EQ(text::find_ascii_icase(text::text_view("Acc"), "accept"), -1);
+
+    std::string const long_lower(100, 'x');
+    std::string const long_upper(100, 'X');
+    std::string const text_(std::string(70, 'y') + long_upper + "!");
+    EXPECT_TRUE(text::equal_ascii_icase(long_lower, long_upper));
+    EXPECT_EQ(text::find_ascii_icase(text_, long_lower + "!"), 70);
+}
+
+TEST(algorithm, test_ascii_icase_constexpr)
+{
+#ifndef BOOST_TEXT_NO_CXX14_CONSTEXPR
+
+    constexpr text::text_view tv_a("a");
+    constexpr text::text_view tv_A("A");
+    constexpr text::text_view tv_Ab("Ab");
+
+    constexpr int compare_a_A = text::compare_ascii_icase(tv_a, tv_A);
+    static_assert(compare_a_A == 0, "");
+    constexpr int compare_Ab_a = text::compare_ascii_icase(tv_Ab, tv_a);
+    static_assert(compare_Ab_a == 1, "");
+    constexpr bool equal_a_A = text::equal_ascii_icase(tv_a, tv_A);
+    static_assert(equal_a_A, "");
+    constexpr int find_Ab_B = text::find_ascii_icase(tv_Ab, text::text_view("B"));
+    static_assert(find_Ab_B == 1, "");
+
+#endif
+}
+
+TEST(algorithm, test_ascii_icase_random)
+{
+    // Letters of both cases, the chars just outside 'A'-'Z' and 'a'-'z',
+    // and the bytes of a non-ASCII code point.
+    char const * const chars[] = {"a", "A", "b", "B", "@", "[", "`", "{", "\xd0\xb0"};
+
+    std::mt19937 gen(2);
+    auto random_string = [&](int max_code_points) {
+        std::string retval;
+        int const n = gen() % (max_code_points + 1);
+        for (int i = 0; i < n; ++i) {
+            retval += chars[gen() % (i % 5 == 0 ? 9 : 4)];
+        }
+        return retval;
+    };
+
+    for (int i = 0; i < 20000; ++i) {
+        std::string const r = random_string(i % 10 == 0 ? 300 : 70);
+        std::string p = random_string(i % 3 == 0 ? 3 : 40);
+        if (i % 4 == 0 && p.size() <= r.size()) {
+            int const at = gen() % (r.size() - p.size() + 1);
+            p = r.substr(at, p.size());
+        }
+
+        std::string const r_lower = ascii_lower(r);
+        std::string const p_lower = ascii_lower(p);
+        text::text_view const r_tv(r.c_str(), r.size(), text::utf8::unchecked);
+        text::text_view const p_tv(p.c_str(), p.size(), text::utf8::unchecked);
+
+        int const expected_find =
+            r_lower.find(p_lower) == std::string::npos ? -1 : (int)r_lower.find(p_lower);
+        EXPECT_EQ(text::find_ascii_icase(r_tv, p_tv), expected_find) << r << " " << p;
+        EXPECT_EQ(sign(text::compare_ascii_icase(r_tv, p_tv)), sign(r_lower.compare(p_lower)))
+            << r << " " << p;
+        EXPECT_EQ(text::equal_ascii_icase(r_tv, p_tv), r_lower == p_lower) << r << " " << p;
+        EXPECT_EQ(text::compare_icase(r_tv, p_tv, test_case_fold) == 0, r_lower == p_lower)
+            << r << " " << p;
+
+        char const * const r_first = r.c_str();
+        char const * const r_last = r_first + r.size();
+        if (!p.empty() && p.size() <= r.size()) {
+            EXPECT_EQ(
+                text::detail::find_ascii_icase_scalar(r_first, r_last, p.c_str(), p.size()),
+                expected_find
+            );
+        }
+    }
+}
+
+TEST(algorithm, test_icase)
+{
+    EXPECT_EQ(text::compare_icase(u8"Éa", u8"éA", test_case_fold), 0);
+    EXPECT_TRUE(text::equal_icase(u8"ΣΟΦΙΑ", u8"σοφια", test_case_fold));
+    EXPECT_FALSE(text::equal_icase(u8"ΣΟΦΙΑ", u8"σοφιαx", test_case_fold));
+
+    // Folding can equate sequences of different sizes.
+    EXPECT_TRUE(text::equal_icase(u8"Kelvin", "kelvin", test_case_fold));
+    EXPECT_TRUE(text::equal_icase("KELVIN", u8"Kelvin", test_case_fold));
+    EXPECT_EQ(text::compare_icase(u8"Kb", "ka", test_case_fold), 1);
+
+    // Folded code points are compared as code points.
+    EXPECT_EQ(text::compare_icase(u8"é", u8"Ω", test_case_fold), -1);
+    EXPECT_EQ(text::compare_icase(u8"Ω", u8"é", test_case_fold), 1);
+    EXPECT_EQ(text::compare_icase("a", u8"ab", test_case_fold), -1);
+    EXPECT_EQ(text::compare_icase(text::text_view(), text::text_view(), test_case_fold), 0);
+}
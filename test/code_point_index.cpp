@@ -0,0 +1,133 @@
+#include <boost/text/code_point_index.hpp>
+#include <boost/text/text.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+
+using namespace boost;
+
+namespace {
+
+    text::text random_text (std::mt19937 & gen, int max_code_points)
+    {
+        char const * const code_points[] = {
+            "a", "\x7f", "\xd0\xb0", "\xe4\xba\x8c", "\xef\xbf\xbd",
+            "\xf0\x90\x8c\x82", "\xf0\x9f\x98\x80"
+        };
+        int const num_code_points = sizeof(code_points) / sizeof(code_points[0]);
+
+        text::text retval;
+        int const length = gen() % (max_code_points + 1);
+        for (int i = 0; i < length; ++i) {
+            retval += code_points[gen() % num_code_points];
+        }
+        return retval;
+    }
+
+    // Code unit offset of every code point in t, plus t.size().
+    std::vector<int> code_point_starts (text::text const & t)
+    {
+        std::vector<int> retval;
+        for (int i = 0; i < t.size(); ++i) {
+            if (!text::utf8::continuation(t[i]))
+                retval.push_back(i);
+        }
+        retval.push_back(t.size());
+        return retval;
+    }
+
+    void check_index (text::text const & t, text::code_point_index & index)
+    {
+        std::vector<int> const starts = code_point_starts(t);
+        int const code_points = (int)starts.size() - 1;
+        EXPECT_EQ(index.code_points(t), code_points);
+        for (int cp = 0; cp <= code_points + 3; ++cp) {
+            int const expected = cp < code_points ? starts[cp] : t.size();
+            EXPECT_EQ(index.code_unit_offset(t, cp), expected) << "cp=" << cp;
+        }
+        for (int cp = 0; cp <= code_points; ++cp) {
+            EXPECT_EQ(index.code_point_offset(t, starts[cp]), cp) << "cp=" << cp;
+        }
+    }
+
+}
+
+TEST(code_point_index, test_empty)
+{
+    text::text_view const tv;
+    text::code_point_index index;
+    EXPECT_EQ(index.stride(), text::code_point_index_default_stride);
+    EXPECT_EQ(index.entries(), 0);
+    EXPECT_EQ(index.code_points(tv), 0);
+    EXPECT_EQ(index.code_unit_offset(tv, 0), 0);
+    EXPECT_EQ(index.code_unit_offset(tv, 5), 0);
+    EXPECT_EQ(index.code_point_offset(tv, 0), 0);
+}
+
+TEST(code_point_index, test_lazy)
+{
+    text::text t;
+    for (int i = 0; i < 100; ++i) {
+        t += "a\xe4\xba\x8c";
+    }
+    text::code_point_index index(10);
+    EXPECT_EQ(index.code_unit_offset(t, 3), 5);
+    EXPECT_EQ(index.entries(), 1);
+    EXPECT_EQ(index.code_unit_offset(t, 25), 49);
+    EXPECT_EQ(index.entries(), 3);
+    EXPECT_EQ(index.code_point_offset(t, 100), 50);
+    EXPECT_EQ(index.entries(), 6);
+    EXPECT_EQ(index.code_points(t), 200);
+    EXPECT_EQ(index.entries(), 21);
+}
+
+TEST(code_point_index, test_strides)
+{
+    std::mt19937 gen(1);
+    for (int i = 0; i < 500; ++i) {
+        text::text const t = random_text(gen, 100);
+        text::code_point_index index(1 + i % 17);
+        check_index(t, index);
+    }
+}
+
+TEST(code_point_index, test_exact_multiple_of_stride)
+{
+    text::text t;
+    for (int i = 0; i < 8; ++i) {
+        t += "\xf0\x9f\x98\x80";
+    }
+    text::code_point_index index(4);
+    EXPECT_EQ(index.code_unit_offset(t, 8), t.size());
+    EXPECT_EQ(index.entries(), 3);
+    check_index(t, index);
+}
+
+TEST(code_point_index, test_invalidate)
+{
+    std::mt19937 gen(2);
+    for (int i = 0; i < 500; ++i) {
+        text::text t = random_text(gen, 200);
+        text::code_point_index index(1 + i % 9);
+        check_index(t, index);
+
+        std::vector<int> const starts = code_point_starts(t);
+        int at = starts[gen() % starts.size()];
+        if (i % 2) {
+            t.insert(at, random_text(gen, 30));
+        } else {
+            int last = starts[gen() % starts.size()];
+            if (last < at)
+                std::swap(at, last);
+            t.erase(t(at, last));
+        }
+        index.invalidate(at);
+
+        // Invalidating at or before the modification is always enough.
+        check_index(t, index);
+    }
+}
@@ -0,0 +1 @@
+#include <boost/text/memory_resource.hpp>
@@ -0,0 +1,2 @@
+#include <boost/text/memory_resource.hpp>
+#include <boost/text/memory_resource.hpp>
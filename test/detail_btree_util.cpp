@@ -29,7 +29,7 @@ TEST(detail_btree_util, test_node_ptr)
     }
 
     {
-        node_ptr<int> p0(new leaf_node_t<int>);
+        node_ptr<int> p0(new_node<leaf_node_t<int>>());
         node_ptr<int> p1 = p0;
 
         EXPECT_EQ(p0->refs_, 2);
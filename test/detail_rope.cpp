@@ -32,7 +32,7 @@ TEST(rope_detail, test_node_ptr)
     }
 
     {
-        node_ptr<rope_tag> p0(new leaf_node_t<rope_tag>);
+        node_ptr<rope_tag> p0(new_node<leaf_node_t<rope_tag>>());
         node_ptr<rope_tag> p1 = p0;
 
         EXPECT_EQ(p0->refs_, 2);
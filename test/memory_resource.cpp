@@ -0,0 +1,237 @@
+#include <boost/text/memory_resource.hpp>
+#include <boost/text/rope.hpp>
+#include <boost/text/segmented_vector.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace boost;
+
+namespace {
+
+    // Counts the allocations made from it, and the bytes and allocations
+    // not yet returned, so that a test can tell where storage came from
+    // and that it all went back.
+    struct counting_resource : text::memory_resource
+    {
+        counting_resource () : allocations_ (0), outstanding_ (0), bytes_ (0) {}
+
+        int allocations_;
+        int outstanding_;
+        std::size_t bytes_;
+
+    private:
+        void * do_allocate (std::size_t bytes, std::size_t alignment) override
+        {
+            void * const retval = text::new_delete_resource()->allocate(bytes, alignment);
+            EXPECT_EQ((std::uintptr_t)retval % alignment, 0u);
+            ++allocations_;
+            ++outstanding_;
+            bytes_ += bytes;
+            return retval;
+        }
+
+        void do_deallocate (void * p, std::size_t bytes, std::size_t alignment) noexcept override
+        {
+            --outstanding_;
+            bytes_ -= bytes;
+            text::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+    };
+
+    std::string to_string (text::rope const & r)
+    { return std::string(r.begin(), r.end()); }
+
+}
+
+TEST(memory_resource, test_default_resource)
+{
+    EXPECT_EQ(text::get_default_resource(), text::new_delete_resource());
+
+    counting_resource resource;
+    {
+        text::default_resource_guard guard(&resource);
+        EXPECT_EQ(text::get_default_resource(), &resource);
+        {
+            counting_resource inner;
+            text::default_resource_guard inner_guard(&inner);
+            EXPECT_EQ(text::get_default_resource(), &inner);
+        }
+        EXPECT_EQ(text::get_default_resource(), &resource);
+
+        // The default is per thread.
+        text::memory_resource * other_default = nullptr;
+        std::thread([&other_default] {
+            other_default = text::get_default_resource();
+            text::text const t(std::string(100, 'a'));
+        }).join();
+        EXPECT_EQ(other_default, text::new_delete_resource());
+        EXPECT_EQ(resource.allocations_, 0);
+    }
+    EXPECT_EQ(text::get_default_resource(), text::new_delete_resource());
+
+    EXPECT_EQ(text::set_default_resource(&resource), text::new_delete_resource());
+    EXPECT_EQ(text::set_default_resource(nullptr), &resource);
+    EXPECT_EQ(text::get_default_resource(), text::new_delete_resource());
+}
+
+TEST(memory_resource, test_text)
+{
+    counting_resource resource;
+    {
+        text::text short_text;
+        text::text long_text;
+        {
+            text::default_resource_guard guard(&resource);
+            short_text = text::text("short");
+            EXPECT_EQ(resource.allocations_, 0);
+            long_text = text::text("a text too long to fit in the object");
+            EXPECT_EQ(resource.allocations_, 1);
+        }
+
+        // A text grows with the resource it was first allocated from.
+        long_text.reserve(1000);
+        EXPECT_EQ(resource.allocations_, 2);
+        EXPECT_EQ(resource.outstanding_, 1);
+        long_text += text::repeated_text_view("more", 100);
+        EXPECT_EQ(resource.outstanding_, 1);
+
+        // Copies use the current default.
+        text::text copy(long_text);
+        EXPECT_EQ(copy, long_text);
+        EXPECT_EQ(resource.allocations_, 2);
+
+        // Moves and swaps take the storage along.
+        text::text moved(std::move(long_text));
+        moved.swap(short_text);
+        EXPECT_EQ(short_text, copy);
+        EXPECT_EQ(moved, "short");
+        EXPECT_EQ(resource.outstanding_, 1);
+
+        short_text.shrink_to_fit();
+        EXPECT_EQ(short_text, copy);
+        EXPECT_EQ(resource.allocations_, 3);
+        EXPECT_EQ(resource.outstanding_, 1);
+
+        short_text = text::text_view("short again");
+        short_text.shrink_to_fit();
+        EXPECT_EQ(short_text, "short again");
+        EXPECT_EQ(resource.outstanding_, 0);
+    }
+    EXPECT_EQ(resource.outstanding_, 0);
+    EXPECT_EQ(resource.bytes_, 0u);
+}
+
+TEST(memory_resource, test_rope)
+{
+    counting_resource resource;
+    {
+        text::rope r;
+        std::string expected;
+        {
+            text::default_resource_guard guard(&resource);
+            for (int i = 0; i < 100; ++i) {
+                std::string const s(600, 'a' + i % 26);
+                int const at = expected.size() / 600 / 2 * 600;
+                r.insert(at, text::text(s));
+                expected.insert(at, s);
+            }
+            r.insert(600, text::repeated_text_view("ab", 10));
+            expected.insert(600, std::string("abababababababababab"));
+
+            // Erasing from a shared rope makes reference leaves.
+            text::rope const copy = r;
+            r.erase(r(10, 20));
+            expected.erase(10, 10);
+            EXPECT_EQ(to_string(r), expected);
+            EXPECT_EQ(copy.size(), (int)expected.size() + 10);
+        }
+        EXPECT_LT(100, resource.allocations_);
+        int const allocations = resource.allocations_;
+
+        // Nodes made after the guard is gone come from the new default,
+        // and replaced nodes return to their own resources.
+        r.insert(0, text::text(std::string(600, 'x')));
+        expected.insert(0, std::string(600, 'x'));
+        r.erase(r(700, 5000));
+        expected.erase(700, 4300);
+        EXPECT_EQ(to_string(r), expected);
+        EXPECT_EQ(resource.allocations_, allocations);
+        EXPECT_LT(0, resource.outstanding_);
+    }
+    EXPECT_EQ(resource.outstanding_, 0);
+    EXPECT_EQ(resource.bytes_, 0u);
+}
+
+TEST(memory_resource, test_segmented_vector)
+{
+    counting_resource resource;
+    {
+        text::segmented_vector<int> v;
+        std::vector<int> expected;
+        {
+            text::default_resource_guard guard(&resource);
+            for (int i = 0; i < 3000; ++i) {
+                v.insert(v.begin() + v.size() / 2, i);
+                expected.insert(expected.begin() + expected.size() / 2, i);
+            }
+        }
+        EXPECT_LT(0, resource.allocations_);
+        EXPECT_EQ(v.size(), 3000);
+        EXPECT_TRUE(std::equal(v.begin(), v.end(), expected.begin()));
+
+        text::segmented_vector<int> copy = v;
+        copy.erase(copy.begin() + 10, copy.begin() + 20);
+        EXPECT_EQ(copy.size(), 2990);
+    }
+    EXPECT_EQ(resource.outstanding_, 0);
+    EXPECT_EQ(resource.bytes_, 0u);
+}
+
+TEST(memory_resource, test_monotonic_buffer_resource)
+{
+    counting_resource upstream;
+    {
+        text::monotonic_buffer_resource arena(64, &upstream);
+        EXPECT_EQ(arena.upstream_resource(), &upstream);
+
+        for (std::size_t alignment : {1, 2, 8, 64, 4, 16, 1, 64}) {
+            for (std::size_t size : {1, 7, 40, 100, 1000}) {
+                char * const p = static_cast<char *>(arena.allocate(size, alignment));
+                EXPECT_EQ((std::uintptr_t)p % alignment, 0u);
+                std::fill(p, p + size, 'x');
+                arena.deallocate(p, size, alignment);
+            }
+        }
+        EXPECT_LT(1, upstream.allocations_);
+        EXPECT_LT(0, upstream.outstanding_);
+
+        arena.release();
+        EXPECT_EQ(upstream.outstanding_, 0);
+
+        // The arena can be used again after release().
+        {
+            text::default_resource_guard guard(&arena);
+            text::rope r;
+            std::string expected;
+            for (int i = 0; i < 50; ++i) {
+                std::string const s(100 + i * 20, 'a' + i % 26);
+                r += text::text(s);
+                expected += s;
+            }
+            text::text t(std::string(1000, 'b'));
+            t += r;
+            EXPECT_EQ(to_string(r), expected);
+            EXPECT_EQ(t.size(), 1000 + (int)expected.size());
+        }
+        EXPECT_LT(0, upstream.outstanding_);
+    }
+    EXPECT_EQ(upstream.outstanding_, 0);
+    EXPECT_EQ(upstream.bytes_, 0u);
+}
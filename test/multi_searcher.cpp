@@ -0,0 +1,157 @@
+#include <boost/text/multi_searcher.hpp>
+
+#include "random_text.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace boost;
+
+namespace {
+
+    std::vector<text::multi_match>
+    expected_matches (std::string const & s, std::vector<std::string> const & patterns)
+    {
+        std::vector<text::multi_match> retval;
+        for (std::ptrdiff_t hi = 1; hi <= (std::ptrdiff_t)s.size(); ++hi) {
+            std::vector<int> matches;
+            for (int i = 0; i < (int)patterns.size(); ++i) {
+                std::ptrdiff_t const size = patterns[i].size();
+                if (size <= hi && !s.compare(hi - size, size, patterns[i]))
+                    matches.push_back(i);
+            }
+            std::stable_sort(
+                matches.begin(), matches.end(),
+                [&patterns](int lhs, int rhs) {
+                    return patterns[rhs].size() < patterns[lhs].size();
+                }
+            );
+            for (int i : matches) {
+                retval.push_back(text::multi_match{i, hi - (std::ptrdiff_t)patterns[i].size(), hi});
+            }
+        }
+        return retval;
+    }
+
+    template <typename Range>
+    std::vector<text::multi_match>
+    matches (Range const & r, text::multi_searcher const & s)
+    {
+        std::vector<text::multi_match> retval;
+        foreach_match(r, s, [&retval](text::multi_match m) {
+            retval.push_back(m);
+        });
+        return retval;
+    }
+
+}
+
+namespace boost { namespace text {
+
+    bool operator== (multi_match lhs, multi_match rhs)
+    { return lhs.pattern == rhs.pattern && lhs.lo == rhs.lo && lhs.hi == rhs.hi; }
+
+    std::ostream & operator<< (std::ostream & os, multi_match m)
+    { return os << "{" << m.pattern << ", " << m.lo << ", " << m.hi << "}"; }
+
+} }
+
+TEST(multi_searcher, test_simple)
+{
+    text::multi_searcher const s{"he", "she", "his", "hers"};
+    EXPECT_EQ(s.size(), 4);
+    EXPECT_EQ(s[2], "his");
+
+    std::vector<text::multi_match> const expected = {
+        {1, 1, 4}, {0, 2, 4}, {3, 2, 6}
+    };
+    EXPECT_EQ(matches(text::text_view("ushers"), s), expected);
+    EXPECT_EQ(matches(std::string("ushers"), s), expected);
+    EXPECT_EQ(matches(text::text("ushers"), s), expected);
+    EXPECT_EQ(matches(text::rope("ushers"), s), expected);
+    EXPECT_EQ(matches(text::rope_view("ushers"), s), expected);
+
+    EXPECT_TRUE(matches(text::text_view(""), s).empty());
+    EXPECT_TRUE(matches(text::text_view("ushers"), text::multi_searcher()).empty());
+
+    EXPECT_THROW(text::multi_searcher({"a", ""}), std::invalid_argument);
+}
+
+TEST(multi_searcher, test_stop)
+{
+    text::multi_searcher const s{"a", "b"};
+    std::string const str(100, 'a');
+    int count = 0;
+    foreach_match(str, s, [&count](text::multi_match) { return ++count < 3; });
+    EXPECT_EQ(count, 3);
+
+    count = 0;
+    foreach_match(text::rope(text::text(str)), s, [&count](text::multi_match) {
+        return ++count < 3;
+    });
+    EXPECT_EQ(count, 3);
+}
+
+TEST(multi_searcher, test_random)
+{
+    std::mt19937 gen(1);
+    for (int i = 0; i < 2000; ++i) {
+        // Sets on both sides of teddy_patterns_max, with and without short
+        // patterns.
+        int const pattern_count = 1 + gen() % 48;
+        int const min_size = 1 + gen() % 4;
+        std::vector<std::string> patterns;
+        for (int j = 0; j < pattern_count; ++j) {
+            patterns.push_back(random_string(gen, min_size, min_size + 6, "aabc"));
+        }
+        text::multi_searcher const s(patterns.begin(), patterns.end());
+        std::string const str = random_string(gen, 0, 300, "aabc");
+        EXPECT_EQ(matches(str, s), expected_matches(str, patterns))
+            << "str=" << str;
+    }
+}
+
+TEST(multi_searcher, test_rope)
+{
+    std::mt19937 gen(2);
+    for (int i = 0; i < 300; ++i) {
+        int const pattern_count = 1 + gen() % 48;
+        std::vector<std::string> patterns;
+        for (int j = 0; j < pattern_count; ++j) {
+            patterns.push_back(random_string(gen, 1, 8, "aabc"));
+        }
+        text::multi_searcher const s(patterns.begin(), patterns.end());
+
+        // Text segments longer than text_insert_max stay separate, so
+        // matches span segments.
+        text::rope r;
+        std::string expected;
+        int const segments = gen() % 6;
+        for (int j = 0; j < segments; ++j) {
+            if (gen() % 2) {
+                std::string const str = random_string(gen, 513, 600, "aabc");
+                r += text::text(str);
+                expected += str;
+            } else {
+                char const * const views[] = {"a", "b", "ab", "abc", "ca"};
+                char const * const str = views[gen() % 5];
+                int const count = gen() % 4;
+                r += text::repeated_text_view(str, count);
+                for (int k = 0; k < count; ++k) {
+                    expected += str;
+                }
+            }
+        }
+
+        EXPECT_EQ(matches(r, s), expected_matches(expected, patterns));
+
+        int const lo = expected.empty() ? 0 : gen() % expected.size();
+        int const hi = lo + gen() % (expected.size() - lo + 1);
+        text::rope_view const rv(r, lo, hi, text::utf8::unchecked);
+        EXPECT_EQ(matches(rv, s), expected_matches(expected.substr(lo, hi - lo), patterns));
+    }
+}
@@ -0,0 +1,129 @@
+#include <boost/text/parallel_algorithm.hpp>
+
+#include "random_text.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace boost;
+
+namespace {
+
+    std::vector<std::ptrdiff_t> expected_find_all (std::string const & s, std::string const & p)
+    {
+        std::vector<std::ptrdiff_t> retval;
+        for (auto pos = s.find(p); pos != std::string::npos; pos = s.find(p, pos + p.size())) {
+            retval.push_back(pos);
+        }
+        return retval;
+    }
+
+    // Builds a rope of text segments of various sizes, and the string it
+    // is equal to.  The rope is size megabytes or more, so that it is
+    // divided into several chunks.
+    void random_rope (
+        std::mt19937 & gen,
+        char const * alphabet,
+        std::size_t size,
+        text::rope & r,
+        std::string & expected
+    ) {
+        while (expected.size() < (size << 20)) {
+            std::string const s = random_string(gen, 600, (1 << 18) + 599, alphabet);
+            r += text::text(s);
+            expected += s;
+        }
+    }
+
+    void check (text::rope const & r, std::string const & expected, std::string const & p)
+    {
+        text::text_view const p_view(p.data(), p.size(), text::utf8::unchecked);
+        std::vector<std::ptrdiff_t> const offsets = expected_find_all(expected, p);
+        std::ptrdiff_t const first = offsets.empty() ? -1 : offsets.front();
+
+        for (int threads : {1, 2, 3, 8}) {
+            EXPECT_EQ(text::parallel_find(r, p_view, threads), first)
+                << "p=" << p << " threads=" << threads;
+            EXPECT_EQ(text::parallel_count(r, p_view, threads), (std::ptrdiff_t)offsets.size())
+                << "p=" << p << " threads=" << threads;
+            EXPECT_EQ(text::parallel_find_all(r, p_view, threads), offsets)
+                << "p=" << p << " threads=" << threads;
+        }
+    }
+
+}
+
+TEST(parallel_algorithm, test_small)
+{
+    text::rope const r("abcabcabd");
+    EXPECT_EQ(text::parallel_find(r, "abd"), 6);
+    EXPECT_EQ(text::parallel_find(r, "x"), -1);
+    EXPECT_EQ(text::parallel_find(r, ""), 0);
+    EXPECT_EQ(text::parallel_count(r, "ab"), 3);
+    EXPECT_EQ(text::parallel_count(r, ""), 0);
+    EXPECT_EQ(text::parallel_find_all(r, "ab"), (std::vector<std::ptrdiff_t>{0, 3, 6}));
+    EXPECT_EQ(text::parallel_find_all(text::rope_view(r, 1, 9), "ab"), (std::vector<std::ptrdiff_t>{2, 5}));
+    EXPECT_EQ(text::parallel_find(text::rope(), "a"), -1);
+    EXPECT_EQ(text::parallel_count(text::rope(), "a"), 0);
+}
+
+TEST(parallel_algorithm, test_random)
+{
+    std::mt19937 gen(1);
+    text::rope r;
+    std::string expected;
+    random_rope(gen, "aabc", 9, r, expected);
+
+    check(r, expected, "abcab");
+    check(r, expected, "aa");
+    check(r, expected, "aaaaaaaa");
+    check(r, expected, "abcd");
+
+    // A pattern that matches only at the very end.
+    std::string const last = expected.substr(expected.size() - 40);
+    check(r, expected, last);
+}
+
+// In a run of 'a's, the matches of "aa" found starting at an even offset
+// never coincide with those found starting at an odd one, so a chunk that
+// starts inside a match must be searched again entirely.
+TEST(parallel_algorithm, test_periodic)
+{
+    std::mt19937 gen(2);
+    text::rope r;
+    std::string expected;
+    random_rope(gen, "a", 3, r, expected);
+    r += text::text("b");
+    expected += "b";
+
+    check(r, expected, "aa");
+    check(r, expected, "aaa");
+    check(r, expected, "ab");
+
+    text::rope_view const rv(r, 1, r.size() - 1);
+    std::string const expected_rv = expected.substr(1, expected.size() - 2);
+    EXPECT_EQ(text::parallel_find_all(rv, "aa", 4), expected_find_all(expected_rv, "aa"));
+    EXPECT_EQ(text::parallel_count(rv, "aaa", 3), (std::ptrdiff_t)expected_find_all(expected_rv, "aaa").size());
+}
+
+TEST(parallel_algorithm, test_chunk_exception)
+{
+    for (int threads : {1, 2, 8}) {
+        std::atomic<int> calls(0);
+        EXPECT_THROW(
+            text::detail::parallel_for_each_chunk(32, threads, [&calls](int i) {
+                ++calls;
+                if (i == 5)
+                    throw std::bad_alloc();
+            }),
+            std::bad_alloc
+        ) << "threads=" << threads;
+        EXPECT_LE(6, calls) << "threads=" << threads;
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef BOOST_TEXT_TEST_RANDOM_TEXT_HPP
+#define BOOST_TEXT_TEST_RANDOM_TEXT_HPP
+
+#include <boost/text/rope.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+
+// Returns a string of [min_size, max_size] code points, each chosen from
+// the UTF-8 code points in alphabet.  A small alphabet makes partial
+// matches, and matches, common.
+inline std::string random_string (
+    std::mt19937 & gen,
+    int min_size,
+    int max_size,
+    char const * alphabet
+) {
+    std::vector<std::string> code_points;
+    while (*alphabet) {
+        int const bytes = boost::text::utf8::code_point_bytes(*alphabet);
+        code_points.emplace_back(alphabet, bytes);
+        alphabet += bytes;
+    }
+    std::string retval;
+    int const size = min_size + gen() % (max_size - min_size + 1);
+    for (int i = 0; i < size; ++i) {
+        retval += code_points[gen() % code_points.size()];
+    }
+    return retval;
+}
+
+// Returns a string of [0, max_size] code points from alphabet.
+inline std::string random_string (std::mt19937 & gen, int max_size, char const * alphabet = "aab")
+{ return random_string(gen, 0, max_size, alphabet); }
+
+// Appends up to 7 random segments to r, and their chars to expected.  Each
+// is one of:
+// - A text made of chars from alphabet, longer than text_insert_max, so
+//   that it stays a separate leaf.
+// - One of views, repeated up to max_count times, which r refers to and
+//   does not copy.
+// - shared, whose tree r then shares.
+inline void append_random_segments (
+    std::mt19937 & gen,
+    char const * alphabet,
+    std::vector<char const *> const & views,
+    int max_count,
+    boost::text::rope const & shared,
+    boost::text::rope & r,
+    std::string & expected
+) {
+    int const segments = gen() % 8;
+    for (int i = 0; i < segments; ++i) {
+        switch (gen() % 3) {
+        case 0: {
+            std::string const s =
+                random_string(gen, 20, alphabet) + std::string(600, 'a') +
+                random_string(gen, 20, alphabet);
+            r += boost::text::text(s);
+            expected += s;
+            break;
+        }
+        case 1: {
+            char const * const v = views[gen() % views.size()];
+            int const count = gen() % (max_count + 1);
+            r += boost::text::repeated_text_view(v, count);
+            for (int j = 0; j < count; ++j) {
+                expected += v;
+            }
+            break;
+        }
+        case 2:
+            r += shared;
+            expected += std::string(shared.begin(), shared.end());
+            break;
+        }
+    }
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include <list>
+#include <type_traits>
 
 
 using namespace boost;
@@ -435,6 +436,164 @@ TEST(rope, test_substr)
     }
 }
 
+TEST(rope, test_count_and_advance_code_points)
+{
+    // Text, repeated, text_view, and reference segments.
+    text::rope r("a\xd0\xb0");
+    r += text::text("\xe4\xba\x8c\xf0\x90\x8c\x82x");
+    r += text::repeated_text_view("b\xd0\xb0", 4);
+    r += text::text_view("\xe4\xba\x8c");
+    text::rope const r_copy = r;
+    r.insert(3, text::text_view("cd"));
+
+    std::ptrdiff_t const expected_count =
+        text::utf8::count_code_points(r.begin(), r.end());
+    EXPECT_EQ(expected_count, 16);
+    EXPECT_EQ(text::utf8::count_code_points(r), expected_count);
+    EXPECT_EQ(text::utf8::count_code_points(text::rope_view(r)), expected_count);
+
+    for (std::ptrdiff_t n = 0; n <= expected_count + 1; ++n) {
+        auto const expected = text::utf8::advance_code_points(r.begin(), r.end(), n);
+        EXPECT_EQ(text::utf8::advance_code_points(r, n), expected);
+        text::rope_view const rv = r;
+        EXPECT_EQ(text::utf8::advance_code_points(rv, n) - rv.begin(), expected - r.begin());
+    }
+
+    for (int lo = 0; lo <= r.size(); ++lo) {
+        for (int hi = lo; hi <= r.size(); ++hi) {
+            if ((lo < r.size() && text::utf8::continuation(r[lo])) ||
+                (hi < r.size() && text::utf8::continuation(r[hi]))) {
+                continue;
+            }
+            text::rope_view const rv = r(lo, hi);
+            std::ptrdiff_t const count =
+                text::utf8::count_code_points(rv.begin(), rv.end());
+            EXPECT_EQ(text::utf8::count_code_points(rv), count);
+            for (std::ptrdiff_t n = 0; n <= count; ++n) {
+                auto const expected =
+                    text::utf8::advance_code_points(rv.begin(), rv.end(), n);
+                EXPECT_EQ(text::utf8::advance_code_points(rv, n), expected);
+            }
+        }
+    }
+
+    EXPECT_EQ(text::utf8::count_code_points(text::text("a\xd0\xb0")), 2);
+}
+
+TEST(rope, test_count_and_advance_utf16_code_units)
+{
+    text::rope r("a\xf0\x9f\x98\x80");
+    r += text::text("\xe4\xba\x8c\xf0\x90\x8c\x82x");
+    r += text::repeated_text_view("b\xf0\x9f\x98\x80", 4);
+    r += text::text_view("\xe4\xba\x8c");
+    text::rope const r_copy = r;
+    r.insert(5, text::text_view("cd"));
+
+    using iter_t = text::utf8::to_utf16_iterator<text::rope::const_iterator>;
+    std::ptrdiff_t const expected_count =
+        std::distance(iter_t(r.begin()), iter_t(r.end()));
+    EXPECT_EQ(expected_count, 22);
+    EXPECT_EQ(text::utf8::count_utf16_code_units(r), expected_count);
+    EXPECT_EQ(text::utf8::count_utf16_code_units(text::rope_view(r)), expected_count);
+
+    for (std::ptrdiff_t n = 0; n <= expected_count + 1; ++n) {
+        auto const expected = text::utf8::advance_utf16_code_units(r.begin(), r.end(), n);
+        EXPECT_EQ(text::utf8::advance_utf16_code_units(r, n), expected);
+        text::rope_view const rv = r;
+        EXPECT_EQ(text::utf8::advance_utf16_code_units(rv, n) - rv.begin(), expected - r.begin());
+    }
+
+    for (int lo = 0; lo <= r.size(); ++lo) {
+        for (int hi = lo; hi <= r.size(); ++hi) {
+            if ((lo < r.size() && text::utf8::continuation(r[lo])) ||
+                (hi < r.size() && text::utf8::continuation(r[hi]))) {
+                continue;
+            }
+            text::rope_view const rv = r(lo, hi);
+            std::ptrdiff_t const count =
+                text::utf8::count_utf16_code_units(rv.begin(), rv.end());
+            EXPECT_EQ(text::utf8::count_utf16_code_units(rv), count);
+            for (std::ptrdiff_t n = 0; n <= count; ++n) {
+                auto const expected =
+                    text::utf8::advance_utf16_code_units(rv.begin(), rv.end(), n);
+                EXPECT_EQ(text::utf8::advance_utf16_code_units(rv, n), expected);
+            }
+        }
+    }
+}
+
+TEST(rope, test_repair_encoding)
+{
+    char const bad[] = "b\xe0\x80";
+    text::text_view const bad_tv(bad, sizeof(bad) - 1, text::utf8::unchecked);
+
+    text::rope r;
+    r += text::text_view("valid ");
+    r.insert(r.end(), bad_tv.begin(), bad_tv.end());
+    text::rope const r_copy = r;
+    r += text::text_view(" more");
+    r += text::repeated_text_view(text::text_view("xy"), 2);
+
+    r.repair_encoding();
+    EXPECT_EQ(r, "valid b\xef\xbf\xbd\xef\xbf\xbd morexyxy");
+    EXPECT_EQ(r_copy.size(), 9);
+    EXPECT_EQ(r_copy[8], '\x80');
+
+    text::rope r2;
+    r2 += text::repeated_text_view(bad_tv, 3);
+    r2.repair_encoding();
+    EXPECT_EQ(
+        r2,
+        "b\xef\xbf\xbd\xef\xbf\xbd"
+        "b\xef\xbf\xbd\xef\xbf\xbd"
+        "b\xef\xbf\xbd\xef\xbf\xbd"
+    );
+
+    text::rope valid("already valid");
+    valid.repair_encoding();
+    EXPECT_EQ(valid, "already valid");
+}
+
+TEST(rope, test_repair_encoding_repeated)
+{
+    // The repaired view is repeated, not expanded, and the rope owns it.
+    std::ptrdiff_t const count = std::ptrdiff_t(1) << 32;
+    text::rope r;
+    {
+        std::string const bad = "b\xe0\x80";
+        r += text::repeated_text_view(
+            text::text_view(bad.data(), bad.size(), text::utf8::unchecked), count
+        );
+        r.repair_encoding();
+    }
+    int segments = 0;
+    int repeated_segments = 0;
+    r.foreach_segment([&segments, &repeated_segments](auto const & segment) {
+        using segment_t = typename std::decay<decltype(segment)>::type;
+        ++segments;
+        if (std::is_same<segment_t, text::repeated_text_view>::value)
+            ++repeated_segments;
+    });
+    EXPECT_EQ(segments, 1);
+    EXPECT_EQ(repeated_segments, 1);
+    EXPECT_EQ(r.size(), 7 * count);
+    EXPECT_EQ(r[7 * count - 1], '\xbd');
+
+    text::rope const copy = r;
+    r.erase(r(7, r.size()));
+    EXPECT_EQ(r, "b\xef\xbf\xbd\xef\xbf\xbd");
+    EXPECT_EQ(copy.size(), 7 * count);
+    EXPECT_EQ(text::rope_view(copy, 14, 22), "b\xef\xbf\xbd\xef\xbf\xbd" "b");
+
+    // "\x9f\xf0" is two invalid chars on its own, but the seam between
+    // repetitions holds the first two chars of a 4-char sequence, so the
+    // segment is repaired as a whole.
+    text::rope seam;
+    seam += text::repeated_text_view(text::text_view("\x9f\xf0", 2, text::utf8::unchecked), 3);
+    seam.repair_encoding();
+    EXPECT_EQ(seam, "\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd");
+}
+
 TEST(rope, test_insert)
 {
     text::text_view const tv("a view ");
@@ -683,6 +842,69 @@ TEST(rope, test_insert_rope_view)
     }
 }
 
+// Inserting into a text leaf in place, several levels down the tree, must
+// bump the keys of each interior node on the way relative to that node.
+TEST(rope, test_insert_in_place_deep)
+{
+    text::rope r;
+    std::string r_as_string;
+    for (int i = 0; i < 400; ++i) {
+        std::string const s(20 + i % 64 * 3, 'a' + i % 26);
+        auto const at = r.size() / 3;
+        r.insert(at, text::text(s));
+        r_as_string.insert(at, s);
+        if (i % 8 == 7) {
+            auto const lo = r.size() / 2;
+            r.erase(r(lo, lo + 50));
+            r_as_string.erase(lo, 50);
+        }
+    }
+
+    std::string local_string(r.begin(), r.end());
+    EXPECT_EQ(local_string, r_as_string);
+}
+
+// Ropes and rope_views are copied into texts a segment at a time, whatever
+// kinds of segments they are made of.
+TEST(rope, test_insert_into_text)
+{
+    text::rope r;
+    std::string r_as_string;
+    for (int i = 0; i < 100; ++i) {
+        std::string const s(100 + i, 'a' + i % 26);
+        r.insert(r.size() / 2, text::text(s));
+        r_as_string.insert(r_as_string.size() / 2, s);
+    }
+    r.insert(150, text::repeated_text_view("xy", 100));
+    r_as_string.insert(150, text::text(text::repeated_text_view("xy", 100)).begin(), 200);
+    text::rope const copy = r;
+    r.erase(r(1000, 1100));
+    r_as_string.erase(1000, 100);
+
+    {
+        text::text t("prefix");
+        t += r;
+        EXPECT_EQ(std::string(t.begin(), t.end()), "prefix" + r_as_string);
+    }
+
+    for (auto lo : {0, 1, 149, 151, 999, 1000, 5000}) {
+        for (auto hi : {lo, lo + 1, lo + 60, lo + 3000}) {
+            text::rope_view const rv = r(lo, hi);
+            text::text t("0123456789");
+            t.insert(t.begin() + 4, rv.begin(), rv.end());
+            EXPECT_EQ(std::string(t.begin(), t.end()), "0123" + r_as_string.substr(lo, hi - lo) + "456789")
+                << "lo=" << lo << " hi=" << hi;
+        }
+    }
+
+    {
+        text::text t("ab");
+        t += text::rope_view(text::repeated_text_view("z", 5), 1, 4);
+        t += text::rope_view("cd");
+        EXPECT_EQ(t, "abzzzcd");
+    }
+}
+
 TEST(rope, test_insert_encoding_checks)
 {
     // Unicode 9, 3.9/D90-D92
@@ -0,0 +1,313 @@
+#include <boost/text/rope_algorithm.hpp>
+
+#include "random_text.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+
+using namespace boost;
+
+namespace {
+
+    // Builds a rope of text, repeated, and shared segments, and the
+    // string it is equal to.
+    void random_rope (std::mt19937 & gen, text::rope & r, std::string & expected)
+    {
+        text::rope const shared(text::text(random_string(gen, 50, "aabc")));
+        append_random_segments(gen, "aabc", {"a", "b", "ab", "abc", "ca"}, 3, shared, r, expected);
+    }
+
+    std::ptrdiff_t to_offset (std::string::size_type pos)
+    { return pos == std::string::npos ? -1 : (std::ptrdiff_t)pos; }
+
+    template <typename Rope>
+    void check_searches (
+        Rope const & r,
+        std::string const & expected,
+        std::string const & p
+    ) {
+        text::text_view const p_view(p.data(), p.size(), text::utf8::unchecked);
+
+        EXPECT_EQ(text::find(r, p_view), to_offset(expected.find(p)))
+            << "s=" << expected << " p=" << p;
+        EXPECT_EQ(text::rfind(r, p_view), to_offset(expected.rfind(p)))
+            << "s=" << expected << " p=" << p;
+
+        if (p.empty())
+            return;
+
+        EXPECT_EQ(text::find_first_of(r, p_view), to_offset(expected.find_first_of(p)))
+            << "s=" << expected << " p=" << p;
+        EXPECT_EQ(text::find_last_of(r, p_view), to_offset(expected.find_last_of(p)))
+            << "s=" << expected << " p=" << p;
+        EXPECT_EQ(text::find_first_not_of(r, p_view), to_offset(expected.find_first_not_of(p)))
+            << "s=" << expected << " p=" << p;
+        EXPECT_EQ(text::find_last_not_of(r, p_view), to_offset(expected.find_last_not_of(p)))
+            << "s=" << expected << " p=" << p;
+    }
+
+}
+
+TEST(rope_algorithm, test_foreach_segment_reverse)
+{
+    std::mt19937 gen(1);
+    for (int i = 0; i < 200; ++i) {
+        text::rope r;
+        std::string expected;
+        random_rope(gen, r, expected);
+
+        std::string reversed;
+        r.foreach_segment_reverse([&reversed](auto const & s) {
+            reversed.insert(reversed.begin(), s.begin(), s.end());
+        });
+        EXPECT_EQ(reversed, expected);
+
+        int const lo = expected.empty() ? 0 : gen() % expected.size();
+        int const hi = lo + gen() % (expected.size() - lo + 1);
+        text::rope_view const rv(r, lo, hi, text::utf8::unchecked);
+        reversed.clear();
+        rv.foreach_segment_reverse([&reversed](auto const & s) {
+            reversed.insert(reversed.begin(), s.begin(), s.end());
+        });
+        EXPECT_EQ(reversed, expected.substr(lo, hi - lo))
+            << "lo=" << lo << " hi=" << hi;
+    }
+}
+
+TEST(rope_algorithm, test_random)
+{
+    std::mt19937 gen(2);
+    for (int i = 0; i < 300; ++i) {
+        text::rope r;
+        std::string expected;
+        random_rope(gen, r, expected);
+
+        for (int j = 0; j < 10; ++j) {
+            std::string const p = j < 5 ?
+                random_string(gen, 8, "aabc") : std::string(gen() % 30, 'a') + "b";
+            check_searches(r, expected, p);
+
+            int const lo = expected.empty() ? 0 : gen() % expected.size();
+            int const hi = lo + gen() % (expected.size() - lo + 1);
+            text::rope_view const rv(r, lo, hi, text::utf8::unchecked);
+            check_searches(rv, expected.substr(lo, hi - lo), p);
+        }
+    }
+}
+
+TEST(rope_algorithm, test_matches_span_segments)
+{
+    text::rope r;
+    r += text::text(std::string(600, 'x') + "ab");
+    r += text::repeated_text_view("c", 1);
+    r += text::text("d" + std::string(600, 'y'));
+
+    EXPECT_EQ(text::find(r, "abcd"), 600);
+    EXPECT_EQ(text::rfind(r, "abcd"), 600);
+    EXPECT_EQ(text::rfind(r, "xabcdy"), 599);
+    EXPECT_EQ(text::rfind(r, "bc"), 601);
+    EXPECT_EQ(text::rfind(r, "cd"), 602);
+    EXPECT_LT(text::rfind(r, "abd"), 0);
+    EXPECT_EQ(text::rfind(r, ""), r.size());
+
+    text::rope_view const all(r);
+    EXPECT_EQ(text::find_view(r, "bcd"), "bcd");
+    EXPECT_EQ(text::find_view(r, "bcd").begin() - all.begin(), 601);
+    EXPECT_EQ(text::rfind_view(r, "yy").begin() - all.begin(), 1202);
+    EXPECT_EQ(text::find_view(r, "abd"), text::rope_view());
+    EXPECT_EQ(text::rfind_view(r, "abd"), text::rope_view());
+
+    EXPECT_EQ(text::find_first_of(r, "cd"), 602);
+    EXPECT_EQ(text::find_last_of(r, "cx"), 602);
+    EXPECT_EQ(text::find_first_not_of(r, "x"), 600);
+    EXPECT_EQ(text::find_last_not_of(r, "y"), 603);
+    EXPECT_EQ(text::find_first_of(r, ""), 0);
+    EXPECT_EQ(text::find_last_of(r, ""), r.size());
+
+    text::rope_view const rv(r, 1, 604);
+    EXPECT_EQ(text::find(rv, "abcd"), 599);
+    EXPECT_EQ(text::rfind(rv, "x"), 598);
+    EXPECT_EQ(text::rfind_view(rv, "cd").begin() - rv.begin(), 601);
+    EXPECT_EQ(text::find_last_not_of(rv, "y"), 602);
+
+    text::rope const empty;
+    EXPECT_EQ(text::find(empty, "a"), -1);
+    EXPECT_EQ(text::rfind(empty, "a"), -1);
+    EXPECT_EQ(text::find_first_of(empty, "a"), -1);
+    EXPECT_EQ(text::find_last_not_of(text::rope_view(empty), "a"), -1);
+}
+
+namespace {
+
+    std::string expected_replace_all (
+        std::string s,
+        std::string const & p,
+        std::string const & replacement
+    ) {
+        if (p.empty())
+            return s;
+        for (auto pos = s.find(p); pos != std::string::npos;
+             pos = s.find(p, pos + replacement.size())) {
+            s.replace(pos, p.size(), replacement);
+        }
+        return s;
+    }
+
+    char const * segment_first (text::text_view tv)
+    { return tv.begin(); }
+
+    char const * segment_first (text::repeated_text_view)
+    { return nullptr; }
+
+}
+
+TEST(rope_algorithm, test_replace_all)
+{
+    std::mt19937 gen(3);
+    for (int i = 0; i < 300; ++i) {
+        text::rope r;
+        std::string expected;
+        random_rope(gen, r, expected);
+        text::rope const original = r;
+        std::string const original_expected = expected;
+
+        std::string const p = random_string(gen, 4, "aabc");
+        std::string const replacement = random_string(gen, 3, "aabc");
+        text::text_view const p_view(p.data(), p.size(), text::utf8::unchecked);
+        text::text_view const replacement_view(
+            replacement.data(), replacement.size(), text::utf8::unchecked
+        );
+
+        std::ptrdiff_t count = 0;
+        for (auto match : text::find_all(r, p_view)) {
+            (void)match;
+            ++count;
+        }
+        EXPECT_EQ(text::replace_all(r, p_view, replacement_view), count);
+        expected = expected_replace_all(expected, p, replacement);
+        EXPECT_EQ(std::string(r.begin(), r.end()), expected)
+            << "p=" << p << " replacement=" << replacement;
+
+        // Ropes that shared segments with r are unchanged.
+        EXPECT_EQ(std::string(original.begin(), original.end()), original_expected);
+
+        // The result is an ordinary rope.
+        r.insert(r.size() / 2, "xyz");
+        expected.insert(expected.size() / 2, "xyz");
+        EXPECT_EQ(std::string(r.begin(), r.end()), expected);
+    }
+}
+
+TEST(rope_algorithm, test_replace_all_does_not_copy)
+{
+    std::string const s = std::string(1000, 'a') + "needle" + std::string(1000, 'b') + "needle";
+    text::rope r{text::text(s)};
+    char const * original_first = nullptr;
+    r.foreach_segment([&original_first](auto const & segment) {
+        original_first = segment_first(segment);
+    });
+
+    EXPECT_EQ(text::replace_all(r, "needle", "pin"), 2);
+    EXPECT_EQ(std::string(r.begin(), r.end()), std::string(1000, 'a') + "pin" + std::string(1000, 'b') + "pin");
+
+    // The unchanged parts refer to the original text, and each replacement
+    // is the same segment.
+    std::vector<char const *> firsts;
+    r.foreach_segment([&firsts](auto const & segment) {
+        firsts.push_back(segment_first(segment));
+    });
+    ASSERT_EQ(firsts.size(), 4u);
+    EXPECT_EQ(firsts[0], original_first);
+    EXPECT_EQ(firsts[2], original_first + 1006);
+    EXPECT_EQ(firsts[1], firsts[3]);
+
+    EXPECT_EQ(text::replace_all(r, "pin", ""), 2);
+    EXPECT_EQ(std::string(r.begin(), r.end()), std::string(1000, 'a') + std::string(1000, 'b'));
+    EXPECT_EQ(text::replace_all(r, "", "x"), 0);
+    EXPECT_EQ(text::replace_all(r, "x", "y"), 0);
+
+    // Many matches make a tree deeper than one level.
+    text::rope many{text::text(std::string(5000, 'a'))};
+    EXPECT_EQ(text::replace_all(many, "aa", "b"), 2500);
+    EXPECT_EQ(std::string(many.begin(), many.end()), std::string(2500, 'b'));
+}
+
+namespace {
+
+    std::string ascii_upper (std::string s)
+    {
+        for (char & c : s) {
+            if ('a' <= c && c <= 'z')
+                c = c - 'a' + 'A';
+        }
+        return s;
+    }
+
+    int sign (int x)
+    { return x < 0 ? -1 : 0 < x ? 1 : 0; }
+
+}
+
+TEST(rope_algorithm, test_ascii_icase)
+{
+    text::rope r("Content-Type: ");
+    r += text::text(std::string(600, 'x'));
+    r += text::repeated_text_view("Ab", 3);
+    EXPECT_EQ(text::find_ascii_icase(r, "content-type"), 0);
+    EXPECT_EQ(text::find_ascii_icase(r, "XaBaB"), 613);
+    EXPECT_EQ(text::find_ascii_icase(r, "bab"), 615);
+    EXPECT_EQ(text::find_ascii_icase(r, "baa"), -1);
+    EXPECT_EQ(text::find_ascii_icase(r, ""), 0);
+    EXPECT_EQ(text::find_ascii_icase(text::rope_view(r, 1, r.size()), "ONTENT"), 0);
+
+    text::rope const same(text::text(ascii_upper(std::string(r.begin(), r.end()))));
+    EXPECT_EQ(text::compare_ascii_icase(r, same), 0);
+    EXPECT_TRUE(text::equal_ascii_icase(r, same));
+    EXPECT_FALSE(text::equal_ascii_icase(r, text::rope_view(same, 0, same.size() - 1)));
+    EXPECT_EQ(text::compare_ascii_icase(r, text::rope_view(same, 0, same.size() - 1)), 1);
+    EXPECT_EQ(text::compare_ascii_icase(text::rope(), r), -1);
+    EXPECT_EQ(text::compare_ascii_icase(r, "content-typf"), -1);
+}
+
+TEST(rope_algorithm, test_ascii_icase_random)
+{
+    std::mt19937 gen(5);
+    for (int i = 0; i < 300; ++i) {
+        text::rope r;
+        std::string expected;
+        random_rope(gen, r, expected);
+
+        // Another rope, with the same chars in upper case and different
+        // segment boundaries, or different chars.
+        std::string other = ascii_upper(expected);
+        if (i % 3 == 0 && !other.empty())
+            other[gen() % other.size()] = "abcd"[gen() % 4];
+        if (i % 5 == 0)
+            other.resize(gen() % (other.size() + 1));
+        text::rope other_r;
+        for (std::size_t lo = 0; lo < other.size(); lo += 700) {
+            other_r += text::text(other.substr(lo, 700));
+        }
+
+        // expected is all lower case.
+        std::string other_lower = other;
+        for (char & c : other_lower) {
+            c = text::detail::ascii_lower(c);
+        }
+        int const expected_compare = sign(expected.compare(other_lower));
+        EXPECT_EQ(sign(text::compare_ascii_icase(r, other_r)), expected_compare);
+        EXPECT_EQ(text::equal_ascii_icase(r, other_r), expected_compare == 0);
+
+        for (int j = 0; j < 5; ++j) {
+            std::string const p = random_string(gen, 6, "aabc");
+            auto const pos = expected.find(p);
+            std::ptrdiff_t const expected_find = p.empty() ? 0 : pos == std::string::npos ? -1 : (std::ptrdiff_t)pos;
+            std::string const upper_p = ascii_upper(p);
+            text::text_view const p_view(upper_p.data(), upper_p.size(), text::utf8::unchecked);
+            EXPECT_EQ(text::find_ascii_icase(r, p_view), expected_find) << "p=" << p;
+        }
+    }
+}
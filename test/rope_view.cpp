@@ -1,8 +1,14 @@
 #include <boost/text/rope_view.hpp>
 
+#include "random_text.hpp"
+
 #include <gtest/gtest.h>
 
 #include <iomanip>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 
 using namespace boost;
@@ -218,3 +224,120 @@ TEST(rope_view, test_unformatted_output)
         EXPECT_EQ(oss.str(), "abc");
     }
 }
+
+namespace {
+
+    int sign (int x)
+    { return x < 0 ? -1 : 0 < x ? 1 : 0; }
+
+    // Bytes >= 0x80 sort after all ASCII chars.
+    char const * const compare_alphabet = "aaab\xc3\xa9";
+    std::vector<char const *> const compare_views = {"a", "ab", "ba"};
+
+}
+
+TEST(rope_view, test_compare)
+{
+    // Non-ASCII chars compare greater than ASCII ones, as they do with
+    // memcmp().
+    EXPECT_LT(text::text_view("a"), text::text_view(u8"\u00e9"));
+    EXPECT_LT(text::rope_view(text::text_view("a")), text::rope_view(text::repeated_text_view(u8"\u00e9", 2)));
+    EXPECT_LT(text::rope("a"), text::rope(u8"\u00e9"));
+
+    text::rope big;
+    std::string big_expected;
+    for (int i = 0; i < 100; ++i) {
+        std::string const s = std::string(600, 'a') + std::to_string(i);
+        big += text::text(s);
+        big_expected += s;
+    }
+    text::rope const copy = big;
+    EXPECT_EQ(big.compare(copy), 0);
+    EXPECT_EQ(text::rope_view(big, 1, big.size()).compare(text::rope_view(copy, 1, copy.size())), 0);
+    EXPECT_LT(text::rope_view(big, 0, big.size() - 1), text::rope_view(copy));
+    EXPECT_LT(text::rope_view(big, 1, big.size()), text::rope_view(copy));
+
+    // The copy shares all but the changed leaf with big.
+    text::rope changed = big;
+    changed.replace(text::rope_view(changed, 30000, 30001), "b");
+    EXPECT_LT(big, changed);
+    EXPECT_GT(changed, big);
+    EXPECT_EQ(text::rope_view(big, 0, 30000), text::rope_view(changed, 0, 30000));
+    EXPECT_EQ(text::rope_view(big, 30001, big.size()), text::rope_view(changed, 30001, changed.size()));
+
+    std::mt19937 gen(6);
+    for (int i = 0; i < 2000; ++i) {
+        text::rope shared;
+        std::string shared_expected;
+        append_random_segments(gen, compare_alphabet, compare_views, 399, text::rope(), shared, shared_expected);
+
+        text::rope l;
+        text::rope r;
+        std::string l_expected;
+        std::string r_expected;
+        append_random_segments(gen, compare_alphabet, compare_views, 399, shared, l, l_expected);
+        if (i % 2) {
+            r = l;
+            r_expected = l_expected;
+        }
+        append_random_segments(gen, compare_alphabet, compare_views, 399, shared, r, r_expected);
+        if (i % 3 == 0)
+            append_random_segments(gen, compare_alphabet, compare_views, 399, shared, l, l_expected);
+
+        EXPECT_EQ(sign(l.compare(r)), sign(l_expected.compare(r_expected))) << "i=" << i;
+        EXPECT_EQ(sign(r.compare(l)), sign(r_expected.compare(l_expected))) << "i=" << i;
+
+        int const l_lo = l_expected.empty() ? 0 : gen() % l_expected.size();
+        int const r_lo = r_expected.empty() ? 0 : gen() % r_expected.size();
+        text::rope_view const l_rv(l, l_lo, l.size(), text::utf8::unchecked);
+        text::rope_view const r_rv(r, r_lo, r.size(), text::utf8::unchecked);
+        EXPECT_EQ(
+            sign(l_rv.compare(r_rv)),
+            sign(l_expected.substr(l_lo).compare(r_expected.substr(r_lo)))
+        ) << "i=" << i;
+        EXPECT_EQ(
+            sign(l_rv.compare(text::text_view(r_expected.c_str(), r_expected.size(), text::utf8::unchecked))),
+            sign(l_expected.substr(l_lo).compare(r_expected))
+        ) << "i=" << i;
+    }
+}
+
+TEST(rope_view, test_large_offsets)
+{
+    static_assert(std::is_same<text::text_view::size_type, std::ptrdiff_t>::value, "");
+    static_assert(std::is_same<text::text::size_type, std::ptrdiff_t>::value, "");
+    static_assert(std::is_same<text::repeated_text_view::size_type, std::ptrdiff_t>::value, "");
+    static_assert(std::is_same<text::rope_view::size_type, std::ptrdiff_t>::value, "");
+
+    // Sizes and offsets past INT_MAX, without allocating that much.
+    std::ptrdiff_t const count = std::ptrdiff_t(1) << 31;
+    text::repeated_text_view const rtv = text::repeat("abc", count);
+    EXPECT_EQ(rtv.size(), 3 * count);
+
+    std::ptrdiff_t const lo = 3 * count - 7;
+    std::ptrdiff_t const hi = 3 * count - 1;
+    EXPECT_EQ(rtv[lo], 'c');
+
+    text::rope_view const rv = rtv(lo, hi);
+    EXPECT_EQ(rv.size(), 6);
+    EXPECT_EQ(std::string(rv.begin(), rv.end()), "cabcab");
+    EXPECT_EQ(rv, text::rope_view(rtv, lo, hi));
+    EXPECT_EQ(text::rope_view(rtv)(-7, -1), rv);
+
+    text::rope r(rtv);
+    EXPECT_EQ(r.size(), 3 * count);
+    r.insert(lo + 1, text::text("x"));
+    EXPECT_EQ(r.size(), 3 * count + 1);
+    text::rope_view const r_rv = r(lo, hi + 1);
+    EXPECT_EQ(std::string(r_rv.begin(), r_rv.end()), "cxabcab");
+    EXPECT_EQ(r[hi], 'b');
+}
+
+TEST(rope_view, test_repeated_text_view_slice)
+{
+    text::repeated_text_view const rtv = text::repeat("abc", 3);
+    text::rope_view const rv = rtv(1, 5);
+    EXPECT_EQ(rv.size(), 4);
+    EXPECT_EQ(std::string(rv.begin(), rv.end()), "bcab");
+    EXPECT_EQ(rv, text::rope_view(rtv, 1, 5));
+}
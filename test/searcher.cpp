@@ -0,0 +1,139 @@
+#include <boost/text/searcher.hpp>
+
+#include "random_text.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+
+
+using namespace boost;
+
+namespace {
+
+    std::ptrdiff_t expected_find (std::string const & s, std::string const & p)
+    {
+        std::string::size_type const pos = s.find(p);
+        return pos == std::string::npos ? -1 : (std::ptrdiff_t)pos;
+    }
+
+}
+
+TEST(searcher, test_text_view)
+{
+    text::text_view const tv("abcabcabd");
+    text::searcher const s("abd");
+    EXPECT_EQ(s.pattern(), "abd");
+    EXPECT_EQ(text::find(tv, s), 6);
+    EXPECT_EQ(text::find(text::text("xyzabd"), s), 3);
+    EXPECT_EQ(text::find(std::string("xyzab"), s), -1);
+    EXPECT_LT(text::find(text::text_view(), s), 0);
+
+    auto const match = s(tv.begin(), tv.end());
+    EXPECT_EQ(match.first, tv.begin() + 6);
+    EXPECT_EQ(match.second, tv.end());
+
+    text::searcher const empty("");
+    EXPECT_EQ(text::find(tv, empty), 0);
+    EXPECT_EQ(text::find(text::text_view(), empty), 0);
+    EXPECT_EQ(empty(tv.begin(), tv.end()).first, tv.begin());
+    EXPECT_EQ(text::find(text::rope(tv), empty), 0);
+    EXPECT_EQ(text::find(text::repeated_text_view(tv, 2), empty), 0);
+}
+
+TEST(searcher, test_random)
+{
+    std::mt19937 gen(1);
+    for (int i = 0; i < 5000; ++i) {
+        std::string const s = random_string(gen, 200);
+        // Covers patterns on both sides of searcher_skip_table_min.
+        std::string const p = random_string(gen, 40);
+        text::searcher const searcher((text::text_view(p)));
+
+        EXPECT_EQ(text::find(s, searcher), expected_find(s, p))
+            << "s=" << s << " p=" << p;
+
+        auto const match = searcher(s.begin(), s.end());
+        auto const expected = std::search(s.begin(), s.end(), p.begin(), p.end());
+        EXPECT_EQ(match.first, expected);
+        EXPECT_EQ(match.second - match.first, expected == s.end() ? 0 : (std::ptrdiff_t)p.size());
+    }
+}
+
+TEST(searcher, test_repeated_text_view)
+{
+    std::mt19937 gen(2);
+    for (int i = 0; i < 5000; ++i) {
+        std::string const view = random_string(gen, 10);
+        int const count = gen() % 6;
+        std::string repeated;
+        for (int j = 0; j < count; ++j) {
+            repeated += view;
+        }
+        std::string const p = random_string(gen, 30);
+        text::searcher const searcher((text::text_view(p)));
+
+        text::repeated_text_view const rtv(text::text_view(view), count);
+        EXPECT_EQ(text::find(rtv, searcher), expected_find(repeated, p))
+            << "view=" << view << " count=" << count << " p=" << p;
+    }
+}
+
+TEST(searcher, test_rope)
+{
+    std::mt19937 gen(3);
+    for (int i = 0; i < 300; ++i) {
+        text::rope const shared(text::text(random_string(gen, 50)));
+        text::rope r;
+        std::string expected;
+        append_random_segments(gen, "aab", {"a", "b", "ab", "aab", "ba"}, 3, shared, r, expected);
+
+        int segment_count = 0;
+        r.foreach_segment([&segment_count](text::rope_view) { ++segment_count; });
+
+        for (int j = 0; j < 10; ++j) {
+            std::string const p = j < 5 ?
+                random_string(gen, 8) : std::string(gen() % 30, 'a') + "b";
+            text::searcher const searcher((text::text_view(p)));
+            EXPECT_EQ(text::find(r, searcher), expected_find(expected, p))
+                << "segments=" << segment_count << " p=" << p;
+
+            int const lo = expected.empty() ? 0 : gen() % expected.size();
+            int const hi = lo + gen() % (expected.size() - lo + 1);
+            text::rope_view const rv(r, lo, hi, text::utf8::unchecked);
+            EXPECT_EQ(
+                text::find(rv, searcher),
+                expected_find(expected.substr(lo, hi - lo), p)
+            ) << "lo=" << lo << " hi=" << hi << " p=" << p;
+        }
+    }
+}
+
+TEST(searcher, test_match_spans_segments)
+{
+    text::rope r;
+    r += text::text(std::string(600, 'x') + "ab");
+    r += text::repeated_text_view("c", 1);
+    r += text::text("d" + std::string(600, 'y'));
+    EXPECT_EQ(text::find(r, text::searcher("abcd")), 600);
+    EXPECT_EQ(text::find(r, text::searcher("xabcdy")), 599);
+    EXPECT_EQ(text::find(r, text::searcher("bc")), 601);
+    EXPECT_EQ(text::find(r, text::searcher("cd")), 602);
+    EXPECT_LT(text::find(r, text::searcher("abd")), 0);
+    EXPECT_EQ(text::find(text::rope_view(r, 1, 605), text::searcher("abcd")), 599);
+}
+
+#if 201703L <= __cplusplus
+TEST(searcher, test_std_search)
+{
+    std::string const s = "the quick brown fox";
+    text::searcher const searcher("brown");
+    EXPECT_EQ(std::search(s.begin(), s.end(), searcher) - s.begin(), 10);
+
+    text::text_view const tv(s.c_str());
+    EXPECT_EQ(std::search(tv.begin(), tv.end(), searcher) - tv.begin(), 10);
+}
+#endif
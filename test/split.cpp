@@ -0,0 +1,223 @@
+#include <boost/text/split.hpp>
+
+#include "random_text.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace boost;
+
+namespace {
+
+    std::vector<std::string> expected_find_all (std::string const & s, std::string const & p)
+    {
+        std::vector<std::string> retval;
+        if (p.empty())
+            return retval;
+        for (auto pos = s.find(p); pos != std::string::npos; pos = s.find(p, pos + p.size())) {
+            retval.push_back(p);
+        }
+        return retval;
+    }
+
+    std::vector<std::string> expected_split (std::string const & s, std::string const & delimiter)
+    {
+        if (delimiter.empty())
+            return std::vector<std::string>(1, s);
+        std::vector<std::string> retval;
+        std::string::size_type lo = 0;
+        while (true) {
+            auto const hi = s.find(delimiter, lo);
+            retval.push_back(s.substr(lo, hi - lo));
+            if (hi == std::string::npos)
+                break;
+            lo = hi + delimiter.size();
+        }
+        return retval;
+    }
+
+    std::vector<std::string> expected_lines (std::string const & s)
+    {
+        std::vector<std::string> retval;
+        std::string::size_type lo = 0;
+        while (lo < s.size()) {
+            auto hi = s.find('\n', lo);
+            if (hi == std::string::npos) {
+                retval.push_back(s.substr(lo));
+                break;
+            }
+            std::string line = s.substr(lo, hi - lo);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            retval.push_back(line);
+            lo = hi + 1;
+        }
+        return retval;
+    }
+
+    template <typename Range>
+    std::vector<std::string> to_strings (Range const & range)
+    {
+        std::vector<std::string> retval;
+        for (auto const & piece : range) {
+            retval.push_back(std::string(piece.begin(), piece.end()));
+        }
+        return retval;
+    }
+
+}
+
+TEST(split, test_find_all)
+{
+    text::text_view const tv("abcabcabd");
+    std::vector<std::ptrdiff_t> offsets;
+    for (text::text_view match : text::find_all(tv, "ab")) {
+        EXPECT_EQ(match, "ab");
+        offsets.push_back(match.begin() - tv.begin());
+    }
+    EXPECT_EQ(offsets, (std::vector<std::ptrdiff_t>{0, 3, 6}));
+
+    // Occurances do not overlap.
+    EXPECT_EQ(to_strings(text::find_all(text::text_view("aaaaa"), "aa")).size(), 2u);
+
+    EXPECT_TRUE(to_strings(text::find_all(tv, "")).empty());
+    EXPECT_TRUE(to_strings(text::find_all(text::text_view(), "a")).empty());
+    EXPECT_TRUE(to_strings(text::find_all(tv, "x")).empty());
+    EXPECT_EQ(to_strings(text::find_all(text::text("xyx"), "x")).size(), 2u);
+
+    std::mt19937 gen(1);
+    for (int i = 0; i < 3000; ++i) {
+        std::string const s = random_string(gen, 200);
+        std::string const p = random_string(gen, 5);
+        EXPECT_EQ(to_strings(text::find_all(s, text::text_view(p))), expected_find_all(s, p))
+            << "s=" << s << " p=" << p;
+    }
+}
+
+TEST(split, test_split)
+{
+    EXPECT_EQ(
+        to_strings(text::split(text::text_view("a,b,,c"), ",")),
+        (std::vector<std::string>{"a", "b", "", "c"})
+    );
+    EXPECT_EQ(
+        to_strings(text::split(text::text_view(",a,"), ",")),
+        (std::vector<std::string>{"", "a", ""})
+    );
+    EXPECT_EQ(
+        to_strings(text::split(text::text_view("a::b"), "::")),
+        (std::vector<std::string>{"a", "b"})
+    );
+    EXPECT_EQ(
+        to_strings(text::split(text::text_view(), ",")),
+        (std::vector<std::string>{""})
+    );
+    EXPECT_EQ(
+        to_strings(text::split(text::text_view("a,b"), "")),
+        (std::vector<std::string>{"a,b"})
+    );
+
+    // Pieces between multi-char code points are not checked, and need not
+    // be, since the delimiter is valid UTF-8.
+    text::text_view const tv(u8"é—è—");
+    EXPECT_EQ(
+        to_strings(text::split(tv, u8"—")),
+        (std::vector<std::string>{u8"é", u8"è", ""})
+    );
+
+    std::mt19937 gen(2);
+    for (int i = 0; i < 3000; ++i) {
+        std::string const s = random_string(gen, 200);
+        std::string const delimiter = random_string(gen, 4);
+        EXPECT_EQ(to_strings(text::split(s, text::text_view(delimiter))), expected_split(s, delimiter))
+            << "s=" << s << " delimiter=" << delimiter;
+    }
+}
+
+TEST(split, test_lines)
+{
+    EXPECT_EQ(
+        to_strings(text::lines(text::text_view("a\nb\r\n\nc"))),
+        (std::vector<std::string>{"a", "b", "", "c"})
+    );
+    EXPECT_EQ(
+        to_strings(text::lines(text::text_view("a\n"))),
+        (std::vector<std::string>{"a"})
+    );
+    EXPECT_EQ(
+        to_strings(text::lines(text::text_view("\n\r\n"))),
+        (std::vector<std::string>{"", ""})
+    );
+    EXPECT_EQ(
+        to_strings(text::lines(text::text_view("a\r"))),
+        (std::vector<std::string>{"a\r"})
+    );
+    EXPECT_TRUE(to_strings(text::lines(text::text_view())).empty());
+
+    std::mt19937 gen(3);
+    for (int i = 0; i < 3000; ++i) {
+        std::string const s = random_string(gen, 200, "ab\r\n");
+        EXPECT_EQ(to_strings(text::lines(s)), expected_lines(s));
+    }
+}
+
+TEST(split, test_iterators)
+{
+    auto const range = text::split(text::text_view("a,b"), ",");
+    auto it = range.begin();
+    EXPECT_EQ(*it, "a");
+    auto const prev = it++;
+    EXPECT_EQ(*prev, "a");
+    EXPECT_EQ(*it, "b");
+    EXPECT_NE(it, range.end());
+    ++it;
+    EXPECT_EQ(it, range.end());
+}
+
+TEST(split, test_rope)
+{
+    std::mt19937 gen(4);
+    for (int i = 0; i < 300; ++i) {
+        text::rope const shared(text::text(random_string(gen, 50, "ab\r\n")));
+        text::rope r;
+        std::string expected;
+        append_random_segments(gen, "ab\r\n", {"a", "\n", "ab", "\r\n", "ba"}, 3, shared, r, expected);
+
+        EXPECT_EQ(to_strings(text::lines(r)), expected_lines(expected));
+
+        int const lo = expected.empty() ? 0 : gen() % expected.size();
+        int const hi = lo + gen() % (expected.size() - lo + 1);
+        text::rope_view const rv(r, lo, hi, text::utf8::unchecked);
+        std::string const expected_rv = expected.substr(lo, hi - lo);
+        EXPECT_EQ(to_strings(text::lines(rv)), expected_lines(expected_rv));
+
+        for (int j = 0; j < 5; ++j) {
+            std::string const p = random_string(gen, 4);
+            text::text_view const p_view(p.data(), p.size(), text::utf8::unchecked);
+            EXPECT_EQ(to_strings(text::find_all(r, p_view)), expected_find_all(expected, p))
+                << "p=" << p;
+            EXPECT_EQ(to_strings(text::split(r, p_view)), expected_split(expected, p))
+                << "p=" << p;
+            EXPECT_EQ(to_strings(text::find_all(rv, p_view)), expected_find_all(expected_rv, p))
+                << "p=" << p;
+            EXPECT_EQ(to_strings(text::split(rv, p_view)), expected_split(expected_rv, p))
+                << "p=" << p;
+        }
+    }
+
+    // rope_views of text_views and repeated_text_views are split without
+    // checking the encoding of each piece.
+    text::text_view const tv(u8"é,è");
+    EXPECT_EQ(
+        to_strings(text::split(text::rope_view(tv), ",")),
+        (std::vector<std::string>{u8"é", u8"è"})
+    );
+    EXPECT_EQ(
+        to_strings(text::find_all(text::rope_view(text::repeated_text_view("ab", 3)), "ba")),
+        (std::vector<std::string>{"ba", "ba"})
+    );
+}
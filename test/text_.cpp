@@ -6,6 +6,7 @@
 #include <gtest/gtest.h>
 
 #include <list>
+#include <stdexcept>
 
 
 using namespace boost;
@@ -28,7 +29,7 @@ TEST(text, test_empty)
     EXPECT_EQ(t.size(), 0);
     EXPECT_EQ(t.begin(), t.end());
 
-    EXPECT_EQ(t.max_size(), INT_MAX);
+    EXPECT_EQ(t.max_size(), PTRDIFF_MAX - 1);
 
     EXPECT_EQ(t.compare(t), 0);
     EXPECT_TRUE(t == t);
@@ -122,8 +123,8 @@ TEST(text, test_non_empty_const_interface)
 
     EXPECT_EQ(t_ab[1], 'b');
 
-    EXPECT_EQ(t_a.max_size(), INT_MAX);
-    EXPECT_EQ(t_ab.max_size(), INT_MAX);
+    EXPECT_EQ(t_a.max_size(), PTRDIFF_MAX - 1);
+    EXPECT_EQ(t_ab.max_size(), PTRDIFF_MAX - 1);
 
     EXPECT_EQ(t_a.compare(t_ab), -1);
     EXPECT_FALSE(t_a == t_ab);
@@ -611,7 +612,7 @@ TEST(text, test_misc)
         EXPECT_EQ(t, "some text");
         EXPECT_EQ(t[t.size()], '\0');
         t.shrink_to_fit();
-        EXPECT_EQ(t.capacity(), 9);
+        EXPECT_EQ(t.capacity(), 15);
         EXPECT_EQ(t, "some text");
         EXPECT_EQ(t[t.size()], '\0');
     }
@@ -639,61 +640,61 @@ TEST(text, test_insert)
         text::text const ct("string");
 
         text::text t0 = ct;
-        EXPECT_EQ(t0.capacity(), 7);
+        EXPECT_EQ(t0.capacity(), 15);
         t0.insert(0, tv);
         EXPECT_EQ(t0, "a view string");
         EXPECT_EQ(t0[t0.size()], '\0');
 
         text::text t1 = ct;
-        EXPECT_EQ(t1.capacity(), 7);
+        EXPECT_EQ(t1.capacity(), 15);
         t1.insert(1, tv);
         EXPECT_EQ(t1, "sa view tring");
         EXPECT_EQ(t1[t1.size()], '\0');
 
         text::text t2 = ct;
-        EXPECT_EQ(t2.capacity(), 7);
+        EXPECT_EQ(t2.capacity(), 15);
         t2.insert(2, tv);
         EXPECT_EQ(t2, "sta view ring");
         EXPECT_EQ(t2[t2.size()], '\0');
 
         text::text t3 = ct;
-        EXPECT_EQ(t3.capacity(), 7);
+        EXPECT_EQ(t3.capacity(), 15);
         t3.insert(3, tv);
         EXPECT_EQ(t3, "stra view ing");
         EXPECT_EQ(t3[t3.size()], '\0');
 
         text::text t4 = ct;
-        EXPECT_EQ(t4.capacity(), 7);
+        EXPECT_EQ(t4.capacity(), 15);
         t4.insert(4, tv);
         EXPECT_EQ(t4, "stria view ng");
         EXPECT_EQ(t4[t4.size()], '\0');
 
         text::text t5 = ct;
-        EXPECT_EQ(t5.capacity(), 7);
+        EXPECT_EQ(t5.capacity(), 15);
         t5.insert(5, tv);
         EXPECT_EQ(t5, "strina view g");
         EXPECT_EQ(t5[t5.size()], '\0');
 
         text::text t6 = ct;
-        EXPECT_EQ(t6.capacity(), 7);
+        EXPECT_EQ(t6.capacity(), 15);
         t6.insert(6, tv);
         EXPECT_EQ(t6, "stringa view ");
         EXPECT_EQ(t6[t6.size()], '\0');
 
         text::text t7 = ct;
-        EXPECT_EQ(t7.capacity(), 7);
+        EXPECT_EQ(t7.capacity(), 15);
         t7.insert(6, t7(0, 3));
         EXPECT_EQ(t7, "stringstr");
         EXPECT_EQ(t7[t7.size()], '\0');
 
         text::text t8 = ct;
-        EXPECT_EQ(t8.capacity(), 7);
+        EXPECT_EQ(t8.capacity(), 15);
         t8.insert(2, t8(0, 3));
         EXPECT_EQ(t8, "ststrring");
         EXPECT_EQ(t8[t8.size()], '\0');
 
         text::text t9 = ct;
-        EXPECT_EQ(t9.capacity(), 7);
+        EXPECT_EQ(t9.capacity(), 15);
         t9.insert(6, t9(3, 6));
         EXPECT_EQ(t9, "stringing");
         EXPECT_EQ(t9[t9.size()], '\0');
@@ -703,61 +704,61 @@ TEST(text, test_insert)
         text::text const ct("string");
 
         text::text t0 = ct;
-        EXPECT_EQ(t0.capacity(), 7);
+        EXPECT_EQ(t0.capacity(), 15);
         t0.insert(0, rtv);
         EXPECT_EQ(t0, "a view a view a view string");
         EXPECT_EQ(t0[t0.size()], '\0');
 
         text::text t1 = ct;
-        EXPECT_EQ(t1.capacity(), 7);
+        EXPECT_EQ(t1.capacity(), 15);
         t1.insert(1, rtv);
         EXPECT_EQ(t1, "sa view a view a view tring");
         EXPECT_EQ(t1[t1.size()], '\0');
 
         text::text t2 = ct;
-        EXPECT_EQ(t2.capacity(), 7);
+        EXPECT_EQ(t2.capacity(), 15);
         t2.insert(2, rtv);
         EXPECT_EQ(t2, "sta view a view a view ring");
         EXPECT_EQ(t2[t2.size()], '\0');
 
         text::text t3 = ct;
-        EXPECT_EQ(t3.capacity(), 7);
+        EXPECT_EQ(t3.capacity(), 15);
         t3.insert(3, rtv);
         EXPECT_EQ(t3, "stra view a view a view ing");
         EXPECT_EQ(t3[t3.size()], '\0');
 
         text::text t4 = ct;
-        EXPECT_EQ(t4.capacity(), 7);
+        EXPECT_EQ(t4.capacity(), 15);
         t4.insert(4, rtv);
         EXPECT_EQ(t4, "stria view a view a view ng");
         EXPECT_EQ(t4[t4.size()], '\0');
 
         text::text t5 = ct;
-        EXPECT_EQ(t5.capacity(), 7);
+        EXPECT_EQ(t5.capacity(), 15);
         t5.insert(5, rtv);
         EXPECT_EQ(t5, "strina view a view a view g");
         EXPECT_EQ(t5[t5.size()], '\0');
 
         text::text t6 = ct;
-        EXPECT_EQ(t6.capacity(), 7);
+        EXPECT_EQ(t6.capacity(), 15);
         t6.insert(6, rtv);
         EXPECT_EQ(t6, "stringa view a view a view ");
         EXPECT_EQ(t6[t6.size()], '\0');
 
         text::text t7 = ct;
-        EXPECT_EQ(t7.capacity(), 7);
+        EXPECT_EQ(t7.capacity(), 15);
         t7.insert(6, text::repeated_text_view(t7(0, 3), 2));
         EXPECT_EQ(t7, "stringstrstr");
         EXPECT_EQ(t7[t7.size()], '\0');
 
         text::text t8 = ct;
-        EXPECT_EQ(t8.capacity(), 7);
+        EXPECT_EQ(t8.capacity(), 15);
         t8.insert(2, text::repeated_text_view(t8(0, 3), 2));
         EXPECT_EQ(t8, "ststrstrring");
         EXPECT_EQ(t8[t8.size()], '\0');
 
         text::text t9 = ct;
-        EXPECT_EQ(t9.capacity(), 7);
+        EXPECT_EQ(t9.capacity(), 15);
         t9.insert(6, text::repeated_text_view(t9(3, 6), 2));
         EXPECT_EQ(t9, "stringinging");
         EXPECT_EQ(t9[t9.size()], '\0');
@@ -772,43 +773,43 @@ TEST(text, test_insert)
         auto const last = text::utf8::from_utf32_iterator<uint32_t const *>(utf32 + 4);
 
         text::text t0 = ct;
-        EXPECT_EQ(t0.capacity(), 7);
+        EXPECT_EQ(t0.capacity(), 15);
         t0.insert(0, first, last);
         EXPECT_EQ(t0, "\x4d\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82string");
         EXPECT_EQ(t0[t0.size()], '\0');
 
         text::text t1 = ct;
-        EXPECT_EQ(t1.capacity(), 7);
+        EXPECT_EQ(t1.capacity(), 15);
         t1.insert(1, first, last);
         EXPECT_EQ(t1, "s\x4d\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82tring");
         EXPECT_EQ(t1[t1.size()], '\0');
 
         text::text t2 = ct;
-        EXPECT_EQ(t2.capacity(), 7);
+        EXPECT_EQ(t2.capacity(), 15);
         t2.insert(2, first, last);
         EXPECT_EQ(t2, "st\x4d\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82ring");
         EXPECT_EQ(t2[t2.size()], '\0');
 
         text::text t3 = ct;
-        EXPECT_EQ(t3.capacity(), 7);
+        EXPECT_EQ(t3.capacity(), 15);
         t3.insert(3, first, last);
         EXPECT_EQ(t3, "str\x4d\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82ing");
         EXPECT_EQ(t3[t3.size()], '\0');
 
         text::text t4 = ct;
-        EXPECT_EQ(t4.capacity(), 7);
+        EXPECT_EQ(t4.capacity(), 15);
         t4.insert(4, first, last);
         EXPECT_EQ(t4, "stri\x4d\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82ng");
         EXPECT_EQ(t4[t4.size()], '\0');
 
         text::text t5 = ct;
-        EXPECT_EQ(t5.capacity(), 7);
+        EXPECT_EQ(t5.capacity(), 15);
         t5.insert(5, first, last);
         EXPECT_EQ(t5, "strin\x4d\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82g");
         EXPECT_EQ(t5[t5.size()], '\0');
 
         text::text t6 = ct;
-        EXPECT_EQ(t6.capacity(), 7);
+        EXPECT_EQ(t6.capacity(), 15);
         t6.insert(6, first, last);
         EXPECT_EQ(t6, "string\x4d\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82");
         EXPECT_EQ(t6[t6.size()], '\0');
@@ -1331,6 +1332,311 @@ TEST(text, test_replace_iter_large_insertions)
     }
 }
 
+namespace {
+
+    // Yields chars from a std::string, and throws when it reaches
+    // throw_at.
+    struct throwing_input_iterator
+    {
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = char const *;
+        using reference = char;
+        using iterator_category = std::input_iterator_tag;
+
+        char operator* () const
+        {
+            if (n_ == throw_at_)
+                throw std::runtime_error("throwing_input_iterator");
+            return (*s_)[n_];
+        }
+        throwing_input_iterator & operator++ ()
+        { ++n_; return *this; }
+
+        friend bool operator== (throwing_input_iterator lhs, throwing_input_iterator rhs)
+        { return lhs.n_ == rhs.n_; }
+        friend bool operator!= (throwing_input_iterator lhs, throwing_input_iterator rhs)
+        { return lhs.n_ != rhs.n_; }
+
+        std::string const * s_;
+        std::ptrdiff_t n_;
+        std::ptrdiff_t throw_at_;
+    };
+
+}
+
+TEST(text, test_insert_iter_growth)
+{
+    std::string const s(10000, 'x');
+    std::list<char> const chars(s.begin(), s.end());
+
+    // Iterators of unknown length, at the start, middle, and end.
+    for (int at : {0, 3, 6}) {
+        text::text t("string");
+        t.insert(at, chars.begin(), chars.end());
+        std::string expected("string");
+        expected.insert(at, s);
+        EXPECT_EQ(t, text::text(expected));
+        EXPECT_EQ(t.end()[0], '\0');
+    }
+
+    {
+        text::text t("0123456789");
+        throwing_input_iterator const last{&s, (std::ptrdiff_t)s.size(), -1};
+        t.insert(5, throwing_input_iterator{&s, 0, -1}, last);
+        EXPECT_EQ(t.size(), 10 + (int)s.size());
+        EXPECT_EQ(t(0, 5), "01234");
+        EXPECT_EQ(t(-5), "56789");
+
+        // An exception leaves the text as it was, even after its storage
+        // has grown.
+        text::text const before = t;
+        throwing_input_iterator const first{&s, 0, 9000};
+        EXPECT_THROW(t.insert(3, first, last), std::runtime_error);
+        EXPECT_EQ(t, before);
+        EXPECT_EQ(t.end()[0], '\0');
+        EXPECT_THROW(t.replace(t.begin() + 3, t.begin() + 8, first, last), std::runtime_error);
+        EXPECT_EQ(t, before);
+    }
+
+    // Random access iterators into *this, with and without reallocation.
+    {
+        text::text t("0123456789");
+        t.reserve(100);
+        t.insert(2, t.begin() + 4, t.end());
+        EXPECT_EQ(t, "0145678923456789");
+        t.insert(t.begin() + 1, t.begin(), t.end());
+        EXPECT_EQ(t, "00145678923456789145678923456789");
+    }
+    {
+        text::text t("0123456789abcdef");
+        t.insert(16, t.begin(), t.end());
+        EXPECT_EQ(t, "0123456789abcdef0123456789abcdef");
+        t.replace(t.begin() + 1, t.begin() + 31, t.begin() + 30, t.end());
+        EXPECT_EQ(t, "0eff");
+    }
+
+    // Iterators of unknown length into *this, appended past the end of
+    // local and heap storage.
+    for (std::string const & str : {std::string("0123456789"), std::string(100, 'x') + "0123456789"}) {
+        text::text t(str);
+        t.shrink_to_fit();
+        using to_utf32 = text::utf8::to_utf32_iterator<char const *>;
+        using from_utf32 = text::utf8::from_utf32_iterator<to_utf32>;
+        char const * const first = t.begin();
+        char const * const last = t.end();
+        t.insert(
+            t.size(),
+            from_utf32(to_utf32(first)),
+            from_utf32(to_utf32(last))
+        );
+        EXPECT_EQ(t, text::text(str + str));
+        EXPECT_EQ(t.end()[0], '\0');
+    }
+}
+
+// Texts of up to 15 chars are stored within the text object, and move to
+// the heap and back as they grow and shrink.
+TEST(text, test_small_buffer)
+{
+    text::text_view const small("0123456789abcde");
+    text::text_view const large("0123456789abcdef");
+
+    // The local chars share their bytes with the heap pointer and
+    // capacity.
+    EXPECT_EQ(sizeof(text::text), 16 + sizeof(text::text::size_type));
+
+    {
+        text::text const t;
+        EXPECT_EQ(t.capacity(), 15);
+        EXPECT_EQ(t[t.size()], '\0');
+        EXPECT_GE(t.begin(), (char const *)&t);
+        EXPECT_LT(t.begin(), (char const *)(&t + 1));
+    }
+
+    {
+        text::text t(small);
+        EXPECT_EQ(t.capacity(), 15);
+        EXPECT_GE(t.begin(), (char const *)&t);
+        EXPECT_LT(t.begin(), (char const *)(&t + 1));
+
+        t.insert(0, "x");
+        EXPECT_EQ(t, "x0123456789abcde");
+        EXPECT_EQ(t[t.size()], '\0');
+        EXPECT_GT(t.capacity(), 15);
+        EXPECT_FALSE(t.begin() >= (char const *)&t && t.begin() < (char const *)(&t + 1));
+
+        t.erase(t(0, 1));
+        EXPECT_EQ(t, small);
+        EXPECT_GT(t.capacity(), 15);
+        t.shrink_to_fit();
+        EXPECT_EQ(t, small);
+        EXPECT_EQ(t[t.size()], '\0');
+        EXPECT_EQ(t.capacity(), 15);
+        EXPECT_GE(t.begin(), (char const *)&t);
+        EXPECT_LT(t.begin(), (char const *)(&t + 1));
+
+        t.shrink_to_fit();
+        EXPECT_EQ(t, small);
+        EXPECT_EQ(t.capacity(), 15);
+    }
+
+    {
+        text::text t(large);
+        EXPECT_EQ(t, large);
+        t.shrink_to_fit();
+        EXPECT_EQ(t, large);
+        EXPECT_EQ(t.capacity(), 16);
+        EXPECT_EQ(t[t.size()], '\0');
+    }
+
+    {
+        text::text t("abc");
+        t.reserve(10);
+        EXPECT_EQ(t.capacity(), 15);
+        t.reserve(100);
+        EXPECT_EQ(t.capacity(), 100);
+        EXPECT_EQ(t, "abc");
+        EXPECT_EQ(t[t.size()], '\0');
+        t.clear();
+        EXPECT_EQ(t.size(), 0);
+        EXPECT_EQ(t.capacity(), 100);
+        EXPECT_EQ(t[t.size()], '\0');
+    }
+
+    // Self-referencing insertions and replacements.
+    {
+        text::text t("abcdefgh");
+        t.insert(4, t);
+        EXPECT_EQ(t, "abcdabcdefghefgh");
+        EXPECT_EQ(t[t.size()], '\0');
+
+        text::text t2("abcd");
+        t2.insert(2, t2);
+        EXPECT_EQ(t2, "ababcdcd");
+        EXPECT_EQ(t2[t2.size()], '\0');
+
+        text::text t3("abcd");
+        t3.replace(t3(0, 1), t3);
+        EXPECT_EQ(t3, "abcdbcd");
+
+        text::text t4("abcd");
+        t4.replace(t4(0, 1), text::repeated_text_view(t4, 5));
+        EXPECT_EQ(t4, "abcdabcdabcdabcdabcdbcd");
+        EXPECT_EQ(t4[t4.size()], '\0');
+    }
+
+    // Self-referencing reverse iterators, with room to insert in place.
+    {
+        text::text t("abcdef");
+        t.reserve(100);
+        t.replace(t.begin(), t.begin() + 1, t.crbegin(), t.crend());
+        EXPECT_EQ(t, "fedcbabcdef");
+        EXPECT_EQ(t[t.size()], '\0');
+
+        text::text t2("abcdef");
+        t2.reserve(100);
+        t2.insert(0, t2.crbegin(), t2.crend());
+        EXPECT_EQ(t2, "fedcbaabcdef");
+        EXPECT_EQ(t2[t2.size()], '\0');
+
+        text::text t3("abcdef");
+        t3.reserve(100);
+        t3.insert(3, t3.rbegin(), t3.rend());
+        EXPECT_EQ(t3, "abcfedcbadef");
+        EXPECT_EQ(t3[t3.size()], '\0');
+
+        text::text t4("abcdef");
+        t4.reserve(100);
+        t4.replace(t4.begin() + 4, t4.end(), t4.rbegin(), t4.rbegin() + 3);
+        EXPECT_EQ(t4, "abcdfed");
+        EXPECT_EQ(t4[t4.size()], '\0');
+
+        text::text t5("abcdef");
+        t5.insert(6, t5.crbegin(), t5.crend());
+        EXPECT_EQ(t5, "abcdeffedcba");
+        EXPECT_EQ(t5[t5.size()], '\0');
+    }
+
+    for (text::text_view tv : {text::text_view(), text::text_view("abc"), small, large}) {
+        for (text::text_view tv2 : {text::text_view(), text::text_view("xy"), small, large}) {
+            text::text const ct(tv);
+            text::text const ct2(tv2);
+
+            text::text copy(ct);
+            EXPECT_EQ(copy, tv);
+            EXPECT_EQ(copy[copy.size()], '\0');
+
+            text::text moved(std::move(copy));
+            EXPECT_EQ(moved, tv);
+            EXPECT_EQ(moved[moved.size()], '\0');
+            EXPECT_EQ(copy, "");
+            EXPECT_EQ(copy[copy.size()], '\0');
+            copy = "reused";
+            EXPECT_EQ(copy, "reused");
+
+            text::text t(ct);
+            text::text t2(ct2);
+            t.swap(t2);
+            EXPECT_EQ(t, tv2);
+            EXPECT_EQ(t2, tv);
+            EXPECT_EQ(t[t.size()], '\0');
+            EXPECT_EQ(t2[t2.size()], '\0');
+
+            t = ct;
+            EXPECT_EQ(t, tv);
+            t = std::move(t2);
+            EXPECT_EQ(t, tv);
+            t = ct2;
+            EXPECT_EQ(t, tv2);
+
+            t += ct;
+            EXPECT_EQ(t, tv2 + ct);
+            EXPECT_EQ(t[t.size()], '\0');
+
+            text::text from_iters(tv2.begin(), tv2.end());
+            from_iters.insert(from_iters.begin(), tv.begin(), tv.end());
+            EXPECT_EQ(from_iters, tv + ct2);
+            EXPECT_EQ(from_iters[from_iters.size()], '\0');
+        }
+    }
+}
+
+TEST(text, test_repair_encoding)
+{
+    {
+        text::text t("valid \xe4\xba\x8c");
+        char const * const data = t.begin();
+        t.repair_encoding();
+        EXPECT_EQ(t, "valid \xe4\xba\x8c");
+        EXPECT_EQ(t.begin(), data);
+    }
+
+    {
+        char const str[] = "a\xe0\x80" "b\xf0\x90\x8c" "c\xff";
+        text::text_view const tv(str, sizeof(str) - 1, text::utf8::unchecked);
+        text::text const expected("a\xef\xbf\xbd\xef\xbf\xbd" "b\xef\xbf\xbd" "c\xef\xbf\xbd");
+
+        text::text const repaired = text::repair_encoding(tv);
+        EXPECT_EQ(repaired, expected);
+
+        text::text t(tv.begin(), tv.end());
+        t.repair_encoding();
+        EXPECT_EQ(t, expected);
+    }
+
+    {
+        // A trailing null is kept.
+        char const str[] = "\xff" "a";
+        text::text const repaired =
+            text::repair_encoding(text::text_view(str, sizeof(str), text::utf8::unchecked));
+        EXPECT_EQ(repaired.size(), 5);
+        EXPECT_EQ(repaired[4], '\0');
+    }
+
+    EXPECT_EQ(text::repair_encoding(text::text_view()), "");
+}
+
 TEST(text, test_unformatted_output)
 {
     {
@@ -0,0 +1,144 @@
+#include <boost/text/text_builder.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+
+using namespace boost;
+
+TEST(text_builder, test_empty)
+{
+    text::text_builder b;
+    EXPECT_TRUE(b.empty());
+    EXPECT_EQ(b.size(), 0);
+    EXPECT_EQ(b.capacity(), 15);
+
+    text::text const t = b.finish();
+    EXPECT_EQ(t, "");
+    EXPECT_EQ(t.begin()[0], '\0');
+
+    text::rope const r = b.finish_rope();
+    EXPECT_TRUE(r.empty());
+}
+
+TEST(text_builder, test_append)
+{
+    std::string const yz = "yz";
+    text::text_builder b;
+    b.append("{\"a\":").append(text::text_view("[1, "))
+        .append(text::repeated_text_view("ab", 3))
+        .append('x')
+        .append(yz.data(), yz.data() + 0);
+    b.append_code_point(0x4d).append_code_point(0x430).append_code_point(0x4e8c)
+        .append_code_point(0x10302).append_code_point(0xd800).append_code_point(0x110000);
+    EXPECT_EQ(b.size(), 5 + 4 + 6 + 1 + 10 + 6);
+
+    text::text const t = b.finish();
+    EXPECT_EQ(
+        t,
+        text::text_view("{\"a\":[1, abababx\x4d\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82\xef\xbf\xbd\xef\xbf\xbd")
+    );
+    EXPECT_EQ(t.end()[0], '\0');
+    EXPECT_TRUE(b.empty());
+
+    b.append("more");
+    EXPECT_EQ(b.finish(), "more");
+}
+
+TEST(text_builder, test_append_wide_chars)
+{
+    text::text_builder b;
+    b.append(u'x').append(U'\u00e9').append(u'\u4e8c').append(U'\U00010302')
+        .append(L'y').append(L'\u0430').append((char16_t)0xd800);
+    EXPECT_EQ(
+        b.finish(),
+        text::text_view("x\xc3\xa9\xe4\xba\x8c\xf0\x90\x8c\x82y\xd0\xb0\xef\xbf\xbd")
+    );
+}
+
+TEST(text_builder, test_append_integers)
+{
+    text::text_builder b;
+    b.append(0).append(' ').append(-1).append(' ').append(42u).append(' ')
+        .append(std::numeric_limits<int>::min()).append(' ')
+        .append(std::numeric_limits<long long>::min()).append(' ')
+        .append(std::numeric_limits<unsigned long long>::max()).append(' ')
+        .append((short)-300).append(' ').append((unsigned char)255).append(' ')
+        .append((signed char)-128);
+    EXPECT_EQ(
+        b.finish(),
+        "0 -1 42 -2147483648 -9223372036854775808 18446744073709551615 -300 255 -128"
+    );
+}
+
+TEST(text_builder, test_append_floating_point)
+{
+    for (double x : {0.0, -0.5, 0.1, 1.0 / 3.0, 1e300, -2.5e-300, 123456789.0}) {
+        text::text_builder b;
+        b.append(x);
+        text::text const t = b.finish();
+        EXPECT_EQ(std::strtod(t.begin(), nullptr), x) << t;
+    }
+    for (float x : {0.1f, -3.25f, 1e30f}) {
+        text::text_builder b;
+        b.append(x);
+        text::text const t = b.finish();
+        EXPECT_EQ((float)std::strtod(t.begin(), nullptr), x) << t;
+    }
+    {
+        text::text_builder b;
+        b.append(0.5).append(',').append(2.0L);
+        EXPECT_EQ(b.finish(), "0.5,2");
+    }
+}
+
+TEST(text_builder, test_growth_and_reserve)
+{
+    text::text_builder b(1000);
+    EXPECT_LE(1000, b.capacity());
+    std::ptrdiff_t const reserved = b.capacity();
+
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        b.append("0123456789");
+        expected += "0123456789";
+    }
+    EXPECT_EQ(b.capacity(), reserved);
+
+    for (int i = 0; i < 10000; ++i) {
+        b.append(i).append(',');
+        expected += std::to_string(i) + ",";
+    }
+    EXPECT_EQ(b.size(), (std::ptrdiff_t)expected.size());
+
+    b.reserve(b.size() + 100000);
+    std::ptrdiff_t const capacity = b.capacity();
+
+    // The result takes the builder's storage.
+    text::text const t = b.finish();
+    EXPECT_EQ(t.capacity(), capacity);
+    EXPECT_EQ(std::string(t.begin(), t.end()), expected);
+
+    b.append("x");
+    b.clear();
+    EXPECT_TRUE(b.empty());
+}
+
+TEST(text_builder, test_invalid_encoding)
+{
+    text::text_builder b;
+    b.append("abc").append('\xe4').append('\xba');
+    EXPECT_THROW(b.finish(), std::invalid_argument);
+    EXPECT_THROW(b.finish_rope(), std::invalid_argument);
+    EXPECT_EQ(b.size(), 5);
+
+    // Completing the code point makes the whole valid.
+    b.append('\x8c');
+    text::rope const r = b.finish_rope();
+    EXPECT_EQ(r, text::text_view("abc\xe4\xba\x8c"));
+    EXPECT_TRUE(b.empty());
+}
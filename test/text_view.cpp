@@ -19,7 +19,7 @@ TEST(text_view, test_empty)
     EXPECT_EQ(tv.size(), 0);
     EXPECT_EQ(tv.begin(), nullptr);
 
-    EXPECT_EQ(tv.max_size(), INT_MAX);
+    EXPECT_EQ(tv.max_size(), PTRDIFF_MAX);
 
     EXPECT_EQ(tv.compare(tv), 0);
     EXPECT_TRUE(tv == tv);
@@ -84,7 +84,7 @@ TEST(text_view, test_empty_constexpr)
     // constexpr char back () const noexcept
     // constexpr char operator[] (int i) const noexcept
 
-    static_assert(tv.max_size() == INT_MAX, "");
+    static_assert(tv.max_size() == PTRDIFF_MAX, "");
 
     static_assert(tv.compare(tv) == 0, "");
     static_assert(tv == tv, "");
@@ -167,8 +167,8 @@ TEST(text_view, test_non_empty)
 
     EXPECT_EQ(tv_ab[1], 'b');
 
-    EXPECT_EQ(tv_a.max_size(), INT_MAX);
-    EXPECT_EQ(tv_ab.max_size(), INT_MAX);
+    EXPECT_EQ(tv_a.max_size(), PTRDIFF_MAX);
+    EXPECT_EQ(tv_ab.max_size(), PTRDIFF_MAX);
 
     EXPECT_EQ(tv_a.compare(tv_ab), -1);
     EXPECT_FALSE(tv_a == tv_ab);
@@ -217,8 +217,8 @@ TEST(text_view, test_non_empty_constexpr)
 
     static_assert(tv_ab[1] == 'b', "");
 
-    static_assert(tv_a.max_size() == INT_MAX, "");
-    static_assert(tv_ab.max_size() == INT_MAX, "");
+    static_assert(tv_a.max_size() == PTRDIFF_MAX, "");
+    static_assert(tv_ab.max_size() == PTRDIFF_MAX, "");
 
     static_assert(tv_a.compare(tv_ab) == -1, "");
     static_assert(!(tv_a == tv_ab), "");
@@ -263,6 +263,33 @@ TEST(text_view, test_non_empty_constexpr)
 
 #endif
 
+TEST(text_view, test_literal_macro)
+{
+    {
+        constexpr text::text_view tv = BOOST_TEXT_LITERAL("a\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82");
+        static_assert(tv.size() == 10, "");
+        EXPECT_EQ(tv, text::text_view("a\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82"));
+    }
+
+    {
+        // Embedded nulls are part of the literal.
+        constexpr text::text_view tv = BOOST_TEXT_LITERAL("a\0b");
+        static_assert(tv.size() == 3, "");
+        EXPECT_EQ(tv[1], '\0');
+    }
+
+    {
+        constexpr text::text_view tv = BOOST_TEXT_LITERAL("");
+        static_assert(tv.empty(), "");
+    }
+
+    text::text const t(BOOST_TEXT_LITERAL("text"));
+    EXPECT_EQ(t, "text");
+
+    // Does not compile:
+    // BOOST_TEXT_LITERAL("\xe0\x80");
+}
+
 TEST(text_view, test_substr)
 {
     text::text_view tv_empty;
@@ -0,0 +1,314 @@
+#include <boost/text/transcode.hpp>
+
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace boost;
+
+namespace {
+
+    std::string random_utf8 (std::mt19937 & gen, bool corrupt)
+    {
+        uint32_t const code_points[] = {
+            0x0, 0x61, 0x7f, 0x80, 0x430, 0x7ff, 0x800, 0x4e8c, 0xd7ff, 0xe000,
+            0xfdd0, 0xfffd, 0xffff, 0x10000, 0x10302, 0x1f600, 0x10ffff
+        };
+        int const num_code_points = sizeof(code_points) / sizeof(code_points[0]);
+
+        std::string retval;
+        int const length = gen() % 300;
+        int const ascii_percent = gen() % 101;
+        int const two_byte_percent = gen() % 101;
+        while ((int)retval.size() < length) {
+            uint32_t cp = 0;
+            if ((int)(gen() % 100) < ascii_percent)
+                cp = 'a' + gen() % 26;
+            else if ((int)(gen() % 100) < two_byte_percent)
+                cp = 0x80 + gen() % 0x780;
+            else
+                cp = code_points[gen() % num_code_points];
+            uint32_t const utf32[] = {cp};
+            retval.insert(
+                retval.end(),
+                text::utf8::from_utf32_iterator<uint32_t const *>(utf32),
+                text::utf8::from_utf32_iterator<uint32_t const *>(utf32 + 1)
+            );
+        }
+
+        if (corrupt && !retval.empty()) {
+            int const corruptions = 1 + gen() % 4;
+            for (int i = 0; i < corruptions; ++i) {
+                retval[gen() % retval.size()] = char(gen() % 256);
+            }
+            retval.resize(gen() % (retval.size() + 1));
+        }
+
+        return retval;
+    }
+
+    // The iterators do not know where the end of the sequence is; they read
+    // the null terminator of s and stop there, which gives the same result
+    // as the bounded bulk transcoding.
+    std::vector<uint32_t> iterator_utf32 (std::string const & s)
+    {
+        using iter_t = text::utf8::to_utf32_iterator<char const *>;
+        return std::vector<uint32_t>(
+            iter_t(s.c_str()),
+            iter_t(s.c_str() + s.size())
+        );
+    }
+
+    std::vector<uint16_t> iterator_utf16 (std::string const & s)
+    {
+        using iter_t = text::utf8::to_utf16_iterator<char const *>;
+        return std::vector<uint16_t>(
+            iter_t(s.c_str()),
+            iter_t(s.c_str() + s.size())
+        );
+    }
+
+}
+
+TEST(transcode, test_to_utf32_matches_iterator)
+{
+    std::mt19937 gen(1);
+    for (int i = 0; i < 5000; ++i) {
+        std::string const s = random_utf8(gen, i % 2 == 1);
+        std::vector<uint32_t> const expected = iterator_utf32(s);
+
+        std::vector<uint32_t> result;
+        auto const r = text::utf8::transcode_to_utf32(
+            s.c_str(), s.c_str() + s.size(), std::back_inserter(result)
+        );
+        EXPECT_EQ(r.in, s.c_str() + s.size());
+        EXPECT_EQ(result, expected);
+    }
+}
+
+TEST(transcode, test_to_utf16_matches_iterator)
+{
+    std::mt19937 gen(2);
+    for (int i = 0; i < 5000; ++i) {
+        std::string const s = random_utf8(gen, i % 2 == 1);
+        std::vector<uint16_t> const expected = iterator_utf16(s);
+
+        std::vector<uint16_t> result;
+        auto const r = text::utf8::transcode_to_utf16(
+            s.c_str(), s.c_str() + s.size(), std::back_inserter(result)
+        );
+        EXPECT_EQ(r.in, s.c_str() + s.size());
+        EXPECT_EQ(result, expected);
+    }
+}
+
+TEST(transcode, test_from_utf32_matches_iterator)
+{
+    std::mt19937 gen(3);
+    for (int i = 0; i < 5000; ++i) {
+        std::vector<uint32_t> utf32 = iterator_utf32(random_utf8(gen, false));
+        if (i % 2 == 1 && !utf32.empty()) {
+            uint32_t const invalid[] = {0xd800, 0xdfff, 0x110000, 0xffffffff, 0xfffe};
+            utf32[gen() % utf32.size()] = invalid[gen() % 5];
+        }
+
+        using iter_t = text::utf8::from_utf32_iterator<uint32_t const *>;
+        std::string const expected(
+            iter_t(utf32.data()),
+            iter_t(utf32.data() + utf32.size())
+        );
+
+        std::string result;
+        auto const r = text::utf8::transcode_from_utf32(
+            utf32.data(), utf32.data() + utf32.size(), std::back_inserter(result)
+        );
+        EXPECT_EQ(r.in, utf32.data() + utf32.size());
+        EXPECT_EQ(result, expected);
+    }
+}
+
+TEST(transcode, test_from_utf16_matches_iterator)
+{
+    std::mt19937 gen(4);
+    for (int i = 0; i < 5000; ++i) {
+        std::vector<uint16_t> utf16 = iterator_utf16(random_utf8(gen, false));
+        if (i % 2 == 1 && !utf16.empty()) {
+            // from_utf16_iterator asserts on an unpaired high surrogate, so
+            // only unpaired low surrogates are used here.
+            utf16[gen() % utf16.size()] = 0xdc00 + gen() % 0x400;
+        }
+
+        using iter_t = text::utf8::from_utf16_iterator<uint16_t const *>;
+        std::string const expected(
+            iter_t(utf16.data()),
+            iter_t(utf16.data() + utf16.size())
+        );
+
+        std::string result;
+        auto const r = text::utf8::transcode_from_utf16(
+            utf16.data(), utf16.data() + utf16.size(), std::back_inserter(result)
+        );
+        EXPECT_EQ(r.in, utf16.data() + utf16.size());
+        EXPECT_EQ(result, expected);
+    }
+}
+
+TEST(transcode, test_from_utf16_unpaired_high_surrogate)
+{
+    uint16_t const utf16[] = {0x61, 0xd800, 0x62, 0xd801};
+    char buf[16];
+    auto const r = text::utf8::transcode_from_utf16(utf16, utf16 + 4, buf, buf + 16);
+    EXPECT_EQ(r.in, utf16 + 4);
+    EXPECT_EQ(std::string(buf, r.out), "a\xef\xbf\xbd" "b\xef\xbf\xbd");
+}
+
+TEST(transcode, test_resume)
+{
+    std::mt19937 gen(5);
+    for (int i = 0; i < 2000; ++i) {
+        std::string const s = random_utf8(gen, i % 2 == 1);
+
+        {
+            std::vector<uint32_t> const expected = iterator_utf32(s);
+            std::vector<uint32_t> result;
+            char const * first = s.c_str();
+            char const * const last = first + s.size();
+            while (first != last) {
+                uint32_t buf[40];
+                int const size = 1 + gen() % 40;
+                auto const r = text::utf8::transcode_to_utf32(first, last, buf, buf + size);
+                EXPECT_LE(r.out - buf, size);
+                EXPECT_LT(first, r.in);
+                result.insert(result.end(), buf, r.out);
+                first = r.in;
+            }
+            EXPECT_EQ(result, expected);
+        }
+
+        {
+            std::vector<uint16_t> const expected = iterator_utf16(s);
+            std::vector<char16_t> result;
+            char const * first = s.c_str();
+            char const * const last = first + s.size();
+            while (first != last) {
+                char16_t buf[40];
+                int const size = 2 + gen() % 39;
+                auto const r = text::utf8::transcode_to_utf16(first, last, buf, buf + size);
+                EXPECT_LE(r.out - buf, size);
+                EXPECT_LT(first, r.in);
+                result.insert(result.end(), buf, r.out);
+                first = r.in;
+            }
+            EXPECT_TRUE(std::equal(result.begin(), result.end(), expected.begin(), expected.end()));
+
+            std::string round_trip;
+            char16_t const * first16 = result.data();
+            char16_t const * const last16 = first16 + result.size();
+            while (first16 != last16) {
+                char buf[40];
+                int const size = 4 + gen() % 37;
+                auto const r = text::utf8::transcode_from_utf16(first16, last16, buf, buf + size);
+                EXPECT_LE(r.out - buf, size);
+                EXPECT_LT(first16, r.in);
+                round_trip.insert(round_trip.end(), buf, r.out);
+                first16 = r.in;
+            }
+            if (i % 2 == 0) {
+                EXPECT_EQ(round_trip, s);
+            }
+        }
+    }
+}
+
+TEST(transcode, test_surrogate_pair_not_split)
+{
+    char const utf8[] = "a\xf0\x90\x8c\x82";
+    uint16_t buf[2];
+    auto r = text::utf8::transcode_to_utf16(utf8, utf8 + 5, buf, buf + 2);
+    EXPECT_EQ(r.in, utf8 + 1);
+    EXPECT_EQ(r.out, buf + 1);
+    EXPECT_EQ(buf[0], 'a');
+
+    r = text::utf8::transcode_to_utf16(r.in, utf8 + 5, buf, buf + 2);
+    EXPECT_EQ(r.in, utf8 + 5);
+    EXPECT_EQ(r.out, buf + 2);
+    EXPECT_EQ(buf[0], 0xd800);
+    EXPECT_EQ(buf[1], 0xdf02);
+}
+
+TEST(transcode, test_repair_encoding)
+{
+    {
+        char const str[] = "a\xe0\x80" "b\xf0\x90\x8c" "c\xff";
+        std::string repaired;
+        text::utf8::repair_encoding(str, str + sizeof(str) - 1, std::back_inserter(repaired));
+        EXPECT_EQ(repaired, "a\xef\xbf\xbd\xef\xbf\xbd" "b\xef\xbf\xbd" "c\xef\xbf\xbd");
+    }
+
+    std::mt19937 gen(42);
+    for (int i = 0; i < 20000; ++i) {
+        std::string const s = random_utf8(gen, i % 2 == 1);
+        std::string repaired;
+        text::utf8::repair_encoding(
+            s.c_str(), s.c_str() + s.size(), std::back_inserter(repaired)
+        );
+        EXPECT_TRUE(text::utf8::encoded(repaired.c_str(), repaired.c_str() + repaired.size()));
+        EXPECT_EQ(iterator_utf32(repaired), iterator_utf32(s)) << "iteration " << i;
+        if (i % 2 == 0) {
+            EXPECT_EQ(repaired, s);
+        }
+    }
+}
+
+TEST(transcode, test_forward_code_points)
+{
+    {
+        char const str[] = "a\xe0\x80" "b\xf0\x90\x8c\x82" "c\xff";
+        char const * const last = str + sizeof(str) - 1;
+        auto const range = text::utf8::forward_code_points(str, last);
+        std::vector<uint32_t> const cps(range.begin(), range.end());
+        std::vector<uint32_t> const expected = {
+            'a', 0xfffd, 0xfffd, 'b', 0x10302, 'c', 0xfffd
+        };
+        EXPECT_EQ(cps, expected);
+
+        auto it = range.begin();
+        EXPECT_EQ(it.base(), str);
+        std::advance(it, 4);
+        EXPECT_EQ(it.base(), str + 4);
+        EXPECT_EQ(*it, 0x10302u);
+        EXPECT_EQ((it++).base(), str + 4);
+        EXPECT_EQ(it.base(), str + 8);
+        EXPECT_EQ(std::distance(range.begin(), range.end()), 7);
+    }
+
+    {
+        auto const range = text::utf8::forward_code_points(nullptr, nullptr);
+        EXPECT_EQ(range.begin(), range.end());
+    }
+
+    std::mt19937 gen(6);
+    for (int i = 0; i < 5000; ++i) {
+        std::string const s = random_utf8(gen, i % 2 == 1);
+        char const * const first = s.c_str();
+        char const * const last = first + s.size();
+        std::vector<uint32_t> result;
+        for (uint32_t cp : text::utf8::forward_code_points(first, last)) {
+            result.push_back(cp);
+        }
+        EXPECT_EQ(result, iterator_utf32(s)) << "iteration " << i;
+
+        // Each code point starts where the previous one's decoding stopped.
+        char const * it = first;
+        auto const range = text::utf8::forward_code_points(first, last);
+        for (auto fwd_it = range.begin(); fwd_it != range.end(); ++fwd_it) {
+            EXPECT_EQ(fwd_it.base(), it);
+            text::utf8::detail::decode_code_point(it, last);
+        }
+        EXPECT_EQ(it, last);
+    }
+}
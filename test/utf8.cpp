@@ -2,6 +2,11 @@
 
 #include <gtest/gtest.h>
 
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
 
 using namespace boost;
 
@@ -530,3 +535,238 @@ TEST(utf_8, test_end_of_invalid_utf8)
         EXPECT_EQ(text::utf8::detail::end_of_invalid_utf8(utf8 + 6), nullptr);
     }
 }
+
+namespace {
+
+    // Every validator that find_invalid_encoding() may dispatch to must give
+    // the same result as the scalar one.
+    void check_find_invalid_encoding (char const * first, char const * last)
+    {
+        char const * const expected =
+            text::utf8::detail::find_invalid_encoding_scalar(first, last);
+        EXPECT_EQ(text::utf8::find_invalid_encoding(first, last), expected);
+        EXPECT_EQ(text::utf8::encoded(first, last), expected == last);
+#if BOOST_TEXT_SSE2
+        EXPECT_EQ(text::utf8::detail::find_invalid_encoding_sse2(first, last), expected);
+#endif
+#if BOOST_TEXT_AVX2
+        if (text::detail::cpu_has_avx2()) {
+            EXPECT_EQ(text::utf8::detail::find_invalid_encoding_avx2(first, last), expected);
+        }
+#endif
+    }
+
+    void append_utf8 (std::string & s, uint32_t cp)
+    {
+        if (cp < 0x80) {
+            s += char(cp);
+        } else if (cp < 0x800) {
+            s += char(0xc0 + (cp >> 6));
+            s += char(0x80 + (cp & 0x3f));
+        } else if (cp < 0x10000) {
+            s += char(0xe0 + (cp >> 12));
+            s += char(0x80 + ((cp >> 6) & 0x3f));
+            s += char(0x80 + (cp & 0x3f));
+        } else {
+            s += char(0xf0 + (cp >> 18));
+            s += char(0x80 + ((cp >> 12) & 0x3f));
+            s += char(0x80 + ((cp >> 6) & 0x3f));
+            s += char(0x80 + (cp & 0x3f));
+        }
+    }
+
+}
+
+TEST(utf_8, test_find_invalid_encoding_constexpr)
+{
+    {
+        constexpr char const str[] = "a\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82";
+        static_assert(text::utf8::encoded(str, str + sizeof(str) - 1), "");
+    }
+    {
+        constexpr char const str[] = "ab\xe4\xba";
+        static_assert(text::utf8::find_invalid_encoding(str, str + sizeof(str) - 1) == str + 2, "");
+    }
+}
+
+TEST(utf_8, test_find_invalid_encoding_all_pairs)
+{
+    // Every pair of bytes, placed within, at the end of, and straddling the
+    // 16- and 32-byte blocks used by the SIMD validators.
+    std::string str(70, 'a');
+    int const offsets[] = {0, 14, 15, 30, 31, 32, 63, 68};
+    for (int offset : offsets) {
+        for (int b0 = 0; b0 < 256; ++b0) {
+            for (int b1 = 0; b1 < 256; ++b1) {
+                str[offset] = char(b0);
+                str[offset + 1] = char(b1);
+                check_find_invalid_encoding(&*str.begin(), &*str.begin() + str.size());
+                check_find_invalid_encoding(&*str.begin(), &*str.begin() + offset + 1);
+                check_find_invalid_encoding(&*str.begin(), &*str.begin() + offset + 2);
+            }
+        }
+        str[offset] = 'a';
+        str[offset + 1] = 'a';
+    }
+}
+
+TEST(utf_8, test_find_invalid_encoding_random)
+{
+    uint32_t const code_points[] = {
+        0x0, 0x61, 0x7f, 0x80, 0x430, 0x7ff, 0x800, 0x4e8c, 0xd7ff, 0xe000,
+        0xfdd0, 0xfffe, 0xffff, 0x10000, 0x10302, 0x1f600, 0xfffff, 0x10ffff
+    };
+    int const num_code_points = sizeof(code_points) / sizeof(code_points[0]);
+
+    std::mt19937 gen(42);
+    for (int i = 0; i < 20000; ++i) {
+        std::string str;
+        int const length = gen() % 200;
+        int const ascii_percent = gen() % 101;
+        while ((int)str.size() < length) {
+            if ((int)(gen() % 100) < ascii_percent)
+                str += char('a' + gen() % 26);
+            else
+                append_utf8(str, code_points[gen() % num_code_points]);
+        }
+
+        char const * const first = str.c_str();
+        check_find_invalid_encoding(first, first + str.size());
+
+        if (str.empty())
+            continue;
+
+        std::string corrupted = str;
+        corrupted[gen() % corrupted.size()] = char(gen() % 256);
+        check_find_invalid_encoding(
+            corrupted.c_str(),
+            corrupted.c_str() + corrupted.size()
+        );
+
+        int const truncated = gen() % str.size();
+        check_find_invalid_encoding(first, first + truncated);
+    }
+}
+
+TEST(utf_8, test_count_code_points_constexpr)
+{
+    constexpr char const str[] = "a\xd0\xb0\xe4\xba\x8c\xf0\x90\x8c\x82";
+    static_assert(text::utf8::count_code_points(str, str + sizeof(str) - 1) == 4, "");
+    static_assert(text::utf8::advance_code_points(str, str + sizeof(str) - 1, 2) == str + 3, "");
+    static_assert(text::utf8::advance_code_points(str, str + sizeof(str) - 1, 4) == str + sizeof(str) - 1, "");
+}
+
+TEST(utf_8, test_count_and_advance_code_points)
+{
+    uint32_t const code_points[] = {
+        0x61, 0x7f, 0x430, 0x7ff, 0x800, 0x4e8c, 0xffff, 0x10302, 0x1f600, 0x10ffff
+    };
+    int const num_code_points = sizeof(code_points) / sizeof(code_points[0]);
+
+    std::mt19937 gen(42);
+    for (int i = 0; i < 2000; ++i) {
+        // Long enough to cover the flushes of the SIMD byte counters.
+        int const length = i % 10 == 0 ? 20000 : gen() % 200;
+        int const ascii_percent = gen() % 101;
+        std::string str;
+        std::vector<std::ptrdiff_t> offsets;
+        while ((int)str.size() < length) {
+            offsets.push_back(str.size());
+            if ((int)(gen() % 100) < ascii_percent)
+                str += char('a' + gen() % 26);
+            else
+                append_utf8(str, code_points[gen() % num_code_points]);
+        }
+
+        char const * const first = str.c_str();
+        char const * const last = first + str.size();
+        std::ptrdiff_t const count = offsets.size();
+        EXPECT_EQ(text::utf8::count_code_points(first, last), count);
+        EXPECT_EQ(text::utf8::count_code_points(str.begin(), str.end()), count);
+
+        for (std::ptrdiff_t n = 0; n <= count + 1; n += 1 + gen() % 7) {
+            char const * const expected = n < count ? first + offsets[n] : last;
+            EXPECT_EQ(text::utf8::advance_code_points(first, last, n), expected);
+            EXPECT_EQ(
+                text::utf8::advance_code_points(str.begin(), str.end(), n) - str.begin(),
+                expected - first
+            );
+#if BOOST_TEXT_SSE2
+            EXPECT_EQ(text::utf8::detail::advance_code_points_sse2(first, last, n), expected);
+#endif
+        }
+
+        EXPECT_EQ(text::utf8::detail::count_code_points_scalar(first, last), count);
+#if BOOST_TEXT_SSE2
+        EXPECT_EQ(text::utf8::detail::count_code_points_sse2(first, last), count);
+#endif
+#if BOOST_TEXT_AVX2
+        if (text::detail::cpu_has_avx2()) {
+            EXPECT_EQ(text::utf8::detail::count_code_points_avx2(first, last), count);
+        }
+#endif
+    }
+}
+
+TEST(utf_8, test_count_utf16_code_units_constexpr)
+{
+    constexpr char const str[] = "a\xd0\xb0\xf0\x90\x8c\x82\xe4\xba\x8c";
+    static_assert(text::utf8::count_utf16_code_units(str, str + sizeof(str) - 1) == 5, "");
+    static_assert(text::utf8::advance_utf16_code_units(str, str + sizeof(str) - 1, 3) == str + 3, "");
+    static_assert(text::utf8::advance_utf16_code_units(str, str + sizeof(str) - 1, 4) == str + 7, "");
+}
+
+TEST(utf_8, test_count_and_advance_utf16_code_units)
+{
+    uint32_t const code_points[] = {
+        // No noncharacters, which to_utf16_iterator replaces with 0xfffd.
+        0x61, 0x7f, 0x430, 0x7ff, 0x800, 0x4e8c, 0xfffd, 0x10302, 0x1f600, 0x10fffd
+    };
+    int const num_code_points = sizeof(code_points) / sizeof(code_points[0]);
+
+    std::mt19937 gen(43);
+    for (int i = 0; i < 2000; ++i) {
+        int const length = i % 10 == 0 ? 20000 : gen() % 200;
+        int const ascii_percent = gen() % 101;
+        std::string str;
+        // The UTF-8 offset of the code point holding each UTF-16 code unit.
+        std::vector<std::ptrdiff_t> offsets;
+        while ((int)str.size() < length) {
+            uint32_t const cp = (int)(gen() % 100) < ascii_percent ?
+                'a' + gen() % 26 : code_points[gen() % num_code_points];
+            offsets.push_back(str.size());
+            if (0x10000 <= cp)
+                offsets.push_back(str.size());
+            append_utf8(str, cp);
+        }
+
+        char const * const first = str.c_str();
+        char const * const last = first + str.size();
+        std::ptrdiff_t const count = offsets.size();
+        using iter_t = text::utf8::to_utf16_iterator<char const *>;
+        EXPECT_EQ(std::distance(iter_t(first), iter_t(last)), count);
+        EXPECT_EQ(text::utf8::count_utf16_code_units(first, last), count);
+        EXPECT_EQ(text::utf8::count_utf16_code_units(str.begin(), str.end()), count);
+        EXPECT_EQ(text::utf8::detail::count_utf16_code_units_scalar(first, last), count);
+#if BOOST_TEXT_SSE2
+        EXPECT_EQ(text::utf8::detail::count_utf16_code_units_sse2(first, last), count);
+#else
+        EXPECT_EQ(text::utf8::detail::count_utf16_code_units_words(first, last), count);
+#endif
+
+        for (std::ptrdiff_t n = 0; n <= count + 1; n += 1 + gen() % 7) {
+            char const * const expected = n < count ? first + offsets[n] : last;
+            EXPECT_EQ(text::utf8::advance_utf16_code_units(first, last, n), expected);
+            EXPECT_EQ(
+                text::utf8::advance_utf16_code_units(str.begin(), str.end(), n) - str.begin(),
+                expected - first
+            );
+            if (n < count) {
+                EXPECT_EQ(
+                    text::utf8::count_utf16_code_units(first, first + offsets[n]),
+                    n == 0 || offsets[n - 1] != offsets[n] ? n : n - 1
+                );
+            }
+        }
+    }
+}
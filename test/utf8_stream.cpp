@@ -0,0 +1,154 @@
+#include <boost/text/utf8_stream.hpp>
+
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace boost;
+
+namespace {
+
+    std::string random_utf8 (std::mt19937 & gen, bool corrupt)
+    {
+        uint32_t const code_points[] = {
+            0x61, 0x7f, 0x80, 0x430, 0x7ff, 0x800, 0x4e8c, 0xd7ff, 0xe000,
+            0xfffd, 0x10000, 0x10302, 0x1f600, 0x10ffff
+        };
+        int const num_code_points = sizeof(code_points) / sizeof(code_points[0]);
+
+        std::string retval;
+        int const length = gen() % 300;
+        while ((int)retval.size() < length) {
+            uint32_t const utf32[] = {code_points[gen() % num_code_points]};
+            retval.insert(
+                retval.end(),
+                text::utf8::from_utf32_iterator<uint32_t const *>(utf32),
+                text::utf8::from_utf32_iterator<uint32_t const *>(utf32 + 1)
+            );
+        }
+
+        if (corrupt && !retval.empty()) {
+            int const corruptions = 1 + gen() % 3;
+            for (int i = 0; i < corruptions; ++i) {
+                retval[gen() % retval.size()] = char(gen() % 256);
+            }
+            retval.resize(gen() % (retval.size() + 1));
+        }
+
+        return retval;
+    }
+
+    // Splits [0, size) into chunks of random sizes, including empty ones.
+    std::vector<int> random_chunk_ends (std::mt19937 & gen, int size)
+    {
+        int const max_chunk = 1 + gen() % 40;
+        std::vector<int> retval;
+        int end = 0;
+        while (end < size) {
+            end = (std::min)(size, end + int(gen() % (max_chunk + 1)));
+            retval.push_back(end);
+        }
+        return retval;
+    }
+
+}
+
+TEST(utf8_stream, test_validator_split_code_point)
+{
+    char const str[] = "a\xf0\x90\x8c\x82" "b";
+    for (int i = 1; i < 6; ++i) {
+        for (int j = i; j < 6; ++j) {
+            text::utf8::stream_validator v;
+            EXPECT_TRUE(v.feed(str, str + i));
+            EXPECT_TRUE(v.feed(str + i, str + j));
+            EXPECT_TRUE(v.feed(str + j, str + 6));
+            EXPECT_EQ(v.pending_size(), 0);
+            EXPECT_TRUE(v.finish());
+            EXPECT_EQ(v.offset(), 6);
+            EXPECT_EQ(v.error_offset(), -1);
+        }
+    }
+
+    {
+        text::utf8::stream_validator v;
+        EXPECT_TRUE(v.feed(str, str + 3));
+        EXPECT_EQ(v.pending_size(), 2);
+        EXPECT_FALSE(v.finish());
+        EXPECT_EQ(v.error_offset(), 1);
+    }
+
+    {
+        // E0 80 can never begin a valid code point, so the error is found
+        // before the code point is complete.
+        char const bad[] = "ab\xe0\x80";
+        text::utf8::stream_validator v;
+        EXPECT_TRUE(v.feed(bad, bad + 3));
+        EXPECT_FALSE(v.feed(bad + 3, bad + 4));
+        EXPECT_EQ(v.error_offset(), 2);
+        EXPECT_FALSE(v.feed(bad, bad + 4));
+        EXPECT_EQ(v.offset(), 8);
+        EXPECT_EQ(v.error_offset(), 2);
+    }
+}
+
+TEST(utf8_stream, test_decoder_split_code_point)
+{
+    char const str[] = "a\xf0\x90\x8c\x82" "b";
+    for (int i = 1; i < 6; ++i) {
+        std::vector<uint32_t> cps;
+        text::utf8::stream_decoder d;
+        d.feed(str, str + i, std::back_inserter(cps));
+        d.feed(str + i, str + 6, std::back_inserter(cps));
+        d.finish(std::back_inserter(cps));
+        EXPECT_EQ(cps, std::vector<uint32_t>({0x61, 0x10302, 0x62}));
+    }
+
+    {
+        std::vector<uint32_t> cps;
+        text::utf8::stream_decoder d;
+        d.feed(str, str + 4, std::back_inserter(cps));
+        EXPECT_EQ(d.pending_size(), 3);
+        d.finish(std::back_inserter(cps));
+        EXPECT_EQ(cps, std::vector<uint32_t>({0x61, 0xfffd}));
+        EXPECT_EQ(d.pending_size(), 0);
+    }
+}
+
+TEST(utf8_stream, test_random_chunks)
+{
+    std::mt19937 gen(42);
+    for (int i = 0; i < 20000; ++i) {
+        std::string const str = random_utf8(gen, i % 2 == 1);
+        char const * const first = str.c_str();
+        char const * const last = first + str.size();
+
+        char const * const invalid = text::utf8::find_invalid_encoding(first, last);
+        std::ptrdiff_t const expected_error_offset =
+            invalid == last ? -1 : invalid - first;
+
+        using iter_t = text::utf8::to_utf32_iterator<char const *>;
+        std::vector<uint32_t> const expected_cps{iter_t(first), iter_t(last)};
+
+        std::vector<int> const ends = random_chunk_ends(gen, str.size());
+
+        text::utf8::stream_validator v;
+        text::utf8::stream_decoder d;
+        std::vector<uint32_t> cps;
+        int chunk_first = 0;
+        for (int end : ends) {
+            v.feed(first + chunk_first, first + end);
+            d.feed(first + chunk_first, first + end, std::back_inserter(cps));
+            chunk_first = end;
+        }
+        v.finish();
+        d.finish(std::back_inserter(cps));
+
+        EXPECT_EQ(v.error_offset(), expected_error_offset) << "iteration " << i;
+        EXPECT_EQ(v.offset(), (std::ptrdiff_t)str.size());
+        EXPECT_EQ(cps, expected_cps) << "iteration " << i;
+    }
+}